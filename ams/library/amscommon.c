@@ -13,8 +13,160 @@
 #define EPOCH_OFFSET_1958	(378691200)
 #define	MAX_GW_EID		(255)
 
+#define	AMS_INDEX_MIN_BUCKETS	(16)
+
 extern void	destroyAmsEndpoint(LystElt elt, void *userdata);
 
+/*	*	*	Integer-keyed index functions	*	*	*/
+
+static int	indexBucket(AmsIndex *index, int key)
+{
+	unsigned int	h = (unsigned int) key;
+
+	/*	Mix the bits of the key so that module keys, which
+	 *	differ mainly in their low-order bits within a unit
+	 *	and in multiples of MAX_MODULE_NBR + 1 across units,
+	 *	spread evenly over the buckets.				*/
+
+	h ^= h >> 16;
+	h *= 0x45d9f3b;
+	h ^= h >> 16;
+	return h & (index->bucketCount - 1);
+}
+
+static int	growIndex(AmsIndex *index)
+{
+	AmsIndexEntry	**oldBuckets = index->buckets;
+	int		oldCount = index->bucketCount;
+	int		newCount;
+	int		i;
+	AmsIndexEntry	*entry;
+	AmsIndexEntry	*nextEntry;
+	int		idx;
+
+	newCount = (oldCount == 0 ? AMS_INDEX_MIN_BUCKETS : oldCount * 2);
+	index->buckets = (AmsIndexEntry **)
+			MTAKE(newCount * sizeof(AmsIndexEntry *));
+	if (index->buckets == NULL)
+	{
+		index->buckets = oldBuckets;
+		putErrmsg("Can't enlarge AMS index.", itoa(newCount));
+		return -1;
+	}
+
+	memset((char *) index->buckets, 0, newCount * sizeof(AmsIndexEntry *));
+	index->bucketCount = newCount;
+	for (i = 0; i < oldCount; i++)
+	{
+		for (entry = oldBuckets[i]; entry; entry = nextEntry)
+		{
+			nextEntry = entry->next;
+			idx = indexBucket(index, entry->key);
+			entry->next = index->buckets[idx];
+			index->buckets[idx] = entry;
+		}
+	}
+
+	if (oldBuckets)
+	{
+		MRELEASE(oldBuckets);
+	}
+
+	return 0;
+}
+
+LystElt	amsIndexFind(AmsIndex *index, int key)
+{
+	AmsIndexEntry	*entry;
+
+	if (index->bucketCount == 0)
+	{
+		return NULL;
+	}
+
+	for (entry = index->buckets[indexBucket(index, key)]; entry;
+			entry = entry->next)
+	{
+		if (entry->key == key)
+		{
+			return entry->elt;
+		}
+	}
+
+	return NULL;
+}
+
+int	amsIndexInsert(AmsIndex *index, int key, LystElt elt)
+{
+	AmsIndexEntry	*entry;
+	int		idx;
+
+	CHKERR(elt);
+	if (index->entryCount >= index->bucketCount)
+	{
+		if (growIndex(index) < 0)
+		{
+			return -1;
+		}
+	}
+
+	entry = (AmsIndexEntry *) MTAKE(sizeof(AmsIndexEntry));
+	CHKERR(entry);
+	entry->key = key;
+	entry->elt = elt;
+	idx = indexBucket(index, key);
+	entry->next = index->buckets[idx];
+	index->buckets[idx] = entry;
+	index->entryCount++;
+	return 0;
+}
+
+void	amsIndexRemove(AmsIndex *index, int key)
+{
+	AmsIndexEntry	**link;
+	AmsIndexEntry	*entry;
+
+	if (index->bucketCount == 0)
+	{
+		return;
+	}
+
+	for (link = &(index->buckets[indexBucket(index, key)]);
+			(entry = *link) != NULL; link = &(entry->next))
+	{
+		if (entry->key == key)
+		{
+			*link = entry->next;
+			MRELEASE(entry);
+			index->entryCount--;
+			return;
+		}
+	}
+}
+
+void	amsIndexClear(AmsIndex *index)
+{
+	int		i;
+	AmsIndexEntry	*entry;
+	AmsIndexEntry	*nextEntry;
+
+	for (i = 0; i < index->bucketCount; i++)
+	{
+		for (entry = index->buckets[i]; entry; entry = nextEntry)
+		{
+			nextEntry = entry->next;
+			MRELEASE(entry);
+		}
+	}
+
+	if (index->buckets)
+	{
+		MRELEASE(index->buckets);
+	}
+
+	memset((char *) index, 0, sizeof(AmsIndex));
+}
+
 static void	eraseContinuum(Continuum *contin)
 {
 	if (contin == NULL)
@@ -77,6 +229,7 @@ void	eraseSubject(Venture *venture, Subject *subj)
 		lyst_destroy(subj->modules);
 	}
 
+	amsIndexClear(&subj->fanIndex);
 	venture->subjects[subj->nbr] = NULL;
 	MRELEASE(subj);
 }
@@ -139,6 +292,8 @@ void	eraseMsgspace(Venture *venture, Subject *msgspace)
 		lyst_destroy(msgspace->modules);
 	}
 
+	amsIndexClear(&msgspace->fanIndex);
+
 	venture->msgspaces[0 - msgspace->nbr] = NULL;
 	MRELEASE(msgspace);
 }
@@ -170,6 +325,7 @@ static void	eraseModule(Module *module)
 		lyst_destroy(module->subjects);
 	}
 
+	amsIndexClear(&module->subjIndex);
 	clearMamsEndpoint(&module->mamsEndpoint);
 	module->role = NULL;
 	MRELEASE(module);
@@ -1113,6 +1269,8 @@ static void	destroyFanModule(LystElt elt, void *userdata)
 {
 	FanModule	*fan = (FanModule *) lyst_data(elt);
 
+	amsIndexRemove(&fan->subj->subject->fanIndex,
+			MODULE_KEY(fan->module->unitNbr, fan->module->nbr));
 	MRELEASE(fan);
 }
 
@@ -2043,6 +2201,7 @@ void	forgetModule(Module *module)
 		lyst_delete(elt);
 	}
 
+	amsIndexClear(&module->subjIndex);
 	clearMamsEndpoint(&module->mamsEndpoint);
 	module->role = NULL;
 }
@@ -195,6 +195,28 @@ typedef int		(*TsSendAmsFn)(AmsEndpointP endpoint, AmsSapP sap,
 				unsigned char flowLabel,
 				char *header, int headerLen,
 				char *content, int contentLen);
+
+/*	An AmsRecipient identifies one destination of a message that
+ *	is sent to multiple modules, e.g., by ams_publish.  The copies
+ *	of such a message differ only in the first byte of the header
+ *	(protected bits and priority, which may be set per XmitRule)
+ *	and therefore in the checksum.  A transport service that
+ *	provides a sendAmsvFn can build the message once and send
+ *	all copies in a single operation; checksum is scratch space
+ *	for the transport service's use.				*/
+
+typedef struct
+{
+	AmsEndpointP	endpoint;
+	unsigned char	flowLabel;
+	unsigned char	headerByte;
+	unsigned short	checksum;
+} AmsRecipient;
+
+typedef int		(*TsSendAmsvFn)(AmsRecipient *recipients,
+				int count, AmsSapP sap,
+				char *header, int headerLen,
+				char *content, int contentLen);
 typedef struct tsvcst
 {
 	char		*name;
@@ -209,6 +231,7 @@ typedef struct tsvcst
 	TsAmsParseFn	parseAmsEndpointFn;
 	TsAmsClearFn	clearAmsEndpointFn;
 	TsSendAmsFn	sendAmsFn;
+	TsSendAmsvFn	sendAmsvFn;	/*	Optional.		*/
 	TsShutdownFn	shutdownFn;
 } TransSvc;
 
@@ -257,6 +280,33 @@ typedef struct
 	char		*privateKeyName;/*	Only in module's MIB.	*/
 } AppRole;
 
+/*	AmsIndex is a small chained hash table that maps integer keys
+ *	(subject numbers, module keys) to the elements of the sorted
+ *	lists that hold the corresponding objects, so that message
+ *	fan-out can find those elements without scanning the lists.
+ *	A zero-filled AmsIndex is empty and valid.			*/
+
+typedef struct amsidxentst
+{
+	int			key;
+	LystElt			elt;
+	struct amsidxentst	*next;
+} AmsIndexEntry;
+
+typedef struct
+{
+	int		bucketCount;	/*	Always a power of 2.	*/
+	int		entryCount;
+	AmsIndexEntry	**buckets;
+} AmsIndex;
+
+/*	MODULE_KEY uniquely identifies a module within a message
+ *	space; module numbers are unique only within a unit.		*/
+
+#define	MODULE_KEY(unitNbr, moduleNbr)	\
+		(((unitNbr) * (MAX_MODULE_NBR + 1)) + (moduleNbr))
+#define	MODULE_KEY_LIMIT	((MAX_UNIT_NBR + 1) * (MAX_MODULE_NBR + 1))
+
 /*	Modules send and receive the messages that are exchanged within
  *	an instance of an application.  Modules' references to subjects
  *	are encapsulated in SubjOfInterest structures.			*/
@@ -283,6 +333,7 @@ typedef struct
 	MamsEndpoint	mamsEndpoint;	/*	Of module.		*/
 	Lyst		amsEndpoints;	/*	(AmsEndpoint *)		*/
 	Lyst		subjects;	/*	(SubjOfInterest *)	*/
+	AmsIndex	subjIndex;	/*	subjects, by subj nbr.	*/
 	int		heartbeatsMissed;	/*	To Registrar.	*/
 	int		confirmed;	/*	Boolean.		*/
 } Module;
@@ -313,6 +364,7 @@ typedef struct subjst
 	char		*marshalFnName;
 	char		*unmarshalFnName;
 	Lyst		modules;		/*	(FanModule *)	*/
+	AmsIndex	fanIndex;		/*	modules, by key.*/
 	LystElt		elt;			/*	In hashtable.	*/
 
 	/*	If this Subject is for a message space (i.e.,
@@ -474,6 +526,11 @@ extern AppRole	*lookUpRole(Venture *venture, char *roleName);
 extern Unit	*lookUpUnit(Venture *venture, char *unitName);
 extern int	lookUpContinuum(char *continuumName);
 
+extern LystElt	amsIndexFind(AmsIndex *index, int key);
+extern int	amsIndexInsert(AmsIndex *index, int key, LystElt elt);
+extern void	amsIndexRemove(AmsIndex *index, int key);
+extern void	amsIndexClear(AmsIndex *index);
+
 extern void	eraseApp(AmsApp *app);
 extern LystElt	createApp(char *name, char *publicKeyName,
 			char *privateKeyName);
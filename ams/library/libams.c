@@ -1332,12 +1332,20 @@ static LystElt	findSubjOfInterest(AmsSAP *sap, Module *module,
 
 	/*	This function finds the SubjOfInterest containing
 	 *	all XmitRules asserted by this module for the specified
-	 *	subject, if any.					*/
+	 *	subject, if any.  The module's subject index resolves
+	 *	the lookup directly; the list is scanned only when the
+	 *	caller needs the insertion point for a new subject.	*/
 
 #if AMSDEBUG
 printf("subjects list length is %u.\n", lyst_length(module->subjects));
 #endif
 	if (nextSubj) *nextSubj = NULL;	/*	Default.		*/
+	elt = amsIndexFind(&module->subjIndex, subject->nbr);
+	if (elt || nextSubj == NULL)
+	{
+		return elt;
+	}
+
 	for (elt = lyst_first(module->subjects); elt; elt = lyst_next(elt))
 	{
 		subj = (SubjOfInterest *) lyst_data(elt);
@@ -1368,9 +1376,17 @@ static LystElt	findFanModule(AmsSAP *sap, Subject *subject, Module *module,
 
 	/*	This function finds the FanModule containing
 	 *	all XmitRule asserted by this module for the specified
-	 *	subject, if any.					*/
+	 *	subject, if any.  As in findSubjOfInterest, the list
+	 *	is scanned only to find an insertion point.		*/
 
 	if (nextFan) *nextFan = NULL;	/*	Default.		*/
+	elt = amsIndexFind(&subject->fanIndex, MODULE_KEY(module->unitNbr,
+			module->nbr));
+	if (elt || nextFan == NULL)
+	{
+		return elt;
+	}
+
 	for (elt = lyst_first(subject->modules); elt; elt = lyst_next(elt))
 	{
 		fan = (FanModule *) lyst_data(elt);
@@ -1567,6 +1583,12 @@ static int	noteAssertion(AmsSAP *sap, Module *module, Subject *subject,
 		}
 
 		CHKERR(elt);
+		if (amsIndexInsert(&module->subjIndex, subject->nbr, elt) < 0)
+		{
+			putErrmsg("Can't index subject of interest.",
+					subject->name);
+			return -1;
+		}
 
 		/*	Also need to insert new FanModule for
 		 *	this subject.					*/
@@ -1593,6 +1615,13 @@ static int	noteAssertion(AmsSAP *sap, Module *module, Subject *subject,
 		}
 
 		CHKERR(subj->fanElt);
+		if (amsIndexInsert(&subject->fanIndex,
+				MODULE_KEY(module->unitNbr, module->nbr),
+				subj->fanElt) < 0)
+		{
+			putErrmsg("Can't index fan module.", subject->name);
+			return -1;
+		}
 	}
 	else	/*	Module already has interest in this subject.	*/
 	{
@@ -4389,39 +4418,139 @@ static XmitRule	*getXmitRule(AmsSAP *sap, Lyst rules)
 	return NULL;
 }	
 
-static int	receivedMsgAlready(Lyst recipients, int moduleNbr)
+/*	Modules that have already been sent a copy of a message are
+ *	noted in a bitmap indexed by module key, so that checking for
+ *	a duplicate copy costs the same for every recipient.		*/
+
+#define	RECIPIENTS_MAP_SIZE	((MODULE_KEY_LIMIT + 7) >> 3)
+
+static int	receivedMsgAlready(unsigned char *recipients, Module *module)
 {
-	LystElt	elt;
-	long	longModuleNbr = (long) moduleNbr;
+	int	key = MODULE_KEY(module->unitNbr, module->nbr);
+
+	return ((recipients[key >> 3] & (1 << (key & 0x07))) != 0);
+}
+
+static void	noteRecipient(unsigned char *recipients, Module *module)
+{
+	int	key = MODULE_KEY(module->unitNbr, module->nbr);
+
+	recipients[key >> 3] |= (1 << (key & 0x07));
+}
+
+/*	Copies of a message that is sent to multiple modules are
+ *	accumulated in an AmsFanout and handed to the transport
+ *	service in batches, so that a transport service that can send
+ *	to many endpoints at once (sendAmsvFn) builds the message only
+ *	once per batch.  Consecutive recipients reached through the
+ *	same transport service are batched together.			*/
+
+#define	AMS_FANOUT_BATCH	(64)
+
+typedef struct
+{
+	AmsSAP		*sap;
+	char		*header;
+	int		headerLength;
+	char		*content;
+	int		contentLength;
+	TransSvc	*ts;
+	int		count;
+	AmsRecipient	recipients[AMS_FANOUT_BATCH];
+} AmsFanout;
+
+static void	initFanout(AmsFanout *fanout, AmsSAP *sap, char *header,
+			int headerLength, char *content, int contentLength)
+{
+	fanout->sap = sap;
+	fanout->header = header;
+	fanout->headerLength = headerLength;
+	fanout->content = content;
+	fanout->contentLength = contentLength;
+	fanout->ts = NULL;
+	fanout->count = 0;
+}
+
+static int	flushFanout(AmsFanout *fanout)
+{
+	TransSvc	*ts = fanout->ts;
+	AmsRecipient	*rcpt;
+	int		i;
+	int		result = 0;
+
+	if (fanout->count == 0)
+	{
+		return 0;
+	}
 
-	for (elt = lyst_first(recipients); elt; elt = lyst_next(elt))
+	if (ts->sendAmsvFn)
 	{
-		if (longModuleNbr == (long) lyst_data(elt))
+		result = ts->sendAmsvFn(fanout->recipients, fanout->count,
+				fanout->sap, fanout->header,
+				fanout->headerLength, fanout->content,
+				fanout->contentLength);
+	}
+	else
+	{
+		for (i = 0, rcpt = fanout->recipients; i < fanout->count;
+				i++, rcpt++)
 		{
-			return 1;
+			fanout->header[0] = (char) (rcpt->headerByte);
+			result = ts->sendAmsFn(rcpt->endpoint, fanout->sap,
+					rcpt->flowLabel, fanout->header,
+					fanout->headerLength, fanout->content,
+					fanout->contentLength);
+			if (result < 0)
+			{
+				break;
+			}
 		}
 	}
 
+	fanout->count = 0;
+	return (result < 0 ? -1 : 0);
+}
+
+static int	addToFanout(AmsFanout *fanout, XmitRule *rule,
+			unsigned char headerByte, unsigned char flowLabel)
+{
+	TransSvc	*ts = rule->amsEndpoint->ts;
+	AmsRecipient	*rcpt;
+
+	if (fanout->count > 0
+	&& (ts != fanout->ts || fanout->count == AMS_FANOUT_BATCH))
+	{
+		if (flushFanout(fanout) < 0)
+		{
+			return -1;
+		}
+	}
+
+	fanout->ts = ts;
+	rcpt = fanout->recipients + fanout->count;
+	rcpt->endpoint = rule->amsEndpoint;
+	rcpt->flowLabel = flowLabel;
+	rcpt->headerByte = headerByte;
+	fanout->count++;
 	return 0;
 }
 
 static int	sendToSubscribers(AmsSAP *sap, Subject *subject,
 			int priority, unsigned char flowLabel, 
-			unsigned char protectedBits, char *amsHeader,
-			int headerLength, char *content, int contentLength,
-	       		Lyst recipients)
+			unsigned char protectedBits, AmsFanout *fanout,
+	       		unsigned char *recipients)
 {
 	LystElt		elt;
 	FanModule	*fan;
 	XmitRule	*rule;
-	int		result;
+	unsigned char	headerByte;
 
 	for (elt = lyst_first(subject->modules); elt; elt = lyst_next(elt))
 	{
 		fan = (FanModule *) lyst_data(elt);
 		if (subject->nbr == ALL_SUBJECTS)
 		{
-			if (receivedMsgAlready(recipients, fan->module->nbr))
+			if (receivedMsgAlready(recipients, fan->module))
 			{
 				continue;/*	Don't send 2nd copy.	*/
 			}
@@ -4439,11 +4568,11 @@ static int	sendToSubscribers(AmsSAP *sap, Subject *subject,
 
 		if (priority)		/*	Override.		*/
 		{
-			amsHeader[0] = (char) (protectedBits | priority);
+			headerByte = protectedBits | priority;
 		}
 		else			/*	Use default per rule.	*/
 		{
-			amsHeader[0] = (char) (protectedBits | rule->priority);
+			headerByte = protectedBits | rule->priority;
 		}
 
 		if (flowLabel == 0)
@@ -4451,18 +4580,14 @@ static int	sendToSubscribers(AmsSAP *sap, Subject *subject,
 			flowLabel = rule->flowLabel;
 		}
 
-		result = rule->amsEndpoint->ts->sendAmsFn(rule->amsEndpoint,
-				sap, flowLabel, amsHeader, headerLength,
-				content, contentLength);
-		if (result < 0)
+		if (addToFanout(fanout, rule, headerByte, flowLabel) < 0)
 		{
-			return result;
+			return -1;
 		}
 
 		if (subject->nbr != ALL_SUBJECTS)
 		{
-			lyst_insert_last(recipients,
-					(void *) ((long) (fan->module->nbr)));
+			noteRecipient(recipients, fan->module);
 		}
 	}
 
@@ -4477,7 +4602,8 @@ static int	ams_publish2(AmsSAP *sap, int subjectNbr, int priority,
 	char		amsHeader[16];
 	int		headerLength = sizeof amsHeader;
 	unsigned char	protectedBits;
-	Lyst		recipients;
+	unsigned char	recipients[RECIPIENTS_MAP_SIZE];
+	AmsFanout	fanout;
 	int		result;
 
 	CHKERR(sap);
@@ -4497,18 +4623,17 @@ static int	ams_publish2(AmsSAP *sap, int subjectNbr, int priority,
 	}
 
 	protectedBits = amsHeader[0] & 0xf0;
-	recipients = lyst_create_using(getIonMemoryMgr());
-	CHKERR(recipients);
+	memset((char *) recipients, 0, sizeof recipients);
+	initFanout(&fanout, sap, amsHeader, headerLength, content,
+			contentLength);
 
 	/*	Now send a copy of the message to every subscriber
 	 *	that has posted at least one subscription whose domain
 	 *	includes the local module.				*/
 
 	if (sendToSubscribers(sap, subject, priority, flowLabel, protectedBits,
-			amsHeader, headerLength, content, contentLength,
-			recipients) < 0)
+			&fanout, recipients) < 0)
 	{
-		lyst_destroy(recipients);
 		MRELEASE(content);
 		return -1;
 	}
@@ -4519,9 +4644,12 @@ static int	ams_publish2(AmsSAP *sap, int subjectNbr, int priority,
 
 	subject = sap->venture->subjects[ALL_SUBJECTS];
 	result = sendToSubscribers(sap, subject, priority, flowLabel,
-			protectedBits, amsHeader, headerLength, content,
-			contentLength, recipients);
-	lyst_destroy(recipients);
+			protectedBits, &fanout, recipients);
+	if (result == 0)
+	{
+		result = flushFanout(&fanout);
+	}
+
 	MRELEASE(content);
 	return result;
 }
@@ -5772,7 +5900,9 @@ static int	ams_announce2(AmsSAP *sap, int roleNbr, int continuumNbr,
 	int		headerLength = sizeof amsHeader;
 	int		result;
 	unsigned char	protectedBits;
-	Lyst		recipients;
+	unsigned char	recipients[RECIPIENTS_MAP_SIZE];
+	AmsFanout	fanout;
+	unsigned char	headerByte;
 	LystElt		elt;
 	FanModule	*fan;
 	XmitRule	*rule;
@@ -5834,8 +5964,9 @@ static int	ams_announce2(AmsSAP *sap, int roleNbr, int continuumNbr,
 	 *	message space now.					*/
 
 	protectedBits = amsHeader[0] & 0xf0;
-	recipients = lyst_create_using(getIonMemoryMgr());
-	CHKERR(recipients);
+	memset((char *) recipients, 0, sizeof recipients);
+	initFanout(&fanout, sap, amsHeader, headerLength, content,
+			contentLength);
 
 	/*	First send a copy of the message to every module in the
 	 *	domain of this request that has posted at least one
@@ -5874,11 +6005,11 @@ static int	ams_announce2(AmsSAP *sap, int roleNbr, int continuumNbr,
 
 		if (priority)		/*	Override.		*/
 		{
-			amsHeader[0] = (char) (protectedBits | priority);
+			headerByte = protectedBits | priority;
 		}
 		else			/*	Use default per rule.	*/
 		{
-			amsHeader[0] = (char) (protectedBits | rule->priority);
+			headerByte = protectedBits | rule->priority;
 		}
 
 		if (flowLabel == 0)
@@ -5886,18 +6017,13 @@ static int	ams_announce2(AmsSAP *sap, int roleNbr, int continuumNbr,
 			flowLabel = rule->flowLabel;
 		}
 
-		result = rule->amsEndpoint->ts->sendAmsFn(rule->amsEndpoint,
-				sap, flowLabel, amsHeader, headerLength,
-				content, contentLength);
-		if (result < 0)
+		if (addToFanout(&fanout, rule, headerByte, flowLabel) < 0)
 		{
-			lyst_destroy(recipients);
 			MRELEASE(content);
-			return result;
+			return -1;
 		}
 
-		lyst_insert_last(recipients,
-				(void *) ((long) (fan->module->nbr)));
+		noteRecipient(recipients, fan->module);
 	}
 
 	/*	Now send a copy of the message to every module in the
@@ -5913,7 +6039,7 @@ static int	ams_announce2(AmsSAP *sap, int roleNbr, int continuumNbr,
 	for (elt = lyst_first(subject->modules); elt; elt = lyst_next(elt))
 	{
 		fan = (FanModule *) lyst_data(elt);
-		if (receivedMsgAlready(recipients, fan->module->nbr))
+		if (receivedMsgAlready(recipients, fan->module))
 		{
 			continue;	/*	Don't send 2nd copy.	*/
 		}
@@ -5943,11 +6069,11 @@ static int	ams_announce2(AmsSAP *sap, int roleNbr, int continuumNbr,
 
 		if (priority)		/*	Override.		*/
 		{
-			amsHeader[0] = (char) (protectedBits | priority);
+			headerByte = protectedBits | priority;
 		}
 		else			/*	Use default per rule.	*/
 		{
-			amsHeader[0] = (char) (protectedBits | rule->priority);
+			headerByte = protectedBits | rule->priority;
 		}
 
 		if (flowLabel == 0)
@@ -5955,20 +6081,16 @@ static int	ams_announce2(AmsSAP *sap, int roleNbr, int continuumNbr,
 			flowLabel = rule->flowLabel;
 		}
 
-		result = rule->amsEndpoint->ts->sendAmsFn(rule->amsEndpoint,
-				sap, flowLabel, amsHeader, headerLength,
-				content, contentLength);
-		if (result < 0)
+		if (addToFanout(&fanout, rule, headerByte, flowLabel) < 0)
 		{
-			lyst_destroy(recipients);
 			MRELEASE(content);
-			return result;
+			return -1;
 		}
 	}
 
-	lyst_destroy(recipients);
+	result = flushFanout(&fanout);
 	MRELEASE(content);
-	return 0;
+	return result;
 }
 
 int	ams_announce(AmsSAP *sap, int roleNbr, int continuumNbr, int unitNbr,
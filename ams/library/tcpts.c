@@ -579,6 +579,105 @@ static void	tcpClearAmsEndpoint(AmsEndpoint *dp)
 	MRELEASE(tsep);
 }
 
+static int	connectSender(TcpTsep *tsep, TcptsSap *tcpSap)
+{
+	struct sockaddr		buf;
+	struct sockaddr_in	*nm = (struct sockaddr_in *) &buf;
+
+	memset((char *) &buf, 0, sizeof buf);
+	nm->sin_family = AF_INET;
+	nm->sin_port = htons(tsep->portNbr);
+	nm->sin_addr.s_addr = htonl(tsep->ipAddress);
+	tsep->fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (tsep->fd < 0)
+	{
+		putSysErrmsg("tcpts can't open TCP socket", NULL);
+		return -1;
+	}
+
+	if (connect(tsep->fd, &buf, sizeof(struct sockaddr)) < 0)
+	{
+		closesocket(tsep->fd);
+		tsep->fd = -1;
+		putSysErrmsg("tcpts can't connect to TCP socket", NULL);
+		return -1;
+	}
+
+	/*	Must be inserted into pool of 32 most active
+	 *	outbound sockets.					*/
+
+	pthread_mutex_lock(&tcpSap->sendPoolMutex);
+	if (tcpSap->nbrInSendPool < 32)
+	{
+		pthread_mutex_unlock(&tcpSap->sendPoolMutex);
+	}
+	else	/*	Must first ditch least active.		*/
+	{
+		pthread_mutex_unlock(&tcpSap->sendPoolMutex);
+		removeSender(tcpSap->lastInSendPool);
+	}
+
+	pthread_mutex_lock(&tcpSap->sendPoolMutex);
+	tsep->next = tcpSap->firstInSendPool;
+	if (tcpSap->firstInSendPool == NULL)
+	{
+		tcpSap->lastInSendPool = tsep;
+	}
+	else
+	{
+		tcpSap->firstInSendPool->prev = tsep;
+	}
+
+	tcpSap->firstInSendPool = tsep;
+	tcpSap->nbrInSendPool++;
+	pthread_mutex_unlock(&tcpSap->sendPoolMutex);
+	tsep->sap = tcpSap;
+	return 0;
+}
+
+static void	promoteSender(TcpTsep *tsep, TcptsSap *tcpSap)
+{
+	/*	Promote sender to top of AMS sender pool.		*/
+
+	pthread_mutex_lock(&tcpSap->sendPoolMutex);
+	if (tcpSap->firstInSendPool != tsep)
+	{
+		tsep->prev->next = tsep->next;
+		if (tsep->next)
+		{
+			tsep->next->prev = tsep->prev;
+		}
+		else
+		{
+			tcpSap->lastInSendPool = tsep->prev;
+		}
+
+		tsep->next = tcpSap->firstInSendPool;
+		tsep->prev = NULL;
+		tcpSap->firstInSendPool->prev = tsep;
+		tcpSap->firstInSendPool = tsep;
+	}
+
+	pthread_mutex_unlock(&tcpSap->sendPoolMutex);
+}
+
+static TcptsSap	*findTcpSap(AmsSAP *sap, TransSvc *ts)
+{
+	int		i;
+	AmsInterface	*tsif;
+
+	for (i = 0, tsif = sap->amsTsifs; i < sap->transportServiceCount; i++,
+			tsif++)
+	{
+		if (tsif->ts == ts)
+		{
+			return (TcptsSap *) (tsif->sap);
+		}
+	}
+
+	return NULL;		/*	No matching interface.		*/
+}
+
 static int	tcpSendAms(AmsEndpoint *dp, AmsSAP *sap,
 			unsigned char flowLabel, char *header, int headerLen,
 			char *content, int contentLen)
@@ -586,11 +685,7 @@ static int	tcpSendAms(AmsEndpoint *dp, AmsSAP *sap,
 	char			*tcpAmsBuf;
 	unsigned int		xmitlen;
 	TcpTsep			*tsep;
-	int			i;
-	AmsInterface		*tsif;
 	TcptsSap		*tcpSap;
-	struct sockaddr		buf;
-	struct sockaddr_in	*nm = (struct sockaddr_in *) &buf;
 	unsigned short		checksum;
 	unsigned short		preamble;
 	int			result;
@@ -608,71 +703,18 @@ static int	tcpSendAms(AmsEndpoint *dp, AmsSAP *sap,
 		return 0;
 	}
 
-	for (i = 0, tsif = sap->amsTsifs; i < sap->transportServiceCount; i++,
-			tsif++)
-	{
-		if (tsif->ts == dp->ts)
-		{
-			break;	/*	Have found interface to use.	*/
-		}
-	}
-
-	if (i == sap->transportServiceCount)	/*	No match.	*/
+	tcpSap = findTcpSap(sap, dp->ts);
+	if (tcpSap == NULL)	/*	No match.			*/
 	{
 		return 0;	/*	Cannot send msg to endpoint.	*/
 	}
 
-	tcpSap = (TcptsSap *) (tsif->sap);
 	if (tsep->fd < 0)	/*	Must open socket connection.	*/
 	{
-		memset((char *) &buf, 0, sizeof buf);
-		nm->sin_family = AF_INET;
-		nm->sin_port = htons(tsep->portNbr);
-		nm->sin_addr.s_addr = htonl(tsep->ipAddress);
-		tsep->fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-		if (tsep->fd < 0)
-		{
-			putSysErrmsg("tcpts can't open TCP socket", NULL);
-			return -1;
-		}
-
-		if (connect(tsep->fd, &buf, sizeof(struct sockaddr)) < 0)
+		if (connectSender(tsep, tcpSap) < 0)
 		{
-			closesocket(tsep->fd);
-			tsep->fd = -1;
-			putSysErrmsg("tcpts can't connect to TCP socket", NULL);
 			return -1;
 		}
-
-		/*	Must be inserted into pool of 32 most
-		 *	active outbound sockets.		*/
-
-		pthread_mutex_lock(&tcpSap->sendPoolMutex);
-		if (tcpSap->nbrInSendPool < 32)
-		{
-			pthread_mutex_unlock(&tcpSap->sendPoolMutex);
-		}
-		else	/*	Must first ditch least active.	*/
-		{
-			pthread_mutex_unlock(&tcpSap->sendPoolMutex);
-			removeSender(tcpSap->lastInSendPool);
-		}
-
-		pthread_mutex_lock(&tcpSap->sendPoolMutex);
-		tsep->next = tcpSap->firstInSendPool;
-		if (tcpSap->firstInSendPool == NULL)
-		{
-			tcpSap->lastInSendPool = tsep;
-		}
-		else
-		{
-			tcpSap->firstInSendPool->prev = tsep;
-		}
-
-		tcpSap->firstInSendPool = tsep;
-		tcpSap->nbrInSendPool++;
-		pthread_mutex_unlock(&tcpSap->sendPoolMutex);
-		tsep->sap = tcpSap;
 	}
 
 	preamble = xmitlen;
@@ -702,28 +744,100 @@ static int	tcpSendAms(AmsEndpoint *dp, AmsSAP *sap,
 		return result;
 	}
 
-	/*	Succeeded; promote self to top of AMS sender pool.	*/
+	promoteSender(tsep, tcpSap);
+	return 0;
+}
+
+static int	tcpSendAmsv(AmsRecipient *recipients, int count, AmsSAP *sap,
+			char *header, int headerLen, char *content,
+			int contentLen)
+{
+	char		*tcpAmsBuf;
+	char		*msg;
+	unsigned int	xmitlen;
+	TcpTsep		*tsep;
+	TcptsSap	*tcpSap;
+	unsigned int	baseChecksum;
+	unsigned short	preamble;
+	AmsRecipient	*recipient;
+	int		i;
+	int		result;
 
-	pthread_mutex_lock(&tcpSap->sendPoolMutex);
-	if (tcpSap->firstInSendPool != tsep)
+	CHKERR(recipients);
+	CHKERR(count > 0);
+	CHKERR(sap);
+	CHKERR(header);
+	CHKERR(headerLen > 0);
+	CHKERR(contentLen == 0 || (contentLen > 0 && content != NULL));
+	xmitlen = headerLen + contentLen + 2;
+	CHKERR(xmitlen <= TCPTS_MAX_MSG_LEN);
+	tcpSap = findTcpSap(sap, recipients->endpoint->ts);
+	if (tcpSap == NULL)	/*	No match.			*/
 	{
-		tsep->prev->next = tsep->next;
-		if (tsep->next)
+		return 0;	/*	Cannot send msg to endpoints.	*/
+	}
+
+	/*	Build the length preamble and message once, with
+	 *	the first byte of the header zeroed, and send the
+	 *	whole thing to each recipient in a single send()
+	 *	after patching in that recipient's header byte and
+	 *	checksum.  The first header byte is the high-order
+	 *	byte of the first 16-bit word of the checksum, so
+	 *	the checksum is recomputed by a single addition.	*/
+
+	tcpAmsBuf = MTAKE(xmitlen + 2);
+	CHKERR(tcpAmsBuf);
+	preamble = xmitlen;
+	preamble = htons(preamble);
+	memcpy(tcpAmsBuf, (char *) &preamble, 2);
+	msg = tcpAmsBuf + 2;
+	memcpy(msg, header, headerLen);
+	if (contentLen > 0)
+	{
+		memcpy(msg + headerLen, content, contentLen);
+	}
+
+	msg[0] = 0;
+	baseChecksum = computeAmsChecksum((unsigned char *) msg,
+			headerLen + contentLen);
+	for (i = 0, recipient = recipients; i < count; i++, recipient++)
+	{
+		tsep = (TcpTsep *) (recipient->endpoint->tsep);
+		if (tsep == NULL)	/*	Lost connectivity.	*/
 		{
-			tsep->next->prev = tsep->prev;
+			continue;
 		}
-		else
+
+		if (tsep->fd < 0)	/*	Must open connection.	*/
 		{
-			tcpSap->lastInSendPool = tsep->prev;
+			if (connectSender(tsep, tcpSap) < 0)
+			{
+				MRELEASE(tcpAmsBuf);
+				return -1;
+			}
 		}
 
-		tsep->next = tcpSap->firstInSendPool;
-		tsep->prev = NULL;
-		tcpSap->firstInSendPool->prev = tsep;
-		tcpSap->firstInSendPool = tsep;
+		msg[0] = recipient->headerByte;
+		recipient->checksum = htons((baseChecksum
+				+ (recipient->headerByte << 8)) & 0xffff);
+		memcpy(msg + headerLen + contentLen,
+				(char *) &(recipient->checksum), 2);
+		result = sendBytesByTCP(tsep, tcpAmsBuf, xmitlen + 2);
+		if (result < 0)
+		{
+			MRELEASE(tcpAmsBuf);
+			return -1;
+		}
+
+		if (result == 0)	/*	Data not transmitted.	*/
+		{
+			continue;
+		}
+
+		promoteSender(tsep, tcpSap);
 	}
 
-	pthread_mutex_unlock(&tcpSap->sendPoolMutex);
+	MRELEASE(tcpAmsBuf);
 	return 0;
 }
 
@@ -763,6 +877,7 @@ void	tcptsLoadTs(TransSvc *ts)
 	ts->parseAmsEndpointFn = tcpParseAmsEndpoint;
 	ts->clearAmsEndpointFn = tcpClearAmsEndpoint;
 	ts->sendAmsFn = tcpSendAms;
+	ts->sendAmsvFn = tcpSendAmsv;
 	ts->shutdownFn = tcpShutdown;
 #ifndef mingw
 	isignal(SIGPIPE, SIG_IGN);
@@ -8,9 +8,13 @@
 	ALL RIGHTS RESERVED.  U.S. Government Sponsorship
 	acknowledged.
 									*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE			/*	For sendmmsg.		*/
+#endif
 #include "amsP.h"
 
 #define	UDPTS_MAX_MSG_LEN	65535
+#define	UDPTS_SENDV_BATCH	64
 
 typedef struct
 {
@@ -532,6 +536,161 @@ PUTS("udpSendAms succeeded.");
 	}
 }
 
+static void	udpBuildSocketName(UdpTsep *tsep, struct sockaddr_in *inetName)
+{
+	unsigned int	hostNbr = htonl(tsep->ipAddress);
+
+	memset((char *) inetName, 0, sizeof(struct sockaddr_in));
+	inetName->sin_family = AF_INET;
+	inetName->sin_port = htons(tsep->portNbr);
+	memcpy((char *) &(inetName->sin_addr.s_addr), (char *) &hostNbr, 4);
+}
+
+static int	udpSendAmsv(AmsRecipient *recipients, int count, AmsSAP *sap,
+			char *header, int headerLen, char *content,
+			int contentLen)
+{
+	char			*udpAmsBuf;
+	int			len;
+	int			i;
+	AmsInterface		*tsif;
+	int			fd;
+	unsigned int		baseChecksum;
+	struct sockaddr_in	names[UDPTS_SENDV_BATCH];
+	int			batchCount;
+	int			recipientNbr;
+	AmsRecipient		*recipient;
+	UdpTsep			*tsep;
+#if defined (linux) && defined (MSG_WAITFORONE)
+	struct mmsghdr		msgs[UDPTS_SENDV_BATCH];
+	struct iovec		iovs[UDPTS_SENDV_BATCH * 3];
+	struct iovec		*iov;
+	int			sent;
+#endif
+
+	CHKERR(recipients);
+	CHKERR(count > 0);
+	CHKERR(sap);
+	CHKERR(header);
+	CHKERR(headerLen > 0);
+	CHKERR(contentLen == 0 || (contentLen > 0 && content != NULL));
+	len = headerLen + contentLen + 2;
+	CHKERR(len <= UDPTS_MAX_MSG_LEN);
+	for (i = 0, tsif = sap->amsTsifs; i < sap->transportServiceCount; i++,
+			tsif++)
+	{
+		if (tsif->ts == recipients->endpoint->ts)
+		{
+			break;	/*	Have found interface to use.	*/
+		}
+	}
+
+	if (i == sap->transportServiceCount)	/*	No match.	*/
+	{
+		return 0;	/*	Cannot send msg to endpoints.	*/
+	}
+
+	fd = (long) (tsif->sap); 
+
+	/*	Build the message once, with the first byte of the
+	 *	header zeroed.  Since the first header byte is the
+	 *	high-order byte of the first 16-bit word of the
+	 *	checksum, each recipient's checksum is just the
+	 *	checksum of this message plus that recipient's
+	 *	header byte shifted left by 8 bits.			*/
+
+	udpAmsBuf = MTAKE(len);
+	CHKERR(udpAmsBuf);
+	memcpy(udpAmsBuf, header, headerLen);
+	if (contentLen > 0)
+	{
+		memcpy(udpAmsBuf + headerLen, content, contentLen);
+	}
+
+	udpAmsBuf[0] = 0;
+	baseChecksum = computeAmsChecksum((unsigned char *) udpAmsBuf,
+			headerLen + contentLen);
+	recipientNbr = 0;
+	while (recipientNbr < count)
+	{
+		batchCount = 0;
+		while (recipientNbr < count && batchCount < UDPTS_SENDV_BATCH)
+		{
+			recipient = recipients + recipientNbr;
+			recipientNbr++;
+			tsep = (UdpTsep *) (recipient->endpoint->tsep);
+			if (tsep == NULL)	/*	Lost connectivity.	*/
+			{
+				continue;
+			}
+
+			recipient->checksum = htons((baseChecksum
+					+ (recipient->headerByte << 8)) & 0xffff);
+			udpBuildSocketName(tsep, names + batchCount);
+#if defined (linux) && defined (MSG_WAITFORONE)
+			iov = iovs + (batchCount * 3);
+			iov[0].iov_base = (char *) &(recipient->headerByte);
+			iov[0].iov_len = 1;
+			iov[1].iov_base = udpAmsBuf + 1;
+			iov[1].iov_len = headerLen + contentLen - 1;
+			iov[2].iov_base = (char *) &(recipient->checksum);
+			iov[2].iov_len = 2;
+			memset((char *) (msgs + batchCount), 0,
+					sizeof(struct mmsghdr));
+			msgs[batchCount].msg_hdr.msg_name = names + batchCount;
+			msgs[batchCount].msg_hdr.msg_namelen =
+					sizeof(struct sockaddr_in);
+			msgs[batchCount].msg_hdr.msg_iov = iov;
+			msgs[batchCount].msg_hdr.msg_iovlen = 3;
+#else
+			udpAmsBuf[0] = recipient->headerByte;
+			memcpy(udpAmsBuf + headerLen + contentLen,
+					(char *) &(recipient->checksum), 2);
+			if (isendto(fd, udpAmsBuf, len, 0, (struct sockaddr *)
+					(names + batchCount),
+					sizeof(struct sockaddr_in)) < 0)
+			{
+#if AMSDEBUG
+PUTS("udpSendAmsv failed.");
+#endif
+				MRELEASE(udpAmsBuf);
+				return -1;
+			}
+#endif
+			batchCount++;
+		}
+
+#if defined (linux) && defined (MSG_WAITFORONE)
+		i = 0;
+		while (i < batchCount)
+		{
+			sent = sendmmsg(fd, msgs + i, batchCount - i, 0);
+			if (sent < 0)
+			{
+				if (errno == EINTR)	/*	Interrupted.	*/
+				{
+					continue;	/*	Retry.		*/
+				}
+
+#if AMSDEBUG
+PUTS("udpSendAmsv failed.");
+#endif
+				MRELEASE(udpAmsBuf);
+				return -1;
+			}
+
+			i += sent;
+		}
+#endif
+	}
+
+#if AMSDEBUG
+PUTS("udpSendAmsv succeeded.");
+#endif
+	MRELEASE(udpAmsBuf);
+	return 0;
+}
+
 static void	udpShutdown(void *abstract_sap)
 {
 	int		fd = (long) abstract_sap;
@@ -561,5 +720,6 @@ void	udptsLoadTs(TransSvc *ts)
 	ts->parseAmsEndpointFn = udpParseAmsEndpoint;
 	ts->clearAmsEndpointFn = udpClearAmsEndpoint;
 	ts->sendAmsFn = udpSendAms;
+	ts->sendAmsvFn = udpSendAmsv;
 	ts->shutdownFn = udpShutdown;
 }
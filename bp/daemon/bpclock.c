@@ -13,7 +13,7 @@
 #include "smlist.h"
 
 #ifdef ENABLE_BPACS
-#include "acs.h"		/* provides sendAcs */
+#include "acs.h"		/* provides flushAcs */
 #endif /* ENABLE_ACS */
 
 static long	_running(long *newValue)
@@ -99,9 +99,9 @@ static int	dispatchEvents(Sdr sdr, Object events, time_t currentTime)
 
 #ifdef ENABLE_BPACS
         case csDue:
-            result = sendAcs(event->ref);
+            result = flushAcs(event->ref);
 
-			/* Note that sendAcs() always erases the 
+			/* Note that flushAcs() always erases the 
 			 * csDue event, so we must NOT do so
 			 * here. */
 
@@ -122,7 +122,7 @@ static void	*sendBundles(void *parm)
 			continue;
 		}
 
-		zco_start_transmitting(bundleZco, &reader);
+		bpStartTransmitting(bundleZco, &reader);
 		zco_track_file_offset(&reader);
 		bytesToSend = zco_transmit(sdr, &reader, DGRCLA_BUFSZ, buffer);
 		oK(sdr_end_xn(sdr));
@@ -198,7 +198,7 @@ static void	*receiveBundles(void *parm)
 	Sdr			sdr = getIonsdr();
 	ReceiverThreadParms	*parms = (ReceiverThreadParms *) parm;
 	char			*procName = "dgrcla";
-	char			*buffer;
+	char			*content;
 	AcqWorkArea		*work;
 	int			threadRunning = 1;
 	DgrRC			rc;
@@ -221,24 +221,16 @@ static void	*receiveBundles(void *parm)
 		return NULL;
 	}
 
-	buffer = MTAKE(DGRCLA_BUFSZ);
-	if (buffer == NULL)
-	{
-		putErrmsg("dgrcla can't get DGR buffer.", NULL);
-		*(parms->running) = 0;
-		ionKillMainThread(procName);
-		return NULL;
-	}
-
-	/*	Now start receiving bundles.				*/
+	/*	Now start receiving bundles.  Each bundle is acquired
+	 *	directly from the buffer in which DGR received it.	*/
 
 	while (threadRunning)
 	{
 		while (1)
 		{
-			if (dgr_receive(parms->dgrSap, &fromPortNbr,
-					&fromHostNbr, buffer, &length, &errnbr,
-					DGR_BLOCKING, &rc) < 0)
+			if (dgr_receive_buffer(parms->dgrSap, &fromPortNbr,
+					&fromHostNbr, &content, &length,
+					&errnbr, DGR_BLOCKING, &rc) < 0)
 			{
 				putErrmsg("Failed receiving bundle.", NULL);
 				threadRunning = 0;
@@ -249,10 +241,20 @@ static void	*receiveBundles(void *parm)
 			switch (rc)
 			{
 				case DgrDatagramAcknowledged:
-					CHKNULL(sdr_begin_xn(sdr));
+					if (sdr_begin_xn(sdr) == 0)
+					{
+						dgr_release_buffer(
+							parms->dgrSap,
+							content);
+						threadRunning = 0;
+						break;	/*	Switch.	*/
+					}
+
 					bundleZco = zco_create(sdr,
 						ZcoSdrSource, sdr_insert(sdr,
-						buffer, length), 0, length);
+						content, length), 0, length);
+					dgr_release_buffer(parms->dgrSap,
+							content);
 					if (sdr_end_xn(sdr) < 0
 					|| bundleZco == (Object) ERROR)
 					{
@@ -295,10 +297,20 @@ bundle ZCO.", NULL);
 					continue;
 
 				case DgrDatagramNotAcknowledged:
-					CHKNULL(sdr_begin_xn(sdr));
+					if (sdr_begin_xn(sdr) == 0)
+					{
+						dgr_release_buffer(
+							parms->dgrSap,
+							content);
+						threadRunning = 0;
+						break;	/*	Switch.	*/
+					}
+
 					bundleZco = zco_create(sdr,
 						ZcoSdrSource, sdr_insert(sdr,
-						buffer, length), 0, length);
+						content, length), 0, length);
+					dgr_release_buffer(parms->dgrSap,
+							content);
 					if (sdr_end_xn(sdr) < 0
 					|| bundleZco == (Object) ERROR)
 					{
@@ -378,8 +390,16 @@ bundle ZCO.", NULL);
 		senderEid = senderEidBuffer;
 		getSenderEid(&senderEid, hostName);
 		if (bpBeginAcq(work, 0, senderEid) < 0
-		|| bpContinueAcq(work, buffer, length) < 0
-		|| bpEndAcq(work) < 0)
+		|| bpContinueAcq(work, content, length) < 0)
+		{
+			dgr_release_buffer(parms->dgrSap, content);
+			putErrmsg("Can't acquire bundle.", NULL);
+			threadRunning = 0;
+			continue;
+		}
+
+		dgr_release_buffer(parms->dgrSap, content);
+		if (bpEndAcq(work) < 0)
 		{
 			putErrmsg("Can't acquire bundle.", NULL);
 			threadRunning = 0;
@@ -397,7 +417,6 @@ bundle ZCO.", NULL);
 	/*	Finish releasing receiver thread's resources.		*/
 
 	bpReleaseAcqArea(work);
-	MRELEASE(buffer);
 	writeErrmsgMemos();
 	writeMemo("[i] dgrcla receiver thread stopping.");
 	return NULL;
@@ -444,6 +463,8 @@ int	main(int argc, char *argv[])
 		return 1;
 	}
 
+	bpStreamXmitDigests();
+
 	findInduct("dgr", ductName, &vinduct, &vductElt);
 	if (vductElt == 0)
 	{
@@ -39,67 +39,69 @@ static void	shutDown()	/*	Commands forwarder termination.	*/
 	sm_SemEnd(_imcfwSemaphore(NULL));
 }
 
-static int	enqueueToNeighbor(Bundle *bundle, Object bundleObj,
-			uvast nodeNbr)
+/*	A NextHop is a distinct means of conveying multicast bundles
+ *	to group members: transmission via one outduct to one
+ *	destination induct.  All members reached in the same way
+ *	receive the same transmitted copy of the bundle.		*/
+
+typedef struct
 {
 	FwdDirective	directive;
 	char		stationEid[64];
+	char		destDuctName[MAX_CL_DUCT_NAME_LEN + 1];
+} NextHop;
+
+static void	deleteNextHop(LystElt elt, void *userdata)
+{
+	MRELEASE(lyst_data(elt));
+}
+
+static int	isSnubbing(uvast nodeNbr)
+{
 	IonNode		*stationNode;
 	PsmAddress	nextElt;
 	PsmPartition	ionwm;
 	PsmAddress	snubElt;
 	IonSnub		*snub;
 
-	if (ipn_lookupPlanDirective(nodeNbr, 0, 0, &directive) == 0)
+	stationNode = findNode(getIonVdb(), nodeNbr, &nextElt);
+	if (stationNode == NULL)
 	{
 		return 0;
 	}
 
-	/*	The station node is a neighbor.				*/
-
-	isprintf(stationEid, sizeof stationEid, "ipn:" UVAST_FIELDSPEC ".0",
-			nodeNbr);
-
-	/*	Is neighbor refusing to be a station for bundles?	*/
-
-	stationNode = findNode(getIonVdb(), nodeNbr, &nextElt);
-	if (stationNode)
+	ionwm = getIonwm();
+	for (snubElt = sm_list_first(ionwm, stationNode->snubs); snubElt;
+			snubElt = sm_list_next(ionwm, snubElt))
 	{
-		ionwm = getIonwm();
-		for (snubElt = sm_list_first(ionwm, stationNode->snubs);
-				snubElt; snubElt = sm_list_next(ionwm, snubElt))
+		snub = (IonSnub *) psp(ionwm, sm_list_data(ionwm, snubElt));
+		if (snub->nodeNbr < nodeNbr)
 		{
-			snub = (IonSnub *) psp(ionwm, sm_list_data(ionwm,
-					snubElt));
-			if (snub->nodeNbr < nodeNbr)
-			{
-				continue;
-			}
-
-			if (snub->nodeNbr > nodeNbr)
-			{
-				break;	/*	Not refusing bundles.	*/
-			}
-
-			/*	Neighbor is refusing bundles.  A
-			 *	neighbor, but not a good neighbor;
-			 *	give up.				*/
+			continue;
+		}
 
-			return 0;
+		if (snub->nodeNbr > nodeNbr)
+		{
+			break;		/*	Not refusing bundles.	*/
 		}
-	}
 
-	if (bpEnqueue(&directive, bundle, bundleObj, stationEid) < 0)
-	{
-		putErrmsg("Can't enqueue bundle.", NULL);
-		return -1;
+		/*	Neighbor is refusing bundles.  A neighbor,
+		 *	but not a good neighbor.			*/
+
+		return 1;
 	}
 
 	return 0;
 }
 
-static int	enqueueBundle(Bundle *bundle, Object bundleObj, uvast nodeNbr)
+static int	noteNextHop(Lyst hops, uvast nodeNbr)
 {
+	Sdr		sdr = getIonsdr();
+	FwdDirective	directive;
+	char		destDuctName[MAX_CL_DUCT_NAME_LEN + 1];
+	LystElt		elt;
+	NextHop		*hop;
+
 	/*	Note that the only way we can prevent multicast
 	 *	forwarding loops is by knowing exactly which
 	 *	neighboring node sent each bundle, so that we
@@ -111,7 +113,59 @@ static int	enqueueBundle(Bundle *bundle, Object bundleObj, uvast nodeNbr)
 	 *	bundles; CGR and static routing groups are of
 	 *	no use.							*/
 
-	if (enqueueToNeighbor(bundle, bundleObj, nodeNbr) < 0)
+	if (ipn_lookupPlanDirective(nodeNbr, 0, 0, &directive) == 0)
+	{
+		return 0;	/*	No plan for this neighbor.	*/
+	}
+
+	if (isSnubbing(nodeNbr))
+	{
+		return 0;	/*	Neighbor is refusing bundles.	*/
+	}
+
+	destDuctName[0] = '\0';
+	if (directive.destDuctName)
+	{
+		if (sdr_string_read(sdr, destDuctName, directive.destDuctName)
+				< 0)
+		{
+			putErrmsg("Can't retrieve dest duct name.", NULL);
+			return -1;
+		}
+	}
+
+	for (elt = lyst_first(hops); elt; elt = lyst_next(elt))
+	{
+		hop = (NextHop *) lyst_data(elt);
+		if (hop->directive.outductElt == directive.outductElt
+		&& strcmp(hop->destDuctName, destDuctName) == 0)
+		{
+			return 0;	/*	Already reached.	*/
+		}
+	}
+
+	hop = (NextHop *) MTAKE(sizeof(NextHop));
+	if (hop == NULL || lyst_insert_last(hops, hop) == NULL)
+	{
+		putErrmsg("Can't note next hop.", NULL);
+		return -1;
+	}
+
+	memcpy((char *) &hop->directive, (char *) &directive,
+			sizeof(FwdDirective));
+	istrcpy(hop->destDuctName, destDuctName, sizeof hop->destDuctName);
+
+	/*	The station node is a neighbor: the first member
+	 *	reached by way of this next hop.			*/
+
+	isprintf(hop->stationEid, sizeof hop->stationEid,
+			"ipn:" UVAST_FIELDSPEC ".0", nodeNbr);
+	return 0;
+}
+
+static int	enqueueBundle(Bundle *bundle, Object bundleObj, NextHop *hop)
+{
+	if (bpEnqueue(&hop->directive, bundle, bundleObj, hop->stationEid) < 0)
 	{
 		putErrmsg("Can't send bundle to neighbor.", NULL);
 		return -1;
@@ -124,12 +178,93 @@ static int	enqueueBundle(Bundle *bundle, Object bundleObj, uvast nodeNbr)
 		return bpAccept(bundleObj, bundle);
 	}
 
-	/*	No plan for conveying bundle to this neighbor, so
+	/*	Can't convey bundle by way of this next hop, so
 	 *	must give up on forwarding it.				*/
 
 	return bpAbandon(bundleObj, bundle);
 }
 
+/*	Enqueues one copy of the bundle for each distinct next hop
+ *	to the members of the group, other than the neighbor that
+ *	sent it.  The bundle itself is the last copy; the others
+ *	are clones, all sharing the bundle's payload source data.
+ *	Returns the number of copies forwarded.				*/
+
+static int	forwardToGroup(Bundle *bundle, Object bundleObj,
+			ImcGroup *group)
+{
+	Sdr		sdr = getIonsdr();
+	Lyst		hops;
+	Object		elt;
+			OBJ_POINTER(NodeId, member);
+	LystElt		hopElt;
+	Bundle		newBundle;
+	Object		newBundleObj;
+	int		copiesForwarded = 0;
+
+	hops = lyst_create_using(getIonMemoryMgr());
+	if (hops == NULL)
+	{
+		putErrmsg("Can't create list of next hops.", NULL);
+		return -1;
+	}
+
+	lyst_delete_set(hops, deleteNextHop, NULL);
+	for (elt = sdr_list_first(sdr, group->members); elt;
+			elt = sdr_list_next(sdr, elt))
+	{
+		GET_OBJ_POINTER(sdr, NodeId, member, sdr_list_data(sdr, elt));
+		if (member->nbr == bundle->clDossier.senderNodeNbr)
+		{
+			continue;
+		}
+
+		if (noteNextHop(hops, member->nbr) < 0)
+		{
+			lyst_destroy(hops);
+			return -1;
+		}
+	}
+
+	for (hopElt = lyst_first(hops); hopElt; hopElt = lyst_next(hopElt))
+	{
+		if (lyst_next(hopElt) == NULL)
+		{
+			/*	Last next hop gets the bundle itself.	*/
+
+			if (enqueueBundle(bundle, bundleObj,
+					(NextHop *) lyst_data(hopElt)) < 0)
+			{
+				copiesForwarded = -1;
+				break;
+			}
+
+			copiesForwarded++;
+			break;
+		}
+
+		if (bpClone(bundle, &newBundle, &newBundleObj, 0, 0) < 0)
+		{
+			putErrmsg("Failed on clone.", NULL);
+			copiesForwarded = -1;
+			break;
+		}
+
+		if (enqueueBundle(&newBundle, newBundleObj,
+				(NextHop *) lyst_data(hopElt)) < 0)
+		{
+			putErrmsg("Failed on enqueue.", NULL);
+			copiesForwarded = -1;
+			break;
+		}
+
+		copiesForwarded++;
+	}
+
+	lyst_destroy(hops);
+	return copiesForwarded;
+}
+
 #if defined (VXWORKS) || defined (RTEMS) || defined (bionic)
 int	imcfw(int a1, int a2, int a3, int a4, int a5,
 		int a6, int a7, int a8, int a9, int a10)
@@ -149,12 +284,8 @@ int	main(int argc, char *argv[])
 	Bundle		bundle;
 	int		copiesForwarded;
 	Object		elt2;
-	Object		elt3;
 	Object		groupAddr;
 	ImcGroup	group;
-			OBJ_POINTER(NodeId, member);
-	Bundle		newBundle;
-	Object		newBundleObj;
 
 	if (bpAttach() < 0)
 	{
@@ -226,7 +357,6 @@ int	main(int argc, char *argv[])
 		 *	database.					*/
 
 		sdr_write(sdr, bundleAddr, (char *) &bundle, sizeof(Bundle));
-		copiesForwarded = 0;
 		imcFindGroup(bundle.destination.c.nodeNbr, &groupAddr, &elt2);
 		if (elt2 == 0)
 		{
@@ -249,47 +379,18 @@ int	main(int argc, char *argv[])
 			{
 				sdr_read(sdr, (char *) &group, groupAddr,
 						sizeof(ImcGroup));
-				for (elt3 = sdr_list_first(sdr, group.members);
-					elt3; elt3 = sdr_list_next(sdr, elt3))
+				copiesForwarded = forwardToGroup(&bundle,
+						bundleAddr, &group);
+				if (copiesForwarded < 0)
 				{
-					GET_OBJ_POINTER(sdr, NodeId, member,
-						sdr_list_data(sdr, elt3));
-					if (member->nbr ==
-						bundle.clDossier.senderNodeNbr)
-					{
-						continue;
-					}
-	
-					if (bpClone(&bundle, &newBundle,
-						&newBundleObj, 0, 0) < 0)
-					{
-						putErrmsg("Failed on clone.",
-							NULL);
-						running = 0;
-						break;	/*	Loop.	*/
-					}
-
-					if (enqueueBundle(&newBundle,
-						newBundleObj, member->nbr) < 0)
-					{
-						sdr_cancel_xn(sdr);
-						putErrmsg("Failed on enqueue.",
-							NULL);
-						running = 0;
-						break;	/*	Loop.	*/
-					}
-
-					copiesForwarded++;
+					sdr_cancel_xn(sdr);
+					putErrmsg("Failed on forwarding.", NULL);
+					running = 0;
 				}
-
-				if (copiesForwarded == 0)
+				else if (copiesForwarded == 0)
 				{
 					oK(bpAbandon(bundleAddr, &bundle));
 				}
-				else	/*	Destroy unused copy.	*/
-				{
-					oK(bpDestroyBundle(bundleAddr, 1));
-				}
 			}
 		}
 
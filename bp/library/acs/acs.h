@@ -57,9 +57,12 @@ extern int	offerNoteAcs(Bundle *bundle, AcqWorkArea *work, char *dictionary,
 	 * offerNoteAcs will return 0, and the caller should deliver a normal
 	 * custody signal instead (via sendCtSignal()).			*/
 
-extern int	sendAcs(Object);
-	/* This function sends a pending custody signal; it's called when
-	 * this custody signal is due on the Nagled custody signal timeline. */
+extern int	flushAcs(Object pendingCustAddr);
+	/* This function serializes and sends all of a custodian's pending
+	 * custody signals, one ACS bundle per signal, in a single transaction.
+	 * It's called when the custodian's signals are due on the Nagled
+	 * custody signal timeline, or when one of them reaches the custodian's
+	 * preferred ACS size. */
 
 extern int	destroyAcsMetadata(Bundle *bundle);
 	/* This function destroys the metadata that ACS is storing for a bundle.
@@ -37,6 +37,7 @@ extern "C" {
 #define DEFAULT_ACS_SIZE     (120)     /* Default bytes of ACS payload */
 #define ACS_SDR_NAME         "acs"
 #define ACS_DBNAME           "acsdb"
+#define ACS_VDBNAME          "acsvdb"
 #define ACS_SDR_DEFAULT_HEAPWORDS    10000
 
 /* SDR hashes take "estimated number of items" and "preferred mean search
@@ -91,6 +92,7 @@ typedef struct
 
 	/* Data structures associated with sending this custodian ACS. */
 	Object			signals;		/* SDR list of SdrAcsSignals. */
+	Object			acsDue;			/* BpEvent: flush all signals. */
 } SdrAcsPendingCust;
 
 typedef struct
@@ -98,23 +100,48 @@ typedef struct
 	unsigned char	succeeded;		/* Boolean */
 	BpCtReason		reasonCode;
 	Object			acsFills;		/* SDR list of SdrAcsFills. */
-	Object	     	acsDue;			/* BpEvent */
 	Object          pendingCustAddr; /* A pointer back to this sig's parent. */
 
-	/* The serializedZco is a reference to a ZCO *in the BP SDR*, even though
-	 * the rest of the ACS data is in the ACS SDR.  This is because the bpSend()
-	 * function actually sends the ZCO, and it needs payloads it sends to be in
-	 * the BP SDR. */
-	Object          serializedZco;
-	/* We can't use zco_get_length() to get the length of the serializedZco:
-	 * it might lead to fulfillment of the Coffman conds. */
-	unsigned long	serializedZcoLength;
+	/* The length of the ACS payload as serializeAcs() would emit it, kept
+	 * up to date as fills change so that the custodian's acsSize can be
+	 * checked without serializing.  The payload itself is only built, in
+	 * the BP SDR, when the signal is sent. */
+	unsigned long	serializedLength;
 } SdrAcsSignal;
 
 /* These don't have references to other objects, and are thus the same
  * for SDR and working memory versions. */
 typedef	AcsFill		SdrAcsFill;
 
+/* The fills of every SdrAcsSignal are also indexed in ION working memory,
+ * so that a custody ID can be placed among them without walking the SDR
+ * list.  The SDR list remains authoritative: it is what gets serialized,
+ * and an index found to disagree with it is discarded and rebuilt from it.
+ *
+ * AcsFillRefs are kept in one tree ordered by (acsFills, start); the
+ * AcsFillIndex for each list notes how many fills of that list are
+ * indexed. */
+typedef struct
+{
+	Object			acsFills;		/* SDR list of SdrAcsFills. */
+	long			fillCount;
+} AcsFillIndex;
+
+typedef struct
+{
+	Object			acsFills;		/* SDR list the fill is in. */
+	unsigned int	start;
+	unsigned int	length;
+	Object			fillAddr;		/* The SdrAcsFill. */
+	Object			fillLElt;		/* Its element in acsFills. */
+} AcsFillRef;
+
+typedef struct
+{
+	PsmAddress		fillIndexes;	/* SM RB tree of AcsFillIndex. */
+	PsmAddress		fillRefs;		/* SM RB tree of AcsFillRef. */
+} AcsVdb;
+
 typedef struct
 {
 	Object			pendingCusts;	/* SDR list of SdrAcsPendingCusts. */
@@ -165,15 +192,17 @@ extern Object findSdrAcsSignal(Object acsSignals, BpCtReason reasonCode,
 
 extern Object findCustodianByEid(Object custodians, const char *eid);
 
-extern unsigned long serializeAcs(Object signalAddr, Object *serializedZco,
-		unsigned long lastSerializedSize);
+extern unsigned long serializeAcs(Object signalAddr, Object *serializedZco);
 
 extern int appendToSdrAcsSignals(Object acsSignals, Object pendingCustAddr,
 		BpCtReason reasonCode, unsigned char succeeded,
 		const CtebScratchpad *cteb);
 
-extern int trySendAcs(SdrAcsPendingCust *custodian, BpCtReason reasonCode,
-		unsigned char succeeded, const CtebScratchpad *cteb);
+extern void forgetAcsFillIndex(Object acsFills);
+
+extern void sendAcs(Object signalLElt, const char *custodianEid);
+
+extern int trySendAcs(Object pendingCustAddr);
 
 extern int get_or_make_custody_id(const char *sourceEid,
 		const BpTimestamp *creationTime, unsigned int fragmentOffset,
@@ -13,173 +13,471 @@
 
 static Sdr		acsSdr = NULL;
 
-static int appendToSdrAcsFills(Object fills, const CtebScratchpad *cteb)
+/* The ACS volatile database lives in ION working memory; it is created by
+ * the first task to need it.  Callers hold the BP SDR transaction, which
+ * serializes access to ION working memory. */
+static AcsVdb *getAcsVdb(PsmPartition wm)
 {
-	unsigned int id = cteb->id;
+	PsmAddress	vdbAddress;
+	PsmAddress	elt;
+	AcsVdb		*vdb;
 
-	Object   curFillLElt;
-	Object   curFillAddr;
-	AcsFill  curFill;
-	Object   nextFillLElt;
-	Object   nextFillAddr;
-	AcsFill  nextFill;
-	Object   newFillAddr;
-	AcsFill  newFill;
-	unsigned int curFillUntil;	/* Last sequence number covered by curId. */
+	if (psm_locate(wm, ACS_VDBNAME, &vdbAddress, &elt) < 0)
+	{
+		putErrmsg("Failed searching for ACS vdb.", NULL);
+		return NULL;
+	}
 
-	ASSERT_ACSSDR_XN;
+	if (elt)
+	{
+		return (AcsVdb *) psp(wm, vdbAddress);
+	}
 
-	/* If we insert a new sequence element into the list, it will be this. */
-	newFill.start = id;
-	newFill.length = 1;
+	vdbAddress = psm_zalloc(wm, sizeof(AcsVdb));
+	if (vdbAddress == 0)
+	{
+		putErrmsg("No space for ACS vdb.", NULL);
+		return NULL;
+	}
+
+	vdb = (AcsVdb *) psp(wm, vdbAddress);
+	memset((char *) vdb, 0, sizeof(AcsVdb));
+	if ((vdb->fillIndexes = sm_rbt_create(wm)) == 0
+	|| (vdb->fillRefs = sm_rbt_create(wm)) == 0
+	|| psm_catlg(wm, ACS_VDBNAME, vdbAddress) < 0)
+	{
+		putErrmsg("Can't initialize ACS vdb.", NULL);
+		return NULL;
+	}
+
+	return vdb;
+}
+
+static int cmpAcsFillIndexes(PsmPartition wm, PsmAddress nodeData,
+		void *dataBuffer)
+{
+	AcsFillIndex	*index = (AcsFillIndex *) psp(wm, nodeData);
+	Object			acsFills = *((Object *) dataBuffer);
+
+	if (index->acsFills < acsFills) return -1;
+	if (index->acsFills > acsFills) return 1;
+	return 0;
+}
+
+static int cmpAcsFillRefs(PsmPartition wm, PsmAddress nodeData,
+		void *dataBuffer)
+{
+	AcsFillRef		*ref = (AcsFillRef *) psp(wm, nodeData);
+	AcsFillRef		*arg = (AcsFillRef *) dataBuffer;
+
+	if (ref->acsFills < arg->acsFills) return -1;
+	if (ref->acsFills > arg->acsFills) return 1;
+	if (ref->start < arg->start) return -1;
+	if (ref->start > arg->start) return 1;
+	return 0;
+}
+
+static void releaseAcsVdbObject(PsmPartition wm, PsmAddress nodeData,
+		void *arg)
+{
+	psm_free(wm, nodeData);
+}
+
+void forgetAcsFillIndex(Object acsFills)
+{
+	PsmPartition	wm = getIonwm();
+	AcsVdb			*vdb;
+	AcsFillRef		key;
+	PsmAddress		node;
+	PsmAddress		successor;
+	AcsFillRef		*ref;
+
+	if ((vdb = getAcsVdb(wm)) == NULL)
+	{
+		return;
+	}
 
-	/* If the list is empty, then add newFill. */
-	if (sdr_list_length(acsSdr, fills) == 0) {
-		newFillAddr = sdr_malloc(acsSdr, sizeof(newFill));
-		if (newFillAddr == 0)
+	sm_rbt_delete(wm, vdb->fillIndexes, cmpAcsFillIndexes, &acsFills,
+			releaseAcsVdbObject, NULL);
+	key.acsFills = acsFills;
+	key.start = 0;
+	while (1)
+	{
+		node = sm_rbt_search(wm, vdb->fillRefs, cmpAcsFillRefs, &key,
+				&successor);
+		if (node == 0)
 		{
-			ACSLOG_WARN("Couldn't sdr_malloc() new fill %u (%s)",
-				id, strerror(errno));
-			return -1;			/* Error */
+			node = successor;
 		}
-		sdr_poke(acsSdr, newFillAddr, newFill);
 
-		if (sdr_list_insert_first(acsSdr, fills, newFillAddr) == 0)
+		if (node == 0)
 		{
-			ACSLOG_WARN("Couldn't insert new fill %u into list (%s)",
-				id, strerror(errno));
-			/* Stale newFill object will be backed out of SDR on
-			 * sdr_end_xn() */
-			return -1;			/* Error */
+			break;
+		}
+
+		ref = (AcsFillRef *) psp(wm, sm_rbt_data(wm, node));
+		if (ref->acsFills != acsFills)
+		{
+			break;
+		}
+
+		key.start = ref->start;
+		sm_rbt_delete(wm, vdb->fillRefs, cmpAcsFillRefs, &key,
+				releaseAcsVdbObject, NULL);
+	}
+}
+
+static AcsFillRef *indexFill(PsmPartition wm, AcsVdb *vdb, Object acsFills,
+		Object fillLElt, Object fillAddr, const SdrAcsFill *fill)
+{
+	PsmAddress	refAddr;
+	AcsFillRef	*ref;
+
+	refAddr = psm_malloc(wm, sizeof(AcsFillRef));
+	if (refAddr == 0)
+	{
+		return NULL;
+	}
+
+	ref = (AcsFillRef *) psp(wm, refAddr);
+	ref->acsFills = acsFills;
+	ref->start = fill->start;
+	ref->length = fill->length;
+	ref->fillAddr = fillAddr;
+	ref->fillLElt = fillLElt;
+	if (sm_rbt_insert(wm, vdb->fillRefs, refAddr, cmpAcsFillRefs, ref) == 0)
+	{
+		psm_free(wm, refAddr);
+		return NULL;
+	}
+
+	return ref;
+}
+
+/* Rebuilds the index of a list of fills with a single pass over the list. */
+static AcsFillIndex *loadAcsFillIndex(PsmPartition wm, AcsVdb *vdb,
+		Object acsFills)
+{
+	PsmAddress		indexAddr;
+	AcsFillIndex	*index;
+	Object			fillLElt;
+	Object			fillAddr;
+	SdrAcsFill		fill;
+
+	forgetAcsFillIndex(acsFills);
+	indexAddr = psm_malloc(wm, sizeof(AcsFillIndex));
+	if (indexAddr == 0)
+	{
+		ACSLOG_WARN("No space to index fills of ACS");
+		return NULL;
+	}
+
+	index = (AcsFillIndex *) psp(wm, indexAddr);
+	index->acsFills = acsFills;
+	index->fillCount = 0;
+	if (sm_rbt_insert(wm, vdb->fillIndexes, indexAddr, cmpAcsFillIndexes,
+			&acsFills) == 0)
+	{
+		psm_free(wm, indexAddr);
+		ACSLOG_WARN("Couldn't index fills of ACS");
+		return NULL;
+	}
+
+	for (fillLElt = sdr_list_first(acsSdr, acsFills); fillLElt;
+			fillLElt = sdr_list_next(acsSdr, fillLElt))
+	{
+		fillAddr = sdr_list_data(acsSdr, fillLElt);
+		sdr_peek(acsSdr, fill, fillAddr);
+		if (indexFill(wm, vdb, acsFills, fillLElt, fillAddr, &fill)
+				== NULL)
+		{
+			ACSLOG_WARN("No space to index fill %u of ACS", fill.start);
+			forgetAcsFillIndex(acsFills);
+			return NULL;
 		}
+
+		index->fillCount++;
+	}
+
+	return index;
+}
+
+/* An indexed fill is trusted only while it matches its SDR counterpart. */
+static int fillRefIsCurrent(const AcsFillRef *ref)
+{
+	SdrAcsFill	fill;
+
+	if (sdr_list_data(acsSdr, ref->fillLElt) != ref->fillAddr)
+	{
 		return 0;
 	}
 
-	for(curFillLElt = sdr_list_first(acsSdr, fills);
-		curFillLElt;
-		curFillLElt = sdr_list_next(acsSdr, curFillLElt))
+	sdr_peek(acsSdr, fill, ref->fillAddr);
+	return (fill.start == ref->start && fill.length == ref->length);
+}
+
+/* Finds the fills of acsFills immediately before (start <= id) and after
+ * (start > id) the custody ID, either of which may be NULL. */
+static void findNeighborFills(PsmPartition wm, AcsVdb *vdb, Object acsFills,
+		unsigned int id, AcsFillRef **prev, AcsFillRef **next)
+{
+	AcsFillRef	key;
+	PsmAddress	node;
+	PsmAddress	successor;
+	PsmAddress	prevNode;
+
+	key.acsFills = acsFills;
+	key.start = id;
+	node = sm_rbt_search(wm, vdb->fillRefs, cmpAcsFillRefs, &key,
+			&successor);
+	if (node)
 	{
-		curFillAddr = sdr_list_data(acsSdr, curFillLElt);
-		if (curFillAddr == 0) {
-			ACSLOG_ERROR("Can't read ACS list element (%s)", strerror(errno));
-			return -1;
+		prevNode = node;
+		successor = sm_rbt_next(wm, node);
+	}
+	else if (successor)
+	{
+		prevNode = sm_rbt_prev(wm, successor);
+	}
+	else
+	{
+		prevNode = sm_rbt_last(wm, vdb->fillRefs);
+	}
+
+	*prev = NULL;
+	*next = NULL;
+	if (prevNode)
+	{
+		*prev = (AcsFillRef *) psp(wm, sm_rbt_data(wm, prevNode));
+		if ((*prev)->acsFills != acsFills)
+		{
+			*prev = NULL;
 		}
-		sdr_peek(acsSdr, curFill, curFillAddr);
+	}
 
-		if (curFill.start <= id)
+	if (successor)
+	{
+		*next = (AcsFillRef *) psp(wm, sm_rbt_data(wm, successor));
+		if ((*next)->acsFills != acsFills)
 		{
-			curFillUntil = curFill.start + curFill.length - 1;
+			*next = NULL;
+		}
+	}
+}
 
-			if (curFillUntil >= id)
-			{
-				return -2;		/* Already added */
-			}
+static long sdnvLength(unsigned int value)
+{
+	Sdnv	encoded;
 
-			nextFillLElt = sdr_list_next(acsSdr, curFillLElt);
-			if (nextFillLElt != 0) {
-				nextFillAddr = sdr_list_data(acsSdr, nextFillLElt);
-				if(nextFillAddr == 0) {
-					ACSLOG_ERROR("Couldn't read next ACS list element");
-					return -1;
-				}
-				sdr_peek(acsSdr, nextFill, nextFillAddr);
-			} else {
-				nextFillAddr = 0;
-			}
+	encodeSdnv(&encoded, value);
+	return encoded.length;
+}
 
-			/* If the current fill is just one too small on the right, 
-			 * we should extend it. */
-			if (curFillUntil + 1 == id)
-			{
-				/* We need to extend curFill.length by one.  But if that means
-				 * we completely fill the hole between curFill and nextFill,
-				 * then we should smush nextFill into curFill, too. */
-				if (nextFillAddr && nextFill.start == id + 1)
-				{
-					curFill.length += 1 + nextFill.length;
-					sdr_list_delete(acsSdr, nextFillLElt, NULL, NULL);
-					sdr_free(acsSdr, nextFillAddr);
-				} else {
-					curFill.length++;
-				}
+static void pokeFill(const AcsFillRef *ref)
+{
+	SdrAcsFill	fill;
 
-				sdr_poke(acsSdr, curFillAddr, curFill);
-				return 0;
-			}
+	fill.start = ref->start;
+	fill.length = ref->length;
+	sdr_poke(acsSdr, ref->fillAddr, fill);
+}
+
+/* Each fill is serialized as the SDNVs of its distance from the end of the
+ * previous fill and of its length, so *growth, the change in the length of
+ * the serialized ACS, depends only on the fills next to the custody ID.
+ * If *growth would exceed room, the fills are left unchanged and -3 is
+ * returned. */
+static int appendToSdrAcsFills(Object fills, const CtebScratchpad *cteb,
+		long room, long *growth)
+{
+	unsigned int id = cteb->id;
+
+	PsmPartition	wm = getIonwm();
+	AcsVdb			*vdb;
+	AcsFillIndex	*index = NULL;
+	PsmAddress		indexNode;
+	AcsFillRef		*prev;
+	AcsFillRef		*next;
+	AcsFillRef		key;
+	Object			newFillAddr;
+	Object			newFillLElt;
+	SdrAcsFill		newFill;
+	unsigned int	prevUntil = 0;	/* Last sequence number covered by prev. */
+	int				reloaded = 0;
+
+	ASSERT_ACSSDR_XN;
+	*growth = 0;
+
+	if ((vdb = getAcsVdb(wm)) == NULL)
+	{
+		return -1;
+	}
+
+	indexNode = sm_rbt_search(wm, vdb->fillIndexes, cmpAcsFillIndexes,
+			&fills, NULL);
+	if (indexNode)
+	{
+		index = (AcsFillIndex *) psp(wm, sm_rbt_data(wm, indexNode));
+	}
 
-			/* If the next fill is just one too small on the left, we should
-			 * extend it. */
-			if (nextFillAddr && nextFill.start == id + 1)
+	/* A canceled transaction can leave the index ahead of the list; the
+	 * fill count and the fills we're about to touch must agree with SDR. */
+	while (1)
+	{
+		if (index == NULL
+		|| index->fillCount != sdr_list_length(acsSdr, fills))
+		{
+			reloaded = 1;
+			index = loadAcsFillIndex(wm, vdb, fills);
+			if (index == NULL)
 			{
-				nextFill.start = id;
-				nextFill.length++;
-				sdr_poke(acsSdr, nextFillAddr, nextFill);
-				return 0;
+				return -1;
 			}
+		}
+
+		findNeighborFills(wm, vdb, fills, id, &prev, &next);
+		if ((prev == NULL || fillRefIsCurrent(prev))
+		&& (next == NULL || fillRefIsCurrent(next)))
+		{
+			break;
+		}
+
+		if (reloaded)
+		{
+			ACSLOG_ERROR("Can't index fills of ACS for %u", id);
+			return -1;
+		}
+
+		index = NULL;
+	}
+
+	if (prev)
+	{
+		prevUntil = prev->start + prev->length - 1;
+		if (prevUntil >= id)
+		{
+			return -2;		/* Already added */
+		}
 
-			/* If the next fill is after our id or doesn't exist, then
-			 * we should insert this id in between current and next. */
-			if (nextFillAddr == 0 || nextFill.start > id)
+		/* If the previous fill is just one too small on the right, 
+		 * we should extend it.  But if that means we completely fill
+		 * the hole between prev and next, then we should smush next
+		 * into prev, too. */
+		if (prevUntil + 1 == id)
+		{
+			if (next && next->start == id + 1)
 			{
-				newFillAddr = sdr_malloc(acsSdr, sizeof(newFill));
-				if (newFillAddr == 0)
+				*growth = sdnvLength(prev->length + 1 + next->length)
+						- sdnvLength(prev->length)
+						- sdnvLength(next->start - prevUntil)
+						- sdnvLength(next->length);
+				if (*growth > room)
 				{
-					ACSLOG_WARN("Couldn't sdr_malloc() new fill %u (%s)",
-							id, strerror(errno));
-					return -1;			/* Error */
+					return -3;	/* Won't fit */
 				}
-				sdr_poke(acsSdr, newFillAddr, newFill);
 
-				if (sdr_list_insert_after(acsSdr, curFillLElt, newFillAddr) == 0)
+				prev->length += 1 + next->length;
+				pokeFill(prev);
+				sdr_list_delete(acsSdr, next->fillLElt, NULL, NULL);
+				sdr_free(acsSdr, next->fillAddr);
+				key.acsFills = fills;
+				key.start = next->start;
+				sm_rbt_delete(wm, vdb->fillRefs, cmpAcsFillRefs, &key,
+						releaseAcsVdbObject, NULL);
+				index->fillCount--;
+			} else {
+				*growth = sdnvLength(prev->length + 1)
+						- sdnvLength(prev->length);
+				if (next)
 				{
-					ACSLOG_WARN("Couldn't insert new fill %u into list (%s)",
-							id, strerror(errno));
-					/* Stale newFill object will be backed out of SDR on
-					 * sdr_end_xn() */
-					return -1;			/* Error */
+					*growth += sdnvLength(next->start - id)
+							- sdnvLength(next->start - prevUntil);
 				}
-				return 0;
-			}
 
-			/* If here, curFill.start <= id, but this wasn't the appropriate
-			 * place to insert this sequence, because nextFill->id is
-			 * also <= id. */
-			continue;
-		}
+				if (*growth > room)
+				{
+					return -3;	/* Won't fit */
+				}
 
-		/* curFill.id > id, and curFill.id wasn't ever <= id, so we need to
-		 * insert a new id at the head of the list. */
-		if (curFill.start == id + 1) {
-			/* Extend curFill to the left by 1. */
-			curFill.start = id;
-			curFill.length++;
-			sdr_poke(acsSdr, curFillAddr, curFill);
-			return 0;
-		} else {
-			/* Make a new object at the beginning of the list. */
-			newFillAddr = sdr_malloc(acsSdr, sizeof(newFill));
-			if (newFillAddr == 0)
-			{
-				ACSLOG_WARN("Couldn't sdr_malloc() new fill %u (%s)",
-						id, strerror(errno));
-				return -1;			/* Error */
+				prev->length++;
+				pokeFill(prev);
 			}
-			sdr_poke(acsSdr, newFillAddr, newFill);
 
-			if (sdr_list_insert_first(acsSdr, fills, newFillAddr) == 0)
-			{
-				ACSLOG_WARN("Couldn't insert new fill %u into list (%s)",
-						id, strerror(errno));
-				/* Stale newFill object will be backed out of SDR on
-				 * sdr_end_xn() */
-				return -1;			/* Error */
-			}
 			return 0;
 		}
 	}
 
-	ACSLOG_ERROR("Hit bottom of appendToAcsFills for %u", id);
-	return -1;
+	/* If the next fill is just one too small on the left, we should
+	 * extend it.  Its position in the index is unchanged, as nothing
+	 * lies between prev and id. */
+	if (next && next->start == id + 1)
+	{
+		*growth = sdnvLength(id - prevUntil)
+				- sdnvLength(next->start - prevUntil)
+				+ sdnvLength(next->length + 1)
+				- sdnvLength(next->length);
+		if (*growth > room)
+		{
+			return -3;		/* Won't fit */
+		}
+
+		next->start = id;
+		next->length++;
+		pokeFill(next);
+		return 0;
+	}
+
+	/* Otherwise this id is a new fill between prev and next. */
+	*growth = sdnvLength(id - prevUntil) + sdnvLength(1);
+	if (next)
+	{
+		*growth += sdnvLength(next->start - id)
+				- sdnvLength(next->start - prevUntil);
+	}
+
+	if (*growth > room)
+	{
+		return -3;			/* Won't fit */
+	}
+
+	newFill.start = id;
+	newFill.length = 1;
+	newFillAddr = sdr_malloc(acsSdr, sizeof(newFill));
+	if (newFillAddr == 0)
+	{
+		ACSLOG_WARN("Couldn't sdr_malloc() new fill %u (%s)",
+				id, strerror(errno));
+		return -1;			/* Error */
+	}
+	sdr_poke(acsSdr, newFillAddr, newFill);
+
+	if (prev)
+	{
+		newFillLElt = sdr_list_insert_after(acsSdr, prev->fillLElt,
+				newFillAddr);
+	} else {
+		newFillLElt = sdr_list_insert_first(acsSdr, fills, newFillAddr);
+	}
+
+	if (newFillLElt == 0)
+	{
+		ACSLOG_WARN("Couldn't insert new fill %u into list (%s)",
+				id, strerror(errno));
+		/* Stale newFill object will be backed out of SDR on
+		 * sdr_end_xn() */
+		return -1;			/* Error */
+	}
+
+	if (indexFill(wm, vdb, fills, newFillLElt, newFillAddr, &newFill)
+			== NULL)
+	{
+		/* The list is right; it will simply be indexed afresh. */
+		forgetAcsFillIndex(fills);
+		return 0;
+	}
+
+	index->fillCount++;
+	return 0;
 }
 
 static int newSdrAcsSignal(Object acsSignals, Object pendingCustAddr,
@@ -188,6 +486,8 @@ static int newSdrAcsSignal(Object acsSignals, Object pendingCustAddr,
 	SdrAcsSignal	newAcsSignal;
 	Address			newAcsSignalAddr;
 	Object			newAcsSignalLElt;
+	long			growth;
+	int				result;
 
 	ASSERT_ACSSDR_XN;
 
@@ -202,14 +502,23 @@ static int newSdrAcsSignal(Object acsSignals, Object pendingCustAddr,
 	newAcsSignal.succeeded  = succeeded;
 	newAcsSignal.reasonCode = reasonCode;
 	newAcsSignal.acsFills   = sdr_list_create(acsSdr);
-	newAcsSignal.acsDue		= 0;
 	newAcsSignal.pendingCustAddr = pendingCustAddr;
-	newAcsSignal.serializedZco = 0;
-	newAcsSignal.serializedZcoLength = 0;
+	newAcsSignal.serializedLength = 2;	/* Admin record and status bytes. */
 	if(newAcsSignal.acsFills == 0) {
 		ACSLOG_WARN("Couldn't allocate new ACS fills list (%s)", strerror(errno));
 		return -1;
 	}
+
+	/* The first custody ID is always taken, even if it makes the signal
+	 * exceed the custodian's acsSize; trySendAcs() then sends it alone. */
+	result = appendToSdrAcsFills(newAcsSignal.acsFills, cteb, LONG_MAX,
+			&growth);
+	if (result < 0)
+	{
+		return result;
+	}
+
+	newAcsSignal.serializedLength += growth;
 	sdr_poke(acsSdr, newAcsSignalAddr, newAcsSignal);
 
 	newAcsSignalLElt = sdr_list_insert(acsSdr, acsSignals, newAcsSignalAddr, cmpSdrAcsSignals,
@@ -222,25 +531,57 @@ static int newSdrAcsSignal(Object acsSignals, Object pendingCustAddr,
 		return -1;			/* Error */
 	}
 
-	return appendToSdrAcsFills(newAcsSignal.acsFills, cteb);
+	return 0;
 }
 
 int appendToSdrAcsSignals(Object acsSignals, Object pendingCustAddr, 
 	BpCtReason reasonCode, unsigned char succeeded,
 	const CtebScratchpad *cteb)
 {
+	Object			curAcsSignalLElt;
 	Object			curAcsSignalAddr;
 	SdrAcsSignal	curAcsSignal;
+	SdrAcsPendingCust	pendingCust;
+	long			room = LONG_MAX;
+	long			growth;
+	int				result;
 
+	acsSdr = getAcssdr();
 	ASSERT_ACSSDR_XN;
 
-	if(findSdrAcsSignal(acsSignals, reasonCode, succeeded,
-							&curAcsSignalAddr) != 0)
+	curAcsSignalLElt = findSdrAcsSignal(acsSignals, reasonCode, succeeded,
+			&curAcsSignalAddr);
+	if(curAcsSignalLElt != 0)
 	{
 		ACSLOG_DEBUG("Found existing custody signal (%s,%d)",
 			succeeded ? "SUCCESS" : "FAIL", reasonCode);
+		sdr_peek(acsSdr, pendingCust, pendingCustAddr);
 		sdr_peek(acsSdr, curAcsSignal, curAcsSignalAddr);
-		return appendToSdrAcsFills(curAcsSignal.acsFills, cteb);
+		if (pendingCust.acsSize > 0)
+		{
+			room = (long) pendingCust.acsSize
+					- (long) curAcsSignal.serializedLength;
+		}
+
+		result = appendToSdrAcsFills(curAcsSignal.acsFills, cteb, room,
+				&growth);
+		if (result == 0 && growth != 0)
+		{
+			curAcsSignal.serializedLength += growth;
+			sdr_poke(acsSdr, curAcsSignalAddr, curAcsSignal);
+		}
+
+		if (result != -3)
+		{
+			return result;
+		}
+
+		/* This custody ID would make the signal exceed the custodian's
+		 * acsSize, so send the signal as it is and start a new one
+		 * with this ID. */
+		ACSLOG_DEBUG("ACS to %s is full at %lu bytes", pendingCust.eid,
+				curAcsSignal.serializedLength);
+		sendAcs(curAcsSignalLElt, pendingCust.eid);
 	}
 
 	ACSLOG_DEBUG("Making new custody signal for (%s,%d)",
@@ -435,12 +776,12 @@ int	offerNoteAcs(Bundle *bundle, AcqWorkArea *work, char *dictionary,
 	printSdrAcsSignal(ACSLOGLEVEL_DEBUG, pendingCust.signals, reasonCode,
 				succeeded, pendingCust.eid);
 
-	if (trySendAcs(&pendingCust, reasonCode, succeeded, &cteb) != 0)
+	if (trySendAcs(pendingCustAddr) != 0)
 	{
-		/* We failed to attempt sending an ACS handling this new signal
-		 * (either itself containing the signal, or carrying over this signal
-		 * to a new, empty ACS).  We should revert the SDR changes we made
-		 * and return 0 so that the caller will send a normal custody signal. */
+		/* We failed to send or schedule the custodian's pending ACS,
+		 * including the one now carrying this signal.  We should revert
+		 * the SDR changes we made and return 0 so that the caller will send
+		 * a normal custody signal. */
 		MRELEASE(currentCustodianEid);
 		sdr_cancel_xn(acsSdr);
 		sdr_cancel_xn(bpSdr);
@@ -32,35 +32,46 @@ typedef struct {
 	unsigned long	iBuf;
 	unsigned long	bufSize;
 	unsigned long 	lastFill;
+	int				overflowed;		/* Boolean */
 } SerializeForeachArgs_t;
 
+/* Appends an SDNV to the buffer unless it would overrun the buffer, in which
+ * case the serialization is marked as failed. */
+static void serializeSdnv(SerializeForeachArgs_t *args, uvast value)
+{
+	Sdnv			encoded;
+
+	encodeSdnv(&encoded, value);
+	if (args->iBuf + encoded.length > args->bufSize)
+	{
+		args->overflowed = 1;
+		return;
+	}
+
+	memcpy(args->buf + args->iBuf, encoded.text, encoded.length);
+	args->iBuf += encoded.length;
+}
+
 static void serializeFill(Sdr sdr, Object fillAddr, void *argsAsVoid)
 {
 	SerializeForeachArgs_t	*args = (SerializeForeachArgs_t *)(argsAsVoid);
 	SdrAcsFill		fill;
-	Sdnv			encoded;
 
 	assert(sdr_in_xn(sdr));
+	if (args->overflowed)
+	{
+		return;
+	}
 
 	sdr_peek(sdr, fill, fillAddr);
 
-	/* Write a start-delta. */
-	encodeSdnv(&encoded, fill.start - args->lastFill);
-	memcpy(args->buf + args->iBuf, encoded.text, encoded.length);
-	args->iBuf += encoded.length;
-	assert(args->bufSize >= args->iBuf);
-
-	/* Write a length. */
-	encodeSdnv(&encoded, fill.length);
-	memcpy(args->buf + args->iBuf, encoded.text, encoded.length);
-	args->iBuf += encoded.length;
-	assert(args->bufSize >= args->iBuf);
-
+	/* Write a start-delta, then a length. */
+	serializeSdnv(args, fill.start - args->lastFill);
+	serializeSdnv(args, fill.length);
 	args->lastFill = fill.start + fill.length - 1;
 }
 
-unsigned long serializeAcs(Object signalAddr, Object *serializedZco,
-		unsigned long lastSerializedSize)
+unsigned long serializeAcs(Object signalAddr, Object *serializedZco)
 {
 	SdrAcsSignal			signal;
 	SerializeForeachArgs_t	args;
@@ -69,26 +80,19 @@ unsigned long serializeAcs(Object signalAddr, Object *serializedZco,
 	Sdr						bpSdr = getIonsdr();
 	Sdr						acsSdr = getAcssdr();
 
-	/* We rely on incremental updates (reserialization) to serializedZco
-	 * to determine the right size of buffer to allocate:
-	 *  - If there is no existing serializedZco, then there is no more
-	 *    than one signal in the list, so the maximum size of buf is known.
-	 *
-	 *  - If there is an existing serializedZco, then we are adding at most
-	 *    one more fill to the serialization, so the maximum increase in
-	 *	  size of buf is known.
-	 *
-	 * This calculation is pessimistic, but it's just our working memory;
-	 * we actually allocate a ZCO of the exact right size after we're done
-	 * serializing. */
-	if (lastSerializedSize == 0)
+	ASSERT_BPSDR_XN;
+	ASSERT_ACSSDR_XN;
+	sdr_peek(acsSdr, signal, signalAddr);
+
+	/* The signal's serializedLength is maintained as its fills change, so
+	 * it is exactly the size of buffer we need; a length that can't even
+	 * hold the two header bytes is corrupt. */
+	args.bufSize = signal.serializedLength;
+	if (args.bufSize < 2)
 	{
-		args.bufSize = 1    /* Admin Record header byte */
-				+ 1         /* reasonCode, succeeded byte */
-				+ 20;       /* 1 start, length SDNV double */
-	} else {
-		args.bufSize = lastSerializedSize
-				+ 20;       /* Possibly new start, length SDNV double. */
+		putErrmsg("ACS signal has invalid serialized length",
+				itoa(args.bufSize));
+		return 0;
 	}
 
 	if((args.buf = MTAKE(args.bufSize)) == 0)
@@ -97,24 +101,26 @@ unsigned long serializeAcs(Object signalAddr, Object *serializedZco,
 		return 0;
 	}
 	args.iBuf = 0;
-
-	ASSERT_BPSDR_XN;
-	ASSERT_ACSSDR_XN;
-	sdr_peek(acsSdr, signal, signalAddr);
+	args.overflowed = 0;
 
 	/* Assign the admin record header byte. */
 	args.buf[args.iBuf] = (BP_AGGREGATE_CUSTODY_SIGNAL << 4) | 0x00;
 	args.iBuf++;
-	assert(args.bufSize >= args.iBuf);
 
 	/* Assign the status byte. */
 	args.buf[args.iBuf] = (signal.succeeded << 7) | (signal.reasonCode & 0x7F);
 	args.iBuf++;
-	assert(args.bufSize >= args.iBuf);
 
 	/* Serialize the acsFills. */
 	args.lastFill = 0;
 	sdr_list_foreach(acsSdr, signal.acsFills, serializeFill, &args);
+	if (args.overflowed || args.iBuf != args.bufSize)
+	{
+		putErrmsg("ACS fills don't match signal's serialized length",
+				itoa(args.bufSize));
+		MRELEASE(args.buf);
+		return 0;
+	}
 
 	serializedSdrAddr = sdr_malloc(bpSdr, args.iBuf);
 	if (serializedSdrAddr == 0)
@@ -298,15 +298,12 @@ static void releaseSdrAcsFill(Sdr sdr, Object elt, void *arg)
 
 static void releaseSdrAcsSignal(Object signalLElt)
 {
-	Sdr			bpSdr = getIonsdr();
 	Sdr                 acsSdr = getAcssdr();
 	Object              signalAddr;
 	SdrAcsSignal        signal;
-	SdrAcsPendingCust   pendingCust;
 
 	assert(signalLElt != 0);
 	ASSERT_ACSSDR_XN;
-	ASSERT_BPSDR_XN;
 
 	if (acsSdr == NULL)
 	{
@@ -321,63 +318,40 @@ static void releaseSdrAcsSignal(Object signalLElt)
 	}
 
 	sdr_peek(acsSdr, signal, signalAddr);
-	sdr_peek(acsSdr, pendingCust, signal.pendingCustAddr);
 
 	/* Destroy the objects this AcsSignal contains */
+	forgetAcsFillIndex(signal.acsFills);
 	sdr_list_destroy(acsSdr, signal.acsFills, releaseSdrAcsFill, NULL);
 
-	if(signal.acsDue != 0) {
-		destroyBpTimelineEvent(signal.acsDue);
-	}
-
-	if(signal.serializedZco != 0) {
-		zco_destroy(bpSdr, signal.serializedZco);
-	}
-
 	/* Destroy this AcsSignal */
 	sdr_free(acsSdr, signalAddr);
 	sdr_list_delete(acsSdr, signalLElt, NULL, NULL);
 }
 
-int sendAcs(Object signalLElt)
+/* Serializes one pending signal, sends it to its custodian, and releases
+ * it, all within the caller's transactions. */
+void sendAcs(Object signalLElt, const char *custodianEid)
 {
 	BpExtendedCOS		ecos = { 0, 0, 255 };
 	Object			signalAddr;
+	Object			serializedZco;
 	Object			acsBundleObj;	/* Unused write-out of bpSend */
-	SdrAcsSignal        	signal;
-	SdrAcsPendingCust	pendingCust;
-	int			result;
 	Sdr			bpSdr = getIonsdr();
 
-	assert(signalLElt != 0);
-
-	if ((acsSdr = getAcssdr()) == NULL)
-	{
-		putErrmsg("Can't send ACS, SDR not available.", NULL);
-		return -1;
-	}
-
-	/* To prevent deadlock, we take the BP SDR before the ACS SDR. */
-	CHKERR(sdr_begin_xn(bpSdr));
-	CHKERR(sdr_begin_xn(acsSdr));
+	ASSERT_BPSDR_XN;
+	ASSERT_ACSSDR_XN;
 
 	signalAddr = sdr_list_data(acsSdr, signalLElt);
-	if (signalAddr == 0) {
-		ACSLOG_ERROR("Can't derefence ACS signal to send it.");
-		sdr_cancel_xn(acsSdr);
-		sdr_cancel_xn(bpSdr);
-		return -1;
+	if (serializeAcs(signalAddr, &serializedZco) == 0)
+	{
+		ACSLOG_ERROR("Can't serialize ACS to %s", custodianEid);
+		releaseSdrAcsSignal(signalLElt);
+		return;
 	}
 
-	sdr_peek(acsSdr, signal, signalAddr);
-	sdr_peek(acsSdr, pendingCust, signal.pendingCustAddr);
-
-	/* Remove ref to this serialized ZCO from signal; also remove the bundle
-	 * IDs covered by this serialized ZCO. */
-	result = bpSend(NULL, pendingCust.eid, NULL, ACS_TTL,
+	switch (bpSend(NULL, (char *) custodianEid, NULL, ACS_TTL,
 			BP_EXPEDITED_PRIORITY, NoCustodyRequested, 0, 0, &ecos,
-			signal.serializedZco, &acsBundleObj, BP_CUSTODY_SIGNAL);
-	switch (result)
+			serializedZco, &acsBundleObj, BP_CUSTODY_SIGNAL))
 	{
 	/* All return codes from bpSend() still cause us to continue processing
 	 * to free this ACS.  If it was sent successfully, good.  If it wasn't,
@@ -385,12 +359,12 @@ int sendAcs(Object signalLElt)
 	 * we can do is delete it from our node without sending. */
 	case -1:
 		ACSLOG_ERROR("Can't send custody transfer signal.");
-		zco_destroy(bpSdr, signal.serializedZco);
+		zco_destroy(bpSdr, serializedZco);
 		break;
 
 	case 0:
 		ACSLOG_ERROR("Custody transfer signal not transmitted.");
-		zco_destroy(bpSdr, signal.serializedZco);
+		zco_destroy(bpSdr, serializedZco);
 		break;
 
 	default:
@@ -399,183 +373,117 @@ int sendAcs(Object signalLElt)
 		break;
 	}
 
-	if (signal.acsDue != 0)
+	releaseSdrAcsSignal(signalLElt);
+}
+
+int flushAcs(Object pendingCustAddr)
+{
+	SdrAcsPendingCust	pendingCust;
+	Object			signalLElt;
+	Sdr			bpSdr = getIonsdr();
+
+	assert(pendingCustAddr != 0);
+
+	if ((acsSdr = getAcssdr()) == NULL)
 	{
-		destroyBpTimelineEvent(signal.acsDue);
+		putErrmsg("Can't send ACS, SDR not available.", NULL);
+		return -1;
 	}
 
-	signal.acsDue = 0;
-	signal.serializedZco = 0;
-	sdr_poke(acsSdr, signalAddr, signal);
+	/* To prevent deadlock, we take the BP SDR before the ACS SDR. */
+	CHKERR(sdr_begin_xn(bpSdr));
+	CHKERR(sdr_begin_xn(acsSdr));
 
-	releaseSdrAcsSignal(signalLElt);
+	sdr_peek(acsSdr, pendingCust, pendingCustAddr);
+	ACSLOG_DEBUG("Flushing %ld ACS to %s", sdr_list_length(acsSdr,
+			pendingCust.signals), pendingCust.eid);
+	while ((signalLElt = sdr_list_first(acsSdr, pendingCust.signals)) != 0)
+	{
+		sendAcs(signalLElt, pendingCust.eid);
+	}
+
+	if (pendingCust.acsDue != 0)
+	{
+		destroyBpTimelineEvent(pendingCust.acsDue);
+		pendingCust.acsDue = 0;
+		sdr_poke(acsSdr, pendingCustAddr, pendingCust);
+	}
 
 	if (sdr_end_xn(acsSdr) < 0)
 	{
-		ACSLOG_ERROR("Couldn't mark a serialized ACS as sent.");
+		ACSLOG_ERROR("Couldn't mark ACS to %s as sent.", pendingCust.eid);
 		sdr_cancel_xn(bpSdr);
 		return -1;
 	}
 
-	if(sdr_end_xn(bpSdr) < 0)
+	if (sdr_end_xn(bpSdr) < 0)
 	{
 		return -1;
 	}
 
-	return result > 0 ? 0 : -1;
+	return 0;
 }
 
-int trySendAcs(SdrAcsPendingCust *custodian, 
-		BpCtReason reasonCode, unsigned char succeeded, 
-		const CtebScratchpad *cteb)
+int trySendAcs(Object pendingCustAddr)
 {
+	SdrAcsPendingCust	pendingCust;
 	Object				signalLElt;
-	Object				signalAddr;
-	SdrAcsSignal        signal;
+	Object				nextSignalLElt;
+	SdrAcsSignal		signal;
 	BpEvent				timelineEvent;
-	Object				newSerializedZco;
-	unsigned long		newSerializedLength;
-	int					result;
 	Sdr					bpSdr = getIonsdr();
 
 	/* To prevent deadlock, take bpSdr before acsSdr. */
 	CHKERR(sdr_begin_xn(bpSdr));
 	CHKERR(sdr_begin_xn(acsSdr));
 
-	signalLElt = findSdrAcsSignal(custodian->signals, reasonCode, succeeded,
-			&signalAddr);
-	if (signalAddr == 0)
-	{
-		ACSLOG_ERROR("Can't find ACS signal");
-		sdr_exit_xn(acsSdr);
-		sdr_exit_xn(bpSdr);
-		return -1;
-	}
-	sdr_peek(acsSdr, signal, signalAddr);
-
+	sdr_peek(acsSdr, pendingCust, pendingCustAddr);
 
-	newSerializedLength = serializeAcs(signalAddr, &newSerializedZco,
-			signal.serializedZcoLength);
-	if (newSerializedLength == 0)
+	/* A signal that has grown to the custodian's preferred size is sent
+	 * at once, on its own; the custodian's other pending ACS wait for the
+	 * flush timer. */
+	if (pendingCust.acsSize > 0)
 	{
-		ACSLOG_ERROR("Can't serialize new ACS (%lu)", signal.serializedZcoLength);
-		sdr_cancel_xn(acsSdr);
-		sdr_cancel_xn(bpSdr);
-		return -1;
-	}
-	ACSLOG_DEBUG("Serialized a new ACS to %s that is %lu long (old: %lu)",
-			custodian->eid, newSerializedLength, signal.serializedZcoLength);
-
-
-	/* If serializeAcs() (which serializes an ACS that covers all the "old"
-	 * custody IDs as well as 1 "new" custody ID that we're trying to append)
-	 * returned an ACS that's larger than the custodian' preferred size, then:
-	 *  1) Send the old ACS (the biggest ACS that's smaller than custodian's
-	 *     preferred size), covering all the old custody IDs but not the new
-	 *     one.
-	 *  2) Make a new ACS that includes only the new custody ID.
-	 */
-	if (custodian->acsSize > 0 && newSerializedLength >= custodian->acsSize)
-	{
-		if(signal.serializedZco == 0)
+		signalLElt = sdr_list_first(acsSdr, pendingCust.signals);
+		while (signalLElt)
 		{
-			/* We don't have an old unserialized ACS to send.  This means the
-			 * first custody signal appended to this ACS exceeded the acsSize
-			 * parameter.  The best we can do is send this ACS even though it's
-			 * bigger than the recommended acsSize. */
-			ACSLOG_WARN("Appending first CS to %s was bigger than %lu", 
-					custodian->eid, custodian->acsSize);
-			signal.serializedZcoLength = newSerializedLength;
-			signal.serializedZco = newSerializedZco;
-			sdr_poke(acsSdr, signalAddr, signal);
-			sendAcs(signalLElt);
-			if(sdr_end_xn(acsSdr) < 0)
-			{
-				ACSLOG_ERROR("Can't serialize ACS bundle.");
-				sdr_cancel_xn(bpSdr);
-				return -1;
-			}
-			if (sdr_end_xn(bpSdr) < 0)
+			nextSignalLElt = sdr_list_next(acsSdr, signalLElt);
+			sdr_peek(acsSdr, signal, sdr_list_data(acsSdr, signalLElt));
+			if (signal.serializedLength >= pendingCust.acsSize)
 			{
-				ACSLOG_ERROR("Can't send ACS bundle.");
-				return -1;
+				ACSLOG_DEBUG("ACS to %s reached %lu bytes", pendingCust.eid,
+						signal.serializedLength);
+				sendAcs(signalLElt, pendingCust.eid);
 			}
-			return 0;
-		}
-
-		/* Calling this invalidates our signalLElt and signalAddr pointers, so
-		 * we must re-find the signal before using them again. */
-		sendAcs(signalLElt);
-
-		/* Add the one that was uncovered by the serialized payload back in */
-		result = appendToSdrAcsSignals(custodian->signals,
-				signal.pendingCustAddr, reasonCode, succeeded,
-				cteb);
-		switch (result)
-		{
-			case 0:
-				/* Success; continue processing. */
-				break;
-			default:
-				ACSLOG_ERROR("Can't carry size-limited ID to new ACS");
-				sdr_cancel_xn(acsSdr);
-				sdr_cancel_xn(bpSdr);
-				return -1;
-		}
-
-		/* Find the uncovered one that we just added. */
-		signalLElt = findSdrAcsSignal(custodian->signals, reasonCode,
-				succeeded, &signalAddr);
-		if (signalAddr == 0)
-		{
-			ACSLOG_ERROR("Can't find ACS signal");
-			sdr_cancel_xn(acsSdr);
-			sdr_cancel_xn(bpSdr);
-			return -1;
-		}
-		sdr_peek(acsSdr, signal, signalAddr);
 
-		/* Serialize the new one */
-		newSerializedLength = serializeAcs(signalAddr, &newSerializedZco, 0);
-		if (newSerializedLength <= 0)
-		{
-			ACSLOG_ERROR("Can't serialize new ACS (%lu)", newSerializedLength);
-			sdr_cancel_xn(acsSdr);
-			sdr_cancel_xn(bpSdr);
-			return -1;
-		}
-	} else {
-		if (signal.serializedZco != 0)
-		{
-			/* Free the old payload zco. */
-			zco_destroy(bpSdr, signal.serializedZco);
+			signalLElt = nextSignalLElt;
 		}
 	}
 
-	/* Store the new ZCO */
-	signal.serializedZco = newSerializedZco;
-	signal.serializedZcoLength = newSerializedLength;
-
-	/* If there is not an ACS generation countdown timer, create one. */
-	if(signal.acsDue == 0)
+	/* If the custodian has pending ACS but no flush countdown timer,
+	 * create one. */
+	if (sdr_list_length(acsSdr, pendingCust.signals) > 0
+	&& pendingCust.acsDue == 0)
 	{
 		timelineEvent.type = csDue;
-		if(custodian->acsDelay == 0) {
+		if(pendingCust.acsDelay == 0) {
 			timelineEvent.time = getUTCTime() + DEFAULT_ACS_DELAY;
 		} else {
-			timelineEvent.time = getUTCTime() + custodian->acsDelay;
+			timelineEvent.time = getUTCTime() + pendingCust.acsDelay;
 		}
-		timelineEvent.ref  = signalLElt;
-		signal.acsDue = insertBpTimelineEvent(&timelineEvent);
-		if (signal.acsDue == 0)
+		timelineEvent.ref  = pendingCustAddr;
+		pendingCust.acsDue = insertBpTimelineEvent(&timelineEvent);
+		if (pendingCust.acsDue == 0)
 		{
 			ACSLOG_ERROR("Can't add timeline event to generate ACS");
 			sdr_cancel_xn(acsSdr);
 			sdr_cancel_xn(bpSdr);
 			return -1;
 		}
+
+		sdr_poke(acsSdr, pendingCustAddr, pendingCust);
 	}
-	sdr_poke(acsSdr, signalAddr, signal);
+
 	if(sdr_end_xn(acsSdr) < 0)
 	{
 		ACSLOG_ERROR("Can't track ACS");
@@ -47,7 +47,9 @@
  * Processing Directives
  * These directives identify processing callbacks for areas of the bundle
  * protocol agent that handle data flow through parts of the extension
- * block lifecycle.
+ * block lifecycle.  A callback that changes any bundle field encoded in
+ * the primary block must call invalidatePrimaryBlock() on the bundle, lest
+ * the primary block serialized at an earlier transmission be reused.
  */
 #define	PROCESS_ON_FORWARD		(0)
 #define	PROCESS_ON_TAKE_CUSTODY		(1)
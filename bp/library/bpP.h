@@ -168,6 +168,7 @@ typedef struct
 {
 	char		*protocolName;
 	char		*proxNodeEid;
+	ZcoDigest	*digest;	/*	NULL unless streaming.	*/
 } DequeueContext;
 
 /*	*	*	Bundle structures	*	*	*	*/
@@ -306,6 +307,13 @@ typedef struct
 		/*	fragment offset is in the id field.		*/
 	unsigned int	totalAduLength;
 
+	/*	The primary block as serialized at the bundle's most
+	 *	recent transmission, reused until invalidatePrimaryBlock
+	 *	is called upon a change to any field encoded in it.	*/
+
+	Object		primaryBlock;	/*	SDR byte array.		*/
+	int		primaryBlockLength;
+
 	/*	Stuff in Extended COS extension block.			*/
 
 	BpExtendedCOS	extendedCOS;
@@ -389,6 +397,8 @@ typedef struct
 	 *	final one) are destroyed.				*/
 
 	unsigned int	totalAduLength;
+	unsigned int	fragmentBytes;	/*	Sum of payload lengths.	*/
+	Object		hashEntry;	/*	Entry in incompletes.	*/
 } IncompleteBundle;
 
 /*	*	*	Endpoint structures	*	*	*	*/
@@ -600,6 +610,7 @@ typedef struct
 	Object		protocols;	/*	SDR list of ClProtocols	*/
 	Object		timeline;	/*	SDR list of BpEvents	*/
 	Object		bundles;	/*	SDR hash of BundleSets	*/
+	Object		incompletes;	/*	SDR hash of Incompletes	*/
 	Object		inboundBundles;	/*	SDR list of ZCOs	*/
 	Object		limboQueue;	/*	SDR list of Bundles	*/
 	Object		clockCmd; 	/*	For starting clock.	*/
@@ -1011,6 +1022,32 @@ extern int		bpDequeue(	VOutduct *vduct,
 			 *
 			 *	Returns 0 on success, -1 on failure.	*/
 
+extern void		bpStreamXmitDigests();
+			/*	This function is invoked by a
+			 *	convergence-layer output adapter
+			 *	that reads every bundle it obtains
+			 *	from bpDequeue sequentially, in one
+			 *	pass, through a ZcoReader initialized
+			 *	by bpStartTransmitting.  Thereafter,
+			 *	digests that are computed over the
+			 *	entire catenated bundle (notably the
+			 *	BAB security result) are not computed
+			 *	by bpDequeue in a separate pass over
+			 *	the bundle; instead they are computed
+			 *	as the adapter copies the bundle's
+			 *	bytes out for transmission, and the
+			 *	results are substituted into the
+			 *	copied bytes.				*/
+
+extern void		bpStartTransmitting(Object bundleZco,
+					ZcoReader *reader);
+			/*	Same as zco_start_transmitting, except
+			 *	that if bundleZco is the bundle most
+			 *	recently returned by bpDequeue and a
+			 *	digest over that bundle is pending
+			 *	then the digest is attached to the
+			 *	reader.					*/
+
 extern int		bpIdentify(Object bundleZco, Object *bundleObj);
 			/*	This function parses out the ID fields
 			 *	of the catenated outbound bundle in
@@ -1258,6 +1295,8 @@ extern char		*getBpString(BpString *bpString);
 extern char		*retrieveDictionary(Bundle *bundle);
 extern void		releaseDictionary(char *dictionary);
 
+extern void		invalidatePrimaryBlock(Bundle *bundle);
+
 extern int		parseEidString(char *eidString, MetaEid *metaEid,
 				VScheme **scheme, PsmAddress *schemeElt);
 extern void		restoreEidString(MetaEid *metaEid);
@@ -673,8 +673,28 @@ int bsp_babPostProcessOnTransmit(ExtensionBlock *blk, Bundle *bundle,void *ctxt)
     * Get it ready to serialize, and grab the bundle length.
     */
    rawBundleLength = zco_length(bpSdr, bundle->payload.content) - asb.resultLen;
+
+   /*
+    * If the CLO streams digests, compute the security result as the CLO
+    * copies the bundle out for transmission rather than in a separate
+    * pass over the bundle here.  The result is substituted for the
+    * zero-filled result at the end of the serialized post-payload block.
+    */
+   if((ctxt != NULL) && (((DequeueContext *) ctxt)->digest != NULL))
+   {
+      result = bsp_babStreamSecResult(((DequeueContext *) ctxt)->digest,
+                     rawBundleLength, keyValue, keyLen, asb.resultLen);
+      if(result != 0)
+      {
+         bsp_releaseKey((unsigned char *) keyValue);
+         result = (result < 0 ? -1 : 0);
+         BAB_DEBUG_PROC("- bsp_babPostProcessOnTransmit --> %d", result);
+         return result;
+      }
+   }
+
    digest = bsp_babGetSecResult(bundle->payload.content, rawBundleLength, keyValue, keyLen, &digestLen);
-   MRELEASE(keyValue);
+   bsp_releaseKey((unsigned char *) keyValue);
 
    // Encode real digest length into sdnv
    encodeSdnv(&digestSdnv, digestLen); 
@@ -928,7 +948,7 @@ int bsp_babPreCheck(AcqExtBlock *pre_blk, AcqWorkArea *wk)
    /* Read data in chunks and hash. */
    digest = bsp_babGetSecResult(wk->bundle.payload.content, lengthToHash, keyValueBuffer, keyLen, &digestLen);
 
-   MRELEASE(keyValueBuffer);
+   bsp_releaseKey((unsigned char *) keyValueBuffer);
 
    /* Let's see if we got a good result */
    if((digest != NULL) && (digestLen == BAB_HMAC_SHA1_RESULT_LEN))   
@@ -1375,3 +1395,150 @@ unsigned char *bsp_babGetSecResult(Object dataObj,
    MRELEASE(dataBuffer);
    return (unsigned char *) hashData;
 }
+
+
+/******************************************************************************
+ *
+ * \par Function Name: bsp_babStreamSecResult
+ *
+ * \par Purpose: Prepares a ZCO digest that calculates the security result
+ *               for a serialized bundle as the bundle is copied out for
+ *               transmission, in place of a separate pass over the bundle
+ *               by bsp_babGetSecResult.  The digest substitutes the
+ *               security result (including its ciphersuite parameter type
+ *               and length) for the zero-filled result at the end of the
+ *               serialized post-payload BAB.
+ *
+ * \retval int  1 - The digest was prepared.
+ *              0 - The digest can't be streamed; use bsp_babGetSecResult.
+ *             -1 - There was a system error.
+ *
+ * \param[out] digest    - The ZCO digest to prepare.
+ * \param[in]  dataLen   - Length of the serialized bundle to be hashed.
+ * \param[in]  keyValue  - The key to use.
+ * \param[in]  keyLen    - Length of the key.
+ * \param[in]  resultLen - Length of the serialized security result.
+ *
+ * \par Notes:
+ *      1. The digest state is static: each process can have only one
+ *         streamed BAB security result pending at a time, which suffices
+ *         for a CLO that transmits each bundle before dequeuing the next.
+ *****************************************************************************/
+
+typedef struct
+{
+   char          *authContext;
+   char          *keyValue;
+   unsigned int  keyLen;
+   char          result[BAB_HMAC_SHA1_RESULT_LEN + 1 + sizeof(Sdnv)];
+} BabStreamState;
+
+static BabStreamState *_babStreamState()
+{
+   static BabStreamState state;
+
+   return &state;
+}
+
+static void bsp_babStreamStart(void *context)
+{
+   BabStreamState *state = (BabStreamState *) context;
+
+   hmac_sha1_init(state->authContext, (unsigned char *) state->keyValue,
+                  state->keyLen);
+}
+
+static void bsp_babStreamUpdate(void *context, char *bytes, vast length)
+{
+   BabStreamState *state = (BabStreamState *) context;
+
+   hmac_sha1_update(state->authContext, (unsigned char *) bytes, length);
+}
+
+static void bsp_babStreamFinish(void *context, char *result, vast resultLength)
+{
+   BabStreamState *state = (BabStreamState *) context;
+   Sdnv digestSdnv;
+
+   encodeSdnv(&digestSdnv, BAB_HMAC_SHA1_RESULT_LEN);
+   *result = BSP_CSPARM_INT_SIG;
+   memcpy(result + 1, digestSdnv.text, digestSdnv.length);
+   hmac_sha1_final(state->authContext,
+                   (unsigned char *) result + 1 + digestSdnv.length,
+                   BAB_HMAC_SHA1_RESULT_LEN);
+   hmac_sha1_reset(state->authContext);
+}
+
+int bsp_babStreamSecResult(ZcoDigest *digest,
+                           unsigned int dataLen,
+                           char *keyValue,
+                           unsigned int keyLen,
+                           unsigned int resultLen)
+{
+   BabStreamState *state = _babStreamState();
+   int authCtxLen;
+   Sdnv digestSdnv;
+
+   BAB_DEBUG_PROC("+ bsp_babStreamSecResult(0x%x, %ld, %d, %d)",
+                  (unsigned long) digest, dataLen, keyLen, resultLen);
+
+   CHKERR(digest);
+   CHKERR(keyValue);
+   encodeSdnv(&digestSdnv, BAB_HMAC_SHA1_RESULT_LEN);
+   if(resultLen != 1 + digestSdnv.length + BAB_HMAC_SHA1_RESULT_LEN)
+   {
+      BAB_DEBUG_INFO("i bsp_babStreamSecResult: result length %d can't be \
+streamed.", resultLen);
+      BAB_DEBUG_PROC("- bsp_babStreamSecResult --> %d", 0);
+      return 0;
+   }
+
+   if(state->authContext == NULL)
+   {
+      if((authCtxLen = hmac_sha1_context_length()) <= 0)
+      {
+         BAB_DEBUG_ERR("x bsp_babStreamSecResult: Bad context length (%d)",
+                       authCtxLen);
+         BAB_DEBUG_PROC("- bsp_babStreamSecResult --> %d", -1);
+         return -1;
+      }
+
+      if((state->authContext = MTAKE(authCtxLen)) == NULL)
+      {
+         BAB_DEBUG_ERR("x bsp_babStreamSecResult: Can't allocate %d bytes",
+                       authCtxLen);
+         BAB_DEBUG_PROC("- bsp_babStreamSecResult --> %d", -1);
+         return -1;
+      }
+   }
+
+   /* The key buffer is reallocated only when the key length changes. */
+   if(state->keyValue != NULL && state->keyLen != keyLen)
+   {
+      MRELEASE(state->keyValue);
+      state->keyValue = NULL;
+   }
+
+   if(state->keyValue == NULL
+   && (state->keyValue = MTAKE(keyLen)) == NULL)
+   {
+      BAB_DEBUG_ERR("x bsp_babStreamSecResult: Can't allocate %d bytes",
+                    keyLen);
+      BAB_DEBUG_PROC("- bsp_babStreamSecResult --> %d", -1);
+      return -1;
+   }
+
+   memcpy(state->keyValue, keyValue, keyLen);
+   state->keyLen = keyLen;
+   digest->start = bsp_babStreamStart;
+   digest->update = bsp_babStreamUpdate;
+   digest->finish = bsp_babStreamFinish;
+   digest->context = state;
+   digest->digestLength = dataLen;
+   digest->result = state->result;
+   digest->resultLength = resultLen;
+   digest->finished = 0;
+
+   BAB_DEBUG_PROC("- bsp_babStreamSecResult --> %d", 1);
+   return 1;
+}
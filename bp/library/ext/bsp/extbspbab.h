@@ -467,6 +467,12 @@ unsigned char *bsp_babGetSecResult(Object dataObj,
 				   unsigned int keyLen,
                                    unsigned int *hashLen);
 
+int bsp_babStreamSecResult(ZcoDigest *digest,
+                           unsigned int dataLen,
+                           char *keyValue,
+                           unsigned int keyLen,
+                           unsigned int resultLen);
+
 
 
 
@@ -353,7 +353,7 @@ int bsp_pcbCheck(AcqExtBlock *blk, AcqWorkArea *wk)
     // Grab the actual key.
     if((ltKeyValue = (unsigned char *) bsp_retrieveKey((int *)&ltKeyLen, secInfo.cipherKeyName)) == NULL)
     {
-        MRELEASE(ltKeyValue);
+        bsp_releaseKey(ltKeyValue);
         discardExtensionBlock(blk);
 	PCB_DEBUG_ERR("x bsp_pcbCheck: Can't retrieve long term key %s.",
 		  secInfo.cipherKeyName);
@@ -366,7 +366,7 @@ int bsp_pcbCheck(AcqExtBlock *blk, AcqWorkArea *wk)
 
     if(sessionKeyValue == NULL) 
     {
-        MRELEASE(ltKeyValue);
+        bsp_releaseKey(ltKeyValue);
         discardExtensionBlock(blk);
 	PCB_DEBUG_ERR("x bsp_pcbCheck: Can't retrieve session key %s.",
 		  sessionKeyValue);
@@ -380,7 +380,7 @@ int bsp_pcbCheck(AcqExtBlock *blk, AcqWorkArea *wk)
                                                 ltKeyValue,
                                                 ltKeyLen)) == NULL)
     {
-        MRELEASE(ltKeyValue);
+        bsp_releaseKey(ltKeyValue);
         discardExtensionBlock(blk);
         PCB_DEBUG_ERR("x bsp_pcbCheck: Can't decrypt \
              session key, len %d", sessionKeyLen);
@@ -389,7 +389,7 @@ int bsp_pcbCheck(AcqExtBlock *blk, AcqWorkArea *wk)
     }
     memcpy((char *) sessionKeyValue, (char *) decryptedData, sessionKeyLen);
     // No longer need our long term key and decryptedData
-    MRELEASE(ltKeyValue); MRELEASE(decryptedData);
+    bsp_releaseKey(ltKeyValue); MRELEASE(decryptedData);
 
     PCB_DEBUG_PROC("- bsp_pcbCheck: decrypted session key is %s, len %d.",
 		  decryptedData, sessionKeyLen);
@@ -570,7 +570,7 @@ as expected.", NULL);
     // Grab our session key
     if( (sessionKeyValue = bsp_pcbGenSessionKey(&sessionKeyLen)) == NULL) 
     {
-	MRELEASE(ltKeyValue);
+	bsp_releaseKey(ltKeyValue);
 	if(eidRefs != NULL) lyst_destroy(eidRefs);
 	PCB_DEBUG_ERR("x bsp_pcbProcessOnDequeue: Can't generate \
 	   session key, len %d", sessionKeyLen);
@@ -583,7 +583,7 @@ as expected.", NULL);
     if( (encryptedData = bsp_pcbCryptSessionKey(sessionKeyValue, sessionKeyLen,
 						ltKeyValue, ltKeyLen)) == NULL) 
     { 
-	MRELEASE(ltKeyValue); MRELEASE(sessionKeyValue);  
+	bsp_releaseKey(ltKeyValue); MRELEASE(sessionKeyValue);  
 	if(eidRefs != NULL) lyst_destroy(eidRefs);
 	PCB_DEBUG_ERR("x bsp_pcbProcessOnDequeue: Can't encrypt \
 	     session key, len %d", sessionKeyLen);
@@ -599,7 +599,7 @@ as expected.", NULL);
 
     if((asb.resultData = MTAKE(sessionKeyLen + 1 + sessionKeySdnv.length)) == NULL)
     {
-	MRELEASE(ltKeyValue); MRELEASE(sessionKeyValue); MRELEASE(asb.resultData);
+	bsp_releaseKey(ltKeyValue); MRELEASE(sessionKeyValue); MRELEASE(asb.resultData);
 	if(eidRefs != NULL) lyst_destroy(eidRefs);
 	PCB_DEBUG_ERR("x bsp_pcbProcessOnDequeue: Can't allocate \
 	  ASB result, len %ld.", sessionKeyLen + 2);
@@ -614,7 +614,7 @@ as expected.", NULL);
     memcpy(asb.resultData + 1 + sessionKeySdnv.length, encryptedData, sessionKeyLen);
 
     // We can release this now since it's no longer needed
-    MRELEASE(encryptedData); MRELEASE(ltKeyValue);
+    MRELEASE(encryptedData); bsp_releaseKey(ltKeyValue);
 
     // Encrypt payload and get its encrypted data
     if((bsp_pcbCryptPayload(&encryptedPayloadZco, bundle->payload.content,
@@ -452,7 +452,7 @@ int bsp_pibCheck(AcqExtBlock *blk, AcqWorkArea *wk)
 
       cmpResult = memcmp(digest, tmpDigest, digestLen);
 
-      MRELEASE(keyValueBuffer);
+      bsp_releaseKey((unsigned char *) keyValueBuffer);
       MRELEASE(tmpDigest);
 
       if((cmpResult == 0) && (digestLen == tmpDigestLen))
@@ -611,7 +611,7 @@ Not using PIB blocks for this bundle.", NULL);
    				bundle->payload.length,
    			        keyValueBuffer, keyLen, &digestLen);
 
-   MRELEASE(keyValueBuffer);
+   bsp_releaseKey((unsigned char *) keyValueBuffer);
 
    /***************************************************************************
     *                      Populate ASB                                       *
@@ -393,6 +393,94 @@ AcqExtBlock *bsp_findAcqExtBlk(AcqWorkArea *wk, int listIdx, int type)
 }
 
 
+/*
+ * Key values are cached in process memory, keyed by key name, so that
+ * securing or checking a bundle normally neither reads the SDR nor
+ * allocates a key buffer.  The entire cache is discarded whenever the
+ * security database's key generation changes.  Each entry is reference
+ * counted: an entry that is discarded while a caller still holds its
+ * value is freed when that caller releases the value.
+ */
+
+typedef struct bspKeyEntry
+{
+	struct bspKeyEntry	*next;
+	int			refCount;
+	int			length;
+	char			name[32];
+	unsigned char		value[1];	/* Extends to length.	*/
+} BspKeyEntry;
+
+typedef struct
+{
+	pthread_mutex_t		lock;
+	unsigned int		generation;
+	BspKeyEntry		*entries;
+} BspKeyCache;
+
+static BspKeyCache	*_bspKeyCache()
+{
+	static BspKeyCache	cache = { PTHREAD_MUTEX_INITIALIZER, 0, NULL };
+
+	return &cache;
+}
+
+static void	releaseKeyEntry(BspKeyEntry *entry)
+{
+	entry->refCount--;
+	if (entry->refCount == 0)
+	{
+		MRELEASE(entry);
+	}
+}
+
+static BspKeyEntry	*loadKeyEntry(char *keyName)
+{
+	BspKeyEntry	*entry;
+	int		keyLen = 0;
+	char		c = ' ';
+
+	/*
+	 * We pass in a key length of zero.  This should result in the sec-get_key
+	 * function populating this value with the key length.  We cannot pass in a
+	 * value of NULL for the keyValueBuffer, so we pass in a single char pointer.
+	 */
+	if(sec_get_key(keyName, &keyLen, &c) != 0)
+	{
+		BSP_DEBUG_ERR("bsp_retrieveKey:  Unable to return length of key %s.",
+				keyName);
+		return NULL;
+	}
+
+	/* If no key length, the key must not have been found.*/
+	if(keyLen == 0)
+	{
+		BSP_DEBUG_ERR("x bsp_retrieveKey: Unable to find key %s", keyName);
+		return NULL;
+	}
+
+	entry = (BspKeyEntry *) MTAKE(sizeof(BspKeyEntry) + keyLen);
+	if(entry == NULL)
+	{
+		BSP_DEBUG_ERR("x bsp_retrieveKey: Failed to allocate %d bytes", keyLen);
+		return NULL;
+	}
+
+	/* Now we have key length and allocated buffer, so get key. */
+	if(sec_get_key(keyName, &keyLen, (char *) entry->value) != keyLen)
+	{
+		BSP_DEBUG_ERR("bsp_retrieveKey:  Can't get key %s", keyName);
+		MRELEASE(entry);
+		return NULL;
+	}
+
+	entry->next = NULL;
+	entry->refCount = 1;
+	entry->length = keyLen;
+	istrcpy(entry->name, keyName, sizeof entry->name);
+	return entry;
+}
+
 /******************************************************************************
  *
  * \par Function Name: bsp_retrieveKey
@@ -405,53 +493,112 @@ AcqExtBlock *bsp_findAcqExtBlk(AcqWorkArea *wk, int listIdx, int type)
  * \param[out] keyLen   The length of the key value that was found.
  * \param[in]  keyName  The name of the key to find.
  *
- * \par Notes: 
+ * \par Notes: The key value is shared with the key cache and must be
+ *             released by bsp_releaseKey, never by MRELEASE.
  *****************************************************************************/
 
 unsigned char *bsp_retrieveKey(int *keyLen, char *keyName)
 {
-	unsigned char *keyValueBuffer = NULL;
-	char c = ' ';
+	BspKeyCache	*cache = _bspKeyCache();
+	BspKeyEntry	*entry;
+	BspKeyEntry	*next;
+	BspKeyEntry	*found;
+	unsigned int	generation;
 
 	BSP_DEBUG_PROC("+ bsp_retrieveKey(%d, %s)", *keyLen, keyName);
 
-	/*
-	 * We pass in a key length of zero.  This should result in the sec-get_key
-	 * function populating this value with the key length.  We cannot pass in a
-	 * value of NULL for the keyValueBuffer, so we pass in a single char pointer.
-	 */
 	CHKNULL(keyLen);
 	CHKNULL(keyName);
 	*keyLen = 0;
-	if(sec_get_key(keyName, keyLen, &c) != 0)
+	pthread_mutex_lock(&cache->lock);
+	generation = sec_get_keyGeneration();
+	if(generation != cache->generation)
 	{
-		BSP_DEBUG_ERR("bsp_retrieveKey:  Unable to return length of key %s.",
-				keyName);
-	}
+		for(entry = cache->entries; entry; entry = next)
+		{
+			next = entry->next;
+			releaseKeyEntry(entry);
+		}
 
-	/* If no key length, the key must not have been found.*/
-	else if(*keyLen == 0)
-	{
-		BSP_DEBUG_ERR("x bsp_retrieveKey: Unable to find key %s", keyName);
+		cache->entries = NULL;
+		cache->generation = generation;
 	}
 
-	else if((keyValueBuffer = (unsigned char *) MTAKE(*keyLen)) == NULL)
+	for(entry = cache->entries; entry; entry = entry->next)
 	{
-		BSP_DEBUG_ERR("x bsp_retrieveKey: Failed to allocate %d bytes", *keyLen);
+		if(strcmp(entry->name, keyName) == 0)
+		{
+			entry->refCount++;
+			break;
+		}
 	}
 
-	/* Now we have key length and allocated buffer, so get key. */
-	else if(sec_get_key(keyName, keyLen, (char *) keyValueBuffer) != *keyLen)
+	pthread_mutex_unlock(&cache->lock);
+	if(entry == NULL)
 	{
-		BSP_DEBUG_ERR("bsp_retrieveKey:  Can't get key %s", keyName);
-		MRELEASE(keyValueBuffer);
-		keyValueBuffer = NULL;
+		/*
+		 * Not cached: load the key from the security database.  It
+		 * is cached only if no key was edited while it was loaded
+		 * and no other thread cached it meanwhile.
+		 */
+		if((entry = loadKeyEntry(keyName)) == NULL)
+		{
+			BSP_DEBUG_PROC("- bsp_retrieveKey - %s", "NULL");
+			return NULL;
+		}
+
+		pthread_mutex_lock(&cache->lock);
+		for(found = cache->entries; found; found = found->next)
+		{
+			if(strcmp(found->name, keyName) == 0)
+			{
+				break;
+			}
+		}
+
+		if(found == NULL && cache->generation == generation)
+		{
+			entry->refCount++;
+			entry->next = cache->entries;
+			cache->entries = entry;
+		}
+
+		pthread_mutex_unlock(&cache->lock);
 	}
 
+	*keyLen = entry->length;
 	BSP_DEBUG_PROC("- bsp_retrieveKey - (begins with) %.*s", MIN(128, *keyLen),
-			keyValueBuffer);
+			entry->value);
+
+	return entry->value;
+}
+
+
+/******************************************************************************
+ *
+ * \par Function Name: bsp_releaseKey
+ *
+ * \par Purpose: Releases a key value obtained from bsp_retrieveKey.
+ *
+ * \retval void
+ *
+ * \param[in]  keyValue  The key value to release; may be NULL.
+ *
+ * \par Notes: 
+ *****************************************************************************/
+
+void bsp_releaseKey(unsigned char *keyValue)
+{
+	BspKeyCache	*cache = _bspKeyCache();
+
+	if(keyValue == NULL)
+	{
+		return;
+	}
 
-	return keyValueBuffer;
+	pthread_mutex_lock(&cache->lock);
+	releaseKeyEntry((BspKeyEntry *) (keyValue - offsetof(BspKeyEntry, value)));
+	pthread_mutex_unlock(&cache->lock);
 }
 
 
@@ -460,6 +460,24 @@ AcqExtBlock *bsp_findAcqExtBlk(AcqWorkArea *wk, int listIdx, int type);
 unsigned char *bsp_retrieveKey(int *keyLen, char *keyName);
 
 
+/******************************************************************************
+ *
+ * \par Function Name: bsp_releaseKey
+ *
+ * \par Purpose: Releases a key value obtained from bsp_retrieveKey.  Key
+ *               values are shared with a per-process key cache that is
+ *               invalidated whenever any key is added, updated, or removed.
+ *
+ * \retval void
+ *
+ * \param[in]  keyValue  The key value to release; may be NULL.
+ *
+ * \par Notes: 
+ *****************************************************************************/
+
+void bsp_releaseKey(unsigned char *keyValue);
+
+
 /******************************************************************************
  *
  * \par Function Name: bsp_serializeASB
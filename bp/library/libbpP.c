@@ -44,6 +44,20 @@
 #define	BUNDLES_HASH_SEARCH_LEN	20
 #endif
 
+#ifndef INCOMPLETES_HASH_KEY_LEN
+#define	INCOMPLETES_HASH_KEY_LEN	64
+#endif
+
+#define	INCOMPLETES_HASH_KEY_BUFLEN	(INCOMPLETES_HASH_KEY_LEN << 1)
+
+#ifndef INCOMPLETES_HASH_ENTRIES
+#define	INCOMPLETES_HASH_ENTRIES	10000
+#endif
+
+#ifndef INCOMPLETES_HASH_SEARCH_LEN
+#define	INCOMPLETES_HASH_SEARCH_LEN	20
+#endif
+
 static BpVdb	*_bpvdb(char **);
 static int	constructCtSignal(BpCtSignal *csig, Object *zco);
 static int	constructStatusRpt(BpStatusRpt *rpt, Object *zco);
@@ -1479,6 +1493,10 @@ int	bpInit()
 				BUNDLES_HASH_KEY_LEN,
 				BUNDLES_HASH_ENTRIES,
 				BUNDLES_HASH_SEARCH_LEN);
+		bpdbBuf.incompletes = sdr_hash_create(bpSdr,
+				INCOMPLETES_HASH_KEY_LEN,
+				INCOMPLETES_HASH_ENTRIES,
+				INCOMPLETES_HASH_SEARCH_LEN);
 		bpdbBuf.inboundBundles = sdr_list_create(bpSdr);
 		bpdbBuf.limboQueue = sdr_list_create(bpSdr);
 		bpdbBuf.clockCmd = sdr_string_create(bpSdr, "bpclock");
@@ -2588,6 +2606,11 @@ static int	destroyIncomplete(IncompleteBundle *incomplete, Object incElt)
 	}
 
 	sdr_list_destroy(bpSdr, incomplete->fragments, NULL, NULL);
+	if (incomplete->hashEntry)
+	{
+		sdr_hash_delete_entry(bpSdr, incomplete->hashEntry);
+	}
+
 	sdr_free(bpSdr, sdr_list_data(bpSdr, incElt));
 	sdr_list_delete(bpSdr, incElt, NULL, NULL);
 	return 0;
@@ -2908,6 +2931,11 @@ incomplete bundle.", NULL);
 		sdr_free(bpSdr, bundle.dictionary);
 	}
 
+	if (bundle.primaryBlock)
+	{
+		sdr_free(bpSdr, bundle.primaryBlock);
+	}
+
 	destroyExtensionBlocks(&bundle);
 	destroyCollaborationBlocks(&bundle);
 	purgeStationsStack(&bundle);
@@ -4360,28 +4388,99 @@ void	bpStopOutduct(char *protocolName, char *ductName)
 	sdr_exit_xn(bpSdr);	/*	Unlock memory.			*/
 }
 
-static int	findIncomplete(Bundle *bundle, VEndpoint *vpoint,
+/*	Incompletes are catalogued in a hash table keyed by endpoint,
+ *	source EID, and creation time, so that the Incomplete for a
+ *	newly arrived fragment is found without examining every other
+ *	bundle in reassembly at the same endpoint.  An Incomplete whose
+ *	key would exceed the maximum key length is not catalogued; it
+ *	can only be found by a search of the endpoint's incompletes
+ *	list.								*/
+
+static int	constructIncompleteHashKey(char *buffer, Object endpointObj,
+			char *sourceEid, BpTimestamp *creationTime)
+{
+	memset(buffer, 0, INCOMPLETES_HASH_KEY_BUFLEN);
+	isprintf(buffer, INCOMPLETES_HASH_KEY_BUFLEN, "%lu:%s:%u:%u",
+			(unsigned long) endpointObj, sourceEid,
+			creationTime->seconds, creationTime->count);
+	if (strlen(buffer) > INCOMPLETES_HASH_KEY_LEN)
+	{
+		*buffer = '\0';	/*	Can't be in hash table.	*/
+	}
+
+	return strlen(buffer);
+}
+
+static int	findIncomplete(Bundle *bundle, VEndpoint *vpoint, char *key,
 			Object *incompleteAddr, Object *incompleteElt)
 {
 	Sdr	bpSdr = getIonsdr();
+	Object	endpointObj;
 	char	*argDictionary;
+	char	*sourceEid;
 		OBJ_POINTER(Endpoint, endpoint);
 	Object	elt;
+	Address	value;
+	Object	hashEntry;
 		OBJ_POINTER(IncompleteBundle, incomplete);
 		OBJ_POINTER(Bundle, fragment);
 	char	*fragDictionary;
 	int	result;
 
 	CHKERR(ionLocked());
+	*incompleteElt = 0;
+	endpointObj = sdr_list_data(bpSdr, vpoint->endpointElt);
+	GET_OBJ_POINTER(bpSdr, Endpoint, endpoint, endpointObj);
+
+	/*	A bundle that isn't a fragment needs no key unless the
+	 *	endpoint has bundles in reassembly; a fragment needs
+	 *	one to start a new IncompleteBundle.			*/
+
+	if (sdr_list_first(bpSdr, endpoint->incompletes) == 0
+	&& !(bundle->bundleProcFlags & BDL_IS_FRAGMENT))
+	{
+		return 0;
+	}
+
 	if ((argDictionary = retrieveDictionary(bundle)) == (char *) bundle)
 	{
 		putErrmsg("Can't retrieve dictionary.", NULL);
 		return -1;
 	}
 	
-	*incompleteElt = 0;
-	GET_OBJ_POINTER(bpSdr, Endpoint, endpoint, 
-			sdr_list_data(bpSdr, vpoint->endpointElt));
+	if (printEid(&(bundle->id.source), argDictionary, &sourceEid) < 0)
+	{
+		releaseDictionary(argDictionary);
+		putErrmsg("Can't print source EID.", NULL);
+		return -1;
+	}
+
+	constructIncompleteHashKey(key, endpointObj, sourceEid,
+			&(bundle->id.creationTime));
+	MRELEASE(sourceEid);
+	if (*key)
+	{
+		releaseDictionary(argDictionary);
+		switch (sdr_hash_retrieve(bpSdr, (_bpConstants())->incompletes,
+				key, &value, &hashEntry))
+		{
+		case -1:
+			putErrmsg("Failed locating incomplete in hash table.",
+					NULL);
+			return -1;
+
+		case 0:
+			return 0;	/*	No such Incomplete.	*/
+
+		default:
+			*incompleteElt = (Object) value;
+			*incompleteAddr = sdr_list_data(bpSdr, *incompleteElt);
+			return 0;
+		}
+	}
+
+	/*	Key is too long for the hash table, so search the list.	*/
+
 	for (elt = sdr_list_first(bpSdr, endpoint->incompletes); elt;
 			elt = sdr_list_next(bpSdr, elt))
 	{
@@ -4742,6 +4841,13 @@ int	bpClone(Bundle *oldBundle, Bundle *newBundle, Object *newBundleObj,
 	}
 
 	memcpy((char *) newBundle, (char *) oldBundle, sizeof(Bundle));
+
+	/*	The old bundle's serialized primary block, if any,
+	 *	remains the old bundle's own.				*/
+
+	newBundle->dbOverhead -= oldBundle->primaryBlockLength;
+	newBundle->primaryBlock = 0;
+	newBundle->primaryBlockLength = 0;
 	if (oldBundle->dictionary)	/*	Must copy dictionary.	*/
 	{
 		dictionaryBuffer = retrieveDictionary(oldBundle);
@@ -6016,34 +6122,49 @@ static int	enqueueForDelivery(Object bundleObj, Bundle *bundle,
 static int	extendIncomplete(IncompleteBundle *incomplete, Object incElt,
 			Object bundleObj, Bundle *bundle)
 {
-	Sdr	bpSdr = getIonsdr();
-	Object	elt;
-		OBJ_POINTER(Bundle, fragment);
+	Sdr		bpSdr = getIonsdr();
+	Object		elt;
+			OBJ_POINTER(Bundle, fragment);
+	Object		incObj;
+	IncompleteBundle	incBuf;
 
 	bundle->incompleteElt = incElt;
 
 	/*	First look for fragment insertion point and insert
-	 *	the new bundle at this point.				*/
+	 *	the new bundle at this point.  Fragments normally
+	 *	arrive in order, so first see whether the new bundle
+	 *	simply follows the last fragment received so far.	*/
 
-	for (elt = sdr_list_first(bpSdr, incomplete->fragments); elt;
-			elt = sdr_list_next(bpSdr, elt))
+	elt = sdr_list_last(bpSdr, incomplete->fragments);
+	GET_OBJ_POINTER(bpSdr, Bundle, fragment, sdr_list_data(bpSdr, elt));
+	if (fragment->id.fragmentOffset < bundle->id.fragmentOffset)
 	{
-		GET_OBJ_POINTER(bpSdr, Bundle, fragment,
-				sdr_list_data(bpSdr, elt));
-		if (fragment->id.fragmentOffset < bundle->id.fragmentOffset)
+		elt = 0;	/*	Insert after last fragment.	*/
+	}
+	else
+	{
+		for (elt = sdr_list_first(bpSdr, incomplete->fragments); elt;
+				elt = sdr_list_next(bpSdr, elt))
 		{
-			continue;
-		}
+			GET_OBJ_POINTER(bpSdr, Bundle, fragment,
+					sdr_list_data(bpSdr, elt));
+			if (fragment->id.fragmentOffset
+					< bundle->id.fragmentOffset)
+			{
+				continue;
+			}
 
-		if (fragment->id.fragmentOffset == bundle->id.fragmentOffset)
-		{
-			bundle->delivered = 1;
-			sdr_write(bpSdr, bundleObj, (char *) bundle,
-					sizeof(Bundle));
-			return 0;	/*	Duplicate fragment.	*/
-		}
+			if (fragment->id.fragmentOffset
+					== bundle->id.fragmentOffset)
+			{
+				bundle->delivered = 1;
+				sdr_write(bpSdr, bundleObj, (char *) bundle,
+						sizeof(Bundle));
+				return 0;	/*	Duplicate.	*/
+			}
 
-		break;	/*	Insert before this fragment.		*/
+			break;	/*	Insert before this fragment.	*/
+		}
 	}
 
 	if (elt)
@@ -6063,13 +6184,17 @@ static int	extendIncomplete(IncompleteBundle *incomplete, Object incElt,
 		return -1;
 	}
 
+	incObj = sdr_list_data(bpSdr, incElt);
+	sdr_stage(bpSdr, (char *) &incBuf, incObj, sizeof(IncompleteBundle));
+	incBuf.fragmentBytes += bundle->payload.length;
+	sdr_write(bpSdr, incObj, (char *) &incBuf, sizeof(IncompleteBundle));
 	bundle->delivered = 1;
 	sdr_write(bpSdr, bundleObj, (char *) bundle, sizeof(Bundle));
 	return 0;
 }
 
 static int	createIncompleteBundle(Object bundleObj, Bundle *bundle,
-			VEndpoint *vpoint)
+			VEndpoint *vpoint, char *key)
 {
 	Sdr			bpSdr = getIonsdr();
 	IncompleteBundle	incomplete;
@@ -6084,6 +6209,8 @@ static int	createIncompleteBundle(Object bundleObj, Bundle *bundle,
 	}
 
 	incomplete.totalAduLength = bundle->totalAduLength;
+	incomplete.fragmentBytes = bundle->payload.length;
+	incomplete.hashEntry = 0;
 	incObj = sdr_malloc(bpSdr, sizeof(IncompleteBundle));
 	if (incObj == 0)
 	{
@@ -6103,6 +6230,20 @@ static int	createIncompleteBundle(Object bundleObj, Bundle *bundle,
 		return -1;
 	}
 
+	if (*key)
+	{
+		if (sdr_hash_insert(bpSdr, (_bpConstants())->incompletes, key,
+				bundle->incompleteElt, &incomplete.hashEntry) < 0)
+		{
+			putErrmsg("Can't insert Incomplete into hash table.",
+					key);
+			return -1;
+		}
+
+		sdr_write(bpSdr, incObj, (char *) &incomplete,
+				sizeof(IncompleteBundle));
+	}
+
 	/*	Enable navigation from fragment back to Incomplete.	*/
 
 	sdr_list_user_data_set(bpSdr, incomplete.fragments,
@@ -6128,6 +6269,7 @@ static int	deliverBundle(Object bundleObj, Bundle *bundle,
 {
 	char	*dictionary;
 	int	result;
+	char	incompleteKey[INCOMPLETES_HASH_KEY_BUFLEN];
 	Object	incompleteAddr = 0;
 		OBJ_POINTER(IncompleteBundle, incomplete);
 	Object	elt;
@@ -6162,7 +6304,8 @@ static int	deliverBundle(Object bundleObj, Bundle *bundle,
 	 *	(which may or may not result in delivery of a new
 	 *	reconstructed original bundle to the application).	*/
 
-	if (findIncomplete(bundle, vpoint, &incompleteAddr, &elt) < 0)
+	if (findIncomplete(bundle, vpoint, incompleteKey, &incompleteAddr,
+			&elt) < 0)
 	{
 		putErrmsg("Failed seeking incomplete bundle.", NULL);
 		return -1;
@@ -6181,7 +6324,8 @@ static int	deliverBundle(Object bundleObj, Bundle *bundle,
 
 	if (bundle->bundleProcFlags & BDL_IS_FRAGMENT)
 	{
-		return createIncompleteBundle(bundleObj, bundle, vpoint);
+		return createIncompleteBundle(bundleObj, bundle, vpoint,
+				incompleteKey);
 	}
 
 	/*	Bundle is not a fragment, so we can deliver it right
@@ -7819,6 +7963,16 @@ static int	checkIncompleteBundle(Bundle *newFragment, VEndpoint *vpoint)
 	incElt = sdr_list_user_data(bpSdr, fragmentsList);
 	incObj = sdr_list_data(bpSdr, incElt);
 	GET_OBJ_POINTER(bpSdr, IncompleteBundle, incomplete, incObj);
+
+	/*	The fragments can't cover the entire ADU until their
+	 *	payloads add up to at least the length of the ADU, so
+	 *	don't look for gaps before then.			*/
+
+	if (incomplete->fragmentBytes < incomplete->totalAduLength)
+	{
+		return 0;	/*	Nothing more to do for now.	*/
+	}
+
 	endOfFurthestFragment = 0;
 	for (elt = sdr_list_first(bpSdr, incomplete->fragments); elt;
 			elt = sdr_list_next(bpSdr, elt))
@@ -7859,6 +8013,7 @@ static int	checkIncompleteBundle(Bundle *newFragment, VEndpoint *vpoint)
 	aggregateBundle.incompleteElt = 0;
 	aggregateBundle.totalAduLength = 0;
 	aggregateBundle.bundleProcFlags &= ~BDL_IS_FRAGMENT;
+	invalidatePrimaryBlock(&aggregateBundle);
 
 	/*	Back out of database occupancy this bundle's
 	 *	original size, then change its size to reflect the
@@ -7885,13 +8040,20 @@ static int	checkIncompleteBundle(Bundle *newFragment, VEndpoint *vpoint)
 		bytesToSkip = aggregateAduLength - fragBuf.id.fragmentOffset;
 		if (bytesToSkip < fragBuf.payload.length)
 		{
+			/*	Splice the fragment's payload extents
+			 *	into the aggregate payload by reference;
+			 *	no payload text is copied, and file
+			 *	extents continue to refer to the same
+			 *	files.					*/
+
 			bytesToCopy = fragBuf.payload.length - bytesToSkip;
-			if (zco_append_extent(bpSdr,
+			if (zco_clone_source_data(bpSdr,
 					aggregateBundle.payload.content,
-					ZcoZcoSource, fragBuf.payload.content,
-					bytesToSkip, bytesToCopy) < 0)
+					fragBuf.payload.content, bytesToSkip,
+					bytesToCopy) < 0)
 			{
-				putErrmsg("Can't append extent.", NULL);
+				putErrmsg("Can't splice fragment payload.",
+						NULL);
 				return -1;
 			}
 
@@ -8585,7 +8747,24 @@ static int	parseAdminRecord(int *adminRecordType, BpStatusRpt *rpt,
 
 /*	*	*	Bundle catenation functions	*	*	*/
 
-static int	catenateBundle(Bundle *bundle)
+void	invalidatePrimaryBlock(Bundle *bundle)
+{
+	Sdr	bpSdr = getIonsdr();
+
+	CHKVOID(bundle);
+	if (bundle->primaryBlock == 0)
+	{
+		return;		/*	Nothing cached.			*/
+	}
+
+	sdr_free(bpSdr, bundle->primaryBlock);
+	zco_reduce_heap_occupancy(bpSdr, bundle->primaryBlockLength);
+	bundle->dbOverhead -= bundle->primaryBlockLength;
+	bundle->primaryBlock = 0;
+	bundle->primaryBlockLength = 0;
+}
+
+static int	serializePrimaryBlock(Bundle *bundle)
 {
 	Sdr		bpSdr = getIonsdr();
 	Sdnv		bundleProcFlagsSdnv;
@@ -8599,28 +8778,10 @@ static int	catenateBundle(Bundle *bundle)
 	Sdnv		dictionaryLengthSdnv;
 	Sdnv		fragmentOffsetSdnv;
 	Sdnv		totalAduLengthSdnv;
-	Sdnv		blkProcFlagsSdnv;
-	Sdnv		payloadLengthSdnv;
-	int		totalHeaderLength;
-	int		totalTrailerLength;
+	int		primaryBlockLength;
 	unsigned char	*buffer;
 	unsigned char	*cursor;
 	int		i;
-	Object		elt;
-	Object		nextElt;
-	Object		blkAddr;
-	ExtensionBlock	blk;
-	unsigned char	*flagbyte;
-
-	CHKZERO(ionLocked());
-
-	/*	We assume that the bundle to be issued is valid:
-	 *	either it was sourced locally (in which case we
-	 *	created it ourselves, so it should be valid) or
-	 *	else it was received from elsewhere (in which case
-	 *	it was created by the acquisition functions, which
-	 *	would have discarded the inbound bundle if it were
-	 *	not well-formed).					*/
 
 	encodeSdnv(&bundleProcFlagsSdnv, bundle->bundleProcFlags);
 	totalLengthOfEidSdnvs = 0;
@@ -8695,25 +8856,17 @@ static int	catenateBundle(Bundle *bundle)
 			fragmentOffsetSdnv.length +
 			totalAduLengthSdnv.length;
 	encodeSdnv(&residualBlkLengthSdnv, residualBlkLength);
-	encodeSdnv(&blkProcFlagsSdnv, bundle->payloadBlockProcFlags);
-	encodeSdnv(&payloadLengthSdnv, bundle->payload.length);
-	totalHeaderLength = 1 + bundleProcFlagsSdnv.length
+	primaryBlockLength = 1 + bundleProcFlagsSdnv.length
 			+ residualBlkLengthSdnv.length
-			+ residualBlkLength
-			+ bundle->extensionsLength[PRE_PAYLOAD]
-			+ 1 + blkProcFlagsSdnv.length
-			+ payloadLengthSdnv.length;
-	buffer = MTAKE(totalHeaderLength);
+			+ residualBlkLength;
+	buffer = MTAKE(primaryBlockLength);
 	if (buffer == NULL)
 	{
-		putErrmsg("Can't construct bundle header.", NULL);
+		putErrmsg("Can't construct primary block.", NULL);
 		return -1;
 	}
 
 	cursor = buffer;
-
-	/*	Construct primary block.				*/
-
 	*cursor = BP_VERSION;
 	cursor++;
 
@@ -8761,6 +8914,81 @@ static int	catenateBundle(Bundle *bundle)
 		cursor += totalAduLengthSdnv.length;
 	}
 
+	/*	Retain the serialized primary block in the bundle, so
+	 *	that it needn't be re-serialized on retransmission.	*/
+
+	bundle->primaryBlock = sdr_malloc(bpSdr, primaryBlockLength);
+	if (bundle->primaryBlock == 0)
+	{
+		MRELEASE(buffer);
+		putErrmsg("No space for primary block.", NULL);
+		return -1;
+	}
+
+	sdr_write(bpSdr, bundle->primaryBlock, (char *) buffer,
+			primaryBlockLength);
+	MRELEASE(buffer);
+	bundle->primaryBlockLength = primaryBlockLength;
+	bundle->dbOverhead += primaryBlockLength;
+	zco_increase_heap_occupancy(bpSdr, primaryBlockLength);
+	return 0;
+}
+
+static int	catenateBundle(Bundle *bundle)
+{
+	Sdr		bpSdr = getIonsdr();
+	Sdnv		blkProcFlagsSdnv;
+	Sdnv		payloadLengthSdnv;
+	int		totalHeaderLength;
+	int		totalTrailerLength;
+	unsigned char	*buffer;
+	unsigned char	*cursor;
+	int		i;
+	Object		elt;
+	Object		nextElt;
+	Object		blkAddr;
+	ExtensionBlock	blk;
+	unsigned char	*flagbyte;
+
+	CHKZERO(ionLocked());
+
+	/*	We assume that the bundle to be issued is valid:
+	 *	either it was sourced locally (in which case we
+	 *	created it ourselves, so it should be valid) or
+	 *	else it was received from elsewhere (in which case
+	 *	it was created by the acquisition functions, which
+	 *	would have discarded the inbound bundle if it were
+	 *	not well-formed).					*/
+
+	if (bundle->primaryBlock == 0)
+	{
+		if (serializePrimaryBlock(bundle) < 0)
+		{
+			putErrmsg("Can't serialize primary block.", NULL);
+			return -1;
+		}
+	}
+
+	encodeSdnv(&blkProcFlagsSdnv, bundle->payloadBlockProcFlags);
+	encodeSdnv(&payloadLengthSdnv, bundle->payload.length);
+	totalHeaderLength = bundle->primaryBlockLength
+			+ bundle->extensionsLength[PRE_PAYLOAD]
+			+ 1 + blkProcFlagsSdnv.length
+			+ payloadLengthSdnv.length;
+	buffer = MTAKE(totalHeaderLength);
+	if (buffer == NULL)
+	{
+		putErrmsg("Can't construct bundle header.", NULL);
+		return -1;
+	}
+
+	/*	Insert primary block.					*/
+
+	cursor = buffer;
+	sdr_read(bpSdr, (char *) cursor, bundle->primaryBlock,
+			bundle->primaryBlockLength);
+	cursor += bundle->primaryBlockLength;
+
 	/*	Insert pre-payload extension blocks.			*/
 
 	for (elt = sdr_list_first(bpSdr, bundle->extensions[PRE_PAYLOAD]);
@@ -9032,6 +9260,7 @@ static int	takeCustody(Bundle *bundle)
 
 	/*	Insert Endpoint ID of custodial endpoint.		*/
 
+	invalidatePrimaryBlock(bundle);
 	if (bundle->dictionaryLength > 0)
 	{
 		return insertNonCbheCustodian(bundle, vscheme);
@@ -10158,6 +10387,36 @@ static int 	getOutboundBundle(Outflow *flows, VOutduct *vduct,
 	}
 }
 
+typedef struct
+{
+	int		enabled;	/*	Boolean.		*/
+	Object		zco;		/*	Bundle being digested.	*/
+	ZcoDigest	digest;
+} XmitDigestState;
+
+static XmitDigestState	*_xmitDigestState()
+{
+	static XmitDigestState	state;
+
+	return &state;
+}
+
+void	bpStreamXmitDigests()
+{
+	_xmitDigestState()->enabled = 1;
+}
+
+void	bpStartTransmitting(Object bundleZco, ZcoReader *reader)
+{
+	XmitDigestState	*state = _xmitDigestState();
+
+	zco_start_transmitting(bundleZco, reader);
+	if (state->zco != 0 && state->zco == bundleZco)
+	{
+		zco_digest_transmission(reader, &(state->digest));
+	}
+}
+
 int	bpDequeue(VOutduct *vduct, Outflow *flows, Object *bundleZco,
 		BpExtendedCOS *extendedCOS, char *destDuctName,
 		unsigned int maxPayloadLength, int timeoutInterval)
@@ -10172,6 +10431,7 @@ int	bpDequeue(VOutduct *vduct, Outflow *flows, Object *bundleZco,
 	BundleSet	bset;
 	char		proxNodeEid[SDRSTRING_BUFSZ];
 	DequeueContext	context;
+	XmitDigestState	*xmitDigest = _xmitDigestState();
 	char		*dictionary;
 	int		xmitLength;
 
@@ -10252,6 +10512,7 @@ int	bpDequeue(VOutduct *vduct, Outflow *flows, Object *bundleZco,
 
 	context.protocolName = protocol->name;
 	context.proxNodeEid = proxNodeEid;
+	context.digest = NULL;
 	if (processExtensionBlocks(&bundle, PROCESS_ON_DEQUEUE, &context) < 0)
 	{
 		putErrmsg("Can't process extensions.", "dequeue");
@@ -10284,15 +10545,31 @@ int	bpDequeue(VOutduct *vduct, Outflow *flows, Object *bundleZco,
 
 	/*	Some final extension-block processing may be necessary
 	 *	after catenation of the bundle, notably BAB hash
-	 *	calculation.						*/
+	 *	calculation.  If the CLO streams digests, that
+	 *	calculation may instead be deferred to the CLO's
+	 *	own pass over the bundle: the extension populates
+	 *	context.digest, which bpStartTransmitting attaches
+	 *	to the CLO's ZCO reader.				*/
 
-	if (processExtensionBlocks(&bundle, PROCESS_ON_TRANSMIT, NULL) < 0)
+	if (xmitDigest->enabled)
+	{
+		xmitDigest->zco = 0;
+		memset((char *) &(xmitDigest->digest), 0, sizeof(ZcoDigest));
+		context.digest = &(xmitDigest->digest);
+	}
+
+	if (processExtensionBlocks(&bundle, PROCESS_ON_TRANSMIT, &context) < 0)
 	{
 		putErrmsg("Can't process extensions.", "dequeue");
 		sdr_cancel_xn(bpSdr);
 		return -1;
 	}
 
+	if (xmitDigest->enabled && xmitDigest->digest.update)
+	{
+		xmitDigest->zco = bundle.payload.content;
+	}
+
 	/*	That's the end of the changes to the bundle.  Pass
 	 *	the catenated bundle (the payload ZCO) to the calling
 	 *	function, then replace it in the bundle structure with
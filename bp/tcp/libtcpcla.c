@@ -209,7 +209,7 @@ static int	sendZcoByTCP(int *bundleSocket, unsigned int bundleLength,
 	char		*from;
 	int		bytesSent;
 
-	zco_start_transmitting(bundleZco, &reader);
+	bpStartTransmitting(bundleZco, &reader);
 	zco_track_file_offset(&reader);
 	while (bytesRemaining > 0)
 	{
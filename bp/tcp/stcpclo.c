@@ -142,6 +142,8 @@ int	main(int argc, char *argv[])
 		return -1;
 	}
 
+	bpStreamXmitDigests();
+
 	buffer = MTAKE(TCPCLA_BUFSZ);
 	if (buffer == NULL)
 	{
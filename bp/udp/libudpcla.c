@@ -92,7 +92,7 @@ int	sendBundleByUDP(struct sockaddr *socketName, int *bundleSocket,
 	/*	Send the bundle in a single UDP datagram.		*/
 
 	sdr = getIonsdr();
-	zco_start_transmitting(bundleZco, &reader);
+	bpStartTransmitting(bundleZco, &reader);
 	zco_track_file_offset(&reader);
 	CHKERR(sdr_begin_xn(sdr));
 	bytesToSend = zco_transmit(sdr, &reader, UDPCLA_BUFSZ, (char *) buffer);
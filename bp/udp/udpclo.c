@@ -67,6 +67,8 @@ int	main(int argc, char *argv[])
 		return -1;
 	}
 
+	bpStreamXmitDigests();
+
 	buffer = MTAKE(UDPCLA_BUFSZ);
 	if (buffer == NULL)
 	{
@@ -42,13 +42,13 @@ extern "C" {
  *  bssNav is a structure that provides navigation assistance to BSS        
  *  applications. It consists of four variables that provide several        
  *  stream parsing information. The curPosition variable holds the          
- *  current position of the parser. That position refers to the row of      
- *  the firstEntryOffset, lastEntryOffset, hgstCountVal and lwstCountVal,   
- *  tables stored in *.tbl file. The prevOffset and nextOffset variables    
- *  hold the offset of previous and next element of the current doubly-     
- *  linked list element that is stored in the *.lst file. Finally, the      
- *  datOffset variable holds the offset of the actual data, stored in
- *  the *.dat file   						       
+ *  current position of the parser, i.e., the position of the current
+ *  entry in the database's in-memory index.  The prevOffset and
+ *  nextOffset variables hold the offsets within the *.dat file of the
+ *  data of the previous and next entries in the index, or -1 if there
+ *  are no such entries.  Finally, the datOffset variable holds the
+ *  offset of the actual data of the current entry, stored in the
+ *  *.dat file.
  */
 
 typedef struct 
@@ -69,6 +69,8 @@ extern int		bssStart(char* bssName, char* path, char* eid,
 extern int		bssRun(char* bssName, char* path, char* eid,
 				char* buffer, long bufLen, RTBHandler handler);
 
+extern int		bssSetDurability(int syncFrames, int syncInterval);
+
 extern void		bssClose();
 extern void		bssStop();
 extern void		bssExit();
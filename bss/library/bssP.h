@@ -26,15 +26,120 @@
 extern "C" {
 #endif
 
+#if defined (mingw) || defined (VXWORKS) || defined (RTEMS)
+#define	BSS_NO_MMAP
+#endif
+
+#ifndef BSS_NO_MMAP
+#include <sys/mman.h>
+#endif
+
+#ifdef mingw
+#define	BSS_SYNC(fd)	_commit(fd)
+#else
+#include <sys/uio.h>
+#if defined (linux)
+#define	BSS_SYNC(fd)	fdatasync(fd)
+#else
+#define	BSS_SYNC(fd)	fsync(fd)
+#endif
+#endif
+
+/*	Minimum number of obsolete entries in the *.idx file before
+ *	the file is compacted.						*/
+
+#ifndef BSS_COMPACTION_MIN
+#define	BSS_COMPACTION_MIN	4096
+#endif
+
+/*  
+ *  A structure that describes the format in which raw data are written to  
+ *  *.dat file. Each record in *.dat file has the following format:	    
+ * 		+---------------+----------------+----------+ 		    
+ * 		| creation time | payload length | raw data | 		    
+ * 		+---------------+----------------+----------+ 		    
+ */
+
+typedef struct
+{
+	BpTimestamp 	crtnTime;
+	long		pLen;
+} dataRecord;
+
+/*	Limits on the frames queued for the writer thread.  When
+ *	either limit is reached the receiving thread waits for the
+ *	writer thread to catch up.					*/
+
+#ifndef BSS_QUEUE_FRAMES
+#define	BSS_QUEUE_FRAMES	256
+#endif
+
+#ifndef BSS_QUEUE_BYTES
+#define	BSS_QUEUE_BYTES		(16 * 1024 * 1024)
+#endif
+
+/*	Maximum number of frames written to the database files by
+ *	a single write operation.					*/
+
+#ifndef BSS_WRITE_BATCH
+#define	BSS_WRITE_BATCH		64
+#endif
+
+/*
+ *  A frame awaiting storage: the header of its *.dat file record,
+ *  immediately followed by the payload.
+ */
+
+typedef struct bssframe
+{
+	struct bssframe	*next;
+	dataRecord	record;
+} BssFrame;
+
+/*
+ *  The queue of frames received by the receiving thread and not yet
+ *  stored by the writer thread.  "stopping" tells the writer thread
+ *  to exit once the queue is empty; "failed" tells the receiving
+ *  thread that the writer thread has exited on an error.
+ */
+
+typedef struct
+{
+	pthread_mutex_t	mutex;
+	pthread_cond_t	frameQueued;
+	pthread_cond_t	spaceFreed;
+	BssFrame	*first;
+	BssFrame	*last;
+	int		frames;
+	long		bytes;
+	int		stopping;
+	int		failed;
+} BssQueue;
+
+/*
+ *  The durability policy of the writer thread: the database files
+ *  are flushed to stable storage after every syncFrames frames
+ *  and/or whenever syncInterval seconds have elapsed since the last
+ *  flush.  Zero disables the corresponding trigger.
+ */
+
+typedef struct
+{
+	int		syncFrames;
+	int		syncInterval;
+} BssDurability;
+
 typedef struct 
 {
 	char		eid[32];
 	int		dat;
-	int		tbl;
-	int		lst;
+	int		idx;
+	off_t		datLength;
 	RTBHandler 	function;
 	char*		buffer;
 	long		bufLength;
+	BssDurability	durability;
+	BssQueue	queue;
 } bss_thread_data;
 
 /* 
@@ -45,100 +150,44 @@ typedef struct
  * capability of BSS for playback control over the last WINDOW seconds of the
  * stream.
  *
- * The BSS database consists of three different files: *.tbl, *.lst and *.dat.
+ * The BSS database consists of two append-only files: *.dat and *.idx.
  *
- * Table file (*.tbl) holds information about the last WINDOW seconds of the
- * stream. Each of these seconds is associated with four variables; the  
- * firstEntryOffset, lastEntryOffset, hgstCountVal and lwstCountVal variable. 
- * These variables are stored in four tables, each one of size WINDOW, where
- * each row of the table contains the relevant valuse for the corresponding
- * second.
- *
- * The firstEntryOffset and lastEntryOffset variables contain the offset of
- * the first and last element respectively of a doubly-linked list which
- * contains information on the ADUs of a single second. The hgstCountVal and
- * lwstCountVal values hold the highest and lowest count value respectively,
- * encountered through the reception of the stream for a particular second.
+ * The data file (*.dat) stores the actual data of the stream. Every new
+ * ADU received by the BSS receiver application is stored in a new record
+ * that is appended at the end of the file. It should be clearly stated that
+ * the stream in its entirety is stored in the *.dat file, NOT only the last
+ * WINDOW seconds.  Each record begins with the creation time and length
+ * of the ADU, so the index can always be rebuilt from the *.dat file.
  *
- * The table file also holds four additional variables; the oldestTime,
- * oldestRowIndex, newestTime and newestRowIndex. The oldestTime and newestTime
- * hold the second with the lowest and highest value respectively among the
- * last WINDOW received seconds, while the oldestRowIndex and newestRowIndex
- * variables hold the rows in which the information for those two seconds are
- * stored.
+ * The index file (*.idx) is a log of index entries, one per ADU that
+ * was received within the last WINDOW seconds of the stream, in order
+ * of reception.  Each entry contains the creation time of the ADU and
+ * the offset and length of its record in the *.dat file.
  *
- * List entries file (*.lst) stores an array of doubly-linked lists;
- * each list corresponds to a single second of the received stream.  Each
- * element of each doubly-linked list contains information on the offset
- * within the *.dat file at which the actual data of some ADU are stored,
- * as well as information on the offset of the previous and the next element
- * of the doubly-linked list.
+ * While the database is open, the entries for the last WINDOW seconds
+ * of the stream are held in memory in an array sorted by creation
+ * time (seconds and count), so that seeking is a binary search and
+ * stepping forward or backward is an array index increment.  Entries
+ * for seconds that drop out of the window are discarded from memory,
+ * and the *.idx file is periodically compacted by rewriting it with
+ * only the entries that are still in the window.  Playback reads the
+ * records of the *.dat file through a memory mapping of the file,
+ * where the platform supports it.
  *
- * Finally, the data file (*.dat) stores the actual data of the stream. Every
- * new ADU received by the BSS receiver application is stored in a new record
- * that is appended at the end of the file. It should be clearly stated that
- * the stream in its entirety is stored in the *.dat file, NOT only the last
- * WINDOW seconds.      
+ * Received frames are written to the database by a dedicated writer
+ * thread, in batches, so that the thread that receives bundles and
+ * displays frames in real time is never delayed by the disk unless
+ * the writer thread's bounded queue fills up.  A frame becomes
+ * visible to playback once its batch has been written.
  *******************************************************************************
  */
 
 /*  
- *  A structure that describes the format of the header of the *.tbl file:
- *    +-------------+-------------------+-------------+------------------+    
- *    | oldest time | oldest row index  | newest time | newest row index |    
- *    +-------------+-------------------+-------------+------------------+    
- */
-
-typedef struct 
-{
-	time_t		oldestTime;
-	long		oldestRowIndex;
-	time_t		newestTime;
-	long		newestRowIndex;
-} tblHeader;
-
-/*  
- *  A structure that describes the format of a single row (corresponding
- *  to a single second of streaming activity) in the *.tbl file:
- *    +-------------+-------------------+-------------+------------------+    
- *    |     first entry offset          |    last entry offset           |    
- *    +---------------------------------+--------------------------------+    
- *    |     highest count value         |    lowest count value          |    
- *    +---------------------------------+--------------------------------+    
- */
-
-typedef struct 
-{
-	long		firstEntryOffset;
-	long		lastEntryOffset;
-	unsigned long	hgstCountVal;
-	unsigned long	lwstCountVal;
-} tblRow;
-
-/*  
- *  A structure that describes the format of *.tbl file. A single instance of 
- *  tblIndex structure is stored in *.tbl file and has the following format:  
- *    +-------------+-------------------+-------------+------------------+    
- *    |                            table header                          |    
- *    +-------------+-------------------+-------------+------------------+    
- *    |                          table row[WINDOW]                       |    
- *    +---------------------------------+--------------------------------+    
- */
-
-typedef struct 
-{
-	tblHeader	header;
-	tblRow		rows[WINDOW];
-} tblIndex;
-
-/*   
- *  A structure that describes the format in which entries are written to   
- *  *.lst file. Each entry in *.lst file has the following format:    	    
+ *  A structure that describes the format of the entries written to the
+ *  *.idx file and held in the in-memory index:
  * 	+---------------+-------------+----------------+	     
  * 	| creation time | data offset | payload length | 	     
  * 	+---------------+-------------+----------------+ 	     
- * 	|     previous entry    |      next entry      | 	     
- * 	+-----------------------+----------------------+  	     
  */
 
 typedef struct 
@@ -146,46 +195,50 @@ typedef struct
 	BpTimestamp 	crtnTime;
 	off_t		datOffset;
 	long		pLen;
-	long		prev;
-	long		next;
-	
-} lstEntry;
+} bssEntry;
 
-/*  
- *  A structure that describes the format in which raw data are written to  
- *  *.dat file. Each record in *.dat file has the following format:	    
- * 		+---------------+----------------+----------+ 		    
- * 		| creation time | payload length | raw data | 		    
- * 		+---------------+----------------+----------+ 		    
+/*
+ *  The in-memory index.  The entries for the last WINDOW seconds of
+ *  the stream are entries[first] through entries[first + count - 1],
+ *  in ascending creation time order.  oldestTime and newestTime are
+ *  the earliest and latest seconds covered by the index; ADUs created
+ *  before oldestTime are stored in the *.dat file but not indexed.
+ *  loggedEntries is the number of entries in the *.idx file, and
+ *  idxLength is the number of bytes of that file that have been loaded.
  */
 
 typedef struct
 {
-	BpTimestamp 	crtnTime;
-	long		pLen;
-} dataRecord;
+	time_t		oldestTime;
+	time_t		newestTime;
+	bssEntry	*entries;
+	long		first;
+	long		count;
+	long		capacity;
+	long		loggedEntries;
+	off_t		idxLength;
+	char		idxName[256];
+} bssIndex;
 
 extern int		_running(int *newValue);
 extern int		_recvThreadId(pthread_t *id, int control);
 extern int		_datFile(int control, int fileDescriptor);
-extern int		_lstFile(int control, int fileDescriptor);
-extern int		_tblFile(int control, int fileDescriptor);
-extern tblIndex		*_tblIndex(int *control);
+extern int		_idxFile(int control, int fileDescriptor);
+extern bssIndex		*_bssIndex(int *control);
 extern int		_lockMutex(int value);
+extern BssDurability	*_durability();
 extern BpSAP		_bpsap(BpSAP *newSAP);
 
-extern int 		getLstEntry(int fileD, lstEntry *entry,
-				long lstEntryOffset);
-
-extern int 		readRecord(int fileD, dataRecord *rec, off_t datOffset);
-extern int 		readPayload(int fileD, char* buffer, long length);
+extern int 		readRecord(int fileD, dataRecord *rec, off_t datOffset,
+				char *buffer, long bufLength);
 
 extern int 		loadRDWRDB(char* bssName, char* path, int* dat, 
-				int* lst, int* tbl);
+				int* idx, off_t *datLength);
 extern int 		loadRDonlyDB(char* bssName, char* path);
+extern int		refreshIndex();
 extern void		*recvBundles(void *args);
 
-extern void		findIndexRow(time_t time, long *position);
+extern long		findEntry(bssIndex *index, BpTimestamp *time);
 #ifdef __cplusplus
 }
 #endif
@@ -23,9 +23,9 @@ void	bssStop()
 	int		recvThreadValid;
 	pthread_t	recvThread;
 
-	if (_datFile(0, 0) == -1)	/*	Must destroy tblIndex.	*/
+	if (_datFile(0, 0) == -1)	/*	Must destroy index.	*/
 	{
-		oK(_tblIndex(&destroy));
+		oK(_bssIndex(&destroy));
 		ionDetach();
 	}
 
@@ -52,15 +52,14 @@ void	bssClose()
 
 	if (_recvThreadId(NULL, 0) == 0)/*	No active receiver.	*/
 	{
-		oK(_tblIndex(&destroy));/*	Must destroy tblIndex.	*/
+		oK(_bssIndex(&destroy));/*	Must destroy index.	*/
 		ionDetach();
 	}
 
 	if (_datFile(0,0) != -1)
 	{
 		oK(_datFile(-1,0));
-		oK(_lstFile(-1,0));
-		oK(_tblFile(-1,0));
+		oK(_idxFile(-1,0));
 	}
 	else
 	{
@@ -78,6 +77,27 @@ void	bssExit()
 	bssClose();
 }
 
+int	bssSetDurability(int syncFrames, int syncInterval)
+{
+	BssDurability	*durability = _durability();
+
+	CHKERR(syncFrames >= 0);
+	CHKERR(syncInterval >= 0);
+
+	/*
+	 *  This function sets the durability policy applied by the
+	 *  receiver threads started after it is called.  The database
+	 *  files are flushed to stable storage after every syncFrames
+	 *  stored frames and whenever syncInterval seconds have passed
+	 *  since the last flush; zero disables either trigger, and by
+	 *  default both are disabled.
+	 */
+
+	durability->syncFrames = syncFrames;
+	durability->syncInterval = syncInterval;
+	return 0;
+}
+
 /* Start and terminate BSS receiver operations */
 int	bssOpen(char* bssName, char* path)
 {
@@ -90,7 +110,7 @@ int	bssOpen(char* bssName, char* path)
 	 */
 
 	ionAttach();
-	if (_datFile(0,0) == -1 && _lstFile(0,0) == -1 && _tblFile(0,0) == -1)
+	if (_datFile(0,0) == -1 && _idxFile(0,0) == -1)
 	{
 		if (loadRDonlyDB(bssName, path)!=0)
 		{	
@@ -116,8 +136,8 @@ int	bssStart(char* bssName, char* path, char* eid, char* buffer,
 		long bufLength, RTBHandler display)
 {	
 	int 			dat;
-	int			lst;
-	int 			tbl;
+	int			idx;
+	off_t			datLength;
 	static bss_thread_data	DB;
  	pthread_t    		bssRecvThread;
 	int			enableLoop = 1;
@@ -138,7 +158,7 @@ int	bssStart(char* bssName, char* path, char* eid, char* buffer,
 	ionAttach();
 	if (_recvThreadId(NULL, 0) == 0)/*	No receiver thread.	*/
 	{
-		if (loadRDWRDB(bssName, path, &dat, &lst, &tbl) != 0)
+		if (loadRDWRDB(bssName, path, &dat, &idx, &datLength) != 0)
 		{	
 			putErrmsg("BSS library: Database creation failed.", 
 				   path);
@@ -157,8 +177,8 @@ session in order to initiate a new one.");
 
 	istrcpy(DB.eid, eid, sizeof(DB.eid));
 	DB.dat = dat;
-	DB.lst = lst;
-	DB.tbl = tbl;
+	DB.idx = idx;
+	DB.datLength = datLength;
 	DB.buffer = buffer;
 	DB.bufLength = bufLength; 
 	DB.function = display;
@@ -180,7 +200,7 @@ session in order to initiate a new one.");
 int	bssRun(char* bssName, char* path, char* eid, char* buffer,
 		long bufLength, RTBHandler display)
 {
-	if (_datFile(0,0) == -1 && _lstFile(0,0) == -1 && _tblFile(0,0) == -1 
+	if (_datFile(0,0) == -1 && _idxFile(0,0) == -1
 		&& _recvThreadId(NULL, 0) == 0)
 	{
 		if (bssStart(bssName, path, eid, buffer, bufLength, display)
@@ -221,45 +241,78 @@ long	bssRead(bssNav nav, char* data, long dataLen)
 		return -1;
 	}
 
-	if (readRecord(_datFile(0,0), &rec, nav.datOffset) < 0)
+	if (readRecord(_datFile(0,0), &rec, nav.datOffset, data, dataLen) < 0)
 	{
 		oK(_lockMutex(0));	/*	unlock mutex	*/
 		return -1;
 	}
 
-	if (dataLen < rec.pLen)	/*	prevent buffer overflow		*/
+	oK(_lockMutex(0));
+
+	return rec.pLen;
+}
+
+static void	updateNavInfo(bssNav *nav, bssIndex *index, long position)
+{
+	bssEntry	*entries = index->entries + index->first;
+
+	nav->curPosition = index->first + position;
+	nav->datOffset = entries[position].datOffset;
+	nav->prevOffset = position > 0 ? entries[position - 1].datOffset : -1;
+	nav->nextOffset = position < index->count - 1 ?
+			entries[position + 1].datOffset : -1;
+}
+
+static long	locateEntry(bssNav *nav, bssIndex *index, int *found)
+{
+	long		position = nav->curPosition - index->first;
+	dataRecord	rec;
+	bssEntry	*entry;
+
+	/*
+	 *  Returns the position in the index of the entry for the
+	 *  current playback position, setting *found to 1.  If that
+	 *  entry is no longer in the index, returns the position of
+	 *  the first entry after it and sets *found to 0.  The
+	 *  entry is normally where nav says it was; if entries have
+	 *  since been inserted before it or discarded, it is found
+	 *  again by its creation time.
+	 */
+
+	*found = 0;
+	if (position >= 0 && position < index->count
+	&& index->entries[nav->curPosition].datOffset == nav->datOffset)
 	{
-		oK(_lockMutex(0));
-		return -1;	
-	}	
+		*found = 1;
+		return position;
+	}
 
-	if (readPayload(_datFile(0,0), data, rec.pLen) < 0)
+	if (readRecord(_datFile(0,0), &rec, nav->datOffset, NULL, 0) < 0)
 	{
-		oK(_lockMutex(0));
 		return -1;
 	}
-	
-	oK(_lockMutex(0));
 
-	return rec.pLen;
-}
+	position = findEntry(index, &rec.crtnTime);
+	if (position < index->count)
+	{
+		entry = index->entries + index->first + position;
+		if (entry->crtnTime.seconds == rec.crtnTime.seconds
+		&& entry->crtnTime.count == rec.crtnTime.count)
+		{
+			*found = 1;
+		}
+	}
 
-static void	updateNavInfo(bssNav *nav, long position, off_t datOffset,
-			long prev, long next)
-{
-	nav->curPosition = position;
-	nav->datOffset = datOffset;
-	nav->prevOffset = prev;
-	nav->nextOffset = next;
+	return position;
 }
 
 long	 bssSeek(bssNav *nav, time_t time, time_t *curTime,
 		unsigned long *count)
 {
-	tblIndex 	*index = _tblIndex(NULL);
+	bssIndex 	*index = _bssIndex(NULL);
+	BpTimestamp	seekTime;
 	long 		position;
-	long 		lstEntryOffset;
-	lstEntry 	entry;
+	bssEntry 	*entry;
 
 	CHKERR(nav);
 	CHKERR(time >= 0);
@@ -272,26 +325,28 @@ long	 bssSeek(bssNav *nav, time_t time, time_t *curTime,
 		return -1;
 	}
 
-	findIndexRow(time, &position);
-	if (position == -1)
+	if (refreshIndex() < 0)
 	{
-		PUTS("Cannot seek to the specified time. No match was found");
 		oK(_lockMutex(0));
 		return -1;
 	}
 
-	lstEntryOffset = index->rows[position].firstEntryOffset;
-	if (getLstEntry(_lstFile(0,0), &entry, lstEntryOffset) == -1)
+	seekTime.seconds = time;
+	seekTime.count = 0;
+	position = findEntry(index, &seekTime);
+	if (position == index->count)
 	{
+		PUTS("Cannot seek to the specified time. No match was found");
 		oK(_lockMutex(0));
 		return -1;
 	}
-	
-	updateNavInfo(nav, position, entry.datOffset, entry.prev, entry.next);
-	*curTime = (time_t) entry.crtnTime.seconds;
-	*count = entry.crtnTime.count;
+
+	updateNavInfo(nav, index, position);
+	entry = index->entries + nav->curPosition;
+	*curTime = (time_t) entry->crtnTime.seconds;
+	*count = entry->crtnTime.count;
 	oK(_lockMutex(0));
-	return entry.pLen;
+	return entry->pLen;
 }
 
 long	 bssSeek_read(bssNav *nav, time_t time, time_t *curTime,
@@ -314,119 +369,65 @@ long	 bssSeek_read(bssNav *nav, time_t time, time_t *curTime,
 	return pLen;
 }
 
-long	bssNext(bssNav *nav, time_t *curTime, unsigned long *count)
+static long	step(bssNav *nav, time_t *curTime, unsigned long *count,
+			int direction)
 {
-	tblIndex 	*index = _tblIndex(NULL);
-	tblHeader	*hdr;
-	tblRow		*row;
-	lstEntry 	entry;
-	long		curPosition = nav->curPosition;
-	int 		i = 0;
-	unsigned long	nextTime;
+	bssIndex 	*index = _bssIndex(NULL);
+	bssEntry 	*entry;
+	long		position;
+	int		found;
 
 	CHKERR(nav);
 	CHKERR(curTime); 
 	CHKERR(count);
 	CHKERR(index);
-	hdr = &(index->header);
-
 	if (_lockMutex(1) == -1)	/*	Protecting transaction.	*/
 	{
 		return -1;
 	}
 
-	if (nav->nextOffset == -1) 
+	if (refreshIndex() < 0 || index->count == 0)
 	{
-		/*	The end of the current doubly-linked list was
-		 *	reached.
-		 *
-		 *	The following check ensures that bssNext 
-		 *	 function will either break or return.		*/
-
-		if (hdr->oldestTime == 0)
-		{
-			oK(_lockMutex(0));
-			return -1;
-		}
-
-		/* 	Move to the next position 			*/
+		oK(_lockMutex(0));
+		return -1;
+	}
 
-		curPosition = (curPosition + 1) % WINDOW;
-		while (i < WINDOW)
-		{
-			/*	 
-			 *  Each row of the tables stored in .tbl file
-			 *  represents a specific second (from the last
-			 *  WINDOW seconds stored).  The curPosition value
-			 *  refers to these rows.  The position in
-			 *  which the information for each second is
-			 *  stored is relative to the value of the
-			 *  second stored in the hdr->oldestRowIndex
-			 *  position. The time (in seconds) represented
-			 *  by the curPosition is calculated by
-			 *  comparing the curPosition with the 
-			 *  hdr->oldestRowIndex value.
-			 */
-
-			if (curPosition >= hdr->oldestRowIndex)
-			{
-				nextTime = hdr->oldestTime
-					+ curPosition - hdr->oldestRowIndex;
-			}
-			else
-			{
-				nextTime = hdr->oldestTime + WINDOW
-					- hdr->oldestRowIndex + curPosition;
-			}
-			
-			if (nextTime <= *curTime)
-			{
-				oK(_lockMutex(0));
-				return -2;	/* 	end of list	*/
-			}
-
-			row = index->rows + curPosition;
-			if (row->firstEntryOffset == -1)
-			{
-				/*  
-				 *  If there is no doubly-linked list
-				 *  created for that particular second,
-				 *  move to the next position. 
-				 */
-				curPosition = (curPosition + 1) % WINDOW;
-			}
-			else
-			{
-				break;
-			}
-			
-			i++;
-		}
+	position = locateEntry(nav, index, &found);
+	if (position < 0)
+	{
+		oK(_lockMutex(0));
+		return -1;
+	}
 
-		if (getLstEntry(_lstFile(0,0), &entry, row->firstEntryOffset)
-				== -1)
+	if (direction > 0)
+	{
+		if (found)
 		{
-			oK(_lockMutex(0));
-			return -1;
+			position++;
 		}
 	}
 	else
 	{
-		if (getLstEntry(_lstFile(0,0), &entry, nav->nextOffset) == -1)
-		{
-			oK(_lockMutex(0));
-			return -1;
-		}
+		position--;
 	}
 
-	updateNavInfo(nav, curPosition, entry.datOffset, entry.prev,
-			entry.next);
-	*curTime = (time_t) entry.crtnTime.seconds;
-	*count = entry.crtnTime.count;
+	if (position < 0 || position >= index->count)
+	{
+		oK(_lockMutex(0));
+		return -2;		/*	End of list.		*/
+	}
 
+	updateNavInfo(nav, index, position);
+	entry = index->entries + nav->curPosition;
+	*curTime = (time_t) entry->crtnTime.seconds;
+	*count = entry->crtnTime.count;
 	oK(_lockMutex(0));
+	return entry->pLen;
+}
 
-	return entry.pLen;
+long	bssNext(bssNav *nav, time_t *curTime, unsigned long *count)
+{
+	return step(nav, curTime, count, 1);
 }
 
 long	bssNext_read(bssNav *nav, time_t *curTime, unsigned long *count,
@@ -455,106 +456,7 @@ long	bssNext_read(bssNav *nav, time_t *curTime, unsigned long *count,
 
 long	bssPrev(bssNav *nav, time_t *curTime, unsigned long *count)
 {
-	tblIndex 	*index = _tblIndex(NULL);
-	tblHeader	*hdr;
-	tblRow		*row;
-	lstEntry 	entry;
-	long		curPosition = nav->curPosition;
-	int 		i=0;
-	unsigned long	prevTime;
-	
-	CHKERR(nav);
-	CHKERR(curTime); 
-	CHKERR(count);
-	CHKERR(index);
-	hdr = &(index->header);
-
-	if (_lockMutex(1) == -1)	/*	Protecting transaction.	*/
-	{
-		return -1;
-	}
-
-	if (nav->prevOffset == -1) 
-	{
-		/*	The following check ensures that bssPrev  	*
-		 *	 function will either break or return.		*/
-
-		if (hdr->oldestTime == 0)
-		{
-			oK(_lockMutex(0));
-			return -1;
-		}
-
-		curPosition--;
-		if (curPosition < 0) curPosition = WINDOW - 1;
-
-		while (i < WINDOW)
-		{
-			/*
-		 	 *  The time (in seconds) represented by the
-			 *  curPosition is calculated by comparing
-			 *  the curPosition with the 
-			 *  hdr->oldestRowIndex value.
-			 */
-
-			if (curPosition >= hdr->oldestRowIndex)
-			{
-				prevTime = hdr->oldestTime
-					+ curPosition - hdr->oldestRowIndex;
-			}
-			else
-			{
-				prevTime = hdr->oldestTime + WINDOW 
-					- hdr->oldestRowIndex + curPosition;	
-			}
-
-			if (prevTime >= (unsigned long) *curTime)
-			{
-				oK(_lockMutex(0));
-				return -2;	/* 	end of list	*/
-			}
-
-			row = index->rows + curPosition;
-			if (row->firstEntryOffset == -1)
-			{
-				/*  
-				 *  If there is no doubly-linked list
-				 *  created for that particular second,
-				 *  move to the next position. 
-				 */
-				curPosition--;
-				if (curPosition < 0) curPosition = WINDOW - 1;
-			}
-			else
-			{
-				break;
-			}
-
-			i++;
-		}
-
-		if (getLstEntry(_lstFile(0,0), &entry, row->lastEntryOffset)
-				== -1)
-		{
-			oK(_lockMutex(0));
-			return -1;
-		}
-	}
-	else
-	{
-		if (getLstEntry(_lstFile(0,0), &entry, nav->prevOffset) == -1)
-		{
-			oK(_lockMutex(0));
-			return -1;
-		}
-	}
-
-	updateNavInfo(nav, curPosition, entry.datOffset, entry.prev, 
-			entry.next);
-	*curTime = (time_t) entry.crtnTime.seconds;
-	*count = entry.crtnTime.count;
-	oK(_lockMutex(0));
-	return entry.pLen;
+	return step(nav, curTime, count, -1);
 }
 
 long	bssPrev_read(bssNav *nav, time_t *curTime, unsigned long *count,
@@ -18,6 +18,10 @@
 #define BSSLIBDEBUG	0
 #endif
 
+#ifndef BSS_NO_MMAP
+static char	*_datMap(int fd, off_t end);
+#endif
+
 int	_running(int *newValue)
 {
 	static int    running = -1;
@@ -84,6 +88,13 @@ int	_lockMutex(int value)
 	return 0;		
 }
 
+BssDurability	*_durability()
+{
+	static BssDurability	durability = { 0, 0 };
+
+	return &durability;
+}
+
 int	_datFile(int control, int fileDescriptor)
 {
 	static int	dat = -1;
@@ -95,6 +106,9 @@ int	_datFile(int control, int fileDescriptor)
 			break;
 
 		case -1:
+#ifndef BSS_NO_MMAP
+			oK(_datMap(-1, 0));
+#endif
 			close(dat);
 			dat = -1;
 			break;
@@ -106,48 +120,30 @@ int	_datFile(int control, int fileDescriptor)
 	return  dat;		
 }
 
-int	_lstFile(int control, int fileDescriptor)
+int	_idxFile(int control, int fileDescriptor)
 {
-	static int	lst=-1;
+	static int	idx = -1;
 
 	switch (control)
 	{
 	case 1: 
-		lst = fileDescriptor;
+		idx = fileDescriptor;
 		break;
 
 	case -1:
-		close(lst);
-		lst = -1;
-		break;
-
-	default:
-		break;
-	}
-
-	return  lst;		
-}
-
-int	_tblFile(int control, int fileDescriptor)
-{
-	static int	tbl=-1;
-
-	switch (control)
-	{
-	case 1: 
-		tbl = fileDescriptor;
-		break;
+		if (idx != -1)
+		{
+			close(idx);
+		}
 
-	case -1:
-		close(tbl);
-		tbl = -1;
+		idx = -1;
 		break;
 
 	default:
 		break;
 	}
 
-	return  tbl;		
+	return  idx;		
 }
 
 BpSAP	_bpsap(BpSAP *newSAP)
@@ -168,661 +164,837 @@ BpSAP	_bpsap(BpSAP *newSAP)
 	return sap;
 }
 
-/* .tbl database file management functions */
+/* .dat database file management functions */
 
-static int	writeTblFile(int fd, long offset, char *from, long length)
+#ifndef BSS_NO_MMAP
+static char	*_datMap(int fd, off_t end)
 {
-	if (lseek(fd, offset, SEEK_SET) < 0)
+	static char	*map = NULL;
+	static off_t	mapLength = 0;
+	static int	mapFile = -1;
+	struct stat	stats;
+
+	/*	Returns a pointer to a read-only mapping of the *.dat
+	 *	file that covers at least the first "end" bytes of
+	 *	the file, remapping the file as it grows.  Returns
+	 *	NULL if no such mapping can be established, in which
+	 *	case the caller must read the file instead.  If fd
+	 *	is -1, releases the current mapping.			*/
+
+	if (fd == -1 || fd != mapFile)
 	{
-		putSysErrmsg("BSS library: can't seek in .tbl file", itoa(fd));
-		return -1;
+		if (map)
+		{
+			munmap(map, mapLength);
+			map = NULL;
+			mapLength = 0;
+		}
+
+		mapFile = fd;
+		if (fd == -1)
+		{
+			return NULL;
+		}
 	}
 
-	if (write(fd, (char *) from, length) < 0)
+	if (end <= mapLength)
 	{
-		putSysErrmsg("BSS library: can't write to .tbl file", itoa(fd));
-		return -1;
+		return map;
 	}
 
-	return 0;
-}
-
-static int	initializeTblIndex(int fd, tblIndex *index)
-{	
-	tblHeader	*hdr = &(index->header);
-	int		i;
-	tblRow		*row;
+	if (fstat(fd, &stats) < 0 || stats.st_size < end)
+	{
+		return NULL;
+	}
 
-	hdr->oldestTime = 0;
-	hdr->oldestRowIndex = 0;
-	hdr->newestTime = 0;
-	hdr->newestRowIndex = 0;
+	if (map)
+	{
+		munmap(map, mapLength);
+		mapLength = 0;
+	}
 
-	for (i = 0; i < WINDOW; i++)
+	map = mmap(NULL, stats.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED)
 	{
-		row = index->rows + i;
-		row->firstEntryOffset = -1;
-		row->lastEntryOffset = -1;
-		row->hgstCountVal = 0;
-		row->lwstCountVal = 0;
+		map = NULL;
+		return NULL;
 	}
 
-	return writeTblFile(fd, 0, (char *) index, sizeof(tblIndex));
+	mapLength = stats.st_size;
+	return map;
 }
+#endif
 
-static int	loadTblIndex(int fd, tblIndex *index)
+int	readRecord(int fileD, dataRecord *rec, off_t datOffset, char *buffer,
+		long bufLength)
 {
-	if (lseek(fd, 0, SEEK_SET) < 0)
+#ifndef BSS_NO_MMAP
+	char	*map;
+#endif
+
+	/*	Reads the header of the record at datOffset and, if
+	 *	buffer is non-NULL, the record's payload.  Returns -1
+	 *	if the record can't be read or if the payload is too
+	 *	large for the buffer.					*/
+
+#ifndef BSS_NO_MMAP
+	map = _datMap(fileD, datOffset + sizeof(dataRecord));
+	if (map)
 	{
-		putSysErrmsg("BSS library: can't seek in .tbl file", itoa(fd));
+		memcpy((char *) rec, map + datOffset, sizeof(dataRecord));
+		if (buffer == NULL)
+		{
+			return 0;
+		}
+
+		if (rec->pLen < 0 || rec->pLen > bufLength)
+		{
+			return -1;	/*	Prevent buffer overflow.*/
+		}
+
+		map = _datMap(fileD, datOffset + sizeof(dataRecord)
+				+ rec->pLen);
+		if (map)
+		{
+			memcpy(buffer, map + datOffset + sizeof(dataRecord),
+					rec->pLen);
+			return 0;
+		}
+	}
+#endif
+	if ((lseek(fileD, datOffset, SEEK_SET) < 0) ||
+	    (read(fileD, rec, sizeof(dataRecord)) < sizeof(dataRecord)))
+	{
+		putSysErrmsg("BSS library: can't seek to read from .dat file",
+				NULL);
 		return -1;
 	}
 
-	if (read(fd, (char *) index, sizeof(tblIndex)) < 0)
+	if (buffer == NULL)
+	{
+		return 0;
+	}
+
+	if (rec->pLen < 0 || rec->pLen > bufLength)
+	{
+		return -1;		/*	Prevent buffer overflow.*/
+	}
+
+	if (read(fileD, buffer, rec->pLen) < rec->pLen)
 	{
-		putSysErrmsg("BSS library: can't read .tbl file", itoa(fd));
+		putSysErrmsg("BSS library: can't read payload from .dat file", 
+				NULL);
 		return -1;
 	}
 
 	return 0;
 }
 
-tblIndex	*_tblIndex(int *control)
+static int	writeRecords(int fileD, struct iovec *iov, int iovCount,
+			long length)
+{
+#ifdef mingw
+	int	i;
+
+	for (i = 0; i < iovCount; i++)
+	{
+		if (write(fileD, iov[i].iov_base, iov[i].iov_len)
+				< (long) iov[i].iov_len)
+		{
+			putSysErrmsg("BSS library: can't write to .dat file",
+					NULL);
+			return -1;
+		}
+	}
+#else
+	/*	The *.dat file is opened in append mode, so no seek
+	 *	is needed.						*/
+
+	if (writev(fileD, iov, iovCount) < length)
+	{
+		putSysErrmsg("BSS library: can't write to .dat file", NULL);
+		return -1;
+	}
+#endif
+	return 0;
+}
+
+/* In-memory index management functions */
+
+bssIndex	*_bssIndex(int *control)
 {
-	static tblIndex	*index = NULL;
+	static bssIndex	*index = NULL;
 
 	if (control)
 	{
-		if (index)		/*	Destroy if it's loaded	.*/
+		if (index)		/*	Destroy if it's loaded.	*/
 		{
+			if (index->entries)
+			{
+				free(index->entries);
+			}
+
 			MRELEASE(index);
 			index = NULL;
 		}
 
 		if (*control)		/*	Creating.		*/
 		{
-			index = MTAKE(sizeof(tblIndex));
+			index = MTAKE(sizeof(bssIndex));
+			if (index)
+			{
+				memset((char *) index, 0, sizeof(bssIndex));
+			}
 		}
 	}
 
 	return index;
 }
 
-/* .lst database file management functions */
-
-int	getLstEntry(int fileD, lstEntry *entry, long lstEntryOffset)
+static void	clearIndex(bssIndex *index)
 {
-	if ((lseek(fileD, lstEntryOffset, SEEK_SET) < 0) ||
-	    (read(fileD, entry, sizeof(lstEntry)) < 0))
-	{
-		putSysErrmsg("BSS library: can't seek or read from .lst file", 
-				NULL);
-		return -1;
-	}
+	index->oldestTime = 0;
+	index->newestTime = 0;
+	index->first = 0;
+	index->count = 0;
+	index->loggedEntries = 0;
+	index->idxLength = 0;
+}
 
+static int	compareTimes(BpTimestamp *t1, BpTimestamp *t2)
+{
+	if (t1->seconds < t2->seconds) return -1;
+	if (t1->seconds > t2->seconds) return 1;
+	if (t1->count < t2->count) return -1;
+	if (t1->count > t2->count) return 1;
 	return 0;
 }
 
-static int	addEntry(int fileD, BpTimestamp time, off_t datOffset,
-			long prev, long next, long dataLength)
+long	findEntry(bssIndex *index, BpTimestamp *time)
 {
-	lstEntry entry;
-	
-	entry.crtnTime = time;
-	entry.datOffset = datOffset;
-	entry.prev = prev;
-	entry.next = next;
-	entry.pLen = dataLength;
-		
-	if ((lseek(fileD, 0, SEEK_END) < 0) ||
-	    (write(fileD, &entry, sizeof(lstEntry)) < 0))
-	{
-		putSysErrmsg("BSS library: can't seek or write to .lst file", 
-				NULL);
-		return -1;
+	bssEntry	*entries = index->entries + index->first;
+	long		low = 0;
+	long		high = index->count;
+	long		mid;
+
+	/*	Returns the position, relative to the first entry in
+	 *	the index, of the first entry whose creation time is
+	 *	on or after the indicated time.  Returns the number
+	 *	of entries in the index if there is no such entry.	*/
+
+	while (low < high)
+	{
+		mid = (low + high) >> 1;
+		if (compareTimes(&entries[mid].crtnTime, time) < 0)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
 	}
 
-	return 0;		
+	return low;
 }
 
-static int	updateEntry(int fileD, lstEntry *entry, long prev, long next, 
-			long offset)
+static int	makeRoom(bssIndex *index)
 {
-	entry->prev = prev;
-	entry->next = next;
-		
-	if ((lseek(fileD, offset, SEEK_SET) < 0) ||
-	    (write(fileD, entry, sizeof(lstEntry)) < 0))
+	long		newCapacity;
+	bssEntry	*newEntries;
+
+	if (index->first > 0)
 	{
-		putSysErrmsg("BSS library: can't seek or write to .lst file", 
-				NULL);
-		return -1;
+		/*	Reclaim the space of discarded entries.		*/
+
+		memmove((char *) index->entries,
+				(char *) (index->entries + index->first),
+				index->count * sizeof(bssEntry));
+		index->first = 0;
+		if (index->count < index->capacity)
+		{
+			return 0;
+		}
 	}
 
-	return 0;		
-}
+	/*	The index holds an entry for every frame received in
+	 *	the last WINDOW seconds, which at video frame rates
+	 *	can exceed the size of ION working memory, so the
+	 *	entries are allocated from the heap.			*/
 
-static int	insertLstEdge(int fileD, lstEntry *curEntry, long curPrev, 
-			long curNext, long offset, BpTimestamp time,
-			off_t datOffset, long prev, long next, long dataLength)
-{
-	if (updateEntry(fileD, curEntry, curPrev, curNext, offset) < 0)
+	newCapacity = index->capacity == 0 ? 1024 : index->capacity * 2;
+	newEntries = (bssEntry *) malloc(newCapacity * sizeof(bssEntry));
+	if (newEntries == NULL)
 	{
-		putErrmsg("Update of .lst file failed", NULL);
+		putErrmsg("BSS library: can't enlarge index.",
+				itoa(newCapacity));
 		return -1;
 	}
-			
-	if (addEntry(fileD, time, datOffset, prev, next, dataLength) < 0)
+
+	if (index->entries)
 	{
-		putErrmsg("Update of .lst file failed", NULL);
-		return -1;
+		memcpy((char *) newEntries, (char *) index->entries,
+				index->count * sizeof(bssEntry));
+		free(index->entries);
 	}
 
-	return 1;		
+	index->entries = newEntries;
+	index->capacity = newCapacity;
+	return 0;
 }
 
-static int	insertLstIntrmd(int fileD, lstEntry *curEntry,
-			long lstEntryOffset, long newEntryOffset,
-			BpTimestamp time, off_t datOffset, long dataLength)
+static int	insertEntry(bssIndex *index, bssEntry *entry)
 {
-	lstEntry	nextEntry;
+	time_t		seconds = entry->crtnTime.seconds;
+	BpTimestamp	oldest;
+	long		expired;
+	long		position;
+	bssEntry	*slot;
 
-	if (addEntry(fileD, time, datOffset, lstEntryOffset, curEntry->next, 
-			dataLength) < 0)
+	/*
+	 *  Adds an entry to the in-memory index, advancing the
+	 *  index's window as necessary.  Returns 1 if the entry
+	 *  was inserted, 0 if an entry with the same creation time
+	 *  is already in the index (i.e., the ADU is a duplicate),
+	 *  -2 if the ADU is too old to be indexed, -1 on any error.
+	 */
+
+	if (index->newestTime == 0)	/*	Empty index.		*/
 	{
-		putErrmsg("Update of .lst file failed", NULL);
-		return -1;
+		index->oldestTime = seconds;
+		index->newestTime = seconds;
 	}
-						
-	if (getLstEntry(fileD, &nextEntry, curEntry->next) < 0)
+
+	if (seconds < index->oldestTime)
 	{
-		putErrmsg("Retrieval of .lst entry failed", NULL);
-		return -1;
+		/* Bundle is too old. A dataRecord will be inserted to
+		 * *.dat file but it will not be trackable by the index.*/
+
+		return -2; 
 	}
 
-	if (updateEntry(fileD, &nextEntry, newEntryOffset, nextEntry.next, 
-			curEntry->next) < 0)
+	if (seconds > index->newestTime)	/*	Time advance.	*/
 	{
-		putErrmsg("Update of .lst file failed", NULL);
-		return -1;
+		index->newestTime = seconds;
+		if (seconds - index->oldestTime >= WINDOW)
+		{
+			/*	Discard the entries for the seconds that
+			 *	have dropped out of the window.		*/
+
+			index->oldestTime = seconds - (WINDOW - 1);
+			oldest.seconds = index->oldestTime;
+			oldest.count = 0;
+			expired = findEntry(index, &oldest);
+			index->first += expired;
+			index->count -= expired;
+		}
 	}
 
-	if (updateEntry(fileD, curEntry, curEntry->prev, newEntryOffset, 
-			lstEntryOffset) < 0)
+	/*	Nearly all ADUs are received in creation time order,
+	 *	so check for the common case of appending first.	*/
+
+	if (index->count == 0 || compareTimes(&entry->crtnTime,
+		&index->entries[index->first + index->count - 1].crtnTime) > 0)
 	{
-		putErrmsg("Update of .lst file failed", NULL);
-		return -1;
+		position = index->count;
+	}
+	else
+	{
+		position = findEntry(index, &entry->crtnTime);
+		if (compareTimes(&entry->crtnTime,
+			&index->entries[index->first + position].crtnTime) == 0)
+		{
+			return 0;	/*	Avoid duplicate entry.	*/
+		}
+	}
+
+	if (index->first + index->count == index->capacity)
+	{
+		if (makeRoom(index) < 0)
+		{
+			return -1;
+		}
 	}
-#if BSSLIBDEBUG
-printf("Adding an intermediate entry into the list for %lu second\n", 
-	time.seconds);
-printf("ADD // new Entry Offset: %ld - previous offset: %ld - next offset: %ld\n", 
-	newEntryOffset, lstEntryOffset, curEntry->next);
-printf("UPDATE NEXT // offset: %ld - previous offset: %ld - next offset: %ld\n", 
-	curEntry->next,  newEntryOffset, nextEntry.next);
-printf("UPDATE CURRENT // offset: %ld - previous offset: %ld - next offset: %ld\n", 
-	lstEntryOffset, curEntry->prev,  newEntryOffset);
-#endif
 
-	return 1;	
+	slot = index->entries + index->first + position;
+	if (position < index->count)
+	{
+		memmove((char *) (slot + 1), (char *) slot,
+				(index->count - position) * sizeof(bssEntry));
+	}
+
+	*slot = *entry;
+	index->count++;
+	return 1;
 }
 
-/* .dat database file management functions */
+/* .idx database file management functions */
 
-int	readRecord(int fileD, dataRecord *rec, off_t datOffset)
+static int	loadIndexLog(bssIndex *index, int fd)
 {
-	if ((lseek(fileD, datOffset, SEEK_SET) < 0) ||
-	    (read(fileD, rec, sizeof(dataRecord)) < 0))
+	bssEntry	entries[256];
+	long		length;
+	long		count;
+	long		i;
+
+	/*	Loads all complete entries that have been appended
+	 *	to the *.idx file since it was last loaded.		*/
+
+	if (lseek(fd, index->idxLength, SEEK_SET) < 0)
 	{
-		putSysErrmsg("BSS library: can't seek to read from .dat file",
-				NULL);
+		putSysErrmsg("BSS library: can't seek in .idx file", itoa(fd));
 		return -1;
 	}
 
-	return 0;
+	while (1)
+	{
+		length = read(fd, (char *) entries, sizeof entries);
+		if (length < 0)
+		{
+			putSysErrmsg("BSS library: can't read .idx file",
+					itoa(fd));
+			return -1;
+		}
+
+		count = length / sizeof(bssEntry);
+		for (i = 0; i < count; i++)
+		{
+			if (insertEntry(index, entries + i) == -1)
+			{
+				return -1;
+			}
+		}
+
+		index->loggedEntries += count;
+		index->idxLength += count * sizeof(bssEntry);
+		if (length < sizeof entries)
+		{
+			return 0;	/*	End of file.		*/
+		}
+	}
 }
 
-int	readPayload(int fileD, char* buffer, long length)
+static int	rebuildIndex(bssIndex *index, int datFd)
 {
-	if (read(fileD, buffer, length*sizeof(char)) < 0)
+	dataRecord	rec;
+	bssEntry	entry;
+	off_t		datOffset = 0;
+
+	/*	Reconstructs the in-memory index from the records in
+	 *	the *.dat file.						*/
+
+	clearIndex(index);
+	while (1)
 	{
-		putSysErrmsg("BSS library: can't read payload from .dat file", 
-				NULL);
-		return -1;
+		if (lseek(datFd, datOffset, SEEK_SET) < 0)
+		{
+			putSysErrmsg("BSS library: can't seek in .dat file",
+					NULL);
+			return -1;
+		}
+
+		if (read(datFd, (char *) &rec, sizeof(dataRecord))
+				< sizeof(dataRecord) || rec.pLen < 0)
+		{
+			break;			/*	End of data.	*/
+		}
+
+		entry.crtnTime = rec.crtnTime;
+		entry.datOffset = datOffset;
+		entry.pLen = rec.pLen;
+		if (insertEntry(index, &entry) == -1)
+		{
+			return -1;
+		}
+
+		datOffset += sizeof(dataRecord) + rec.pLen;
 	}
 
 	return 0;
 }
 
-static long	addDataRecord(int fileD, off_t datOffset, BpTimestamp time,
-			long payloadLength)
+static int	compactIndexLog(bssIndex *index, int *idxFd)
 {
-	dataRecord data;
+	char	tmpName[300];
+	int	fd;
+	long	length = index->count * sizeof(bssEntry);
 
-	data.crtnTime = time;
-	data.pLen = payloadLength;
+	/*	Replaces the *.idx file with a file containing only
+	 *	the entries that are currently in the index.		*/
 
-	if (write(fileD, &data, sizeof(dataRecord)) < 0)
+	isprintf(tmpName, sizeof tmpName, "%s.tmp", index->idxName);
+	fd = open(tmpName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0)
 	{
-		putSysErrmsg("BSS library: can't write to .dat file", NULL);
+		putSysErrmsg("BSS library: can't create .idx file", tmpName);
 		return -1;
 	}
-#if BSSLIBDEBUG
-printf("New data record added to the database\n");
-printf("-------------------------------------\n");
-printf("creation time: %lu - length: %ld\n", time.seconds, payloadLength);
-#endif
-	return 0;		
+
+	if (write(fd, (char *) (index->entries + index->first), length)
+			< length)
+	{
+		putSysErrmsg("BSS library: can't write .idx file", tmpName);
+		close(fd);
+		unlink(tmpName);
+		return -1;
+	}
+
+	close(fd);
+	if (rename(tmpName, index->idxName) < 0)
+	{
+		putSysErrmsg("BSS library: can't replace .idx file", tmpName);
+		unlink(tmpName);
+		return -1;
+	}
+
+	fd = open(index->idxName, O_RDWR | O_APPEND, 0666);
+	if (fd < 0)
+	{
+		putSysErrmsg("BSS library: can't open .idx file",
+				index->idxName);
+		return -1;
+	}
+
+	close(*idxFd);
+	*idxFd = fd;
+	index->loggedEntries = index->count;
+	index->idxLength = length;
+	return 0;
 }
 
 /* Receiver's operations - section */
 
-static int	updateLstEntries(int lstFile, long lstEntryOffset,
-			long newEntryOffset, off_t datOffset, BpTimestamp time,
-			long dataLength)
+static int	storeFrames(bss_thread_data *db, BssFrame *batch)
 {
-	lstEntry 	curEntry;
-	
+	bssIndex	*index = _bssIndex(NULL);
+	struct iovec	iov[2 * BSS_WRITE_BATCH];
+	bssEntry	entries[BSS_WRITE_BATCH];
+	bssEntry	entry;
+	int		iovCount = 0;
+	int		entryCount = 0;
+	int		frameCount = 0;
+	off_t		datLength = db->datLength;
+	long		length;
+	BssFrame	*frame;
+	int		result = 0;
+
 	/*
-	 *  This function adds new entries and applies appropriate
-	 *  updates on the contents of *.lst file, as needed. The
-	 *  operation of the function depends on the value of
-	 *  lstEntryOffset.
-	 *
-	 *  If lstEntryOffset is 1 then it can't be a legitimate
-	 *  list entry offset, since the size of a list entry is
-	 *  greater than 1.  (The first entry in the .lst file is
-	 *  at offset zero, the second is at offset N where N is the
-	 *  size of a list entry, etc.)  Therefore this value of
-	 *  lstEntryOffset is used to indicate that the linked list
-	 *  of entries for the indicated time is currently empty.
-	 *  A new entry that isn't connected to any other entries
-	 *  is created and appended at the end of the file.
-	 *
-	 *  If lstEntryOffset has a value other than 1, that means
-	 *  that the linked list of entries for the indicated time
-	 *  is not empty.  A new entry with the proper contents is
-	 *  created and appended to the end of the file and the
-	 *  pointer to lstEntryOffset is used as a starting point
-	 *  for stepping through the other entries of that doubly-
-	 *  linked list so that they can get updated (based on their
-	 *  count value), placing the new entry at the right spot.	       
+	 *  Appends the frames of a batch of no more than BSS_WRITE_BATCH
+	 *  frames to the *.dat file in a single write, adds entries for
+	 *  them to the in-memory index, and appends those entries to
+	 *  the *.idx file.  Frames that are duplicates are discarded;
+	 *  frames that are too old to be indexed are stored but not
+	 *  indexed.  Returns the number of frames stored, -1 on any
+	 *  error.
 	 */
 
-	if (lstEntryOffset == 1)
-	{
-		/*	Doubly-linked list is empty.	*/
-		if (addEntry(lstFile, time, datOffset, -1, -1, dataLength) < 0)
-		{
-			putErrmsg("Update of .lst file failed", NULL);
-			return -1;
-		}
-#if BSSLIBDEBUG
-printf("ADD // new Entry Offset: %ld - previous offset: -1 - next offset: -1\n",
-	newEntryOffset);
-#endif
-		return 1;
-	}
-	
-	if (getLstEntry(lstFile, &curEntry, lstEntryOffset) < 0)
+	if (_lockMutex(1) == -1)
 	{
-		putErrmsg("Retrieval of .lst entry failed", NULL);
 		return -1;
 	}
-	
-	if (curEntry.crtnTime.count < time.count)
+
+	for (frame = batch; frame; frame = frame->next)
 	{
-		if (insertLstEdge(lstFile, &curEntry, curEntry.prev, 
-			newEntryOffset, lstEntryOffset, time, datOffset, 
-			lstEntryOffset, -1, dataLength) < 0)
+		entry.crtnTime = frame->record.crtnTime;
+		entry.datOffset = datLength;
+		entry.pLen = frame->record.pLen;
+		switch (insertEntry(index, &entry))
 		{
-			return -1;
+		case -1:
+			result = -1;	/*	Unresolved error.	*/
+			break;
+
+		case 0:
+			continue;	/*	Already received.	*/
+
+		case -2:
+			break;	/*	Too old; store, don't index.	*/
+
+		default:
+			entries[entryCount] = entry;
+			entryCount++;
 		}
-#if BSSLIBDEBUG
-printf("Same as end of list. Adding an entry at the end of the list for %lu \
-second\n", time.seconds);
-printf("UPDATE // offset: %ld - previous offset: %ld - next offset: %ld\n", 
-lstEntryOffset, curEntry.prev, newEntryOffset);
-printf("ADD // new Entry Offset: %ld - previous offset: %ld - next offset: -1\n", newEntryOffset, lstEntryOffset);
-#endif
-		return 1;
+
+		if (result < 0)
+		{
+			break;
+		}
+
+		iov[iovCount].iov_base = (char *) &(frame->record);
+		iov[iovCount].iov_len = sizeof(dataRecord);
+		iovCount++;
+		iov[iovCount].iov_base = (char *) (frame + 1);
+		iov[iovCount].iov_len = frame->record.pLen;
+		iovCount++;
+		datLength += sizeof(dataRecord) + frame->record.pLen;
+		frameCount++;
 	}
-	else if (curEntry.crtnTime.count == time.count)
+
+	/*	The index entries are logged only after the data
+	 *	records have been written.				*/
+
+	if (result == 0 && iovCount > 0)
 	{
-		return 0;		/*	Avoid duplicate entry.	*/
+		result = writeRecords(db->dat, iov, iovCount,
+				datLength - db->datLength);
+		db->datLength = datLength;
 	}
 
-	while (curEntry.prev != -1)
+	if (result == 0 && entryCount > 0)
 	{
-		lstEntryOffset = curEntry.prev;
-
-		if (getLstEntry(lstFile, &curEntry, lstEntryOffset) < 0)
+		length = entryCount * sizeof(bssEntry);
+		if (write(db->idx, (char *) entries, length) < length)
 		{
-			putErrmsg("Retrieval of .lst entry failed", NULL);
-			return -1;
+			putSysErrmsg("BSS library: can't write to .idx file",
+					NULL);
+			result = -1;
 		}
-
-		if (curEntry.crtnTime.count < time.count)
+		else
 		{
-			if (insertLstIntrmd(lstFile, &curEntry, lstEntryOffset, 
-		 			newEntryOffset, time, datOffset,
-					dataLength) < 0)
-			{
-				return -1;	
-			}
-
-			return 1;
-		}
-		else if (curEntry.crtnTime.count == time.count)
-		{
-			return 0;	/*	Avoid duplicate entry.	*/
+			index->loggedEntries += entryCount;
+			index->idxLength += length;
 		}
 	}
 
-	if (curEntry.crtnTime.count == time.count)
+	/*	Compact the *.idx file when most of its entries are
+	 *	for frames that have dropped out of the window.		*/
+
+	if (result == 0 && index->loggedEntries - index->count
+			>= BSS_COMPACTION_MIN
+	&& index->loggedEntries > 2 * index->count)
 	{
-		return 0;		/*	Avoid duplicate entry.	*/
+		result = compactIndexLog(index, &db->idx);
 	}
 
-	if (insertLstEdge(lstFile, &curEntry, newEntryOffset, 
-			curEntry.next, lstEntryOffset, time, datOffset, 
-			-1, lstEntryOffset, dataLength) < 0)
+	oK(_lockMutex(0));
+	return (result < 0 ? -1 : frameCount);
+}
+
+static int	syncFiles(bss_thread_data *db)
+{
+	if (BSS_SYNC(db->dat) < 0 || BSS_SYNC(db->idx) < 0)
 	{
+		putSysErrmsg("BSS library: can't flush database files", NULL);
 		return -1;
 	}
-#if BSSLIBDEBUG
-printf("Adding an entry at the beginning of the list for %lu second\n", 
-	time.seconds);
-printf("UPDATE // offset: %ld - previous offset: %ld - next offset: %ld\n", 
-	lstEntryOffset, newEntryOffset,  curEntry.next);
-printf("ADD // Entry Offset: %ld - previous offset: -1 - next offset: %ld\n", 
-	newEntryOffset, lstEntryOffset);
-#endif
-	return 1;
+
+	return 0;
 }
 
-static void	updateTbl(tblRow *row, int _switch, long offset,
-			BpTimestamp time)
+static void	releaseFrames(BssFrame *frame)
 {
-	/*  
-	 *  This function updates the values of tblIndex structure based      
-	 *  on _switch value. In the first case, it updates the variables     
-	 *  that hold the details for the bundle with the oldest creation     
-	 *  time of a particular second. In the second case it updates the    
-	 *  variables that hold the details for the bundle with the newest    
-	 *  creation time of a particular second. Finally, in the third case, 
-	 *  the bundle that just got received is the first received bundle  
-	 *  of a particular second, so both variables that hold the details    
-	 *  for the oldest and newest bundle are being initialized with the   
-	 *  same value.		     			               
-	 */
+	BssFrame	*next;
 
-	if (_switch == 0)
-	{
-		row->firstEntryOffset = offset;
-		row->lwstCountVal = time.count;
-	}
-	else if (_switch == 1)
-	{
-		row->lastEntryOffset = offset;
-		row->hgstCountVal = time.count;
-	}
-	else if (_switch == 2)
+	while (frame)
 	{
-		row->firstEntryOffset = offset;
-		row->lwstCountVal = time.count;
-		row->lastEntryOffset = offset;
-		row->hgstCountVal = time.count;
+		next = frame->next;
+		free(frame);
+		frame = next;
 	}
 }
 
-static long	getEntryPosition(int tblFile, BpTimestamp time, long entry)
+static void	*writeFrames(void *args)
 {
-	tblIndex	*index = _tblIndex(NULL);
-	tblHeader	*hdr = &(index->header);
-	tblRow		*row;
-	long		elapsed;
-	long		relativeTime;
-	long		position;
-	long		offset;
-	long		newestRow = -1;
-	time_t		newestTime = 0;
-	long		oldestRow = -1;
-	time_t		oldestTime = 0;
-	long		lastEntry; 	/*	offset of last in list	*/
-
-	/* 
-	 *  This function calculates in which position (row number),  
-	 *  of the lists stored in .tbl, the new entry should be     
-	 *  inserted, updates the proper elements as needed and returns
-	 *  last entry's offset in .lst file for the indicated second.         
-	 */
-
-#if BSSLIBDEBUG
-printf("(BEFORE) Creation time of the oldest frame stored in *.tbl file: %lu\n",
-	hdr->oldestTime);
-printf("(BEFORE) Creation time of the newest frame stored in *.tbl file: %lu\n",
-	hdr->newestTime);
-#endif
+	bss_thread_data	*db = (bss_thread_data *) args;
+	BssQueue	*queue = &(db->queue);
+	BssDurability	*durability = &(db->durability);
+	BssFrame	*batch;
+	BssFrame	*last;
+	int		batchSize = BSS_WRITE_BATCH;
+	int		count;
+	long		bytes;
+	int		written;
+	int		unsynced = 0;
+	time_t		lastSync = time(NULL);
+	struct timespec	deadline;
+	int		stopLoop = 0;
 
-	/*	In case getEntryPosition function is executed for
-	 *	the first time, initialize the values of oldestTime
-	 *	and newestTime in the index file.			*/
+	/*	Writer thread: stores batches of frames taken from the
+	 *	queue, flushing the database files to stable storage
+	 *	as required by the durability policy.  A batch never
+	 *	spans a required flush.					*/
 
-	if (hdr->oldestTime == 0)
+	if (durability->syncFrames > 0 && durability->syncFrames < batchSize)
 	{
-		hdr->oldestTime = time.seconds;
-		if (writeTblFile(tblFile, 0, (char *) index, sizeof(tblHeader))
-				< 0)
-		{
-			return -1;
-		}
+		batchSize = durability->syncFrames;
 	}
 
-	if (hdr->newestTime == 0)
+	pthread_mutex_lock(&(queue->mutex));
+	while (1)
 	{
-		hdr->newestTime = time.seconds;
-		if (writeTblFile(tblFile, 0, (char *) index, sizeof(tblHeader))
-				< 0)
+		if (queue->first == NULL)
 		{
-			return -1;
-		}
-	}
+			if (queue->stopping)
+			{
+				break;
+			}
 
-	/*	Determine correct .tbl row for this bundle.		*/
+			if (unsynced > 0 && durability->syncInterval > 0)
+			{
+				deadline.tv_sec = lastSync
+						+ durability->syncInterval;
+				deadline.tv_nsec = 0;
+				if (pthread_cond_timedwait(&(queue->frameQueued),
+						&(queue->mutex), &deadline)
+						!= ETIMEDOUT)
+				{
+					continue;
+				}
 
-	if (time.seconds < hdr->oldestTime)
-	{
-		/* Bundle is too old. A dataRecord will be inserted to
-		 * *.dat file but it will not be trackable by *.tbl or
-		 * *.lst files.			    			*/
+				pthread_mutex_unlock(&(queue->mutex));
+				written = syncFiles(db);
+				pthread_mutex_lock(&(queue->mutex));
+				if (written < 0)
+				{
+					queue->failed = 1;
+					break;
+				}
 
-		return -2; 
-	}
+				unsynced = 0;
+				lastSync = time(NULL);
+				continue;
+			}
 
-#if BSSLIBDEBUG
-printf("(before calculation) position value: %ld - NewestRowIndex value %ld\n",
-position, hdr->newestRowIndex);
-#endif
+			pthread_cond_wait(&(queue->frameQueued),
+					&(queue->mutex));
+			continue;
+		}
 
-	if (time.seconds <= hdr->newestTime)	/*	Data from past.	*/
-	{
-		/*	No change to either oldest or newest time.	*/
+		/*	Take a batch of frames off the queue.		*/
 
-		relativeTime = time.seconds - hdr->oldestTime;
-		position = hdr->oldestRowIndex + relativeTime;
-		if (position >= WINDOW)
+		batch = last = queue->first;
+		count = 1;
+		bytes = last->record.pLen;
+		while (count < batchSize && last->next)
 		{
-			position -= WINDOW;
+			last = last->next;
+			count++;
+			bytes += last->record.pLen;
 		}
-	}
-	else	/*	Time has advanced.				*/
-	{
-		elapsed = time.seconds - hdr->newestTime;
-		if (elapsed >= WINDOW)
+
+		queue->first = last->next;
+		if (queue->first == NULL)
 		{
-			/*	The time advance is too large to be
-			 *	contained in the database's index,
-			 *	so we wipe out the whole index and
-			 *	start over again at this time.		*/
-
-			initializeTblIndex(tblFile, index);
-			position = 0;
-			newestRow = 0;
-			newestTime = time.seconds;
-			oldestRow = 0;
-			oldestTime = time.seconds;
+			queue->last = NULL;
 		}
-		else	/*	Time advance fits within index.		*/
-		{
-			position = hdr->newestRowIndex + 1;
-			oldestRow = hdr->oldestRowIndex;
-			oldestTime = hdr->oldestTime;
-
-			/*	Must clear out old data for any rows
-			 *	(seconds) between the previous newest
-			 *	time and the time to which we have
-			 *	now advanced.  If the time advance is
-			 *	just one second, no need to erase
-			 *	anything -- we're going to write into
-			 *	the first row after the previous newest
-			 *	time anyway.				*/
-
-			while (1)
-			{
-				if (position == WINDOW)
-				{
-					position = 0;
-				}
-
-				/*	May be overwriting the oldest
-				 *	row in the table.		*/
 
-				if (position == oldestRow)
-				{
-					oldestTime++;
-					oldestRow++;
-					if (oldestRow == WINDOW)
-					{
-						oldestRow = 0;
-					}
-				}
+		last->next = NULL;
+		queue->frames -= count;
+		queue->bytes -= bytes;
+		pthread_cond_broadcast(&(queue->spaceFreed));
+		pthread_mutex_unlock(&(queue->mutex));
 
-				/*	Erase this intervening second.	*/
-
-				row = index->rows + position;
-				row->firstEntryOffset = -1;
-				row->lastEntryOffset = -1;
-				row->hgstCountVal = 0;
-				row->lwstCountVal = 0;
-				offset = ((char *) row) - ((char *) index);
-				if (writeTblFile(tblFile, offset, (char *) row,
-						sizeof(tblRow)) < 0)
+		written = storeFrames(db, batch);
+		releaseFrames(batch);
+		if (written >= 0)
+		{
+			unsynced += written;
+			if ((durability->syncFrames > 0
+				&& unsynced >= durability->syncFrames)
+			|| (durability->syncInterval > 0 && unsynced > 0
+				&& time(NULL) - lastSync
+					>= durability->syncInterval))
+			{
+				if (syncFiles(db) < 0)
 				{
-					return -1;
+					written = -1;
 				}
-#if BSSLIBDEBUG
-printf("Row (%lu) was erased\n", position);
-#endif
-				elapsed -= 1;
-				if (elapsed == 0)
+				else
 				{
-					break;	/*	Done erasing.	*/
+					unsynced = 0;
+					lastSync = time(NULL);
 				}
-
-				position++;
 			}
+		}
 
-			newestRow = position;
-			newestTime = time.seconds;
+		pthread_mutex_lock(&(queue->mutex));
+		if (written < 0)
+		{
+			putErrmsg("bss: can't store frames.", NULL);
+			queue->failed = 1;
+			break;
 		}
 	}
 
-#if BSSLIBDEBUG
-printf("(after calculation) position value: %ld - NewestRowIndex value %ld\n",
-position, hdr->newestRowIndex);
-#endif
-	/*
-	 *  Checks if there is already a doubly-linked list created
-	 *  for this second. If a doubly-linked list already exists,
-	 *  returns the position (offset) of the last entry in the
-	 *  doubly-linked list and updates accordingly the .tbl file.
-	 *  Otherwise, returns a zero value to indicate that a doubly-
-	 *  linked list for this second doesn't exist and updates
-	 *  accordingly the .tbl file.
-	 */
-
-	row = index->rows + position;
-	if (row->lastEntryOffset == -1)
-	{
-		lastEntry = 1;	 /*	no entries for this second yet	*/
-		updateTbl(row, 2, entry, time);	
-	}
-	else
+	pthread_cond_broadcast(&(queue->spaceFreed));
+	pthread_mutex_unlock(&(queue->mutex));
+	if (queue->failed)
 	{
-		lastEntry = row->lastEntryOffset;
-		if (time.count < row->lwstCountVal)
-		{
-			updateTbl(row, 0, entry, time);
-		}
-		else if (time.count > row->hgstCountVal)
-		{
-			updateTbl(row, 1, entry, time);
-		}
+		/*	Stop the receiving thread as well.		*/
+
+		oK(_running(&stopLoop));
+		bp_interrupt(_bpsap(NULL));
+		return NULL;
 	}
 
-	offset = ((char *) row) - ((char *) index);
-	if (writeTblFile(tblFile, offset, (char *) row, sizeof(tblRow)) < 0)
+	if (unsynced > 0)
 	{
-		return -1;
+		oK(syncFiles(db));
 	}
 
-	/*
-	 *  If either newest or oldest row values got updated during
-	 *  the execution of this function, update index structure
-	 *  values in order to save changes later.
-	 */
+	return NULL;
+}
 
-	if (oldestRow != -1)
+static int	enqueueFrame(BssQueue *queue, BpTimestamp time, char *buffer,
+			long contentLength)
+{
+	BssFrame	*frame;
+
+	/*	Frames are queued in heap memory rather than ION
+	 *	working memory for the same reason as the index.	*/
+
+	frame = (BssFrame *) malloc(sizeof(BssFrame) + contentLength);
+	if (frame == NULL)
 	{
-		hdr->oldestTime = oldestTime;
-		hdr->oldestRowIndex = oldestRow;
+		putErrmsg("bss: can't queue frame.", itoa(contentLength));
+		return -1;
 	}
-	
-	if (newestRow != -1)
+
+	frame->next = NULL;
+	frame->record.crtnTime = time;
+	frame->record.pLen = contentLength;
+	memcpy((char *) (frame + 1), buffer, contentLength);
+	pthread_mutex_lock(&(queue->mutex));
+	while (queue->failed == 0 && queue->frames > 0
+	&& (queue->frames >= BSS_QUEUE_FRAMES
+		|| queue->bytes + contentLength > BSS_QUEUE_BYTES))
 	{
-		hdr->newestTime = newestTime;
-		hdr->newestRowIndex = newestRow;
+		pthread_cond_wait(&(queue->spaceFreed), &(queue->mutex));
 	}
 
-	if (writeTblFile(tblFile, 0, (char *) index, sizeof(tblHeader)) < 0)
+	if (queue->failed)
 	{
+		pthread_mutex_unlock(&(queue->mutex));
+		free(frame);
 		return -1;
 	}
 
-#if BSSLIBDEBUG
-printf("(AFTER) Creation time of the oldest frame stored in *.tbl file: %lu\n", 
-	hdr->oldestTime);
-printf("(AFTER) Creation time of the newest frame stored in *.tbl file: %lu\n", 
-	hdr->newestTime);
-printf("firstEntryOffset: %lu - lastEntryOffset: %lu  returned value: %ld\n", 
-index->rows[position].firstEntryOffset, index->rows[position].lastEntryOffset, lastEntry);
-#endif
+	if (queue->last)
+	{
+		queue->last->next = frame;
+	}
+	else
+	{
+		queue->first = frame;
+	}
 
-	return lastEntry;
+	queue->last = frame;
+	queue->frames++;
+	queue->bytes += contentLength;
+	pthread_cond_signal(&(queue->frameQueued));
+	pthread_mutex_unlock(&(queue->mutex));
+	return 0;
 }
 
-static int	receiveFrame(Sdr sdr, BpDelivery *dlv, int datFile, int lstFile,
-			int tblFile, BpTimestamp *lastDis, char *buffer, 
-			long bufLength, RTBHandler display)
+static int	receiveFrame(Sdr sdr, BpDelivery *dlv, bss_thread_data *db,
+			BpTimestamp *lastDis)
 {
+	char		*buffer = db->buffer;
+	long		bufLength = db->bufLength;
+	RTBHandler	display = db->function;
 	ZcoReader       reader;
 	long		contentLength;
 	char		error[3] = "-1";
-	off_t		datOffset;
-	long 		newEntryOffset;
-	long		lstEntryOffset;
-	int		updateStat;
 	int		res = 0;
 
 	memset(buffer, '\0', bufLength);
@@ -844,104 +1016,24 @@ static int	receiveFrame(Sdr sdr, BpDelivery *dlv, int datFile, int lstFile,
 			return -1;
 		}
 
-		if (_lockMutex(1) == -1)
-		{
-			return -1;
-		}
-
-		/*	Locate the offset within lstFile at which the
-		 *	new entry will be inserted.			*/
+		/*	The frame is stored by the writer thread; a
+		 *	frame that turns out to be a duplicate is
+		 *	discarded there.				*/
 
-		newEntryOffset = (long) lseek(lstFile, 0, SEEK_END);
-		if (newEntryOffset < 0)
+		if (enqueueFrame(&(db->queue), dlv->bundleCreationTime,
+				buffer, contentLength) < 0)
 		{
-			putSysErrmsg("BSS library can't seek to the end of \
-					.lst file", NULL);
-			oK(_lockMutex(0));
+			putErrmsg("bss: can't store frame.", NULL);
 			return -1;
 		}
-#if BSSRECVLIBDEBUG
-printf("new Entry Offset returned from seeking to the end of .lst file: %ld\n", 
-newEntryOffset);
-#endif
-		/*	Locate the offset within datFile at which the
-		 *	new data record will be inserted.		*/
 
-		datOffset = (off_t) lseek(datFile, 0, SEEK_END);
-		if (datOffset < 0)
-		{
-			putSysErrmsg("BSS library can't seek to the end of \
-					.dat file", NULL);
-			oK(_lockMutex(0));
-			return -1;
-		}
-	
-		/* 
-		 *  Find offset of last entry in the doubly-linked list
-		 *  that  holds the entries for the second on which this
-		 *  bundle was created. 
-		 */
-		lstEntryOffset = getEntryPosition(tblFile,
-				dlv->bundleCreationTime, newEntryOffset);
-		switch (lstEntryOffset)
-		{
-		case -1:
-			oK(_lockMutex(0));
-			return -1;	/*	Unresolved error.	*/
-
-		case -2:
-			break; /* 
-				*  Bundle is too old. It will be 
-				*  discarded from .lst file but its 
- 				*  payload will be saved for later 
-				*  processing in .dat file.			
-				*/
-		default:
-			updateStat = updateLstEntries(lstFile, lstEntryOffset, 
-						newEntryOffset, datOffset, 
-						dlv->bundleCreationTime, 
-						contentLength);
-			switch (updateStat)
-			{
-			case -1:
-				oK(_lockMutex(0));
-				return -1;	/*	Unsuccessful.	*/
-
-			case 0:
-				/*	Already received.  Discard.	*/
-
-				oK(_lockMutex(0));
-				return 0;
-
-			default:
-				break;
-			}
-		}
-#if BSSRECVLIBDEBUG
-printf(".lst file Entry Offset that was returned from getEntryPosition function: \
-	%ld\n", lstEntryOffset);
-#endif
-	
-		/*	OK to write dataRecord information and payload
-		 *	into .dat file.					*/
-
-		if (addDataRecord(datFile, datOffset, dlv->bundleCreationTime, 
-				contentLength) < 0
-		|| write(datFile, buffer, contentLength) < 0)
-		{
-			putSysErrmsg("bss: can't write to .dat file", NULL);
-			oK(_lockMutex(0));
-			return -1;	/*	Unresolved error.	*/
-		}
-
-		oK(_lockMutex(0));	/*	Unlock mutex 		*/
-		
 #if BSSLIBDEBUG
 printf("from this point on, the execution of the provided display function begins\n");
 #endif
 		/*	Display function is called only if the current
 		 *	frame has a creation time greater than the last
-		 *	displayed frame.  				*/ 
+		 *	displayed frame, so duplicates are never
+		 *	displayed.					*/ 
 
 		if (dlv->bundleCreationTime.seconds > lastDis->seconds)
 		{
@@ -969,6 +1061,48 @@ printf("from this point on, the execution of the provided display function begin
 	return res;
 }
 
+static int	startWriter(bss_thread_data *db, pthread_t *writerThread)
+{
+	BssQueue	*queue = &(db->queue);
+
+	memset((char *) queue, 0, sizeof(BssQueue));
+	if (pthread_mutex_init(&(queue->mutex), NULL)
+	|| pthread_cond_init(&(queue->frameQueued), NULL)
+	|| pthread_cond_init(&(queue->spaceFreed), NULL))
+	{
+		putSysErrmsg("Can't initialize bss frame queue", NULL);
+		return -1;
+	}
+
+	db->durability = *(_durability());
+	if (pthread_begin(writerThread, NULL, writeFrames, (void *) db) < 0)
+	{
+		putSysErrmsg("Can't create bss writer thread", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void	stopWriter(bss_thread_data *db, pthread_t writerThread)
+{
+	BssQueue	*queue = &(db->queue);
+
+	/*	The writer thread stores all frames remaining in
+	 *	the queue before it exits.				*/
+
+	pthread_mutex_lock(&(queue->mutex));
+	queue->stopping = 1;
+	pthread_cond_signal(&(queue->frameQueued));
+	pthread_mutex_unlock(&(queue->mutex));
+	oK(pthread_join(writerThread, NULL));
+	releaseFrames(queue->first);	/*	Only if writer failed.	*/
+	queue->first = queue->last = NULL;
+	pthread_cond_destroy(&(queue->spaceFreed));
+	pthread_cond_destroy(&(queue->frameQueued));
+	pthread_mutex_destroy(&(queue->mutex));
+}
+
 void	*recvBundles(void *args)
 {
 	int		stopLoop = 0;
@@ -977,6 +1111,7 @@ void	*recvBundles(void *args)
 	BpDelivery	dlv;
 	bss_thread_data	*db;
 	BpTimestamp	lastDis;
+	pthread_t	writerThread;
 	
 	/*	Initialize the variable that holds the time of the 
 	 *	last displayed frame from receiving thread.		*/	
@@ -990,8 +1125,7 @@ void	*recvBundles(void *args)
 	{
 		putErrmsg("Can't attach to BP.", NULL);
 		close(db->dat);
-		close(db->lst);
-		close(db->tbl);
+		close(db->idx);
 		oK(_recvThreadId(NULL, -1));
 		pthread_exit(NULL);
 	}
@@ -1000,13 +1134,21 @@ void	*recvBundles(void *args)
 	{
 		putErrmsg("Can't open own endpoint.", db->eid);
 		close(db->dat);
-		close(db->lst);
-		close(db->tbl);
+		close(db->idx);
 		oK(_recvThreadId(NULL, -1));
 		pthread_exit(NULL);
 	}
 
 	oK(_bpsap(&sap));
+	if (startWriter(db, &writerThread) < 0)
+	{
+		bp_close(sap);
+		close(db->dat);
+		close(db->idx);
+		oK(_recvThreadId(NULL, -1));
+		pthread_exit(NULL);
+	}
+
 	sdr = bp_get_sdr();
 	writeMemo("[i] bss reception thread is running.");
 	while (_running(NULL))
@@ -1025,9 +1167,7 @@ void	*recvBundles(void *args)
 			break;		/*	Out of switch.		*/
 
 		case BpPayloadPresent:
-			if (receiveFrame(sdr, &dlv, db->dat, db->lst, db->tbl,
-				&lastDis, db->buffer, db->bufLength, 
-				db->function) < 0)
+			if (receiveFrame(sdr, &dlv, db, &lastDis) < 0)
 			{
 				putErrmsg("bss failed.", NULL);
 				oK(_running(&stopLoop));
@@ -1043,11 +1183,12 @@ void	*recvBundles(void *args)
 	}
 
 	/*	Close the files that recv thread had opened and had
-	 *	rd/rw access.						*/
+	 *	rd/rw access, once the writer thread has stored all
+	 *	frames received.					*/
 
+	stopWriter(db, writerThread);
 	close(db->dat);
-	close(db->lst);
-	close(db->tbl);
+	close(db->idx);
 	bp_close(sap);
 	writeErrmsgMemos();
 	writeMemo("[i] Stopping bss reception thread.");
@@ -1058,291 +1199,247 @@ void	*recvBundles(void *args)
 
 /*	Create/Load database - section		*/
 
-static int	checkDb(int dat, int lst, int tbl)
+static int	checkDb(int dat, bssIndex *index)
 {	
 	dataRecord 	data;
-	lstEntry 	entry;
-	tblIndex 	*index = _tblIndex(NULL);
-	tblHeader	*hdr = &(index->header);
-	char*		payload;
-	int		result;
+	bssEntry	*entry;
+	int		i;
 
-	if (_lockMutex(1) == -1)
-	{
-		return -1;
-	}
-	
-	if (hdr->newestRowIndex != 0)
-	{
-		if (getLstEntry(lst, &entry,
-			index->rows[hdr->oldestRowIndex].firstEntryOffset) < 0)
-		{
-			oK(_lockMutex(0));
-			return -1;
-		}
+	/*	Verifies that the first and last entries in the index
+	 *	match the records in the *.dat file that they refer
+	 *	to.  Returns -1 if they don't.				*/
 
-		if (readRecord(dat, &data, entry.datOffset) < 0)
+	for (i = 0; i < 2 && index->count > 0; i++)
+	{
+		entry = index->entries + index->first
+				+ (i == 0 ? 0 : index->count - 1);
+		if (readRecord(dat, &data, entry->datOffset, NULL, 0) < 0)
 		{
-			oK(_lockMutex(0));
 			return -1;
 		}
-			
-		payload = MTAKE(data.pLen);
-		if (payload == NULL)
-		{
-			oK(_lockMutex(0));
-			return -2;
-		}
 
-		result = readPayload(dat, payload, data.pLen);
-		MRELEASE(payload);			
-		if (result < 0)
-		{
-			oK(_lockMutex(0));
-			return -1;	/*	Unresolved error.	*/
-		}
-
-		if ((hdr->oldestTime != entry.crtnTime.seconds)
-		|| (entry.crtnTime.seconds != data.crtnTime.seconds)
-		|| (entry.crtnTime.count != data.crtnTime.count))
+		if ((entry->crtnTime.seconds != data.crtnTime.seconds)
+		|| (entry->crtnTime.count != data.crtnTime.count)
+		|| (entry->pLen != data.pLen))
 		{
 			/*	Database corruption detected.		*/
 
-			oK(_lockMutex(0));
 			return -1;
 		}
 	}
 
-	oK(_lockMutex(0));
 	return 0;
 }
 
-int	loadRDWRDB(char* bssName, char* path, int* dat, int* lst, int* tbl)
+static int	openDbFiles(char *bssName, char *path, int flags, int *dat,
+			int *idx, char *idxName)
 {
 	char 		fileName[255];
-	long		tblSize;
-	int		create = 1;
-	int		destroy = 0;
-	tblIndex	*index;
 
 	isprintf(fileName, sizeof(fileName), "%s/%s.dat", path, bssName);
-	*dat = open(fileName, O_RDWR | O_CREAT | O_LARGEFILE, 0666);
+	*dat = open(fileName, flags | O_LARGEFILE, 0666);
 	if (*dat < 0)
 	{
 		putSysErrmsg("BSS Library: can't open .dat file", fileName);
 		return -1;
 	}
 
-	isprintf(fileName, sizeof(fileName), "%s/%s.lst", path, bssName);
-	*lst = open(fileName, O_RDWR | O_CREAT, 0666);
-	if (*lst < 0)
+	/*	A database that was created by an earlier version of
+	 *	BSS may have no *.idx file; the index is then rebuilt
+	 *	from the *.dat file.					*/
+
+	isprintf(idxName, 255, "%s/%s.idx", path, bssName);
+	*idx = open(idxName, flags, 0666);
+	return 0;
+}
+
+int	loadRDWRDB(char* bssName, char* path, int* dat, int* idx,
+		off_t *datLength)
+{
+	char		idxName[255];
+	int		create = 1;
+	int		destroy = 0;
+	bssIndex	*index;
+
+	if (openDbFiles(bssName, path, O_RDWR | O_CREAT | O_APPEND, dat, idx,
+			idxName) < 0)
 	{
-		putSysErrmsg("BSS Library: can't open .lst file", fileName);
 		return -1;
 	}
 
-	isprintf(fileName, sizeof(fileName), "%s/%s.tbl", path, bssName);
-	*tbl = open(fileName, O_RDWR | O_CREAT, 0666);
-	if (*tbl < 0)
+	if (*idx < 0)
 	{
-		putSysErrmsg("BSS Library: can't open .tbl file", fileName);
+		putSysErrmsg("BSS Library: can't open .idx file", idxName);
+		close(*dat);
 		return -1;
 	}
-	
-	/*	Checks if DB already exists. If not, initializes the
-	 *	*.tbl file contents.					*/
 
-	tblSize = (long) lseek(*tbl, 0, SEEK_END);
-	if (tblSize < 0)
+	*datLength = lseek(*dat, 0, SEEK_END);
+	if (*datLength < 0)
 	{
-		putSysErrmsg("BSS library: can't seek to the end to .tbl file",
+		putSysErrmsg("BSS library: can't seek to the end of .dat file",
 				NULL);
 		close(*dat);
-		close(*lst);
-		close(*tbl);
+		close(*idx);
 		return -1;
 	}
 
-	index = _tblIndex(&create);
+	index = _bssIndex(&create);
 	if (index == NULL)
 	{
-		putErrmsg("BSS library: can't create table index image.", NULL);
+		putErrmsg("BSS library: can't create index.", NULL);
 		close(*dat);
-		close(*lst);
-		close(*tbl);
+		close(*idx);
 		return -1;
 	}
 
-	if (tblSize == 0)
+	istrcpy(index->idxName, idxName, sizeof index->idxName);
+	if (_lockMutex(1) == -1)
 	{
-		if (initializeTblIndex(*tbl, index) < 0)
-		{
-			oK(_tblIndex(&destroy));
-			close(*dat);
-			close(*lst);
-			close(*tbl);
-			return -1;
-		}
+		oK(_bssIndex(&destroy));
+		close(*dat);
+		close(*idx);
+		return -1;
 	}
-	else
+
+	if (loadIndexLog(index, *idx) < 0)
 	{
-		if (loadTblIndex(*tbl, index) < 0)
-		{
-			oK(_tblIndex(&destroy));
-			close(*dat);
-			close(*lst);
-			close(*tbl);
-			return -1;
-		}
+		oK(_lockMutex(0));
+		oK(_bssIndex(&destroy));
+		close(*dat);
+		close(*idx);
+		return -1;
 	}
 
-	/*	Database's integrity check				*/
+	/*	Database's integrity check.  If the index doesn't
+	 *	match the data, rebuild it from the data.		*/
 
-	if (checkDb(*dat, *lst, *tbl) == -1)
+	if ((index->count == 0 && *datLength > 0)
+	|| checkDb(*dat, index) < 0)
 	{
-		putErrmsg("Database is corrupted. Use recovery mode.", NULL);
-		oK(_tblIndex(&destroy));
-		close(*dat);
-		close(*lst);
-		close(*tbl);
-		return -1;
+		writeMemoNote("[i] Rebuilding BSS index", idxName);
+		if (rebuildIndex(index, *dat) < 0
+		|| compactIndexLog(index, idx) < 0)
+		{
+			putErrmsg("Database is corrupted.", idxName);
+			oK(_lockMutex(0));
+			oK(_bssIndex(&destroy));
+			close(*dat);
+			close(*idx);
+			return -1;
+		}
 	}
 
+	oK(_lockMutex(0));
 	return 0;
 }
 
 int	loadRDonlyDB(char* bssName, char* path)
 {
-	char		fileName[255];
+	char		idxName[255];
 	int		datRO;
-	int		lstRO;
-	int		tblRO;
-	tblIndex	*index;
+	int		idxRO;
+	bssIndex	*index;
 	int		create = 1;
 	int		destroy = 0;
+	int		result = 0;
 
-	isprintf(fileName, sizeof(fileName), "%s/%s.dat", path, bssName);
-	datRO = open(fileName, O_RDONLY | O_LARGEFILE, 0666);
-	if (datRO < 0)
+	if (openDbFiles(bssName, path, O_RDONLY, &datRO, &idxRO, idxName) < 0)
 	{
-		putSysErrmsg("BSS Library: can't open .dat file", fileName);
 		return -1;
 	}
 
-	isprintf(fileName, sizeof(fileName), "%s/%s.lst", path, bssName);
-	lstRO = open(fileName, O_RDONLY, 0666);
-	if (lstRO < 0)
-	{
-		putSysErrmsg("BSS Library: can't open .lst file", fileName);
-		return -1;
-	}
+	oK(_datFile(1, datRO));
+	oK(_idxFile(1, idxRO));
+
+	/*	If this process is also receiving the stream, the
+	 *	receiver's index is shared.				*/
 
-	isprintf(fileName, sizeof(fileName), "%s/%s.tbl", path, bssName);
-	tblRO = open(fileName, O_RDONLY, 0666);
-	if (tblRO < 0)
+	if (_recvThreadId(NULL, 0))
 	{
-		putSysErrmsg("BSS Library: can't open .tbl file", fileName);
-		return -1;
+		return 0;
 	}
 
-	oK(_datFile(1, datRO));
-	oK(_lstFile(1, lstRO));
-	oK(_tblFile(1, tblRO));
-	index = _tblIndex(&create);
+	index = _bssIndex(&create);
 	if (index == NULL)
 	{
-		putErrmsg("BSS library: can't create table index image.", NULL);
+		putErrmsg("BSS library: can't create index.", NULL);
 		oK(_datFile(-1,0));
-		oK(_lstFile(-1,0));
-		oK(_tblFile(-1,0));
+		oK(_idxFile(-1,0));
 		return -1;
 	}
 
-	if (loadTblIndex(tblRO, index) < 0)
+	istrcpy(index->idxName, idxName, sizeof index->idxName);
+	if (idxRO < 0)
 	{
-		oK(_tblIndex(&destroy));
-		return -1;
+		result = rebuildIndex(index, datRO);
+	}
+	else
+	{
+		result = loadIndexLog(index, idxRO);
+		if (result == 0 && checkDb(datRO, index) < 0)
+		{
+			result = rebuildIndex(index, datRO);
+		}
 	}
-	
-	/*	Database's integrity check	*/
 
-	if (checkDb(_datFile(0,0), _lstFile(0,0), _tblFile(0,0)) == -1)
+	if (result < 0)
 	{
-		putErrmsg("Database is corrupted. Use recovery mode.", NULL);
-		oK(_tblIndex(&destroy));
+		putErrmsg("Database is corrupted.", idxName);
+		oK(_bssIndex(&destroy));
+		oK(_datFile(-1,0));
+		oK(_idxFile(-1,0));
 		return -1;
 	}
 
 	return 0;
 }
 
-/*	Database navigation - section	*/
-
-void	findIndexRow(time_t time, long *position)
+int	refreshIndex()
 {
+	bssIndex	*index = _bssIndex(NULL);
+	int		idx = _idxFile(0, 0);
+	struct stat	fileStats;
+	struct stat	fdStats;
+
 	/*
-	 *  This function locates the first active second in the database
-	 *  that is on or after the specified time, placing that second's
-	 *  row number in *position.  If no such second exists in the database,
-	 *  *position is set to -1.
+	 *  Brings a playback session's index up to date with the
+	 *  *.idx file that is being appended to by a BSS receiver
+	 *  in another process.  If that receiver has compacted the
+	 *  file (replacing it), the index is reloaded from scratch.
 	 */
 
-	tblIndex	*index = _tblIndex(NULL);
-	tblHeader	*hdr;
-	int		i;
-
-	CHKVOID(position);
-	CHKVOID(index);
-	hdr = &(index->header);
-	if (hdr->oldestTime == 0	/*	Empty database.		*/
-	|| time > hdr->newestTime)	/*	Hasn't happened yet.	*/
+	CHKERR(index);
+	if (_recvThreadId(NULL, 0) || idx < 0)
 	{
-		*position = -1;
-		return;			/*	No such entry.		*/
+		return 0;	/*	Index is shared or static.	*/
 	}
 
-	/*	Find earliest second on or after the specified time.	*/
-
-	if (time < hdr->oldestTime)
-	{
-		i = hdr->oldestRowIndex;
-	}
-	else
+	if (stat(index->idxName, &fileStats) < 0
+	|| fstat(idx, &fdStats) < 0)
 	{
-		i = hdr->oldestRowIndex + (time - hdr->oldestTime);
-		if (i >= WINDOW)		/*	Wrap around.	*/
-		{
-			i -= WINDOW;
-		}
+		return 0;	/*	Can't tell; use index as is.	*/
 	}
 
-	/*	Search for a second with some activity.			*/
-
-	while (1)
+	if (fileStats.st_ino != fdStats.st_ino
+	|| fileStats.st_size < index->idxLength)
 	{
-		if (index->rows[i].firstEntryOffset < 0)
+		idx = open(index->idxName, O_RDONLY, 0666);
+		if (idx < 0)
 		{
-			/*	Inactive.  Try next second, if any.	*/
-
-			if (i == hdr->newestRowIndex)
-			{
-				*position = -1;
-				return;		/*	No such entry.	*/
-			}
-
-			i++;
-			if (i == WINDOW)	/*	Wrap around.	*/
-			{
-				i = 0;
-			}
-
-			continue;
+			putSysErrmsg("BSS Library: can't open .idx file",
+					index->idxName);
+			return -1;
 		}
 
-		break;				/*	Found it.	*/
+		oK(_idxFile(-1, 0));
+		oK(_idxFile(1, idx));
+		clearIndex(index);
 	}
-#if BSSLIBDEBUG
-printf("oldestTime: %lu >= time: %lu\n", hdr->oldestTime + i, time);
-#endif
-	*position = i;
+	else if (fileStats.st_size == index->idxLength)
+	{
+		return 0;	/*	Nothing new.			*/
+	}
+
+	return loadIndexLog(index, idx);
 }
@@ -12,6 +12,11 @@
 #define	CFDP_SEND_SVC_NBR	(64)
 #define	CFDP_RECV_SVC_NBR	(65)
 
+/*	Maximum number of PDUs dequeued (in a single transaction)
+ *	for each cycle of transmission.					*/
+
+#define	BPUTA_BATCH_SIZE	(16)
+
 typedef struct
 {
 	pthread_t	mainThread;
@@ -108,6 +113,11 @@ static void	*receivePdus(void *parm)
 		sm_TaskYield();
 	}
 
+	if (cfdpFlushInboundData() < 0)
+	{
+		putErrmsg("bputa can't flush inbound file data.", NULL);
+	}
+
 	bp_close(parms->rxSap);
 	MRELEASE(buffer);
 	writeMemo("[i] bputa input has stopped.");
@@ -116,6 +126,71 @@ static void	*receivePdus(void *parm)
 
 /*	*	*	Main thread functions	*	*	*	*/
 
+static int	sendPdu(BpSAP txSap, Object pduZco, OutFdu *fduBuffer,
+			Object *newBundle)
+{
+	BpUtParms	utParms;
+	uvast		destinationNodeNbr;
+	char		destEid[64];
+	char		reportToEidBuf[64];
+	char		*reportToEid;
+
+	/*	Determine quality of service for transmission.	*/
+
+	if (fduBuffer->utParmsLength == sizeof(BpUtParms))
+	{
+		memcpy((char *) &utParms, (char *) &fduBuffer->utParms,
+				sizeof(BpUtParms));
+	}
+	else
+	{
+		memset((char *) &utParms, 0, sizeof(BpUtParms));
+		utParms.reportToNodeNbr = 0;
+		utParms.lifespan = 86400;	/*	1 day.		*/
+		utParms.classOfService = BP_STD_PRIORITY;
+		utParms.custodySwitch = NoCustodyRequested;
+		utParms.srrFlags = 0;
+		utParms.ackRequested = 0;
+		utParms.extendedCOS.flowLabel = 0;
+		utParms.extendedCOS.flags = 0;
+		utParms.extendedCOS.ordinal = 0;
+	}
+
+	cfdp_decompress_number(&destinationNodeNbr,
+			&fduBuffer->destinationEntityNbr);
+	if (destinationNodeNbr == 0)
+	{
+		writeMemo("[?] bputa declining to send to node 0.");
+		return 0;
+	}
+
+	isprintf(destEid, sizeof destEid, "ipn:" UVAST_FIELDSPEC ".%u",
+			destinationNodeNbr, CFDP_RECV_SVC_NBR);
+	if (utParms.reportToNodeNbr == 0)
+	{
+		reportToEid = NULL;
+	}
+	else
+	{
+		isprintf(reportToEidBuf, sizeof reportToEidBuf,
+				"ipn:" UVAST_FIELDSPEC ".%u",
+				utParms.reportToNodeNbr, CFDP_RECV_SVC_NBR);
+		reportToEid = reportToEidBuf;
+	}
+
+	/*	Send PDU in a bundle.					*/
+
+	if (bp_send(txSap, destEid, reportToEid, utParms.lifespan,
+			utParms.classOfService, utParms.custodySwitch,
+			utParms.srrFlags, utParms.ackRequested,
+			&utParms.extendedCOS, pduZco, newBundle) <= 0)
+	{
+		return -1;
+	}
+
+	return 0;
+}
+
 #if defined (VXWORKS) || defined (RTEMS) || defined (bionic)
 int	bputa(int a1, int a2, int a3, int a4, int a5,
 		int a6, int a7, int a8, int a9, int a10)
@@ -130,14 +205,11 @@ int	main(int argc, char **argv)
 	Sdr		sdr;
 	pthread_t	rxThread;
 	int		haveRxThread = 0;
-	Object		pduZco;
-	OutFdu		fduBuffer;
-	BpUtParms	utParms;
-	uvast		destinationNodeNbr;
-	char		destEid[64];
-	char		reportToEidBuf[64];
-	char		*reportToEid;
-	Object		newBundle;
+	Object		pduZcos[BPUTA_BATCH_SIZE];
+	OutFdu		fduBuffers[BPUTA_BATCH_SIZE];
+	Object		newBundles[BPUTA_BATCH_SIZE];
+	int		pduCount;
+	int		i;
 	Object		pduElt;
 
 	if (bp_attach() < 0)
@@ -181,9 +253,12 @@ int	main(int argc, char **argv)
 	writeMemo("[i] bputa is running.");
 	while (parms.running)
 	{
-		/*	Get an outbound CFDP PDU for transmission.	*/
+		/*	Get a batch of outbound CFDP PDUs for
+		 *	transmission.					*/
 
-		if (cfdpDequeueOutboundPdu(&pduZco, &fduBuffer) < 0)
+		pduCount = cfdpDequeueOutboundPdus(pduZcos, fduBuffers,
+				BPUTA_BATCH_SIZE);
+		if (pduCount < 0)
 		{
 			writeMemo("[?] bputa can't dequeue outbound CFDP PDU; \
 terminating.");
@@ -191,69 +266,25 @@ terminating.");
 			continue;
 		}
 
-		/*	Determine quality of service for transmission.	*/
-
-		if (fduBuffer.utParmsLength == sizeof(BpUtParms))
-		{
-			memcpy((char *) &utParms, (char *) &fduBuffer.utParms,
-					sizeof(BpUtParms));
-		}
-		else
-		{
-			memset((char *) &utParms, 0, sizeof(BpUtParms));
-			utParms.reportToNodeNbr = 0;
-			utParms.lifespan = 86400;	/*	1 day.	*/
-			utParms.classOfService = BP_STD_PRIORITY;
-			utParms.custodySwitch = NoCustodyRequested;
-			utParms.srrFlags = 0;
-			utParms.ackRequested = 0;
-			utParms.extendedCOS.flowLabel = 0;
-			utParms.extendedCOS.flags = 0;
-			utParms.extendedCOS.ordinal = 0;
-		}
-
-		cfdp_decompress_number(&destinationNodeNbr,
-				&fduBuffer.destinationEntityNbr);
-		if (destinationNodeNbr == 0)
-		{
-			writeMemo("[?] bputa declining to send to node 0.");
-			continue;
-		}
-
-		isprintf(destEid, sizeof destEid, "ipn:" UVAST_FIELDSPEC ".%u",
-				destinationNodeNbr, CFDP_RECV_SVC_NBR);
-		if (utParms.reportToNodeNbr == 0)
-		{
-			reportToEid = NULL;
-		}
-		else
+		for (i = 0; i < pduCount; i++)
 		{
-			isprintf(reportToEidBuf, sizeof reportToEidBuf,
-					"ipn:" UVAST_FIELDSPEC ".%u",
-					utParms.reportToNodeNbr,
-					CFDP_RECV_SVC_NBR);
-			reportToEid = reportToEidBuf;
-		}
-
-		/*	Send PDU in a bundle.				*/
-
-		newBundle = 0;
-		if (bp_send(txSap, destEid, reportToEid, utParms.lifespan,
-				utParms.classOfService, utParms.custodySwitch,
-				utParms.srrFlags, utParms.ackRequested,
-				&utParms.extendedCOS, pduZco, &newBundle) <= 0)
-		{
-			putErrmsg("bputa can't send PDU in bundle; terminated.",
-					NULL);
-			parms.running = 0;
-		}
+			newBundles[i] = 0;
+			if (parms.running == 0)
+			{
+				continue;
+			}
 
-		if (newBundle == 0)
-		{
-			continue;	/*	Must have stopped.	*/
+			if (sendPdu(txSap, pduZcos[i], fduBuffers + i,
+					newBundles + i) < 0)
+			{
+				putErrmsg("bputa can't send PDU in bundle; \
+terminated.", NULL);
+				parms.running = 0;
+			}
 		}
 
-		/*	Enable cancellation of this PDU.		*/
+		/*	Enable cancellation of the PDUs that were sent,
+		 *	and destroy those that weren't.			*/
 
 		if (sdr_begin_xn(sdr) == 0)
 		{
@@ -261,11 +292,20 @@ terminating.");
 			continue;
 		}
 
-		pduElt = sdr_list_insert_last(sdr, fduBuffer.extantPdus,
-				newBundle);
-		if (pduElt)
+		for (i = 0; i < pduCount; i++)
 		{
-			bp_track(newBundle, pduElt);
+			if (newBundles[i] == 0)	/*	Not sent.	*/
+			{
+				zco_destroy(sdr, pduZcos[i]);
+				continue;
+			}
+
+			pduElt = sdr_list_insert_last(sdr,
+					fduBuffers[i].extantPdus, newBundles[i]);
+			if (pduElt)
+			{
+				bp_track(newBundles[i], pduElt);
+			}
 		}
 
 		if (sdr_end_xn(sdr) < 0)
@@ -93,10 +93,24 @@ typedef struct
 	Object			recordLengths;	/*	sdrlist		*/
 	Object			eofPdu;		/*	ZCO reference	*/
 	Object			extantPdus;	/*	sdrlist		*/
+
+	/*	A "streaming" FDU has no list of record lengths.  Its
+	 *	file data PDUs are cut, at the maximum file data
+	 *	length, as they are issued; the checksum is computed
+	 *	from the data of each PDU as it is cut and is written
+	 *	into the EOF PDU when the last PDU has been cut.	*/
+
+	int			streaming;	/*	Boolean		*/
+	unsigned int		checksum;	/*	so far		*/
+	Object			eofText;	/*	EOF PDU content	*/
 } OutFdu;
 
 /*	Each CfdpExtent in "extents" indicates a range of bytes of file
- *	data received so far in the course of receiving this FDU.  The
+ *	data received so far in the course of receiving this FDU; note
+ *	that the extents list, bytesReceived, and computedChecksum of
+ *	the FDU that is currently being reassembled are updated only
+ *	periodically, as buffered file data are written (see "Inbound
+ *	file data buffering" in libcfdpP.c).  The
  *	extents list in the InFdu is managed in ascending offset
  *	order.  The arrival of a file data PDU creates a CfdpExtent
  *	if necessary but merely increases the length of an existing
@@ -185,6 +199,7 @@ typedef struct
 	unsigned short	discardIncompleteFile;		/*	Boolean	*/
 	unsigned short	crcRequired;			/*	Boolean	*/
 	unsigned short	maxFileDataLength;
+	unsigned short	streamingFdus;			/*	Boolean	*/
 	unsigned int	transactionInactivityLimit;
 	unsigned int	checkTimerPeriod;
 	unsigned int	checkTimeoutLimit;
@@ -201,6 +216,13 @@ typedef struct
 	Object		entities;	/*	SDR list: Entity	*/
 } CfdpDB;
 
+/*	Number of PDUs an outbound FDU may issue in each turn of
+ *	the transmission scheduler, by priority class.			*/
+
+#define	CFDP_BULK_QUANTUM	(1)
+#define	CFDP_STD_QUANTUM	(4)
+#define	CFDP_EXPEDITED_QUANTUM	(16)
+
 /*	The volatile database object encapsulates the current volatile
 	state of the database.						*/
 
@@ -225,6 +247,18 @@ typedef struct
 
 	sm_SemId	fduSemaphore;
 
+	/*	Outbound FDUs are served in weighted round-robin
+	 *	order.  currentOutFdu is the element of the
+	 *	outboundFdus list for the FDU from which PDUs are
+	 *	currently being issued, and outFduCredit is the
+	 *	number of further PDUs that FDU may issue before the
+	 *	next FDU in the list gets its turn.  Each FDU's
+	 *	credit for a turn is the quantum of its priority
+	 *	class, i.e., the class of service in its UT parms.	*/
+
+	Object		currentOutFdu;
+	int		outFduCredit;
+
 	/*	currentFdu identifies the FDU that is currently being
 	 *	reassembled, if any.  currentFile is the FD that is
 	 *	being used to reassemble that FDU.			*/
@@ -271,6 +305,17 @@ extern int		checkFile(char *);
 
 extern void		addToChecksum(unsigned char octet, unsigned int *offset,
 				unsigned int *checksum);
+extern void		addBytesToChecksum(unsigned char *buffer, int length,
+				unsigned int *offset, unsigned int *checksum);
+
+#define	CFDP_CRC_INIT	(0xffff)
+extern unsigned short	updateCRC(unsigned short crc, unsigned char *buffer,
+				int length);
+			/*	Advances the CRC-CCITT of a PDU over
+			 *	the next "length" octets of the PDU,
+			 *	so that a CRC can be computed over
+			 *	discontiguous data.  Start with crc
+			 *	equal to CFDP_CRC_INIT.			*/
 
 extern int		getReqNbr();	/*	Returns next req nbr.	*/
 
@@ -299,7 +344,22 @@ extern int		handleFault(CfdpTransactionId *id, CfdpCondition c,
 				CfdpHandler *handler);
 
 extern int		cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer);
+extern int		cfdpDequeueOutboundPdus(Object *pdus,
+				OutFdu *fduBuffers, int maxPdus);
+			/*	Dequeues up to maxPdus outbound PDUs,
+			 *	in a single transaction, blocking
+			 *	until at least one is available.  The
+			 *	FDU from which each PDU was issued is
+			 *	copied into the corresponding element
+			 *	of fduBuffers.  Returns the number of
+			 *	PDUs dequeued, or -1 on any error.	*/
 extern int		cfdpHandleInboundPdu(unsigned char *buf, int length);
+extern int		cfdpFlushInboundData();
+			/*	Writes all buffered inbound file data
+			 *	and records the corresponding reception
+			 *	status in the database.  Must be called
+			 *	by the task that handles inbound PDUs
+			 *	before it stops.			*/
 
 #ifdef __cplusplus
 }
@@ -146,14 +146,22 @@ void	cfdp_update_checksum(unsigned char octet, unsigned int *offset,
 	addToChecksum(octet, offset, checksum);
 }
 
+void	cfdp_update_checksum_buffer(unsigned char *buffer, int length,
+		unsigned int *offset, unsigned int *checksum)
+{
+	CHKVOID(buffer);
+	CHKVOID(length >= 0);
+	CHKVOID(offset);
+	CHKVOID(checksum);
+	addBytesToChecksum(buffer, length, offset, checksum);
+}
+
 static int	defaultReader(int fd, unsigned int *checksum)
 {
 	static char	defaultReaderBuf[CFDP_MAX_PDU_SIZE];
 	CfdpDB		*cfdpConstants = getCfdpConstants();
 	unsigned int	offset;
 	int		length;
-	int		i;
-	char		*octet;
 
 	offset = (unsigned int) lseek(fd, 0, SEEK_CUR);
 	if (offset == (unsigned int) -1)
@@ -169,11 +177,8 @@ static int	defaultReader(int fd, unsigned int *checksum)
 		return -1;
 	}
 
-	for (i = 0, octet = defaultReaderBuf; i < length; i++, octet++)
-	{
-		addToChecksum((unsigned char) *octet, &offset, checksum);
-	}
-
+	addBytesToChecksum((unsigned char *) defaultReaderBuf, length, &offset,
+			checksum);
 	return length;
 }
 
@@ -183,7 +188,6 @@ int	cfdp_read_space_packets(int fd, unsigned int *checksum)
 	CfdpDB		*cfdpConstants = getCfdpConstants();
 	unsigned int	offset;
 	int		length;
-	int		i;
 	char		*octet;
 	unsigned int	recordLen;
 	unsigned short	pktlen;
@@ -259,10 +263,8 @@ int	cfdp_read_space_packets(int fd, unsigned int *checksum)
 
 	/*	Add record to checksum.					*/
 
-	for (i = 0, octet = pktReaderBuf; i < length; i++, octet++)
-	{
-		addToChecksum((unsigned char) *octet, &offset, checksum);
-	}
+	addBytesToChecksum((unsigned char *) pktReaderBuf, length, &offset,
+			checksum);
 
 	return length;
 }
@@ -323,10 +325,8 @@ int	cfdp_read_text_lines(int fd, unsigned int *checksum)
 
 	/*	Add record to checksum.					*/
 
-	for (i = 0, octet = textReaderBuf; i < length; i++, octet++)
-	{
-		addToChecksum((unsigned char) *octet, &offset, checksum);
-	}
+	addBytesToChecksum((unsigned char *) textReaderBuf, length, &offset,
+			checksum);
 
 	return length;
 }
@@ -1056,9 +1056,77 @@ static int	constructEofPdu(OutFdu *fdu, unsigned int checksum)
 	}
 
 	sdr_write(sdr, obj, (char *) eofBuf, sizeof eofBuf);
+	fdu->eofText = obj;
 	return 0;
 }
 
+static int	noteRecordLengths(OutFdu *fdu, int sourceFile,
+			CfdpReaderFn readerFn, unsigned int *checksum,
+			char *sourceFileName)
+{
+	Sdr		sdr = getIonsdr();
+	int		recordLength;
+	CfdpHandler	handler;
+
+	/*	Returns 1 on success, 0 if the FDU is to be canceled,
+	 *	-1 on any system error.					*/
+
+	fdu->recordLengths = sdr_list_create(sdr);
+	if (fdu->recordLengths == 0)
+	{
+		putErrmsg("CFDP can't create list of lengths.", NULL);
+		return -1;
+	}
+
+	while (1)
+	{
+		recordLength = readerFn(sourceFile, checksum);
+		if (recordLength < 0)
+		{
+			putErrmsg("CFDP failed reading records.",
+					sourceFileName);
+			return -1;
+		}
+
+		if (recordLength == 0)
+		{
+			if (lseek(sourceFile, 0, SEEK_CUR) == fdu->fileSize)
+			{
+				return 1;	/*	No more records.*/
+			}
+
+			/*	Stopped before end of file.		*/
+
+			if (handleFault(&fdu->transactionId,
+					CfdpInvalidFileStructure, &handler) < 0)
+			{
+				putErrmsg("Can't segment file.", NULL);
+				return -1;
+			}
+
+			switch (handler)
+			{
+			case CfdpCancel:
+			case CfdpAbandon:
+				return 0;	/*	Done.		*/
+
+			default:		/*	No problem.	*/
+				return 1;	/*	No more records.*/
+			}
+		}
+
+		/*	Note length of this record.			*/
+
+		if (sdr_list_insert_last(sdr, fdu->recordLengths,
+				recordLength) == 0)
+		{
+			putErrmsg("CFDP failed noting record lengths.",
+					sourceFileName);
+			return -1;
+		}
+	}
+}
+
 int	createFDU(CfdpNumber *destinationEntityNbr, unsigned int utParmsLength,
 		unsigned char *utParms, char *sourceFileName,
 		char *destFileName, CfdpReaderFn readerFn,
@@ -1075,9 +1143,8 @@ int	createFDU(CfdpNumber *destinationEntityNbr, unsigned int utParmsLength,
 	int		recordBoundariesRespected = 1;
 	int		sourceFile;
 	long		fileSize;
-	int		recordLength;
+	int		result;
 	unsigned int	checksum = 0;
-	CfdpHandler	handler;
 	CfdpDB		db;
 	Object		fduObj;
 	CfdpEvent	event;
@@ -1170,7 +1237,14 @@ int	createFDU(CfdpNumber *destinationEntityNbr, unsigned int utParmsLength,
 		if (readerFn == NULL)
 		{
 			recordBoundariesRespected = 0;
-			readerFn = defaultReader;
+			if ((getCfdpConstants())->streamingFdus)
+			{
+				fdu.streaming = 1;
+			}
+			else
+			{
+				readerFn = defaultReader;
+			}
 		}
 
 		sourceFile = iopen(sourceFileName, O_RDONLY, 0);
@@ -1201,76 +1275,25 @@ int	createFDU(CfdpNumber *destinationEntityNbr, unsigned int utParmsLength,
 			return -1;
 		}
 
-		fdu.recordLengths = sdr_list_create(sdr);
-		if (fdu.recordLengths == 0)
+		if (fdu.streaming)
 		{
+			/*	File data PDUs will be cut, and the
+			 *	checksum computed, as the PDUs are
+			 *	issued; no need to read the file now.	*/
+
 			close(sourceFile);
-			sdr_cancel_xn(sdr);
-			putErrmsg("CFDP can't create list of lengths.", NULL);
-			return -1;
 		}
-
-		while (1)
+		else
 		{
-			recordLength = readerFn(sourceFile, &checksum);
-			if (recordLength < 0)
-			{
-				close(sourceFile);
-				sdr_cancel_xn(sdr);
-				putErrmsg("CFDP failed reading records.",
-						sourceFileName);
-				return -1;
-			}
-
-			if (recordLength == 0)
-			{
-				if (lseek(sourceFile, 0, SEEK_CUR)
-						== fdu.fileSize)
-				{
-					break;	/*	No more records.*/
-				}
-
-				/*	Stopped before end of file.	*/
-
-				if (handleFault(&fdu.transactionId,
-						CfdpInvalidFileStructure,
-						&handler) < 0)
-				{
-					close(sourceFile);
-					sdr_cancel_xn(sdr);
-					putErrmsg("Can't segment file.", NULL);
-					return -1;
-				}
-
-				switch (handler)
-				{
-				case CfdpCancel:
-				case CfdpAbandon:
-					close(sourceFile);
-					sdr_cancel_xn(sdr);
-					return 0;	/*	Done.	*/
-
-				default:	/*	No problem.	*/
-					break;	/*	Out of switch.	*/
-				}
-
-				break;		/*	No more records.*/
-			}
-
-			/*	Note length of this record.		*/
-
-			if (sdr_list_insert_last(sdr, fdu.recordLengths,
-					recordLength) == 0)
+			result = noteRecordLengths(&fdu, sourceFile, readerFn,
+					&checksum, sourceFileName);
+			close(sourceFile);
+			if (result < 1)
 			{
-				close(sourceFile);
 				sdr_cancel_xn(sdr);
-				putErrmsg("CFDP failed noting record lengths.",
-						sourceFileName);
-				return -1;
+				return result;
 			}
 		}
-
-		close(sourceFile);
 	}
 
 	/*	Prepare for construction of PDUs for this FDU.		*/
@@ -228,6 +228,77 @@ void	addToChecksum(unsigned char octet, unsigned int *offset,
 	(*offset)++;
 }
 
+void	addBytesToChecksum(unsigned char *buffer, int length,
+		unsigned int *offset, unsigned int *checksum)
+{
+	unsigned char	*cursor = buffer;
+	unsigned char	*end = buffer + length;
+	unsigned char	*words;
+	unsigned int	sum = *checksum;
+	unsigned int	lane0 = 0;
+	unsigned int	lane1 = 0;
+	unsigned int	lane2 = 0;
+	unsigned int	lane3 = 0;
+
+	/*	The checksum is the modulo-2^32 sum of the file's
+	 *	content taken as 4-byte big-endian words, each aligned
+	 *	on a 4-byte boundary from the start of the file.  Since
+	 *	shifting distributes over modular addition, the sum of
+	 *	the words equals the sum of the first octets of all
+	 *	words shifted left 24 bits, plus the sum of all second
+	 *	octets shifted left 16 bits, and so on.  So we sum the
+	 *	octets in each of the four "lanes" of the words
+	 *	separately -- a loop that the compiler can turn into
+	 *	SIMD byte additions -- and fold the lane sums into
+	 *	the checksum once, at the end.
+	 *
+	 *	First, the unaligned head of the buffer.		*/
+
+	while (cursor < end && (*offset & 0x03) != 0)
+	{
+		sum += ((unsigned int) *cursor)
+				<< ((3 - (*offset & 0x03)) << 3);
+		cursor++;
+		(*offset)++;
+	}
+
+	/*	Then the aligned words, four at a time.			*/
+
+	words = cursor;
+	while (end - cursor >= 16)
+	{
+		lane0 += cursor[0] + cursor[4] + cursor[8] + cursor[12];
+		lane1 += cursor[1] + cursor[5] + cursor[9] + cursor[13];
+		lane2 += cursor[2] + cursor[6] + cursor[10] + cursor[14];
+		lane3 += cursor[3] + cursor[7] + cursor[11] + cursor[15];
+		cursor += 16;
+	}
+
+	while (end - cursor >= 4)
+	{
+		lane0 += cursor[0];
+		lane1 += cursor[1];
+		lane2 += cursor[2];
+		lane3 += cursor[3];
+		cursor += 4;
+	}
+
+	sum += (lane0 << 24) + (lane1 << 16) + (lane2 << 8) + lane3;
+	*offset += cursor - words;
+
+	/*	Finally the unaligned tail.				*/
+
+	while (cursor < end)
+	{
+		sum += ((unsigned int) *cursor)
+				<< ((3 - (*offset & 0x03)) << 3);
+		cursor++;
+		(*offset)++;
+	}
+
+	*checksum = sum;
+}
+
 int	getReqNbr()
 {
 	Sdr	sdr = getIonsdr();
@@ -241,23 +312,22 @@ int	getReqNbr()
 	return db.requestCounter;
 }
 
-static unsigned char	*_crcComputationBuf()
+static unsigned short	*_crcTables()
 {
-	static unsigned char	buffer[CFDP_MAX_PDU_SIZE];
-
-	return buffer;
-}
+	static int		crcTablesInitialized = 0;
+	static unsigned short	crcTables[8][256];
+	int			i;
+	int			k;
+	unsigned int		tmp;
 
-static unsigned short	computeCRC(unsigned char *buffer, int length)
-{
-	static int		crcCalcValuesInitialized = 0;
-    	int			i;
-    	unsigned int		tmp;
-	static unsigned int	crcCalcValues[256];
-	unsigned char		*cursor = buffer;
-	unsigned int		crc = 0xffff;
+	/*	crcTables[0] is the conventional byte-at-a-time table
+	 *	for CRC-CCITT (polynomial 0x1021).  crcTables[k][b] is
+	 *	the CRC register that results from processing octet
+	 *	b followed by k octets of zero, starting from a zero
+	 *	register; these tables enable the CRC to be advanced
+	 *	by 8 octets at a time ("slicing by 8").			*/
 
-	if (!crcCalcValuesInitialized)
+	if (!crcTablesInitialized)
 	{
 		for (i = 0; i < 256; i++)
 		{
@@ -270,21 +340,59 @@ static unsigned short	computeCRC(unsigned char *buffer, int length)
 			if ((i & 32) != 0) tmp = tmp ^ 0x2462;
 			if ((i & 64) != 0) tmp = tmp ^ 0x48c4;
 			if ((i & 128) != 0) tmp = tmp ^ 0x9188;
-			crcCalcValues[i] = tmp;
+			crcTables[0][i] = tmp;
+		}
+
+		for (k = 1; k < 8; k++)
+		{
+			for (i = 0; i < 256; i++)
+			{
+				tmp = crcTables[k - 1][i];
+				crcTables[k][i] = ((tmp << 8) & 0xff00)
+					^ crcTables[0][(tmp >> 8) & 0xff];
+			}
 		}
 
-		crcCalcValuesInitialized = 1;
+		crcTablesInitialized = 1;
 	}
 
+	return (unsigned short *) crcTables;
+}
+
+unsigned short	updateCRC(unsigned short crc, unsigned char *buffer,
+			int length)
+{
+	unsigned short	*tables = _crcTables();
+	unsigned short	*t0 = tables;
+	unsigned char	*cursor = buffer;
+	unsigned int	reg = crc;
+
+#define	T(k, octet)	tables[((k) << 8) + (octet)]
+	while (length >= 8)
+	{
+		reg = T(7, cursor[0] ^ (reg >> 8))
+			^ T(6, cursor[1] ^ (reg & 0xff))
+			^ T(5, cursor[2]) ^ T(4, cursor[3])
+			^ T(3, cursor[4]) ^ T(2, cursor[5])
+			^ T(1, cursor[6]) ^ T(0, cursor[7]);
+		cursor += 8;
+		length -= 8;
+	}
+#undef	T
+
 	while (length > 0)
 	{
-	    crc = (((crc << 8) & 0xff00)
-			^ crcCalcValues[(((crc >> 8) ^ (*cursor)) & 0x00ff)]);
-	    cursor++;
-	    length--;
+		reg = ((reg << 8) & 0xff00) ^ t0[((reg >> 8) ^ *cursor) & 0xff];
+		cursor++;
+		length--;
 	}
 
-	return crc;
+	return reg;
+}
+
+static unsigned short	computeCRC(unsigned char *buffer, int length)
+{
+	return updateCRC(CFDP_CRC_INIT, buffer, length);
 }
 
 /*	*	*	CFDP service control functions	*	*	*/
@@ -429,6 +537,7 @@ int	cfdpInit()
 		cfdpdbBuf.discardIncompleteFile = 1;
 		cfdpdbBuf.crcRequired = 0;
 		cfdpdbBuf.maxFileDataLength = 65000;
+		cfdpdbBuf.streamingFdus = 1;
 		cfdpdbBuf.transactionInactivityLimit = 86400;
 		cfdpdbBuf.checkTimerPeriod = 86400;	/*	1 day.	*/
 		cfdpdbBuf.checkTimeoutLimit = 7;
@@ -1234,6 +1343,11 @@ void	destroyOutFdu(OutFdu *fdu, Object fduObj, Object fduElt)
 		zco_destroy_file_ref(sdr, fdu->fileRef);
 	}
 
+	if (_cfdpvdb(NULL)->currentOutFdu == fduElt)
+	{
+		_cfdpvdb(NULL)->currentOutFdu = 0;
+	}
+
 	sdr_free(sdr, fduObj);
 	sdr_list_delete(sdr, fduElt, NULL, NULL);
 }
@@ -1271,172 +1385,654 @@ static int	abandonOutFdu(CfdpTransactionId *transactionId,
 	return event.reqNbr;
 }
 
-void	destroyInFdu(InFdu *fdu, Object fduObj, Object fduElt)
+/*	*	*	Inbound file data buffering	*	*	*	*/
+
+/*	File data received for the FDU that is currently being
+ *	reassembled are not written to the file PDU by PDU.  Instead,
+ *	contiguous new data are accumulated in a write-behind buffer
+ *	and written to the file in a single operation, and the
+ *	extents of data received so far are tracked in a sorted
+ *	array in memory rather than in the FDU's non-volatile list
+ *	of extents.  The number of new bytes received and their
+ *	contribution to the checksum (which, being a modular sum,
+ *	can be accumulated in any order) are likewise held in
+ *	memory.  All of this reception state is "synced" -- the
+ *	buffered data written to the file, and the extents, byte
+ *	count, and checksum recorded in the InFdu -- every
+ *	CFDP_SYNC_INTERVAL file data PDUs, whenever reception
+ *	switches to another FDU, and whenever the FDU may be
+ *	complete.  So the non-volatile state of the FDU never
+ *	reflects data that are not in the file.  This state is
+ *	private to the task that handles inbound PDUs.		*/
+
+#define	CFDP_WRITE_BUFFER_SIZE	(256 * 1024)
+#define	CFDP_SYNC_INTERVAL	(64)
+
+typedef struct
 {
-	Sdr	sdr = getIonsdr();
-	CfdpVdb	*cfdpvdb = _cfdpvdb(NULL);
-	Object	elt;
-	Object	obj;
-		OBJ_POINTER(MsgToUser, msg);
-		OBJ_POINTER(FilestoreRequest, req);
+	Object		fduObj;		/*	0 if none.		*/
+	CfdpExtent	*extents;	/*	Sorted, disjoint.	*/
+	int		extentsCount;
+	int		extentsLimit;
+	unsigned int	bytesReceived;	/*	Since last sync.	*/
+	unsigned int	checksum;	/*	Since last sync.	*/
+	int		pdusHandled;	/*	Since last sync.	*/
+	unsigned int	dataOffset;	/*	Of buffered data.	*/
+	unsigned int	dataLength;	/*	Of buffered data.	*/
+	unsigned char	*data;		/*	Write-behind buffer.	*/
+} CfdpReception;
+
+static CfdpReception	*_reception()
+{
+	static CfdpReception	reception;
 
-	CHKVOID(fdu);
-	CHKVOID(fduObj);
-	CHKVOID(fduElt);
-	if (fdu->sourceFileName)
+	return &reception;
+}
+
+static void	discardReception()
+{
+	CfdpReception	*rcv = _reception();
+
+	rcv->fduObj = 0;
+	rcv->extentsCount = 0;
+	rcv->bytesReceived = 0;
+	rcv->checksum = 0;
+	rcv->pdusHandled = 0;
+	rcv->dataLength = 0;
+}
+
+static int	writeFileData(int fd, unsigned int offset,
+			unsigned char *data, unsigned int length)
+{
+	unsigned char	fill[4096];
+	off_t		endOfFile;
+	unsigned int	fillLength;
+
+	/*	Write leading fill characters as necessary.		*/
+
+	endOfFile = lseek(fd, 0, SEEK_END);
+	if (endOfFile == (off_t) -1)
 	{
-		sdr_free(sdr, fdu->sourceFileName);
+		putSysErrmsg("Can't lseek in file", itoa(fd));
+		return -1;
 	}
 
-	if (fdu->destFileName)
+	if (endOfFile < offset)
 	{
-		sdr_free(sdr, fdu->destFileName);
+		memset(fill, _cfdpConstants()->fillCharacter, sizeof fill);
+		while (endOfFile < offset)
+		{
+			fillLength = offset - endOfFile;
+			if (fillLength > sizeof fill)
+			{
+				fillLength = sizeof fill;
+			}
+
+			if (write(fd, fill, fillLength) < 0)
+			{
+				putSysErrmsg("Can't write to file", itoa(fd));
+				return -1;
+			}
+
+			endOfFile += fillLength;
+		}
 	}
 
-	if (fdu->flowLabel)
+	/*	Reposition at offset of new file data bytes.		*/
+
+	if (lseek(fd, offset, SEEK_SET) == (off_t) -1)
 	{
-		sdr_free(sdr, fdu->flowLabel);
+		putSysErrmsg("Can't lseek in file", itoa(fd));
+		return -1;
 	}
 
-	while (fdu->messagesToUser)
+	if (write(fd, data, length) < 0)
 	{
-		elt = sdr_list_first(sdr, fdu->messagesToUser);
-		if (elt == 0)
-		{
-			sdr_list_destroy(sdr, fdu->messagesToUser, NULL,
-					NULL);
-			fdu->messagesToUser = 0;
-			continue;
-		}
+		putSysErrmsg("Can't write to file", itoa(length));
+		return -1;
+	}
 
-		obj = sdr_list_data(sdr, elt);
-		GET_OBJ_POINTER(sdr, MsgToUser, msg, obj);
-		if (msg->text)
-		{
-			sdr_free(sdr, msg->text);
-		}
+	return 0;
+}
 
-		sdr_free(sdr, obj);
-		sdr_list_delete(sdr, elt, NULL, NULL);
+static int	flushFileData()
+{
+	CfdpReception	*rcv = _reception();
+	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
+	int		result = 0;
+
+	if (rcv->dataLength > 0 && cfdpvdb->currentFile != -1)
+	{
+		result = writeFileData(cfdpvdb->currentFile, rcv->dataOffset,
+				rcv->data, rcv->dataLength);
 	}
 
-	while (fdu->filestoreRequests)
+	rcv->dataLength = 0;
+	return result;
+}
+
+static int	bufferFileData(unsigned char *data, unsigned int offset,
+			unsigned int length)
+{
+	CfdpReception	*rcv = _reception();
+	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
+
+	if (rcv->data == NULL)
 	{
-		elt = sdr_list_first(sdr, fdu->filestoreRequests);
-		if (elt == 0)
-		{
-			sdr_list_destroy(sdr, fdu->filestoreRequests, NULL,
-				       	NULL);
-			fdu->filestoreRequests = 0;
-			continue;
-		}
+		rcv->data = MTAKE(CFDP_WRITE_BUFFER_SIZE);
 
-		obj = sdr_list_data(sdr, elt);
-		GET_OBJ_POINTER(sdr, FilestoreRequest, req, obj);
-		if (req->firstFileName)
-		{
-			sdr_free(sdr, req->firstFileName);
-		}
+		/*	If no buffer can be allocated, file data
+		 *	are simply written as they arrive.		*/
+	}
 
-		if (req->secondFileName)
+	if (rcv->dataLength > 0
+	&& (offset != rcv->dataOffset + rcv->dataLength
+		|| rcv->dataLength + length > CFDP_WRITE_BUFFER_SIZE))
+	{
+		if (flushFileData() < 0)
 		{
-			sdr_free(sdr, req->secondFileName);
+			discardReception();
+			return -1;
 		}
-
-		sdr_free(sdr, obj);
-		sdr_list_delete(sdr, elt, NULL, NULL);
 	}
 
-	while (fdu->extents)
+	if (rcv->data == NULL || length > CFDP_WRITE_BUFFER_SIZE)
 	{
-		elt = sdr_list_first(sdr, fdu->extents);
-		if (elt == 0)
+		if (cfdpvdb->currentFile == -1)
 		{
-			sdr_list_destroy(sdr, fdu->extents, NULL, NULL);
-			fdu->extents = 0;
-			continue;
+			return 0;
 		}
 
-		obj = sdr_list_data(sdr, elt);
-		sdr_free(sdr, obj);	/*	A CfdpExtent structure.	*/
-		sdr_list_delete(sdr, elt, NULL, NULL);
+		return writeFileData(cfdpvdb->currentFile, offset, data,
+				length);
 	}
 
-	sdr_free(sdr, fduObj);
-	sdr_list_delete(sdr, fduElt, NULL, NULL);
-	if (cfdpvdb->currentFdu == fduObj)
+	if (rcv->dataLength == 0)
 	{
-		if (cfdpvdb->currentFile != -1)
+		rcv->dataOffset = offset;
+	}
+
+	memcpy(rcv->data + rcv->dataLength, data, length);
+	rcv->dataLength += length;
+	return 0;
+}
+
+static int	firstExtentAfter(unsigned int offset)
+{
+	CfdpReception	*rcv = _reception();
+	int		low = 0;
+	int		high = rcv->extentsCount;
+	int		mid;
+
+	/*	Returns the index of the first extent that ends after
+	 *	offset, i.e., the first one that either contains
+	 *	offset or starts after it.				*/
+
+	while (low < high)
+	{
+		mid = (low + high) >> 1;
+		if (rcv->extents[mid].offset + rcv->extents[mid].length
+				> offset)
 		{
-			close(cfdpvdb->currentFile);
-			cfdpvdb->currentFile = -1;
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
 		}
-
-		cfdpvdb->currentFdu = 0;
 	}
+
+	return low;
 }
 
-static int	abandonInFdu(CfdpTransactionId *transactionId,
-			CfdpCondition condition)
+static int	noteExtent(unsigned int offset, unsigned int end)
 {
-	InFdu		fduBuf;
-	Object		fduObj;
-	Object		fduElt;
-	Sdr		sdr = getIonsdr();
-	CfdpEvent	event;
-	char		fileName[256];
+	CfdpReception	*rcv = _reception();
+	CfdpExtent	*extents;
+	int		first;
+	int		last;
+	unsigned int	extentEnd;
 
-	fduObj = findInFdu(transactionId, &fduBuf, &fduElt, 0);
-	if (fduObj == 0)
+	/*	Adds the range from offset to end to the set of
+	 *	extents, combining it with all extents that it
+	 *	overlaps or abuts.					*/
+
+	first = (offset == 0 ? 0 : firstExtentAfter(offset - 1));
+	for (last = first; last < rcv->extentsCount; last++)
 	{
-		return 0;
+		if (rcv->extents[last].offset > end)
+		{
+			break;
+		}
+
+		if (rcv->extents[last].offset < offset)
+		{
+			offset = rcv->extents[last].offset;
+		}
+
+		extentEnd = rcv->extents[last].offset
+				+ rcv->extents[last].length;
+		if (extentEnd > end)
+		{
+			end = extentEnd;
+		}
 	}
 
-	sdr_stage(sdr, NULL, fduObj, 0);
-	memset((char *) &event, 0, sizeof(CfdpEvent));
-	event.type = CfdpAbandonedInd;
-	memcpy((char *) &event.transactionId, (char *) transactionId,
-			sizeof(CfdpTransactionId));
-	event.condition = condition;
-	event.progress = fduBuf.progress;
-	event.reqNbr = getReqNbr();
-	if (enqueueCfdpEvent(&event) < 0)
+	if (last == first)	/*	Must insert a new extent.	*/
 	{
-		putErrmsg("CFDP can't abandon transaction.", NULL);
-		return -1;
+		if (rcv->extentsCount == rcv->extentsLimit)
+		{
+			extents = MTAKE((rcv->extentsLimit + 16)
+					* sizeof(CfdpExtent));
+			if (extents == NULL)
+			{
+				putErrmsg("Can't expand extents array.", NULL);
+				return -1;
+			}
+
+			if (rcv->extents)
+			{
+				memcpy((char *) extents, (char *) rcv->extents,
+					rcv->extentsCount * sizeof(CfdpExtent));
+				MRELEASE(rcv->extents);
+			}
+
+			rcv->extents = extents;
+			rcv->extentsLimit += 16;
+		}
+
+		memmove((char *) (rcv->extents + first + 1),
+				(char *) (rcv->extents + first),
+				(rcv->extentsCount - first)
+				* sizeof(CfdpExtent));
+		rcv->extentsCount++;
+		last = first + 1;
 	}
 
-	if (fduBuf.destFileName)
+	/*	Extents first through last - 1 become one extent.	*/
+
+	rcv->extents[first].offset = offset;
+	rcv->extents[first].length = end - offset;
+	if (last > first + 1)
 	{
-		sdr_string_read(sdr, fileName, fduBuf.destFileName);
-		unlink(fileName);
+		memmove((char *) (rcv->extents + first + 1),
+				(char *) (rcv->extents + last),
+				(rcv->extentsCount - last)
+				* sizeof(CfdpExtent));
+		rcv->extentsCount -= (last - (first + 1));
 	}
 
-	destroyInFdu(&fduBuf, fduObj, fduElt);
-	return event.reqNbr;
+	return 0;
 }
 
-static int	missingFileName(char *fileName, int parmNbr,
-			FilestoreResponse *resp, char *msgBuf, int bufLen)
+static int	loadExtents(InFdu *fdu)
 {
-	if (fileName)
+	Sdr		sdr = getIonsdr();
+	Object		elt;
+	CfdpExtent	extent;
+
+	for (elt = sdr_list_first(sdr, fdu->extents); elt;
+			elt = sdr_list_next(sdr, elt))
 	{
-		return 0;
+		sdr_read(sdr, (char *) &extent, sdr_list_data(sdr, elt),
+				sizeof(CfdpExtent));
+		if (noteExtent(extent.offset, extent.offset + extent.length)
+				< 0)
+		{
+			return -1;
+		}
 	}
-	
-	resp->status = 1;
-	isprintf(msgBuf, bufLen, "file name %d not provided", parmNbr);
-	return 1;
+
+	return 0;
 }
-			
-static void	frCreateFile(char *firstFileName, char *secondFileName,
-			FilestoreResponse *resp, char *msgBuf, int bufLen)
+
+static int	recordExtents(InFdu *fdu)
 {
-	int	fd;
+	CfdpReception	*rcv = _reception();
+	Sdr		sdr = getIonsdr();
+	Object		elt;
+	Object		nextElt;
+	Object		addr;
+	CfdpExtent	extent;
+	int		i;
 
-	if (missingFileName(firstFileName, 1, resp, msgBuf, bufLen))
+	/*	Rewrite the FDU's list of extents to match the
+	 *	extents array, reusing the list's existing extent
+	 *	objects wherever possible.				*/
+
+	elt = sdr_list_first(sdr, fdu->extents);
+	for (i = 0; i < rcv->extentsCount; i++)
 	{
-		return;
+		if (elt)
+		{
+			addr = sdr_list_data(sdr, elt);
+			sdr_read(sdr, (char *) &extent, addr,
+					sizeof(CfdpExtent));
+			if (extent.offset != rcv->extents[i].offset
+			|| extent.length != rcv->extents[i].length)
+			{
+				sdr_write(sdr, addr, (char *)
+						(rcv->extents + i),
+						sizeof(CfdpExtent));
+			}
+
+			elt = sdr_list_next(sdr, elt);
+			continue;
+		}
+
+		addr = sdr_malloc(sdr, sizeof(CfdpExtent));
+		if (addr == 0
+		|| sdr_list_insert_last(sdr, fdu->extents, addr) == 0)
+		{
+			putErrmsg("Can't insert extent.", NULL);
+			return -1;
+		}
+
+		sdr_write(sdr, addr, (char *) (rcv->extents + i),
+				sizeof(CfdpExtent));
+	}
+
+	while (elt)
+	{
+		nextElt = sdr_list_next(sdr, elt);
+		sdr_free(sdr, sdr_list_data(sdr, elt));
+		sdr_list_delete(sdr, elt, NULL, NULL);
+		elt = nextElt;
+	}
+
+	return 0;
+}
+
+static int	handleFilestoreRejection(InFdu *fdu, int returnCode,
+			CfdpHandler *handler)
+{
+	if (handleFault(&fdu->transactionId, CfdpFilestoreRejection,
+				handler) < 0)
+	{
+		putErrmsg("Can't handle filestore rejection.", NULL);
+		returnCode = -1;
+	}
+
+	return returnCode;
+}
+
+static int	syncReception(Object fduObj, InFdu *fdu)
+{
+	CfdpReception	*rcv = _reception();
+	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
+	Sdr		sdr = getIonsdr();
+	InFdu		fduBuf;
+	CfdpHandler	handler;
+
+	/*	fdu, if not NULL, is the current content of the
+	 *	InFdu at fduObj; it is updated as well.  Returns 1
+	 *	if the buffered file data couldn't be written, in
+	 *	which case the failure has been handled as a
+	 *	filestore rejection for the FDU being synced.		*/
+
+	if (rcv->fduObj == 0)
+	{
+		return 0;		/*	Nothing to sync.	*/
+	}
+
+	if (cfdpvdb->currentFdu != rcv->fduObj)
+	{
+		/*	FDU has been destroyed since its reception
+		 *	state was last synced.				*/
+
+		discardReception();
+		return 0;
+	}
+
+	if (fdu == NULL || fduObj != rcv->fduObj)
+	{
+		fdu = &fduBuf;
+		sdr_stage(sdr, (char *) fdu, rcv->fduObj, sizeof(InFdu));
+	}
+
+	if (flushFileData() < 0)
+	{
+		/*	The data received since the last sync are
+		 *	not all in the file, so none of that
+		 *	reception state may be recorded.		*/
+
+		putErrmsg("Can't write buffered file data.", NULL);
+		discardReception();
+		if (handleFilestoreRejection(fdu, 0, &handler) < 0)
+		{
+			return -1;
+		}
+
+		return 1;
+	}
+
+	fdu->bytesReceived += rcv->bytesReceived;
+	fdu->computedChecksum += rcv->checksum;
+	if (recordExtents(fdu) < 0)
+	{
+		putErrmsg("Can't record extents.", NULL);
+		return -1;
+	}
+
+	sdr_write(sdr, rcv->fduObj, (char *) fdu, sizeof(InFdu));
+	rcv->bytesReceived = 0;
+	rcv->checksum = 0;
+	rcv->pdusHandled = 0;
+	return 0;
+}
+
+static int	selectReception(Object fduObj, InFdu *fdu)
+{
+	CfdpReception	*rcv = _reception();
+	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
+
+	if (rcv->fduObj == fduObj && cfdpvdb->currentFdu == fduObj)
+	{
+		return 0;		/*	No change.		*/
+	}
+
+	if (syncReception(0, NULL) < 0)
+	{
+		return -1;
+	}
+
+	discardReception();
+	if (loadExtents(fdu) < 0)
+	{
+		putErrmsg("Can't load extents.", NULL);
+		return -1;
+	}
+
+	rcv->fduObj = fduObj;
+	return 0;
+}
+
+int	cfdpFlushInboundData()
+{
+	Sdr	sdr = getIonsdr();
+
+	CHKERR(sdr_begin_xn(sdr));
+	if (syncReception(0, NULL) < 0)
+	{
+		sdr_cancel_xn(sdr);
+		putErrmsg("Can't flush inbound file data.", NULL);
+		return -1;
+	}
+
+	return sdr_end_xn(sdr);
+}
+
+void	destroyInFdu(InFdu *fdu, Object fduObj, Object fduElt)
+{
+	Sdr	sdr = getIonsdr();
+	CfdpVdb	*cfdpvdb = _cfdpvdb(NULL);
+	Object	elt;
+	Object	obj;
+		OBJ_POINTER(MsgToUser, msg);
+		OBJ_POINTER(FilestoreRequest, req);
+
+	CHKVOID(fdu);
+	CHKVOID(fduObj);
+	CHKVOID(fduElt);
+	if (fdu->sourceFileName)
+	{
+		sdr_free(sdr, fdu->sourceFileName);
+	}
+
+	if (fdu->destFileName)
+	{
+		sdr_free(sdr, fdu->destFileName);
+	}
+
+	if (fdu->flowLabel)
+	{
+		sdr_free(sdr, fdu->flowLabel);
+	}
+
+	while (fdu->messagesToUser)
+	{
+		elt = sdr_list_first(sdr, fdu->messagesToUser);
+		if (elt == 0)
+		{
+			sdr_list_destroy(sdr, fdu->messagesToUser, NULL,
+					NULL);
+			fdu->messagesToUser = 0;
+			continue;
+		}
+
+		obj = sdr_list_data(sdr, elt);
+		GET_OBJ_POINTER(sdr, MsgToUser, msg, obj);
+		if (msg->text)
+		{
+			sdr_free(sdr, msg->text);
+		}
+
+		sdr_free(sdr, obj);
+		sdr_list_delete(sdr, elt, NULL, NULL);
+	}
+
+	while (fdu->filestoreRequests)
+	{
+		elt = sdr_list_first(sdr, fdu->filestoreRequests);
+		if (elt == 0)
+		{
+			sdr_list_destroy(sdr, fdu->filestoreRequests, NULL,
+				       	NULL);
+			fdu->filestoreRequests = 0;
+			continue;
+		}
+
+		obj = sdr_list_data(sdr, elt);
+		GET_OBJ_POINTER(sdr, FilestoreRequest, req, obj);
+		if (req->firstFileName)
+		{
+			sdr_free(sdr, req->firstFileName);
+		}
+
+		if (req->secondFileName)
+		{
+			sdr_free(sdr, req->secondFileName);
+		}
+
+		sdr_free(sdr, obj);
+		sdr_list_delete(sdr, elt, NULL, NULL);
+	}
+
+	while (fdu->extents)
+	{
+		elt = sdr_list_first(sdr, fdu->extents);
+		if (elt == 0)
+		{
+			sdr_list_destroy(sdr, fdu->extents, NULL, NULL);
+			fdu->extents = 0;
+			continue;
+		}
+
+		obj = sdr_list_data(sdr, elt);
+		sdr_free(sdr, obj);	/*	A CfdpExtent structure.	*/
+		sdr_list_delete(sdr, elt, NULL, NULL);
+	}
+
+	sdr_free(sdr, fduObj);
+	sdr_list_delete(sdr, fduElt, NULL, NULL);
+	if (_reception()->fduObj == fduObj)
+	{
+		discardReception();
+	}
+
+	if (cfdpvdb->currentFdu == fduObj)
+	{
+		if (cfdpvdb->currentFile != -1)
+		{
+			close(cfdpvdb->currentFile);
+			cfdpvdb->currentFile = -1;
+		}
+
+		cfdpvdb->currentFdu = 0;
+	}
+}
+
+static int	abandonInFdu(CfdpTransactionId *transactionId,
+			CfdpCondition condition)
+{
+	InFdu		fduBuf;
+	Object		fduObj;
+	Object		fduElt;
+	Sdr		sdr = getIonsdr();
+	CfdpEvent	event;
+	char		fileName[256];
+
+	fduObj = findInFdu(transactionId, &fduBuf, &fduElt, 0);
+	if (fduObj == 0)
+	{
+		return 0;
+	}
+
+	sdr_stage(sdr, NULL, fduObj, 0);
+	memset((char *) &event, 0, sizeof(CfdpEvent));
+	event.type = CfdpAbandonedInd;
+	memcpy((char *) &event.transactionId, (char *) transactionId,
+			sizeof(CfdpTransactionId));
+	event.condition = condition;
+	event.progress = fduBuf.progress;
+	event.reqNbr = getReqNbr();
+	if (enqueueCfdpEvent(&event) < 0)
+	{
+		putErrmsg("CFDP can't abandon transaction.", NULL);
+		return -1;
+	}
+
+	if (fduBuf.destFileName)
+	{
+		sdr_string_read(sdr, fileName, fduBuf.destFileName);
+		unlink(fileName);
+	}
+
+	destroyInFdu(&fduBuf, fduObj, fduElt);
+	return event.reqNbr;
+}
+
+static int	missingFileName(char *fileName, int parmNbr,
+			FilestoreResponse *resp, char *msgBuf, int bufLen)
+{
+	if (fileName)
+	{
+		return 0;
+	}
+	
+	resp->status = 1;
+	isprintf(msgBuf, bufLen, "file name %d not provided", parmNbr);
+	return 1;
+}
+			
+static void	frCreateFile(char *firstFileName, char *secondFileName,
+			FilestoreResponse *resp, char *msgBuf, int bufLen)
+{
+	int	fd;
+
+	if (missingFileName(firstFileName, 1, resp, msgBuf, bufLen))
+	{
+		return;
 	}
 
 	fd = iopen(firstFileName, O_CREAT, 0777);
@@ -2283,42 +2879,374 @@ int	handleFault(CfdpTransactionId *transactionId, CfdpCondition fault,
 	default:
 		return 0;
 	}
-}
+}
+
+/*	*	*	PDU issuance functions	*	*	*	*/
+
+static int	fduQuantum(OutFdu *fdu)
+{
+	BpUtParms	utParms;
+
+	if (fdu->utParmsLength != sizeof(BpUtParms))
+	{
+		return CFDP_STD_QUANTUM;
+	}
+
+	memcpy((char *) &utParms, (char *) fdu->utParms, sizeof(BpUtParms));
+	switch (utParms.classOfService)
+	{
+	case BP_BULK_PRIORITY:
+		return CFDP_BULK_QUANTUM;
+
+	case BP_EXPEDITED_PRIORITY:
+		return CFDP_EXPEDITED_QUANTUM;
+
+	default:
+		return CFDP_STD_QUANTUM;
+	}
+}
+
+static int	fduIsReady(Object elt, OutFdu *buffer, Object *obj)
+{
+	Sdr	sdr = getIonsdr();
+
+	*obj = sdr_list_data(sdr, elt);
+	sdr_read(sdr, (char *) buffer, *obj, sizeof(OutFdu));
+	return (buffer->state == FduActive
+		&& buffer->eofPdu != 0);  /*	Something left to send.	*/
+}
+
+static Object	selectOutFdu(OutFdu *buffer)
+{
+	Sdr	sdr = getIonsdr();
+	CfdpDB	*cfdpConstants = _cfdpConstants();
+	CfdpVdb	*cfdpvdb = _cfdpvdb(NULL);
+	Object	elt = cfdpvdb->currentOutFdu;
+	Object	obj;
+	int	fdusToCheck;
+
+	/*	The current FDU keeps issuing PDUs until its credit
+	 *	for this turn is exhausted or it has nothing more to
+	 *	send.  Then the turn passes to the next FDU in the
+	 *	list that is ready to send, wrapping around to the
+	 *	start of the list; that FDU's credit is the quantum
+	 *	for its priority class.  So small transfers never
+	 *	wait long behind large ones, while higher-priority
+	 *	transfers get proportionally more of the link.		*/
+
+	if (elt && cfdpvdb->outFduCredit > 0)
+	{
+		if (fduIsReady(elt, buffer, &obj))
+		{
+			cfdpvdb->outFduCredit--;
+			return obj;
+		}
+	}
+
+	fdusToCheck = sdr_list_length(sdr, cfdpConstants->outboundFdus);
+	if (elt)
+	{
+		elt = sdr_list_next(sdr, elt);
+	}
+
+	while (fdusToCheck > 0)
+	{
+		if (elt == 0)
+		{
+			elt = sdr_list_first(sdr, cfdpConstants->outboundFdus);
+		}
+
+		if (fduIsReady(elt, buffer, &obj))
+		{
+			cfdpvdb->currentOutFdu = elt;
+			cfdpvdb->outFduCredit = fduQuantum(buffer) - 1;
+			return obj;
+		}
+
+		elt = sdr_list_next(sdr, elt);
+		fdusToCheck--;
+	}
+
+	cfdpvdb->currentOutFdu = 0;
+	return 0;
+}
+
+static Object	constructFileDataPdu(OutFdu *fdu, unsigned int length)
+{
+	Sdr		sdr = getIonsdr();
+	unsigned int	offset;
+	Object		header;
+	Object		pdu;
+
+	offset = htonl(fdu->progress);
+	header = sdr_malloc(sdr, 4);
+	if (header == 0)
+	{
+		putErrmsg("No space for file PDU hdr.", NULL);
+		return 0;
+	}
+
+	sdr_write(sdr, header, (char *) &offset, 4);
+	pdu = zco_create(sdr, ZcoSdrSource, header, 0, 4);
+	if (pdu == (Object) ERROR || pdu == 0)
+	{
+		putErrmsg("No space for file PDU.", NULL);
+		return 0;
+	}
+
+	if (zco_append_extent(sdr, pdu, ZcoFileSource, fdu->fileRef,
+			fdu->progress, length) <= 0)
+	{
+		putErrmsg("Can't append extent.", NULL);
+		return 0;
+	}
+
+	return pdu;
+}
+
+static unsigned char	*_pduSourceBuf()
+{
+	static unsigned char	buffer[4 + CFDP_MAX_PDU_SIZE];
+
+	return buffer;
+}
+
+/*	The file descriptors of the source files of streaming FDUs
+ *	are kept open, from the first file data PDU of each FDU to
+ *	its last, so that cutting each PDU costs a single read
+ *	while the ION transaction is held.  The descriptors are
+ *	private to the task that dequeues outbound PDUs; those of
+ *	FDUs that have been canceled or destroyed meanwhile are
+ *	closed whenever that task next dequeues PDUs.		*/
+
+#define	CFDP_SOURCE_FILES	(16)
+
+typedef struct
+{
+	CfdpNumber	transactionNbr;
+	int		fd;		/*	-1 if slot is unused.	*/
+	unsigned int	offset;		/*	Current file position.	*/
+} CfdpSourceFile;
+
+static CfdpSourceFile	*_sourceFiles()
+{
+	static CfdpSourceFile	files[CFDP_SOURCE_FILES];
+	static int		initialized = 0;
+	int			i;
+
+	if (!initialized)
+	{
+		for (i = 0; i < CFDP_SOURCE_FILES; i++)
+		{
+			files[i].fd = -1;
+		}
+
+		initialized = 1;
+	}
+
+	return files;
+}
+
+static void	closeSourceFile(CfdpSourceFile *file)
+{
+	close(file->fd);
+	file->fd = -1;
+}
+
+static void	closeStaleSourceFiles()
+{
+	CfdpSourceFile	*file = _sourceFiles();
+	CfdpTransactionId	transactionId;
+	OutFdu		fduBuf;
+	Object		fduElt;
+	int		i;
+
+	memset((char *) &transactionId, 0, sizeof(CfdpTransactionId));
+	for (i = 0; i < CFDP_SOURCE_FILES; i++, file++)
+	{
+		if (file->fd == -1)
+		{
+			continue;
+		}
+
+		memcpy((char *) &transactionId.transactionNbr,
+				(char *) &file->transactionNbr,
+				sizeof(CfdpNumber));
+		if (findOutFdu(&transactionId, &fduBuf, &fduElt) == 0
+		|| fduBuf.state == FduCanceled)
+		{
+			closeSourceFile(file);
+		}
+	}
+}
+
+static CfdpSourceFile	*getSourceFile(OutFdu *fdu)
+{
+	static int	nextVictim = 0;
+	Sdr		sdr = getIonsdr();
+	CfdpSourceFile	*files = _sourceFiles();
+	CfdpSourceFile	*file = NULL;
+	char		pathName[256];
+	int		i;
+
+	for (i = 0; i < CFDP_SOURCE_FILES; i++)
+	{
+		if (files[i].fd == -1)
+		{
+			if (file == NULL)
+			{
+				file = files + i;
+			}
+
+			continue;
+		}
+
+		if (memcmp((char *) &files[i].transactionNbr,
+				(char *) &fdu->transactionId.transactionNbr,
+				sizeof(CfdpNumber)) == 0)
+		{
+			return files + i;
+		}
+	}
+
+	if (file == NULL)	/*	All slots in use.		*/
+	{
+		file = files + nextVictim;
+		nextVictim = (nextVictim + 1) % CFDP_SOURCE_FILES;
+		closeSourceFile(file);
+	}
+
+	if (zco_file_ref_path(sdr, fdu->fileRef, pathName, sizeof pathName)
+			== NULL)
+	{
+		putErrmsg("Can't get path name of file to send.", NULL);
+		return NULL;
+	}
+
+	file->fd = iopen(pathName, O_RDONLY, 0);
+	if (file->fd < 0)
+	{
+		file->fd = -1;
+		putSysErrmsg("Can't open file to send", pathName);
+		return NULL;
+	}
+
+	memcpy((char *) &file->transactionNbr,
+			(char *) &fdu->transactionId.transactionNbr,
+			sizeof(CfdpNumber));
+	file->offset = 0;
+	return file;
+}
+
+static int	readStreamedData(OutFdu *fdu, unsigned int length)
+{
+	unsigned char	*buffer = _pduSourceBuf();
+	CfdpSourceFile	*file;
+	int		bytesRead;
+	unsigned int	offset = fdu->progress;
+
+	/*	Reads the file data for the next PDU of a streaming
+	 *	FDU into the PDU source buffer, following the 4-byte
+	 *	offset, and adds it to the FDU's checksum.  Returns
+	 *	the number of bytes read.  If the file has been
+	 *	truncated since the FDU was created, the missing
+	 *	data are simply omitted from the checksum; the
+	 *	receiver will detect the checksum failure.		*/
+
+	file = getSourceFile(fdu);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	if (file->offset != offset)
+	{
+		if (lseek(file->fd, offset, SEEK_SET) == (off_t) -1)
+		{
+			closeSourceFile(file);
+			putSysErrmsg("Can't seek in file to send",
+					itoa(offset));
+			return -1;
+		}
+
+		file->offset = offset;
+	}
+
+	bytesRead = read(file->fd, (char *) buffer + 4, length);
+	if (bytesRead < 0)
+	{
+		closeSourceFile(file);
+		putSysErrmsg("Can't read file to send", itoa(length));
+		return -1;
+	}
+
+	file->offset += bytesRead;
+	if (offset + length >= fdu->fileSize)
+	{
+		closeSourceFile(file);	/*	Last PDU of the file.	*/
+	}
+
+	addBytesToChecksum(buffer + 4, bytesRead, &offset, &fdu->checksum);
+	return bytesRead;
+}
+
+static Object	selectStreamedPdu(OutFdu *fdu, unsigned char **pduSource)
+{
+	Sdr		sdr = getIonsdr();
+	unsigned int	length;
+	int		bytesRead;
+	Object		pdu;
+	unsigned int	u4;
+
+	length = fdu->fileSize - fdu->progress;
+	if (length > _cfdpConstants()->maxFileDataLength)
+	{
+		length = _cfdpConstants()->maxFileDataLength;
+	}
+
+	bytesRead = readStreamedData(fdu, length);
+	if (bytesRead < 0)
+	{
+		putErrmsg("Can't compute checksum of file data.", NULL);
+		return 0;
+	}
+
+	pdu = constructFileDataPdu(fdu, length);
+	if (pdu == 0)
+	{
+		return 0;
+	}
 
-/*	*	*	PDU issuance functions	*	*	*	*/
+	/*	The PDU's source data -- offset and file data -- are
+	 *	now in memory, so the CRC (if any) can be computed
+	 *	without reading the PDU back out of its ZCO.		*/
 
-static Object	selectOutFdu(OutFdu *buffer)
-{
-	Sdr	sdr = getIonsdr();
-	CfdpDB	*cfdpConstants = _cfdpConstants();
-	Object	elt;
-	Object	obj;
+	if (bytesRead == length)
+	{
+		u4 = htonl(fdu->progress);
+		memcpy(_pduSourceBuf(), (char *) &u4, 4);
+		*pduSource = _pduSourceBuf();
+	}
 
-	for (elt = sdr_list_first(sdr, cfdpConstants->outboundFdus); elt;
-			elt = sdr_list_next(sdr, elt))
+	fdu->progress += length;
+	if (fdu->progress == fdu->fileSize)
 	{
-		obj = sdr_list_data(sdr, elt);
-		sdr_read(sdr, (char *) buffer, obj, sizeof(OutFdu));
-		if (buffer->state != FduActive
-		|| buffer->eofPdu == 0	/*	Nothing left to send.	*/)
-		{
-			continue;
-		}
+		/*	Last PDU has been cut; checksum is complete.	*/
 
-		return obj;
+		u4 = htonl(fdu->checksum);
+		sdr_write(sdr, fdu->eofText + 2, (char *) &u4, 4);
 	}
 
-	return 0;
+	return pdu;
 }
 
-static Object	selectOutPdu(OutFdu *fdu, int *pduIsFileData)
+static Object	selectOutPdu(OutFdu *fdu, int *pduIsFileData,
+			unsigned char **pduSource)
 {
 	Object		pdu;
 	Sdr		sdr = getIonsdr();
 	Object		elt;
 	unsigned int	length;
-	unsigned int	offset;
-	Object		header;
 
 	if (fdu->metadataPdu)
 	{
@@ -2328,33 +3256,23 @@ static Object	selectOutPdu(OutFdu *fdu, int *pduIsFileData)
 		return pdu;
 	}
 
-	if (fdu->fileSize > 0)
+	if (fdu->streaming)
+	{
+		if (fdu->progress < fdu->fileSize)
+		{
+			*pduIsFileData = 1;
+			return selectStreamedPdu(fdu, pduSource);
+		}
+	}
+	else if (fdu->fileSize > 0)
 	{
 		elt = sdr_list_first(sdr, fdu->recordLengths);
 		if (elt)
 		{
 			length = sdr_list_data(sdr, elt);
-			offset = fdu->progress;
-			offset = htonl(offset);
-			header = sdr_malloc(sdr, 4);
-			if (header == 0)
-			{
-				putErrmsg("No space for file PDU hdr.", NULL);
-				return 0;
-			}
-
-			sdr_write(sdr, header, (char *) &offset, 4);
-			pdu = zco_create(sdr, ZcoSdrSource, header, 0, 4);
-			if (pdu == (Object) ERROR || pdu == 0)
-			{
-				putErrmsg("No space for file PDU.", NULL);
-				return 0;
-			}
-
-			if (zco_append_extent(sdr, pdu, ZcoFileSource,
-				fdu->fileRef, fdu->progress, length) <= 0)
+			pdu = constructFileDataPdu(fdu, length);
+			if (pdu == 0)
 			{
-				putErrmsg("Can't append extent.", NULL);
 				return 0;
 			}
 
@@ -2371,13 +3289,12 @@ static Object	selectOutPdu(OutFdu *fdu, int *pduIsFileData)
 	return pdu;
 }
 
-int	cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer)
+static int	issueOutboundPdu(Object fduObj, OutFdu *fduBuffer,
+			Object *pdu, CfdpDB *cfdpdb)
 {
 	Sdr		sdr = getIonsdr();
-	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
-	CfdpDB		cfdpdb;
-	Object		fduObj;
 	int		pduIsFileData = 0;	/*	Boolean.	*/
+	unsigned char	*pduSource = NULL;
 	unsigned int	dataFieldLength;
 	unsigned int	octet;
 	int		pduSourceDataLength;
@@ -2385,54 +3302,26 @@ int	cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer)
 	unsigned char	pduHeader[28];
 	unsigned int	pduHeaderLength = 4;
 	unsigned int	proposedLength;
-	unsigned char	*buf;
+	unsigned char	buf[4096];
+	int		bytesToCrc;
 	ZcoReader	reader;
 	unsigned short	crc;
 
-	CHKERR(pdu);
-	CHKERR(fduBuffer);
-	CHKERR(sdr_begin_xn(sdr));
-	fduObj = selectOutFdu(fduBuffer);
-	while (fduObj == 0)
-	{
-		sdr_exit_xn(sdr);
-
-		/*	Wait until an FDU is resumed or a new one
-		 *	is created.					*/
-
-		if (sm_SemTake(cfdpvdb->fduSemaphore) < 0)
-		{
-			putErrmsg("UTO can't take FDU semaphore.", NULL);
-			return -1;
-		}
-
-		if (sm_SemEnded(cfdpvdb->fduSemaphore))
-		{
-			writeMemo("[i] UTO has been stopped.");
-			return -1;
-		}
-
-		CHKERR(sdr_begin_xn(sdr));
-		fduObj = selectOutFdu(fduBuffer);
-	}
-
 	sdr_stage(sdr, NULL, fduObj, 0);
-	*pdu = selectOutPdu(fduBuffer, &pduIsFileData);
+	*pdu = selectOutPdu(fduBuffer, &pduIsFileData, &pduSource);
 	if (*pdu == 0)
 	{
 		putErrmsg("UTO can't get outbound PDU.", NULL);
-		sdr_cancel_xn(sdr);
 		return -1;
 	}
 
-	sdr_read(sdr, (char *) &cfdpdb, getCfdpDbObject(), sizeof(CfdpDB));
 	octet = (pduIsFileData << 4)	/*	bit 3 is PDU type	*/
 			+ 4		/*	1 in bit 6 == unack	*/
-			+ (cfdpdb.crcRequired ? 2 : 0);
+			+ (cfdpdb->crcRequired ? 2 : 0);
 	pduHeader[0] = octet;
 	pduSourceDataLength = zco_length(sdr, *pdu);
 	dataFieldLength = pduSourceDataLength
-			+ (cfdpdb.crcRequired ? 2 : 0);
+			+ (cfdpdb->crcRequired ? 2 : 0);
 
 	/*	Note that length of CRC, if present, is included in
 	 *	the data field length per 4.1.1.3.2.			*/
@@ -2442,7 +3331,7 @@ int	cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer)
 
 	/*	Compute the lengths byte value.				*/
 
-	entityNbrLength = cfdpdb.ownEntityNbr.length;
+	entityNbrLength = cfdpdb->ownEntityNbr.length;
 	if (fduBuffer->destinationEntityNbr.length > entityNbrLength)
 	{
 		entityNbrLength = fduBuffer->destinationEntityNbr.length;
@@ -2459,12 +3348,11 @@ int	cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer)
 			+ entityNbrLength;
 	if (proposedLength > sizeof pduHeader)
 	{
-		sdr_cancel_xn(sdr);
 		putErrmsg("pduHeaderLength too large.", utoa(proposedLength));
 		return -1;
 	}
 
-	memcpy(pduHeader + pduHeaderLength, cfdpdb.ownEntityNbr.buffer,
+	memcpy(pduHeader + pduHeaderLength, cfdpdb->ownEntityNbr.buffer,
 			entityNbrLength);
 	pduHeaderLength += entityNbrLength;
 	memcpy(pduHeader + pduHeaderLength,
@@ -2483,27 +3371,112 @@ int	cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer)
 
 	/*	If CRC required, compute CRC and append to pdu.		*/
 
-	if (cfdpdb.crcRequired)
+	if (cfdpdb->crcRequired)
 	{
-		buf = _crcComputationBuf();
-		memcpy((char *) buf, pduHeader, pduHeaderLength);
-		zco_start_receiving(*pdu, &reader);
-		if (zco_receive_source(sdr, &reader, pduSourceDataLength,
-				((char *) buf) + pduHeaderLength) < 0)
+		crc = updateCRC(CFDP_CRC_INIT, pduHeader, pduHeaderLength);
+		if (pduSource)	/*	Source data already in memory.	*/
 		{
-			sdr_cancel_xn(sdr);
-			putErrmsg("Can't read ZCO.", NULL);
-			return -1;
+			crc = updateCRC(crc, pduSource, pduSourceDataLength);
+		}
+		else	/*	Must read source data from the ZCO.	*/
+		{
+			zco_start_receiving(*pdu, &reader);
+			while (pduSourceDataLength > 0)
+			{
+				bytesToCrc = pduSourceDataLength;
+				if (bytesToCrc > sizeof buf)
+				{
+					bytesToCrc = sizeof buf;
+				}
+
+				bytesToCrc = zco_receive_source(sdr, &reader,
+						bytesToCrc, (char *) buf);
+				if (bytesToCrc < 0)
+				{
+					putErrmsg("Can't read ZCO.", NULL);
+					return -1;
+				}
+
+				if (bytesToCrc == 0)
+				{
+					break;	/*	No more data.	*/
+				}
+
+				crc = updateCRC(crc, buf, bytesToCrc);
+				pduSourceDataLength -= bytesToCrc;
+			}
 		}
 
-		crc = computeCRC(buf, pduHeaderLength + pduSourceDataLength);
 		crc = htons(crc);
 		oK(zco_append_trailer(sdr, *pdu, (char *) &crc, 2));
 	}
 
-	/*	Rewrite FDU and exit.					*/
+	/*	Rewrite FDU.						*/
 
 	sdr_write(sdr, fduObj, (char *) fduBuffer, sizeof(OutFdu));
+	return 0;
+}
+
+int	cfdpDequeueOutboundPdus(Object *pdus, OutFdu *fduBuffers, int maxPdus)
+{
+	Sdr		sdr = getIonsdr();
+	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
+	CfdpDB		cfdpdb;
+	Object		fduObj;
+	int		pduCount = 0;
+	int		i;
+
+	CHKERR(pdus);
+	CHKERR(fduBuffers);
+	CHKERR(maxPdus > 0);
+	CHKERR(sdr_begin_xn(sdr));
+	fduObj = selectOutFdu(fduBuffers);
+	while (fduObj == 0)
+	{
+		sdr_exit_xn(sdr);
+
+		/*	Wait until an FDU is resumed or a new one
+		 *	is created.					*/
+
+		if (sm_SemTake(cfdpvdb->fduSemaphore) < 0)
+		{
+			putErrmsg("UTO can't take FDU semaphore.", NULL);
+			return -1;
+		}
+
+		if (sm_SemEnded(cfdpvdb->fduSemaphore))
+		{
+			writeMemo("[i] UTO has been stopped.");
+			return -1;
+		}
+
+		CHKERR(sdr_begin_xn(sdr));
+		fduObj = selectOutFdu(fduBuffers);
+	}
+
+	/*	Issue as many PDUs as are ready, up to maxPdus, in
+	 *	a single transaction.					*/
+
+	closeStaleSourceFiles();
+	sdr_read(sdr, (char *) &cfdpdb, getCfdpDbObject(), sizeof(CfdpDB));
+	while (fduObj)
+	{
+		if (issueOutboundPdu(fduObj, fduBuffers + pduCount,
+				pdus + pduCount, &cfdpdb) < 0)
+		{
+			sdr_cancel_xn(sdr);
+			return -1;
+		}
+
+		pduCount++;
+		if (pduCount == maxPdus)
+		{
+			break;
+		}
+
+		fduObj = selectOutFdu(fduBuffers + pduCount);
+	}
+
 	if (sdr_end_xn(sdr))
 	{
 		putErrmsg("UTO can't dequeue outbound PDU.", NULL);
@@ -2512,10 +3485,24 @@ int	cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer)
 
 	if (cfdpvdb->watching & WATCH_p)
 	{
-		putchar('p');
+		for (i = 0; i < pduCount; i++)
+		{
+			putchar('p');
+		}
+
 		fflush(stdout);
 	}
 
+	return pduCount;
+}
+
+int	cfdpDequeueOutboundPdu(Object *pdu, OutFdu *fduBuffer)
+{
+	if (cfdpDequeueOutboundPdus(pdu, fduBuffer, 1) < 0)
+	{
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -2535,9 +3522,26 @@ static int	checkInFduComplete(InFdu *fdu, Object fduObj, Object fduElt)
 		return 0;
 	}
 
-	if (fdu->bytesReceived < fdu->fileSize)	/*	Missing data.	*/
+	if (fdu->bytesReceived + (_reception()->fduObj == fduObj ?
+			_reception()->bytesReceived : 0) < fdu->fileSize)
 	{
-		return 0;
+		return 0;			/*	Missing data.	*/
+	}
+
+	/*	All data have been received, so all buffered data
+	 *	must now be written to the file.			*/
+
+	switch (syncReception(fduObj, fdu))
+	{
+	case -1:
+		putErrmsg("Can't sync reception.", NULL);
+		return -1;
+
+	case 1:
+		return 0;	/*	Filestore rejection handled.	*/
+
+	default:
+		break;
 	}
 
 	if (fdu->computedChecksum == fdu->eofChecksum)
@@ -2598,25 +3602,11 @@ static int	getFileName(InFdu *fdu, char *stringBuf, int bufLen)
 	return 0;
 }
 
-static int	handleFilestoreRejection(InFdu *fdu, int returnCode,
-			CfdpHandler *handler)
-{
-	if (handleFault(&fdu->transactionId, CfdpFilestoreRejection,
-				handler) < 0)
-	{
-		putErrmsg("Can't handle filestore rejection.", NULL);
-		returnCode = -1;
-	}
-
-	return returnCode;
-}
-
-static int	writeSegmentData(InFdu *fdu, unsigned char **cursor,
-			int *bytesRemaining, unsigned int *segmentOffset,
-			int bytesToWrite)
+static int	writeSegmentData(unsigned char *data, unsigned int offset,
+			unsigned int length)
 {
 	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
-	CfdpHandler	handler;
+	CfdpReception	*rcv = _reception();
 	int		remainder;
 
 	if (cfdpvdb->corruptionModulus)
@@ -2624,26 +3614,18 @@ static int	writeSegmentData(InFdu *fdu, unsigned char **cursor,
 		remainder = rand() % cfdpvdb->corruptionModulus;
 		if (remainder == 0)
 		{
-			(**cursor)++;	/*	Introduce corruption.	*/
+			(*data)++;	/*	Introduce corruption.	*/
 			writeMemo("CFDP corrupted a byte.");
 		}
 	}
 
-	if (write(cfdpvdb->currentFile, *cursor, bytesToWrite) < 0)
-	{
-		putSysErrmsg("Can't write to file", itoa(bytesToWrite));
-		return handleFilestoreRejection(fdu, -1, &handler);
-	}
-
-	fdu->bytesReceived += bytesToWrite;
-	while (bytesToWrite > 0)
+	if (bufferFileData(data, offset, length) < 0)
 	{
-		addToChecksum(**cursor, segmentOffset, &fdu->computedChecksum);
-		(*cursor)++;
-		(*bytesRemaining)--;
-		bytesToWrite--;
+		return -1;
 	}
 
+	rcv->bytesReceived += length;
+	addBytesToChecksum(data, length, &offset, &rcv->checksum);
 	return 0;
 }
 
@@ -2660,20 +3642,12 @@ static int	handleFileDataPdu(unsigned char *cursor, int bytesRemaining,
 	Sdr		sdr = getIonsdr();
 	CfdpVdb		*cfdpvdb = _cfdpvdb(NULL);
 	CfdpDB		cfdpdb;
-	Object		elt;
-	Object		addr;
-	CfdpExtent	extent;
-	unsigned int	extentEnd = 0;
-	Object		nextElt = 0;
-	unsigned int	bytesToSkip;
+	CfdpReception	*rcv;
+	unsigned int	newDataLength;
+	unsigned int	gapStart;
+	unsigned int	gapEnd;
 	char		stringBuf[256];
 	char		workingNameBuffer[MAXPATHLEN + 2];
-	off_t		endOfFile;
-	unsigned int	fileLength;
-	Object		nextAddr;
-	CfdpExtent	nextExtent;
-	unsigned int	bytesToWrite;
-	unsigned int	nextExtentEnd;
 
 	if (bytesRemaining < 4) return 0;	/*	Malformed.	*/
 	for (i = 0; i < 4; i++)
@@ -2730,91 +3704,41 @@ static int	handleFileDataPdu(unsigned char *cursor, int bytesRemaining,
 
 	/*	Figure out how much of the file data PDU is new data.	*/
 
-	for (elt = sdr_list_first(sdr, fdu->extents); elt;
-			elt = sdr_list_next(sdr, elt))
+	if (selectReception(fduObj, fdu) < 0)
 	{
-		addr = sdr_list_data(sdr, elt);
-		sdr_stage(sdr, (char *) &extent, addr, sizeof(CfdpExtent));
-		extentEnd = extent.offset + extent.length;
-#if CFDPDEBUG
-printf("Viewing extent from %d to %d.\n", extent.offset, extent.offset + extent.length);
-#endif
-		if (extentEnd < segmentOffset)	/*	No relation.	*/
-		{
-			continue;	/*	Look for later extent.	*/
-		}
-
-		/*	This extent ends at or after the start of
-		 *	this segment.  Don't search any further in
-		 *	the extents.					*/
+		putErrmsg("Can't select FDU for reception.", NULL);
+		return -1;
+	}
 
-		if (extent.offset <= segmentOffset)
+	rcv = _reception();
+	newDataLength = 0;
+	i = firstExtentAfter(segmentOffset);
+	for (gapStart = segmentOffset; gapStart < segmentEnd; gapStart = gapEnd)
+	{
+		if (i < rcv->extentsCount && rcv->extents[i].offset <= gapStart)
 		{
-			/*	This extent starts before the start
-			 *	of the segment, i.e., part or all of
-			 *	this segment has already been received.	*/
-
-			bytesToSkip = extentEnd - segmentOffset;
-			if (bytesToSkip >= bytesRemaining)
-			{
-				return 0;	/*	Ignore.		*/
-			}
-
-			/*	This segment extends this extent.	*/
-
-			extent.length = segmentEnd - extent.offset;
-			sdr_write(sdr, addr, (char *) &extent,
-					sizeof(CfdpExtent));
-#if CFDPDEBUG
-printf("Rewriting extent at %d, to %d.\n", extent.offset, extent.offset + extent.length);
-#endif
-			extentEnd = extent.offset + extent.length;
-
-			/*	Skip over any repeated data at the
-			 *	start of the segment.			*/
+			/*	Skip data that have already been received.	*/
 
-			segmentOffset += bytesToSkip;
-			cursor += bytesToSkip;
-			bytesRemaining -= bytesToSkip;
-#if CFDPDEBUG
-printf("Skipping %d bytes, segmentOffset changed to %d.\n", bytesToSkip, segmentOffset);
-#endif
+			gapEnd = rcv->extents[i].offset
+					+ rcv->extents[i].length;
+			i++;
+			continue;
 		}
-		else	/*	This segment starts a new extent.	*/
+
+		gapEnd = segmentEnd;
+		if (i < rcv->extentsCount && rcv->extents[i].offset < gapEnd)
 		{
-			nextElt = elt;
-			elt = 0;	/*	New extent needed.	*/
+			gapEnd = rcv->extents[i].offset;
 		}
 
-		break;
+		newDataLength += gapEnd - gapStart;
 	}
 
-	/*	Insert new extent if necessary.				*/
-
-	if (elt == 0)	/*	Must write the new extent to database.	*/
+	if (newDataLength == 0)
 	{
-		extent.offset = segmentOffset;
-		extent.length = bytesRemaining;
-		addr = sdr_malloc(sdr, sizeof (CfdpExtent));
-		if (addr == 0
-		|| (elt = (nextElt == 0	?
-			sdr_list_insert_last(sdr, fdu->extents, addr)
-					:
-			sdr_list_insert_before(sdr, nextElt, addr))) == 0)
-		{
-			putErrmsg("Can't insert extent.", NULL);
-			return -1;
-		}
-
-		sdr_write(sdr, addr, (char *) &extent, sizeof(CfdpExtent));
-#if CFDPDEBUG
-printf("Writing extent from %d to %d.\n", extent.offset, extent.offset + extent.length);
-#endif
-		extentEnd = extent.offset + extent.length;
+		return 0;	/*	Ignore.				*/
 	}
 
-	nextElt = sdr_list_next(sdr, elt);
-
 	/*	Open the file (possibly a temporary working file) if
 	 *	it's not the currently open file.  First figure out
 	 *	the file's fully-qualified name.			*/
@@ -2849,112 +3773,77 @@ printf("Writing extent from %d to %d.\n", extent.offset, extent.offset + extent.
 		}
 	}
 
-	/*	Write leading fill characters as necessary.		*/
-
-	endOfFile = lseek(cfdpvdb->currentFile, 0, SEEK_END);
-	if (endOfFile == (off_t) -1)
-	{
-		putSysErrmsg("Can't lseek in file", workingNameBuffer);
-		return handleFilestoreRejection(fdu, -1, &handler);
-	}
+	/*	Now write the new file data, i.e., the data in all
+	 *	gaps between extents within the segment, updating
+	 *	the checksum in the process.  Then note the extent
+	 *	of the segment.						*/
 
-	fileLength = endOfFile;
-	while (fileLength < segmentOffset)
+	i = firstExtentAfter(segmentOffset);
+	for (gapStart = segmentOffset; gapStart < segmentEnd; gapStart = gapEnd)
 	{
-		if (write(cfdpvdb->currentFile,
-				&(cfdpdb.fillCharacter), 1) < 0)
+		if (i < rcv->extentsCount && rcv->extents[i].offset <= gapStart)
 		{
-			putSysErrmsg("Can't write to file", workingNameBuffer);
-			return handleFilestoreRejection(fdu, -1, &handler);
+			gapEnd = rcv->extents[i].offset
+					+ rcv->extents[i].length;
+			i++;
+			continue;
 		}
 
-		fileLength++;
-	}
-
-	/*	Reposition at offset of new file data bytes.		*/
-
-	if (lseek(cfdpvdb->currentFile, segmentOffset, SEEK_SET) == (off_t) -1)
-	{
-		putSysErrmsg("Can't lseek in file", workingNameBuffer);
-		return handleFilestoreRejection(fdu, -1, &handler);
-	}
-
-	/*	Now write new file data, updating checksum in the
-	 *	process.  While doing this, collapse subsequent
-	 *	extents into the current one until an unbridged gap
-	 *	in continuity is reached.  This may entail filling
-	 *	any number of inter-extent gaps.			*/
-
-	while (nextElt)
-	{
-		nextAddr = sdr_list_data(sdr, nextElt);
-		sdr_stage(sdr, (char *) &nextExtent, nextAddr,
-				sizeof(CfdpExtent));
-#if CFDPDEBUG
-printf("Continuing to extent from %d to %d; segmentOffset is %d.\n", nextExtent.offset, nextExtent.offset + nextExtent.length, segmentOffset);
-#endif
-		if (nextExtent.offset > segmentEnd)
+		gapEnd = segmentEnd;
+		if (i < rcv->extentsCount && rcv->extents[i].offset < gapEnd)
 		{
-			break;	/*	Reached an unbridged gap.	*/
+			gapEnd = rcv->extents[i].offset;
 		}
 
-		/*	This extent will be subsumed into prior extent.
-		 *	First, bridge gap to the start of this extent.	*/
-
-		bytesToWrite = nextExtent.offset - segmentOffset;
-		if (writeSegmentData(fdu, &cursor, &bytesRemaining,
-				&segmentOffset, bytesToWrite) < 0)
+		if (writeSegmentData(cursor + (gapStart - segmentOffset),
+				gapStart, gapEnd - gapStart) < 0)
 		{
 			putErrmsg("Can't write segment data.",
 					workingNameBuffer);
-			return -1;
+			return handleFilestoreRejection(fdu, -1, &handler);
 		}
+	}
 
-		/*	Now skip over all data that were written when
-		 *	this extent was posted.				*/
-
-		bytesToSkip = nextExtent.length;
-		segmentOffset += bytesToSkip;
-		cursor += bytesToSkip;
-		bytesRemaining -= bytesToSkip;
-
-		/*	Now subsume the extent into the prior extent.	*/
+	if (noteExtent(segmentOffset, segmentEnd) < 0)
+	{
+		putErrmsg("Can't note extent of segment.", NULL);
+		return -1;
+	}
 
-		nextExtentEnd = nextExtent.offset + nextExtent.length;
-		if (nextExtentEnd > extentEnd)
-		{
-			/*	Extend the prior extent.		*/
+	rcv->pdusHandled++;
+#ifdef TargetFFS
+	switch (syncReception(fduObj, fdu))
+	{
+	case -1:
+		putErrmsg("Can't sync reception.", NULL);
+		return -1;
 
-			extent.length = nextExtentEnd - extent.offset;
-			sdr_write(sdr, addr, (char *) &extent,
-					sizeof(CfdpExtent));
-			extentEnd = extent.offset + extent.length;
-		}
+	case 1:
+		return 0;	/*	Filestore rejection handled.	*/
 
-		elt = sdr_list_next(sdr, nextElt);
-		sdr_free(sdr, nextAddr);
-		sdr_list_delete(sdr, nextElt, NULL, NULL);
-		nextElt = elt;
+	default:
+		break;
 	}
 
-	/*	Write final hunk of segment data.			*/
-
-	if (segmentEnd > segmentOffset)
+	close(cfdpvdb->currentFile);
+	cfdpvdb->currentFile = -1;
+	cfdpvdb->currentFdu = 0;
+#else
+	if (rcv->pdusHandled >= CFDP_SYNC_INTERVAL)
 	{
-		bytesToWrite = segmentEnd - segmentOffset;
-		if (writeSegmentData(fdu, &cursor, &bytesRemaining,
-				&segmentOffset, bytesToWrite) < 0)
+		switch (syncReception(fduObj, fdu))
 		{
-			putErrmsg("Can't write segment data.",
-					workingNameBuffer);
+		case -1:
+			putErrmsg("Can't sync reception.", NULL);
 			return -1;
+
+		case 1:
+			return 0;	/*	Rejection handled.	*/
+
+		default:
+			break;
 		}
 	}
-
-#ifdef TargetFFS
-	close(cfdpvdb->currentFile);
-	cfdpvdb->currentFile = -1;
-	cfdpvdb->currentFdu = 0;
 #endif
 	/*	Deliver File-Segment-Recv indication.			*/
 
@@ -71,6 +71,7 @@ static void	printUsage()
 	PUTS("\t   m maxtimeouts <max number of check cycle timeouts>");
 	PUTS("\t   m maxtrnbr <max transaction number>");
 	PUTS("\t   m segsize <max bytes per file data segment>");
+	PUTS("\t   m streaming { 0 | 1 }");
 	PUTS("\t   m inactivity <inactivity limit, in seconds>");
 	PUTS("\ti\tInfo");
 	PUTS("\t   i");
@@ -173,6 +174,36 @@ static void	manageRequirecrc(int tokenCount, char **tokens)
 	}
 }
 
+static void	manageStreaming(int tokenCount, char **tokens)
+{
+	Sdr	sdr = getIonsdr();
+	Object	cfdpdbObj = getCfdpDbObject();
+	CfdpDB	cfdpdb;
+	int	newStreaming;
+
+	if (tokenCount != 3)
+	{
+		SYNTAX_ERROR;
+		return;
+	}
+
+	newStreaming = atoi(tokens[2]);
+	if (newStreaming != 0 && newStreaming != 1)
+	{
+		putErrmsg("streamingFdus switch invalid.", tokens[2]);
+		return;
+	}
+
+	CHKVOID(sdr_begin_xn(sdr));
+	sdr_stage(sdr, (char *) &cfdpdb, cfdpdbObj, sizeof(CfdpDB));
+	cfdpdb.streamingFdus = newStreaming;
+	sdr_write(sdr, cfdpdbObj, (char *) &cfdpdb, sizeof(CfdpDB));
+	if (sdr_end_xn(sdr) < 0)
+	{
+		putErrmsg("Can't change streamingFdus switch.", NULL);
+	}
+}
+
 static void	manageFillchar(int tokenCount, char **tokens)
 {
 	Sdr	sdr = getIonsdr();
@@ -410,6 +441,12 @@ static void	executeManage(int tokenCount, char **tokens)
 		return;
 	}
 
+	if (strcmp(tokens[1], "streaming") == 0)
+	{
+		manageStreaming(tokenCount, tokens);
+		return;
+	}
+
 	SYNTAX_ERROR;
 }
 
@@ -422,10 +459,11 @@ static void	executeInfo()
 	CHKVOID(sdr_begin_xn(sdr));	/*	Just to lock memory.	*/
 	GET_OBJ_POINTER(sdr, CfdpDB, db, getCfdpDbObject());
 	isprintf(buffer, sizeof buffer, "xncount=%lu, maxtrnbr=%lu, \
-fillchar=0x%x, discard=%hu, requirecrc=%hu, segsize=%hu, inactivity=%u, \
-ckperiod=%u, maxtimeouts=%u", db->transactionCounter, db->maxTransactionNbr,
-			db->fillCharacter, db->discardIncompleteFile,
-			db->crcRequired, db->maxFileDataLength, 
+fillchar=0x%x, discard=%hu, requirecrc=%hu, segsize=%hu, streaming=%hu, \
+inactivity=%u, ckperiod=%u, maxtimeouts=%u", db->transactionCounter,
+			db->maxTransactionNbr, db->fillCharacter,
+			db->discardIncompleteFile, db->crcRequired,
+			db->maxFileDataLength, db->streamingFdus,
 			db->transactionInactivityLimit, db->checkTimerPeriod,
 			db->checkTimeoutLimit);
 	sdr_exit_xn(sdr);
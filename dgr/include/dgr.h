@@ -176,6 +176,50 @@ extern int		dgr_receive(	Dgr dgr,
 			 *
 			 *	Returns 0 on success, -1 on failure.	*/
 
+extern int		dgr_receive_buffer(Dgr dgr,
+					unsigned short *fromPortNbr,
+					unsigned int *fromIpAddress,
+					char **content,
+					int *length,
+					int *errnbr,
+					int timeoutSeconds,
+					DgrRC *rc);
+			/*	Same as dgr_receive, except that the
+			 *	content of the received message or
+			 *	delivered/undeliverable message is
+			 *	not copied: instead, a pointer to DGR's
+			 *	own buffer containing that content is
+			 *	placed in *content.  The buffer must be
+			 *	returned to DGR by dgr_release_buffer
+			 *	once the content has been processed;
+			 *	DGR can lend only a limited number of
+			 *	buffers at any time, after which all
+			 *	inbound messages are copied.  No buffer
+			 *	is lent if *rc is DgrTimedOut,
+			 *	DgrInterrupted, or DgrFailed.		*/
+
+extern void		dgr_release_buffer(Dgr dgr,
+					char *content);
+			/*	Returns to DGR a buffer that was lent
+			 *	by dgr_receive_buffer.			*/
+
+extern int		dgr_set_congestion_control(Dgr dgr,
+					char *name);
+			/*	Selects the congestion control algorithm
+			 *	that DGR applies to transmission to all
+			 *	destinations: "cubic" (the default)
+			 *	limits the number of unacknowledged
+			 *	bytes sent to each destination by a
+			 *	CUBIC congestion window and paces
+			 *	transmission at a rate derived from
+			 *	that window and the measured round-trip
+			 *	time; "legacy" applies the rate control
+			 *	of earlier versions of DGR, a fixed
+			 *	delay per byte adjusted once per tenth
+			 *	of a second.  Congestion control state
+			 *	for all destinations is reset.  Returns
+			 *	0 on success, -1 if the name is unknown.*/
+
 extern void		dgr_interrupt(Dgr dgr);
 			/*	Interrupts a dgr_receive invocation
 			 *	that is currently blocked.  Designed 
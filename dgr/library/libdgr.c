@@ -9,6 +9,9 @@
 	acknowledged.
 	
 									*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE			/*	For recvmmsg.		*/
+#endif
 #include "dgr.h"
 #include "memmgr.h"
 
@@ -21,10 +24,11 @@
 #endif
 
 #define	DGR_DB_ORDER	(8)
-#define	DGR_BUCKETS	(1 << DGR_DB_ORDER)
+#define	DGR_BUCKETS	(1 << DGR_DB_ORDER)	/*	Initially.	*/
+#define	DGR_MAX_BUCKETS	(1 << 16)
 #define	DGR_BIN_COUNT	(257)		/*	Must be prime for hash.	*/
-#define	DGR_MAX_DESTS	(256)
-#define	DGR_SESNBR_MASK	(DGR_BUCKETS - 1)
+#define	DGR_DESTS	(16)		/*	Initially.		*/
+#define	DGR_MAX_DESTS	(4096)
 #define	DGR_MIN_XMIT	(2)
 #define	NBR_OF_OCC_LVLS	(3)
 #define DGR_MAX_XMIT	(DGR_MIN_XMIT + NBR_OF_OCC_LVLS)
@@ -33,11 +37,29 @@
 #define	MAX_DATA_HDR	(58)
 #define MAX_DATA_SIZE	(DGR_BUF_SIZE - MAX_DATA_HDR)
 
+/*	Inbound datagrams are received, up to DGR_RECV_BATCH at a
+ *	time, into a pool of DGR_RECV_BUFS buffers from which message
+ *	content is lent to the application rather than copied.  When
+ *	the application is holding all pooled buffers, datagrams are
+ *	received into the SAP's input buffer and copied as before.	*/
+
+#ifndef DGR_RECV_BUFS
+#define	DGR_RECV_BUFS	(16)		/*	Must be power of 2.	*/
+#endif
+
+#define	DGR_RING_MASK	(DGR_RECV_BUFS - 1)
+
+#ifndef DGR_RECV_BATCH
+#define	DGR_RECV_BATCH	(8)
+#endif
+
+#define	DGR_REPORT_SIZE	(64)
+
 #define	MTAKE(size)	sap->mtake(__FILE__, __LINE__, size)
 #define MRELEASE(ptr)	sap->mrelease(__FILE__, __LINE__, ptr)
 
 #ifndef SYS_CLOCK_RES
-#define SYS_CLOCK_RES	10000		/*	Linux (usec per tick)	*/
+#define SYS_CLOCK_RES	1000		/*	Linux (usec, hrtimers)	*/
 #endif
 
 #ifndef EPISODE_PERIOD
@@ -48,6 +70,40 @@
 #define MAX_BACKLOG	524288		/*	.5 MB (bytes)		*/
 #endif
 
+/*	Congestion controllers that limit the number of bytes in
+ *	flight to each destination may let the total backlog grow
+ *	to MAX_WINDOW.							*/
+
+#ifndef MAX_WINDOW
+#define MAX_WINDOW	(4 * MAX_BACKLOG)
+#endif
+
+/*	Retransmission timers are kept in a timer wheel whose
+ *	granularity is the rate control episode period.  The wheel
+ *	must span more than MAX_TIMEOUT seconds.			*/
+
+#define	WHEEL_SLOTS	(1024)
+#define	WHEEL_MASK	(WHEEL_SLOTS - 1)
+
+#ifndef DGR_SOCKBUF_SIZE
+#define DGR_SOCKBUF_SIZE	MAX_WINDOW
+#endif
+
+#ifndef DGR_DEFAULT_CC
+#define DGR_DEFAULT_CC	"cubic"
+#endif
+
+/*	Parameters of the CUBIC congestion controller, per RFC 8312.
+ *	Window sizes are in bytes, computed in units of CC_MSS.	*/
+
+#define	CC_MSS		(1024)
+#define	CC_INIT_CWND	(10 * CC_MSS)
+#define	CC_MIN_CWND	(2 * CC_MSS)
+#define	CC_C		(0.4)
+#define	CC_BETA		(0.7)
+#define	CC_MIN_DELAY	(250)		/*	HyStart, usec	*/
+#define	CC_MAX_DELAY	(16000)		/*	HyStart, usec	*/
+
 #ifndef MIN_TIMEOUT
 #define MIN_TIMEOUT	2		/*	per Stevens (seconds)	*/
 #endif
@@ -124,12 +180,6 @@ typedef enum
 	DgrDeliveryFailure
 } DgrRecordType;
 
-typedef struct
-{
-	Lyst		msgs;		/*	(DgrRecord *)		*/
-	pthread_mutex_t	mutex;
-} DgrArqBucket;
-
 typedef struct dgr_rec
 {
 	DgrRecordType	type;
@@ -141,7 +191,6 @@ typedef struct dgr_rec
 	/*	Relevant only for outbound messages.			*/
 	int		notificationFlags;
 	int		transmissionCount;
-	DgrArqBucket	*bucket;
 	LystElt		outboundMsgsElt;
 	struct timeval	transmitTime;
 	LystElt		pendingResendsElt;
@@ -163,6 +212,7 @@ typedef struct
 {
 	SegmentId	id;
 	struct timeval	resendTime;
+	uvast		tick;		/*	Timer wheel tick.	*/
 } ResendReq;
 
 typedef enum
@@ -191,8 +241,6 @@ typedef struct
 	int		msgsSent;
 	int		backlog;	/*	bytes			*/
 	int		msgsInBacklog;
-	int		lessActiveDest;
-	int		moreActiveDest;
 	LystElt		ownElt;
 	struct timeval	cursorXmitTime;
 	int		rttSmoothed;	/*	microseconds		*/
@@ -219,8 +267,62 @@ typedef struct
 	int		retard;		/*	microseconds per byte	*/
 	int		bytesToTransmit;
 	int		pendingDelay;	/*	microseconds		*/
+
+	/*	Congestion controller output: limit on backlog (0
+	 *	if unlimited) and pacing rate (0 if unpaced).		*/
+
+	int		cwnd;		/*	bytes			*/
+	unsigned int	pacingRate;	/*	bytes per second	*/
+
+	/*	CUBIC congestion controller state.			*/
+
+	int		ssthresh;	/*	bytes			*/
+	int		wMax;		/*	bytes			*/
+	int		wEst;		/*	bytes			*/
+	double		k;		/*	seconds			*/
+	int		minRtt;		/*	microseconds		*/
+	struct timeval	epochStart;
+	struct timeval	lastReduction;
 } DgrDest;
 
+/*	A congestion controller is a set of functions that maintain
+ *	the cwnd and pacingRate of a destination.  "acked" is called
+ *	on every acknowledgment, with the measured round-trip time
+ *	or -1 if the acknowledgment is ambiguous; "timedOut" on every
+ *	retransmission timeout; "tick" once per rate control episode.	*/
+
+typedef struct
+{
+	char		*name;
+	void		(*start)(DgrDest *dest);
+	void		(*acked)(DgrDest *dest, int bytes, int rtt);
+	void		(*timedOut)(DgrDest *dest, int bytes,
+				struct timeval *transmitTime);
+	void		(*tick)(DgrDest *dest);
+	int		maxBacklog;
+} DgrCc;
+
+/*	A DgrRing is a single-producer, single-consumer queue of
+ *	references to pooled buffers.  The producer advances only
+ *	the tail and the consumer only the head, so no lock is
+ *	needed between them.						*/
+
+typedef struct
+{
+	char		*buffer;	/*	Pooled buffer.		*/
+	char		*content;	/*	Within buffer.		*/
+	int		length;
+	unsigned short	portNbr;
+	unsigned int	ipAddress;
+} DgrDelivery;
+
+typedef struct
+{
+	unsigned int	head;
+	unsigned int	tail;
+	DgrDelivery	slots[DGR_RECV_BUFS];
+} DgrRing;
+
 typedef struct dgrsapst
 {
 	/*	The DgrSAP is roughly equivalent to the LTP database
@@ -230,37 +332,68 @@ typedef struct dgrsapst
 	uvast		engineId;
 	unsigned int	clientSvcId;
 	DgrSapState	state;
+	int		mmid;
 	MemAllocator	mtake;
 	MemDeallocator	mrelease;
 	int		udpSocket;
+	DgrCc		*cc;
 
 	pthread_mutex_t	sapMutex;
 	pthread_cond_t	sapCV;
 	unsigned int	sessionNbr;
 	int		backlog;	/*	Total, for all dests.	*/
+	int		maxBacklog;
 
 	Lyst		outboundMsgs;	/*	(SendReq *)		*/
 	struct llcv_str	outboundCV_str;
 	Llcv		outboundCV;
 
-	Lyst		pendingResends;	/*	(ResendReq *)		*/
+	Lyst		pendingResends[WHEEL_SLOTS];	/*	ResendReq *	*/
+	uvast		currentTick;	/*	Last tick processed.	*/
 	pthread_mutex_t	pendingResendsMutex;
 
 	Lyst		inboundEvents;	/*	(DgrRecord *)		*/
 	struct llcv_str	inboundCV_str;
 	Llcv		inboundCV;
 
-	DgrArqBucket	buckets[DGR_BUCKETS];
+	/*	Pooled receive buffers.  "delivered" is filled by
+	 *	the receiver thread and drained by dgr_receive;
+	 *	"returned" is filled by dgr_release_buffer and drained
+	 *	by the receiver thread.  The application's ends of
+	 *	both rings are guarded by deliveryMutex, so that any
+	 *	number of application threads may use them.		*/
+
+	char		*pool;		/*	May be NULL.		*/
+	DgrRing		delivered;
+	DgrRing		returned;
+	pthread_mutex_t	deliveryMutex;
+
+	/*	Reports issued by the receiver thread, not yet sent.	*/
+
+	int		reportsQueued;
+	int		reportLengths[DGR_RECV_BATCH];
+	struct sockaddr_in	reportAddresses[DGR_RECV_BATCH];
+	char		reports[DGR_RECV_BATCH][DGR_REPORT_SIZE];
+
+	/*	The ARQ database is a hash table of records, hashed
+	 *	by session number.  The table is enlarged as the
+	 *	number of records grows.				*/
+
+	pthread_mutex_t	arqMutex;
+	Lyst		*buckets;	/*	(DgrRecord *)		*/
+	int		bucketCount;	/*	Power of 2.		*/
+	int		recordCount;
+
 	pthread_t	sender;
 	pthread_t	resender;
 	pthread_t	receiver;
 
 	pthread_mutex_t	destsMutex;
+	pthread_cond_t	destsCV;
 	int		destsCount;
-	DgrDest		dests[DGR_MAX_DESTS];
+	int		destsLimit;
+	DgrDest		**dests;
 	Lyst		destLysts[DGR_BIN_COUNT];
-	int		leastActiveDest;
-	int		mostActiveDest;
 	DgrDest		defaultDest;
 
 	char		inputBuffer[DGR_BUF_SIZE];
@@ -328,6 +461,46 @@ static int	time_to_stop(Llcv llcv)
 	return 1;
 }
 
+static int	ringPut(DgrRing *ring, DgrDelivery *delivery)
+{
+	unsigned int	tail = ring->tail;
+
+	if (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)
+			== DGR_RECV_BUFS)
+	{
+		return -1;		/*	Ring is full.		*/
+	}
+
+	ring->slots[tail & DGR_RING_MASK] = *delivery;
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+static int	ringGet(DgrRing *ring, DgrDelivery *delivery)
+{
+	unsigned int	head = ring->head;
+
+	if (head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE))
+	{
+		return 0;		/*	Ring is empty.		*/
+	}
+
+	*delivery = ring->slots[head & DGR_RING_MASK];
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+static int	inboundReady(Llcv llcv)
+{
+	DgrSAP	*sap = (DgrSAP *) (((char *) llcv)
+				- offsetof(DgrSAP, inboundCV_str));
+
+	return (lyst_length(llcv->list) > 0
+		|| __atomic_load_n(&sap->delivered.tail, __ATOMIC_ACQUIRE)
+			!= __atomic_load_n(&sap->delivered.head,
+				__ATOMIC_ACQUIRE));
+}
+
 	/*	Hash function adapted from Dr. Dobbs, April 1996.	*/
 
 static int	hashDestId(unsigned short portNbr, unsigned int ipAddress)
@@ -372,7 +545,7 @@ static DgrDest	*findDest(DgrSAP *sap, unsigned short portNbr,
 	bin = hashDestId(portNbr, ipAddress);
 	for (elt = lyst_first(sap->destLysts[bin]); elt; elt = lyst_next(elt))
 	{
-		dest = sap->dests + (i = (unsigned long) lyst_data(elt));
+		dest = sap->dests[(i = (unsigned long) lyst_data(elt))];
 		if (dest->ipAddress == ipAddress && dest->portNbr == portNbr)
 		{
 			*idx = i;
@@ -384,6 +557,12 @@ static DgrDest	*findDest(DgrSAP *sap, unsigned short portNbr,
 	return &sap->defaultDest;
 }
 
+static uvast	tickOf(struct timeval *time)
+{
+	return ((((uvast) (time->tv_sec)) * 1000000) + time->tv_usec)
+			/ EPISODE_PERIOD;
+}
+
 static int	insertEvent(DgrSAP *sap, DgrRecord rec)
 {
 	LystElt	elt;
@@ -413,16 +592,15 @@ static int	insertEvent(DgrSAP *sap, DgrRecord rec)
 
 /*	*	*	Common operational functions	*	*	*/
 
-static void	initializeDest(DgrDest *dest, unsigned short portNbr,
-			unsigned int ipAddress)
+static void	initializeDest(DgrSAP *sap, DgrDest *dest,
+			unsigned short portNbr, unsigned int ipAddress)
 {
 	dest->portNbr = portNbr;
 	dest->ipAddress = ipAddress;
 	dest->rttSmoothed = INIT_SMOOTHED;
 	dest->meanRttDeviation = INIT_MRD;
 	dest->rttPredicted = INIT_RTT;
-	dest->retard = INITIAL_RETARD;
-	dest->bytesToTransmit = EPISODE_PERIOD / dest->retard;
+	sap->cc->start(dest);
 #if DGRDEBUG
 computedRtt = 0;
 traceMeasuredRtt = 0;
@@ -436,36 +614,81 @@ traceBytesToTransmit = dest->bytesToTransmit;
 #endif
 }
 
+static int	leastActiveDest(DgrSAP *sap)
+{
+	int	i;
+	DgrDest	*dest;
+	int	leastActive = 0;
+	DgrDest	*least = sap->dests[0];
+
+	/*	Prefer dests that have no messages awaiting
+	 *	acknowledgment.						*/
+
+	for (i = 1; i < sap->destsCount; i++)
+	{
+		dest = sap->dests[i];
+		if ((dest->msgsInBacklog == 0 && least->msgsInBacklog > 0)
+		|| ((dest->msgsInBacklog == 0) == (least->msgsInBacklog == 0)
+			&& dest->msgsSent < least->msgsSent))
+		{
+			least = dest;
+			leastActive = i;
+		}
+	}
+
+	return leastActive;
+}
+
 static DgrDest	*addNewDest(DgrSAP *sap, unsigned short portNbr,
 			unsigned int ipAddress, int *destIdx)
 {
 	unsigned long	newDest;
 	DgrDest		*dest;
-	int		nextDest;
+	DgrDest		**dests;
 	int		bin;
 
-	if (sap->destsCount < DGR_MAX_DESTS)	/*	Empty slot.	*/
+	if (sap->destsCount == sap->destsLimit
+	&& sap->destsLimit < DGR_MAX_DESTS)
+	{
+		/*	Table is full; enlarge it.			*/
+
+		dests = (DgrDest **) MTAKE(2 * sap->destsLimit
+				* sizeof(DgrDest *));
+		if (dests == NULL)
+		{
+			crashThread(sap, "Can't enlarge destinations table");
+			return NULL;
+		}
+
+		memcpy((char *) dests, (char *) sap->dests,
+				sap->destsCount * sizeof(DgrDest *));
+		MRELEASE(sap->dests);
+		sap->dests = dests;
+		sap->destsLimit *= 2;
+	}
+
+	if (sap->destsCount < sap->destsLimit)	/*	Empty slot.	*/
 	{
-		nextDest = DGR_MAX_DESTS - sap->destsCount;
-		newDest = nextDest - 1;
-		dest = sap->dests + newDest;
-		sap->leastActiveDest = newDest;
-		if (sap->destsCount == 0)	/*	The first one.	*/
+		dest = (DgrDest *) MTAKE(sizeof(DgrDest));
+		if (dest == NULL)
 		{
-			sap->mostActiveDest = newDest;
+			crashThread(sap, "Can't add new active destination");
+			return NULL;
 		}
 
+		newDest = sap->destsCount;
+		sap->dests[newDest] = dest;
 		sap->destsCount++;
 	}
 	else	/*	Replace the dest that's currently least active.	*/
 	{
-		newDest = sap->leastActiveDest;
-		dest = sap->dests + newDest;
+		newDest = leastActiveDest(sap);
+		dest = sap->dests[newDest];
 		lyst_delete(dest->ownElt);
-		nextDest = dest->moreActiveDest;
-		memset((char *) dest, 0, sizeof(DgrDest));
 	}
 
+	memset((char *) dest, 0, sizeof(DgrDest));
+
 	/*	Insert subscript of this location as new entry in
 	 *	the dests list that this IP address hashes to.		*/
 
@@ -477,9 +700,7 @@ static DgrDest	*addNewDest(DgrSAP *sap, unsigned short portNbr,
 		return NULL;
 	}
 
-	dest->lessActiveDest = -1;	/*	New one's least active.	*/
-	dest->moreActiveDest = nextDest;
-	initializeDest(dest, portNbr, ipAddress);
+	initializeDest(sap, dest, portNbr, ipAddress);
 	*destIdx = newDest;
 	return dest;
 }
@@ -519,12 +740,13 @@ static void	removeRecord(DgrSAP *sap, DgrRecord rec, LystElt arqElt)
 	}
 
 	lyst_delete(arqElt);	/*	Remove from database bucket.	*/
+	sap->recordCount--;
 
 	/*	Enable more messages to be sent.			*/
 
 	pthread_mutex_lock(&sap->sapMutex);
 	sap->backlog -= (rec->contentLength + sizeof(SegmentId));
-	if (sap->backlog <= MAX_BACKLOG)
+	if (sap->backlog <= sap->maxBacklog)
 	{
 		pthread_cond_signal(&sap->sapCV);
 	}
@@ -532,65 +754,79 @@ static void	removeRecord(DgrSAP *sap, DgrRecord rec, LystElt arqElt)
 	pthread_mutex_unlock(&sap->sapMutex);
 }
 
-static void	adjustActiveDestChain(DgrSAP *sap, int destIdx)
+static void	enlargeArqTable(DgrSAP *sap)
 {
-	int	ceiling;
-	DgrDest	*dest;
-	DgrDest	*other = NULL;
-	DgrDest	*next;
-	DgrDest	*prev;
+	int	newCount = sap->bucketCount * 2;
+	Lyst	*buckets;
+	int	i;
+	LystElt	elt;
+
+	/*	Doubles the number of buckets in the ARQ database.
+	 *	Each old bucket's records are split between two new
+	 *	buckets, preserving their order.  The caller holds
+	 *	arqMutex.  On any failure the old table is retained.	*/
 
-	dest = sap->dests + destIdx;
-	ceiling = dest->moreActiveDest;
-	while (ceiling < DGR_MAX_DESTS)
+	buckets = (Lyst *) MTAKE(newCount * sizeof(Lyst));
+	if (buckets == NULL)
 	{
-		other = sap->dests + ceiling;
-		if (dest->msgsSent <= other->msgsSent)	/*	ceiling	*/
+		return;
+	}
+
+	memset((char *) buckets, 0, newCount * sizeof(Lyst));
+	for (i = 0; i < newCount; i++)
+	{
+		if ((buckets[i] = lyst_create_using(sap->mmid)) == NULL)
 		{
 			break;
 		}
-
-		/*	Have become more active than this one.		*/
-
-		ceiling = other->moreActiveDest;
 	}
 
-	if (ceiling != dest->moreActiveDest)	/*	more active now	*/
+	if (i == newCount)
 	{
-		/*	Detach from current neighbors in list.		*/
-
-		if (dest->lessActiveDest == -1)	/*	currently least	*/
-		{
-			sap->leastActiveDest = dest->moreActiveDest;
-		}
-		else	/*	Not currently the least active dest.	*/
+		for (i = 0; i < sap->bucketCount; i++)
 		{
-			prev = sap->dests + dest->lessActiveDest;
-			prev->moreActiveDest = dest->moreActiveDest;
-		}
-
-		/*	(Cannot already be the most active dest.)	*/
+			for (elt = lyst_first(sap->buckets[i]); elt;
+					elt = lyst_next(elt))
+			{
+				DgrRecord	rec = (DgrRecord) lyst_data(elt);
 
-		next = sap->dests + dest->moreActiveDest;
-		next->lessActiveDest = dest->lessActiveDest;
+				if (lyst_insert_last(buckets
+					[rec->segment.id.sessionNbr
+					& (newCount - 1)], rec) == NULL)
+				{
+					break;
+				}
+			}
 
-		/*	Insert before new ceiling, overtaking another.	*/
+			if (elt)
+			{
+				break;
+			}
+		}
 
-		dest->moreActiveDest = ceiling;
-		if (ceiling == DGR_MAX_DESTS)	/*	now most active	*/
+		if (i == sap->bucketCount)	/*	All copied.	*/
 		{
-			dest->lessActiveDest = sap->mostActiveDest;
-			sap->mostActiveDest = destIdx;
+			for (i = 0; i < sap->bucketCount; i++)
+			{
+				lyst_destroy(sap->buckets[i]);
+			}
+
+			MRELEASE(sap->buckets);
+			sap->buckets = buckets;
+			sap->bucketCount = newCount;
+			return;
 		}
-		else	/*	Insert before the more active dest.	*/
+	}
+
+	for (i = 0; i < newCount; i++)
+	{
+		if (buckets[i])
 		{
-			dest->lessActiveDest = other->lessActiveDest;
-			other->lessActiveDest = destIdx;
+			lyst_destroy(buckets[i]);
 		}
-
-		prev = sap->dests + dest->lessActiveDest;
-		prev->moreActiveDest = destIdx;
 	}
+
+	MRELEASE(buckets);
 }
 
 static int	insertResendReq(DgrSAP *sap, DgrRecord rec, DgrDest *dest,
@@ -599,7 +835,6 @@ static int	insertResendReq(DgrSAP *sap, DgrRecord rec, DgrDest *dest,
 	ResendReq	*req;
 	int		rtt;
 	LystElt		elt;
-	ResendReq	*pending;
 	static int	minTimeout = MIN_TIMEOUT * 1000000;
 	static int	maxTimeout = MAX_TIMEOUT * 1000000;
 
@@ -625,8 +860,6 @@ static int	insertResendReq(DgrSAP *sap, DgrRecord rec, DgrDest *dest,
 		}
 		else	/*	Dest is active, we predict RTT for it.	*/
 		{
-			dest = sap->dests + destIdx;
-
 			/*	Apply exponential backoff to predicted
 			 *	round-trip time as necessary.		*/
 
@@ -637,30 +870,13 @@ static int	insertResendReq(DgrSAP *sap, DgrRecord rec, DgrDest *dest,
 resends[rec->transmissionCount - 2]++;
 #endif
 	}
-	else	/*	Original transmission, note dest activity.	*/
+	else	/*	Original transmission.			*/
 	{
-		if (destIdx < 0)	/*	Newly active dest.	*/
-		{
-			dest = addNewDest(sap, rec->portNbr, rec->ipAddress,
-					&destIdx);
-			if (dest == NULL)
-			{
-				return -1;
-			}
-		}
-
 		/*	Apply exponential backoff to predicted round-
-		 *	trip time as necessary.				*/
+		 *	trip time as necessary.  (Dest activity was
+		 *	recorded when the message was submitted.)	*/
 
 		rtt = dest->rttPredicted << dest->predictedResends;
-
-		/*	Record activity and reorder dests by level of
-		 *	activity as necessary.				*/
-
-		dest->backlog += (rec->contentLength + sizeof(SegmentId));
-		dest->msgsInBacklog++;
-		dest->msgsSent++;
-		adjustActiveDestChain(sap, destIdx);
 		dest->bytesOriginated += rec->contentLength;
 #if DGRDEBUG
 traceBytesOriginated = dest->bytesOriginated;
@@ -695,34 +911,17 @@ computedRtt = rtt;
 	}
 
 	/*	Now insert the retransmission request into the
-	 *	pendingResends list, preserving resendTime order.	*/
+	 *	timer wheel slot for the tick in which it comes due.	*/
 
+	req->tick = tickOf(&req->resendTime);
 	pthread_mutex_lock(&sap->pendingResendsMutex);
-	for (elt = lyst_last(sap->pendingResends); elt; elt = lyst_prev(elt))
-	{
-		pending = (ResendReq *) lyst_data(elt);
-		if (pending->resendTime.tv_sec > req->resendTime.tv_sec)
-		{
-			continue;
-		}
-
-		if (pending->resendTime.tv_sec < req->resendTime.tv_sec
-		|| pending->resendTime.tv_usec <= req->resendTime.tv_usec)
-		{
-			break;	/*	Found "floor" item.		*/
-		}
-	}
-
-	if (elt)
+	if (req->tick <= sap->currentTick)
 	{
-		elt = rec->pendingResendsElt = lyst_insert_after(elt, req);
-	}
-	else
-	{
-		elt = rec->pendingResendsElt =
-				lyst_insert_first(sap->pendingResends, req);
+		req->tick = sap->currentTick + 1;
 	}
 
+	elt = rec->pendingResendsElt = lyst_insert_last(sap->pendingResends
+			[req->tick & WHEEL_MASK], req);
 	pthread_mutex_unlock(&sap->pendingResendsMutex);
 	if (elt == NULL)
 	{
@@ -855,7 +1054,7 @@ static int	sendMessage(DgrSAP *sap, DgrRecord rec, LystElt arqElt,
 	return insertResendReq(sap, rec, dest, destIdx);
 }
 
-static void	noteCompletion(DgrRecord rec, DgrDest *dest, int destIdx)
+static int	noteCompletion(DgrRecord rec, DgrDest *dest, int destIdx)
 {
 	struct timeval	arrivalTime;
 	int		measuredRtt;
@@ -864,7 +1063,10 @@ static void	noteCompletion(DgrRecord rec, DgrDest *dest, int destIdx)
 	int		adj;
 	int		change;
 
-	/*	Update predicted RTT, but only if this is not a
+	/*	Returns the measured round-trip time, or -1 if the
+	 *	round-trip time can't be measured.
+	 *
+	 *	Update predicted RTT, but only if this is not a
 	 *	delayed acknowledgement, and only if we can be sure
 	 *	that the original transmission is the one that has
 	 *	been acknowledged (else we have the retransmission
@@ -882,14 +1084,14 @@ static void	noteCompletion(DgrRecord rec, DgrDest *dest, int destIdx)
 	dest->msgsInBacklog--;
 	if (rec->transmissionCount > 1)
 	{
-		return;	/*	Might not be ack of most recent xmit.	*/
+		return -1;	/*	Might not be ack of latest xmit.*/
 	}
 
 	if (rec->transmitTime.tv_sec < dest->cursorXmitTime.tv_sec
 	|| (rec->transmitTime.tv_sec == dest->cursorXmitTime.tv_sec
 		&& rec->transmitTime.tv_usec < dest->cursorXmitTime.tv_usec))
 	{
-		return;	/*	A delayed acknowledgment, somehow.	*/
+		return -1;	/*	A delayed acknowledgment.	*/
 	}
 
 	/*	Timely acknowledgment of an original transmission to
@@ -952,6 +1154,7 @@ traceRttPredicted = dest->rttPredicted;
 #if DGRDEBUG
 tracePredictedResends = dest->predictedResends;
 #endif
+	return measuredRtt;
 }
 
 static int	handleRpt(DgrSAP *sap, DgrRecord rec, LystElt arqElt,
@@ -968,13 +1171,14 @@ appliedAcks++;
 
 	dest->bytesAcknowledged += rec->contentLength;
 
-	/*	May want to update predicted RTT if the acknowledging
-	 *	dest is active enough for us to be trying to predict
-	 *	accurate RTT.						*/
+	/*	May want to update predicted RTT and congestion
+	 *	control if the acknowledging dest is active enough
+	 *	for us to be trying to predict accurate RTT.		*/
 
 	if (destIdx >= 0)	/*	An active destination.		*/
 	{
-		noteCompletion(rec, dest, destIdx);
+		sap->cc->acked(dest, rec->contentLength,
+				noteCompletion(rec, dest, destIdx));
 	}
 
 	/*	Delete pendingResends object; it's now moot.		*/
@@ -1074,6 +1278,9 @@ tracePredictedResends = dest->predictedResends;
 			}
 		}
 
+		sap->cc->timedOut(dest, rec->contentLength,
+				&rec->transmitTime);
+
 		/*	Adjust transmission limit: diminishes as an
 		 *	exponential function of increase in backlog
 		 *	of unacknowledged messages:
@@ -1170,19 +1377,19 @@ tracePredictedResends = dest->predictedResends;
 static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 			RecordOperation op)
 {
-	DgrArqBucket	*bucket;
+	Lyst		bucket;
 	LystElt		elt;
 	DgrRecord	rec;
 	DgrDest		*dest;
 	int		destIdx;
 	int		result;
 
-	bucket = sap->buckets + (sessionNbr & DGR_SESNBR_MASK);
-	pthread_mutex_lock(&bucket->mutex);
+	pthread_mutex_lock(&sap->arqMutex);
+	bucket = sap->buckets[sessionNbr & (sap->bucketCount - 1)];
 	pthread_mutex_lock(&sap->destsMutex);
 	if (op == DgrSendMessage)
 	{
-		for (elt = lyst_last(bucket->msgs); elt; elt = lyst_prev(elt))
+		for (elt = lyst_last(bucket); elt; elt = lyst_prev(elt))
 		{
 			rec = (DgrRecord) lyst_data(elt);
 			if (rec->segment.id.engineId > engineId)
@@ -1193,7 +1400,7 @@ static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 			if (rec->segment.id.engineId < engineId)
 			{
 				pthread_mutex_unlock(&sap->destsMutex);
-				pthread_mutex_unlock(&bucket->mutex);
+				pthread_mutex_unlock(&sap->arqMutex);
 				return 0;	/*	What happened?	*/
 			}
 
@@ -1207,7 +1414,7 @@ static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 			if (rec->segment.id.sessionNbr < sessionNbr)
 			{
 				pthread_mutex_unlock(&sap->destsMutex);
-				pthread_mutex_unlock(&bucket->mutex);
+				pthread_mutex_unlock(&sap->arqMutex);
 				return 0;	/*	What happened?	*/
 			}
 
@@ -1219,21 +1426,21 @@ static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 		if (elt == NULL)
 		{
 			pthread_mutex_unlock(&sap->destsMutex);
-			pthread_mutex_unlock(&bucket->mutex);
+			pthread_mutex_unlock(&sap->arqMutex);
 			return 0;		/*	What happened?	*/
 		}
 
 		dest = findDest(sap, rec->portNbr, rec->ipAddress, &destIdx);
 		result = sendMessage(sap, rec, elt, dest, destIdx);
 		pthread_mutex_unlock(&sap->destsMutex);
-		pthread_mutex_unlock(&bucket->mutex);
+		pthread_mutex_unlock(&sap->arqMutex);
 		return result;
 	}
 
 	/*	Timeout or ACK for previously sent message, so search
 	 *	from the front of the list rather than the back.	*/
 
-	for (elt = lyst_first(bucket->msgs); elt; elt = lyst_next(elt))
+	for (elt = lyst_first(bucket); elt; elt = lyst_next(elt))
 	{
 		rec = (DgrRecord) lyst_data(elt);
 		if (rec->segment.id.engineId < engineId)
@@ -1244,7 +1451,7 @@ static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 		if (rec->segment.id.engineId > engineId)
 		{
 			pthread_mutex_unlock(&sap->destsMutex);
-			pthread_mutex_unlock(&bucket->mutex);
+			pthread_mutex_unlock(&sap->arqMutex);
 			return 0;	/*	Record is already gone.	*/
 		}
 
@@ -1258,7 +1465,7 @@ static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 		if (rec->segment.id.sessionNbr > sessionNbr)
 		{
 			pthread_mutex_unlock(&sap->destsMutex);
-			pthread_mutex_unlock(&bucket->mutex);
+			pthread_mutex_unlock(&sap->arqMutex);
 			return 0;	/*	Record is already gone.	*/
 		}
 
@@ -1270,7 +1477,7 @@ static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 	if (elt == NULL)
 	{
 		pthread_mutex_unlock(&sap->destsMutex);
-		pthread_mutex_unlock(&bucket->mutex);
+		pthread_mutex_unlock(&sap->arqMutex);
 		return 0;		/*	Record is already gone.	*/
 	}
 
@@ -1284,8 +1491,11 @@ static int	arq(DgrSAP *sap, uvast engineId, unsigned int sessionNbr,
 		result = handleTimeout(sap, rec, elt, dest, destIdx);
 	}
 
+	/*	Backlog and congestion window may have changed.		*/
+
+	pthread_cond_broadcast(&sap->destsCV);
 	pthread_mutex_unlock(&sap->destsMutex);
-	pthread_mutex_unlock(&bucket->mutex);
+	pthread_mutex_unlock(&sap->arqMutex);
 	return result;
 }
 
@@ -1293,11 +1503,6 @@ static void	resetDestActivity(DgrSAP *sap)
 {
 	int	i;
 	DgrDest	*dest;
-	int	maxActivity;
-	int	mostActive;
-	int	n;
-	int	ceiling;
-	DgrDest	*ceilingDest;
 
 	pthread_mutex_lock(&sap->destsMutex);
 	if (sap->destsCount < DGR_MAX_DESTS)
@@ -1309,71 +1514,14 @@ static void	resetDestActivity(DgrSAP *sap)
 		return;
 	}
 
-	/*	Time to clean house.  First, find the most active dest.	*/
+	/*	Time to clean house.  Reduce activity count to current
+	 *	backlog for all dests, so that dests that used to be
+	 *	active but no longer are become the least active.	*/
 
-	maxActivity = -1;
-	for (i = 0; i < DGR_MAX_DESTS; i++)
+	for (i = 0; i < sap->destsCount; i++)
 	{
-		dest = sap->dests + i;
-
-		/*	Reduce activity count to current backlog for
-		 *	all dests, and flag all as not yet inserted
-		 *	into activity chain.				*/
-
+		dest = sap->dests[i];
 		dest->msgsSent = dest->msgsInBacklog;
-		dest->moreActiveDest = -1;
-		dest->lessActiveDest = -1;
-		if (dest->msgsSent > maxActivity)
-		{
-			maxActivity = dest->msgsSent;
-			mostActive = i;
-		}
-	}
-
-	sap->mostActiveDest = mostActive;
-	sap->leastActiveDest = mostActive;
-	dest = sap->dests + mostActive;
-	dest->moreActiveDest = DGR_MAX_DESTS;
-
-	/*	Now insert all other dests into the chain in descending
-	 *	activity order.  Obviously there are faster ways to do
-	 *	this sort, but we don't do it very often, so optimizing
-	 *	it seems premature; something to come back to later.	*/
-
-	for (n = 0; n < (DGR_MAX_DESTS - 1); n++)
-	{
-		ceiling = mostActive;
-		ceilingDest = dest;
-		maxActivity = -1;
-
-		/*	Find most active dest other than those that
-		 *	have already been sorted into the list.		*/
-
-		for (i = 0; i < DGR_MAX_DESTS; i++)
-		{
-			dest = sap->dests + i;
-			if (dest->moreActiveDest > 0)
-			{
-				continue;	/*	Already sorted.	*/
-			}
-
-			/*	This dest hasn't been reinserted into
-			 *	the chain yet.				*/
-
-			if (dest->msgsSent > maxActivity)
-			{
-				maxActivity = dest->msgsSent;
-				mostActive = i;
-			}
-		}
-
-		/*	Insert this one in front of the one found
-		 *	on the prior pass.				*/
-
-		ceilingDest->lessActiveDest = mostActive;
-		sap->leastActiveDest = mostActive;
-		dest = sap->dests + mostActive;
-		dest->moreActiveDest = ceiling;
 	}
 
 	pthread_mutex_unlock(&sap->destsMutex);
@@ -1526,93 +1674,380 @@ aggregateDelay = 0;
 	dest->bytesOriginated = 0;
 }
 
-static void	adjustRateControl(DgrSAP *sap)
+/*	*	*	Congestion controllers	*	*	*	*/
+
+/*	The "legacy" controller is DGR's original rate control: no
+ *	congestion window, and a pacing rate derived from the mean
+ *	rate of acknowledgment over the past eight episodes.		*/
+
+static void	legacyPace(DgrDest *dest)
 {
-	int	i;
-	DgrDest	*dest;
+	dest->pacingRate = (dest->retard > 0 ? 1000000 / dest->retard : 0);
+}
 
-#if DGRDEBUG
-PUTS("---------------------------------------------------------------");
-#endif
+static void	legacyStart(DgrDest *dest)
+{
+	dest->retard = INITIAL_RETARD;
+	dest->bytesToTransmit = EPISODE_PERIOD / dest->retard;
+	dest->cwnd = 0;
+	legacyPace(dest);
+}
 
-	pthread_mutex_lock(&sap->destsMutex);
-	for (i = 0, dest = sap->dests; i < DGR_MAX_DESTS; i++, dest++)
+static void	legacyAcked(DgrDest *dest, int bytes, int rtt)
+{
+	return;		/*	Acknowledgments tallied per episode.	*/
+}
+
+static void	legacyTimedOut(DgrDest *dest, int bytes,
+			struct timeval *transmitTime)
+{
+	return;		/*	Unused capacity tallied per episode.	*/
+}
+
+static void	legacyTick(DgrDest *dest)
+{
+	if (dest->bytesToTransmit > 0)
 	{
-		if (dest->bytesToTransmit > 0)
-		{
-			adjustRetard(dest);
-		}
+		adjustRetard(dest);
+		legacyPace(dest);
 	}
-
-#if DGRDEBUG
-appliedAcks = 0;
-#endif
-	pthread_mutex_unlock(&sap->destsMutex);
 }
 
-/*	*	*	DGR background thread functions		*	*/
+/*	The "cubic" controller limits the number of bytes in flight
+ *	to each destination by a congestion window that is grown and
+ *	reduced per CUBIC (RFC 8312), and paces transmission at a
+ *	rate of slightly more than one window per round trip.  Loss
+ *	is detected only by retransmission timeout, and the window
+ *	is reduced at most once per loss episode: timeouts of
+ *	segments transmitted before the last reduction are ignored.	*/
 
-static void	*sender(void *parm)
+static double	cubeRoot(double x)
 {
-	DgrSAP		*sap = (DgrSAP *) parm;
-	LystElt		elt;
-	SendReq		*req;
-	uvast		engineId;
-	unsigned int	sessionNbr;
-#ifndef mingw
-	sigset_t	signals;
+	double	y = 1.0;
+	int	i;
 
-	sigfillset(&signals);
-	pthread_sigmask(SIG_BLOCK, &signals, NULL);
-#endif
-	while (sap->state == DgrSapOpen)
+	if (x <= 0.0)
 	{
-		if (llcv_wait(sap->outboundCV, llcv_lyst_not_empty,
-					LLCV_BLOCKING))
-		{
-			crashThread(sap, "Sender thread failed on wait");
-			return NULL;
-		}
-
-		if (sap->state != DgrSapOpen)
-		{
-			return NULL;
-		}
+		return 0.0;
+	}
 
-		while (1)
-		{
-			llcv_lock(sap->outboundCV);
-			elt = lyst_first(sap->outboundMsgs);
-			if (elt == NULL)
-			{
-				llcv_unlock(sap->outboundCV);
-				break;
-			}
+	while (y * y * y < x)
+	{
+		y *= 2.0;
+	}
 
-			req = (SendReq *) lyst_data(elt);
-			engineId = req->id.engineId;
-			sessionNbr = req->id.sessionNbr;
-			llcv_unlock(sap->outboundCV);
-			if (arq(sap, engineId, sessionNbr, DgrSendMessage))
-			{
-				writeMemo("[i] DGR sender thread ended.");
-				return NULL;
-			}
-		}
+	for (i = 0; i < 20; i++)	/*	Newton-Raphson.		*/
+	{
+		y = ((2.0 * y) + (x / (y * y))) / 3.0;
 	}
 
-	return NULL;
+	return y;
 }
 
-static void	*resender(void *parm)
+static double	secondsSince(struct timeval *from, struct timeval *to)
 {
-	DgrSAP		*sap = (DgrSAP *) parm;
-	int		cycleNbr = 1;
-	struct timeval	currentTime;
-	LystElt		elt;
-	ResendReq	*req;
-	uvast		engineId;
-	unsigned int	sessionNbr;
+	return (to->tv_sec - from->tv_sec)
+			+ ((to->tv_usec - from->tv_usec) / 1000000.0);
+}
+
+static void	cubicPace(DgrDest *dest)
+{
+	int	rtt = dest->rttSmoothed;
+	double	gain;
+	double	rate;
+
+	if (rtt < dest->minRtt)
+	{
+		rtt = dest->minRtt;
+	}
+
+	if (rtt <= 0)		/*	No RTT measured yet.		*/
+	{
+		dest->pacingRate = 0;	/*	Window-limited only.	*/
+		return;
+	}
+
+	if (rtt < 100)
+	{
+		rtt = 100;
+	}
+
+	/*	Pace fast enough to let the window grow: twice the
+	 *	current rate during slow start, 1.25 times otherwise.	*/
+
+	gain = (dest->cwnd < dest->ssthresh ? 2.0 : 1.25);
+	rate = (gain * dest->cwnd * 1000000.0) / rtt;
+	dest->pacingRate = (rate >= UINT_MAX ? 0 : (unsigned int) rate);
+}
+
+static int	cubicDelayThreshold(DgrDest *dest)
+{
+	int	threshold = dest->minRtt >> 3;
+
+	if (threshold < CC_MIN_DELAY)
+	{
+		return CC_MIN_DELAY;
+	}
+
+	if (threshold > CC_MAX_DELAY)
+	{
+		return CC_MAX_DELAY;
+	}
+
+	return threshold;
+}
+
+static void	cubicStart(DgrDest *dest)
+{
+	dest->cwnd = CC_INIT_CWND;
+	dest->ssthresh = MAX_WINDOW;
+	dest->wMax = 0;
+	dest->wEst = 0;
+	dest->k = 0.0;
+	dest->minRtt = 0;
+	dest->epochStart.tv_sec = 0;
+	dest->lastReduction.tv_sec = 0;
+	dest->lastReduction.tv_usec = 0;
+	cubicPace(dest);
+}
+
+static void	cubicAcked(DgrDest *dest, int bytes, int rtt)
+{
+	struct timeval	now;
+	double		t;
+	double		target;
+	int		increase;
+
+	if (rtt > 0 && (dest->minRtt == 0 || rtt < dest->minRtt))
+	{
+		dest->minRtt = rtt;
+	}
+
+	if (dest->cwnd < dest->ssthresh)	/*	Slow start.	*/
+	{
+		/*	Loss is detected only by timeout, so leave
+		 *	slow start as soon as queuing delay shows up
+		 *	in the round-trip time (as in HyStart).		*/
+
+		if (rtt > 0 && rtt > dest->minRtt + cubicDelayThreshold(dest))
+		{
+			dest->ssthresh = dest->cwnd;
+		}
+		else
+		{
+			dest->cwnd += bytes;
+		}
+	}
+	else					/*	Avoidance.	*/
+	{
+		getCurrentTime(&now);
+		if (dest->epochStart.tv_sec == 0)
+		{
+			dest->epochStart = now;
+			if (dest->cwnd < dest->wMax)
+			{
+				dest->k = cubeRoot((dest->wMax - dest->cwnd)
+						/ (CC_C * CC_MSS));
+			}
+			else
+			{
+				dest->k = 0.0;
+				dest->wMax = dest->cwnd;
+			}
+
+			dest->wEst = dest->cwnd;
+		}
+
+		/*	Window growth targets the value of the cubic
+		 *	function one round trip from now, but never
+		 *	grows by more than half of the acknowledged
+		 *	bytes per acknowledgment.			*/
+
+		t = secondsSince(&dest->epochStart, &now)
+				+ (dest->minRtt / 1000000.0) - dest->k;
+		target = dest->wMax + (CC_C * CC_MSS * t * t * t);
+		if (target > dest->cwnd)
+		{
+			increase = ((target - dest->cwnd) * bytes) / dest->cwnd;
+			if (increase > (bytes >> 1))
+			{
+				increase = bytes >> 1;
+			}
+
+			dest->cwnd += increase;
+		}
+
+		/*	In the TCP-friendly region, grow at least as
+		 *	fast as standard TCP would.			*/
+
+		dest->wEst += ((3.0 * (1.0 - CC_BETA) / (1.0 + CC_BETA))
+				* bytes * CC_MSS) / dest->cwnd;
+		if (dest->wEst > dest->cwnd)
+		{
+			dest->cwnd = dest->wEst;
+		}
+	}
+
+	if (dest->cwnd > MAX_WINDOW)
+	{
+		dest->cwnd = MAX_WINDOW;
+	}
+
+	cubicPace(dest);
+}
+
+static void	cubicTimedOut(DgrDest *dest, int bytes,
+			struct timeval *transmitTime)
+{
+	if (transmitTime->tv_sec < dest->lastReduction.tv_sec
+	|| (transmitTime->tv_sec == dest->lastReduction.tv_sec
+		&& transmitTime->tv_usec < dest->lastReduction.tv_usec))
+	{
+		return;		/*	Loss episode already handled.	*/
+	}
+
+	/*	Fast convergence: release bandwidth to competing
+	 *	flows if the window was reduced in the last episode.	*/
+
+	if (dest->cwnd < dest->wMax)
+	{
+		dest->wMax = (dest->cwnd * (1.0 + CC_BETA)) / 2.0;
+	}
+	else
+	{
+		dest->wMax = dest->cwnd;
+	}
+
+	dest->cwnd *= CC_BETA;
+	if (dest->cwnd < CC_MIN_CWND)
+	{
+		dest->cwnd = CC_MIN_CWND;
+	}
+
+	dest->ssthresh = dest->cwnd;
+	dest->epochStart.tv_sec = 0;
+	getCurrentTime(&dest->lastReduction);
+	cubicPace(dest);
+}
+
+static void	cubicTick(DgrDest *dest)
+{
+	cubicPace(dest);
+}
+
+static DgrCc	ccTable[] =
+{
+	{ "legacy", legacyStart, legacyAcked, legacyTimedOut, legacyTick,
+			MAX_BACKLOG },
+	{ "cubic", cubicStart, cubicAcked, cubicTimedOut, cubicTick,
+			MAX_WINDOW },
+	{ NULL, NULL, NULL, NULL, NULL, 0 }
+};
+
+static DgrCc	*findCc(char *name)
+{
+	DgrCc	*cc;
+
+	for (cc = ccTable; cc->name; cc++)
+	{
+		if (strcmp(cc->name, name) == 0)
+		{
+			return cc;
+		}
+	}
+
+	return NULL;
+}
+
+static void	adjustRateControl(DgrSAP *sap)
+{
+	int	i;
+	DgrDest	*dest;
+
+#if DGRDEBUG
+PUTS("---------------------------------------------------------------");
+#endif
+
+	pthread_mutex_lock(&sap->destsMutex);
+	for (i = 0; i < sap->destsCount; i++)
+	{
+		dest = sap->dests[i];
+		sap->cc->tick(dest);
+	}
+
+	pthread_cond_broadcast(&sap->destsCV);
+
+#if DGRDEBUG
+appliedAcks = 0;
+#endif
+	pthread_mutex_unlock(&sap->destsMutex);
+}
+
+/*	*	*	DGR background thread functions		*	*/
+
+static void	*sender(void *parm)
+{
+	DgrSAP		*sap = (DgrSAP *) parm;
+	LystElt		elt;
+	SendReq		*req;
+	uvast		engineId;
+	unsigned int	sessionNbr;
+#ifndef mingw
+	sigset_t	signals;
+
+	sigfillset(&signals);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+#endif
+	while (sap->state == DgrSapOpen)
+	{
+		if (llcv_wait(sap->outboundCV, llcv_lyst_not_empty,
+					LLCV_BLOCKING))
+		{
+			crashThread(sap, "Sender thread failed on wait");
+			return NULL;
+		}
+
+		if (sap->state != DgrSapOpen)
+		{
+			return NULL;
+		}
+
+		while (1)
+		{
+			llcv_lock(sap->outboundCV);
+			elt = lyst_first(sap->outboundMsgs);
+			if (elt == NULL)
+			{
+				llcv_unlock(sap->outboundCV);
+				break;
+			}
+
+			req = (SendReq *) lyst_data(elt);
+			engineId = req->id.engineId;
+			sessionNbr = req->id.sessionNbr;
+			llcv_unlock(sap->outboundCV);
+			if (arq(sap, engineId, sessionNbr, DgrSendMessage))
+			{
+				writeMemo("[i] DGR sender thread ended.");
+				return NULL;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static void	*resender(void *parm)
+{
+	DgrSAP		*sap = (DgrSAP *) parm;
+	int		cycleNbr = 1;
+	struct timeval	currentTime;
+	uvast		tick;
+	Lyst		slot;
+	LystElt		elt;
+	ResendReq	*req;
+	uvast		engineId;
+	unsigned int	sessionNbr;
 #ifndef mingw
 	sigset_t	signals;
 
@@ -1628,64 +2063,159 @@ static void	*resender(void *parm)
 		}
 
 		adjustRateControl(sap);
+		cycleNbr++;
 		if ((cycleNbr & 0x7f) == 0)	/*	Every 128th.	*/
 		{
 			resetDestActivity(sap);
 		}
 
-		/*	Deal with all retransmissions that are now due.	*/
+		/*	Deal with all retransmissions that are now due,
+		 *	advancing the timer wheel one tick at a time.	*/
 
 		getCurrentTime(&currentTime);
-		while (1)
+		tick = tickOf(&currentTime);
+		pthread_mutex_lock(&sap->pendingResendsMutex);
+		if (tick > sap->currentTick + WHEEL_SLOTS)
 		{
-			pthread_mutex_lock(&sap->pendingResendsMutex);
-			elt = lyst_first(sap->pendingResends);
-			if (elt == NULL)
+			/*	Clock has jumped; one revolution of the
+			 *	wheel will catch up.			*/
+
+			sap->currentTick = tick - WHEEL_SLOTS;
+		}
+
+		while (sap->currentTick < tick)
+		{
+			slot = sap->pendingResends[(sap->currentTick + 1)
+					& WHEEL_MASK];
+			for (elt = lyst_first(slot); elt; elt = lyst_next(elt))
 			{
-				pthread_mutex_unlock(&sap->pendingResendsMutex);
-				break;	/*	No more for now.	*/
+				req = (ResendReq *) lyst_data(elt);
+				if (req->tick <= sap->currentTick + 1)
+				{
+					break;	/*	Due now.	*/
+				}
 			}
 
-			req = (ResendReq *) lyst_data(elt);
-			if (req->resendTime.tv_sec > currentTime.tv_sec)
+			if (elt == NULL)	/*	Slot is done.	*/
 			{
-				pthread_mutex_unlock(&sap->pendingResendsMutex);
-				break;	/*	No more for now.	*/
+				sap->currentTick++;
+				continue;
 			}
 
-			if (req->resendTime.tv_sec < currentTime.tv_sec
-			|| req->resendTime.tv_usec <= currentTime.tv_usec)
+			/*	Segment's resend time is here.		*/
+
+			engineId = req->id.engineId;
+			sessionNbr = req->id.sessionNbr;
+			pthread_mutex_unlock(&sap->pendingResendsMutex);
+			if (arq(sap, engineId, sessionNbr, DgrHandleTimeout))
 			{
-				/*	Segment's resend time is here.	*/
+				writeMemo("[i] DGR resender ended.");
+				return NULL;
+			}
 
-				engineId = req->id.engineId;
-				sessionNbr = req->id.sessionNbr;
-				pthread_mutex_unlock(&sap->pendingResendsMutex);
-				if (arq(sap, engineId, sessionNbr,
-						DgrHandleTimeout))
-				{
-					writeMemo("[i] DGR resender ended.");
-					return NULL;
-				}
+			pthread_mutex_lock(&sap->pendingResendsMutex);
+		}
+
+		pthread_mutex_unlock(&sap->pendingResendsMutex);
+	}
+}
+
+static int	flushReports(DgrSAP *sap)
+{
+	int	i = 0;
+#if defined (linux) && defined (MSG_WAITFORONE)
+	struct mmsghdr	msgs[DGR_RECV_BATCH];
+	struct iovec	iovs[DGR_RECV_BATCH];
+	int		sent;
+
+	memset((char *) msgs, 0, sap->reportsQueued * sizeof(struct mmsghdr));
+	for (i = 0; i < sap->reportsQueued; i++)
+	{
+		iovs[i].iov_base = sap->reports[i];
+		iovs[i].iov_len = sap->reportLengths[i];
+		msgs[i].msg_hdr.msg_name = (struct sockaddr *)
+				(sap->reportAddresses + i);
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		msgs[i].msg_hdr.msg_iov = iovs + i;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
 
+	i = 0;
+	while (i < sap->reportsQueued)
+	{
+		sent = sendmmsg(sap->udpSocket, msgs + i,
+				sap->reportsQueued - i, 0);
+		if (sent < 0)
+		{
+			if (errno == EINTR)
+			{
 				continue;
 			}
 
-			pthread_mutex_unlock(&sap->pendingResendsMutex);
-			break;		/*	No more for now.	*/
+			break;
+		}
+
+		i += sent;
+	}
+#else
+	for (i = 0; i < sap->reportsQueued; i++)
+	{
+		if (isendto(sap->udpSocket, sap->reports[i],
+				sap->reportLengths[i], 0, (struct sockaddr *)
+				(sap->reportAddresses + i),
+				sizeof(struct sockaddr_in)) < 0)
+		{
+			break;
+		}
+	}
+#endif
+	if (i < sap->reportsQueued)
+	{
+		if (errno != EBADF)		/*	Socket closed.	*/
+		{
+			crashThread(sap, "Receiver thread failed sending \
+report");
 		}
+
+		return -1;
 	}
+
+	sap->reportsQueued = 0;
+	return 0;
 }
 
-static int	sendAck(DgrSAP *sap, char *reportBuffer, int headerLength,
-			unsigned int rptSerialNbr, struct sockaddr *sockName,
-			socklen_t sockaddrlen)
+static int	queueReport(DgrSAP *sap, char *report, int length,
+			struct sockaddr *sockName)
+{
+	/*	Reports and report acknowledgments are sent in a
+	 *	batch once all segments in the current batch of
+	 *	received segments have been handled.			*/
+
+	if (sap->reportsQueued == DGR_RECV_BATCH)
+	{
+		if (flushReports(sap) < 0)
+		{
+			return -1;
+		}
+	}
+
+	memcpy(sap->reports[sap->reportsQueued], report, length);
+	sap->reportLengths[sap->reportsQueued] = length;
+	memcpy((char *) (sap->reportAddresses + sap->reportsQueued),
+			(char *) sockName, sizeof(struct sockaddr_in));
+	sap->reportsQueued++;
+	return 0;
+}
+
+static int	sendAck(DgrSAP *sap, char *segment, char *reportBuffer,
+			int headerLength, unsigned int rptSerialNbr,
+			struct sockaddr *sockName)
 {
 	char	*cursor;
 	int	length;
 	Sdnv	sdnv;
 
-	memcpy(reportBuffer, sap->inputBuffer, headerLength);
+	memcpy(reportBuffer, segment, headerLength);
 	*reportBuffer = 9;	/*	00001001; report ACK.		*/
 	length = headerLength;
 	cursor = reportBuffer + length;
@@ -1699,31 +2229,19 @@ static int	sendAck(DgrSAP *sap, char *reportBuffer, int headerLength,
 
 	/*	ACK is now ready to transmit.				*/
 
-	if (isendto(sap->udpSocket, reportBuffer, length, 0, sockName,
-			sockaddrlen) < 0)
-	{
-		if (errno != EBADF)		/*	Socket closed.	*/
-		{
-			crashThread(sap, "Receiver thread failed sending \
-acknowledgement");
-		}
-
-		return -1;
-	}
-
-	return 0;
+	return queueReport(sap, reportBuffer, length, sockName);
 }
 
-static int	sendReport(DgrSAP *sap, char *reportBuffer, int headerLength,
-			unsigned int ckptSerialNbr, unsigned int dataLength,
-			struct sockaddr *sockName, socklen_t sockaddrlen)
+static int	sendReport(DgrSAP *sap, char *segment, char *reportBuffer,
+			int headerLength, unsigned int ckptSerialNbr,
+			unsigned int dataLength, struct sockaddr *sockName)
 {
 	char		*cursor;
 	int		length;
 	Sdnv		sdnv;
 	unsigned int	rptSerialNbr = rand();
 
-	memcpy(reportBuffer, sap->inputBuffer, headerLength);
+	memcpy(reportBuffer, segment, headerLength);
 	*reportBuffer = 8;	/*	00001000; report.		*/
 	length = headerLength;
 	cursor = reportBuffer + length;
@@ -1779,29 +2297,14 @@ static int	sendReport(DgrSAP *sap, char *reportBuffer, int headerLength,
 
 	/*	Report is now ready to transmit.			*/
 
-	if (isendto(sap->udpSocket, reportBuffer, length, 0, sockName,
-			sockaddrlen) < 0)
-	{
-		if (errno != EBADF)		/*	Socket closed.	*/
-		{
-			crashThread(sap, "Receiver thread failed sending \
-report");
-		}
-
-		return -1;
-	}
-
-	return 0;
+	return queueReport(sap, reportBuffer, length, sockName);
 }
 
-static void	*receiver(void *parm)
+static int	handleSegment(DgrSAP *sap, char *buffer, int length,
+			struct sockaddr_in *socketAddress, int pooled)
 {
-	DgrSAP			*sap = (DgrSAP *) parm;
-	struct sockaddr_in	socketAddress;
-	struct sockaddr		*sockName = (struct sockaddr *) &socketAddress;
-	socklen_t		sockaddrlen;
+	struct sockaddr		*sockName = (struct sockaddr *) socketAddress;
 	unsigned short		portNbr;
-	int			length;
 	unsigned char		*cursor;
 	int			bytesRemaining;
 	unsigned int		versionNbr;
@@ -1816,305 +2319,472 @@ static void	*receiver(void *parm)
 	uvast			svcDataLength;
 	uvast			ckptSerialNbr;
 	uvast			rptSerialNbr;
-	char			reportBuffer[64];
+	char			reportBuffer[DGR_REPORT_SIZE];
 	int			reclength;
 	DgrRecord		rec;
-#ifndef mingw
-	sigset_t		signals;
+	DgrDelivery		delivery;
 
-	sigfillset(&signals);
-	pthread_sigmask(SIG_BLOCK, &signals, NULL);
-#endif
-	while (1)
+	/*	Returns 1 if the (pooled) buffer has been lent to the
+	 *	application, 0 if the buffer may be reused, -1 if the
+	 *	receiver thread must stop.				*/
+
+	/*	Parse the LTP segment header.				*/
+
+	cursor = (unsigned char *) buffer;
+	bytesRemaining = length;
+
+	/*	Version number.						*/
+
+	if (bytesRemaining < 1)
 	{
-		sockaddrlen = sizeof(struct sockaddr_in);
-		length = irecvfrom(sap->udpSocket, sap->inputBuffer,
-				DGR_BUF_SIZE, 0, sockName, &sockaddrlen);
-		if (length < 0)
-		{
-			switch (errno)
-			{
-			case EBADF:	/*	Socket has been closed.	*/
-				break;
+		return 0;	/*	Ignore random guck.		*/
+	}
 
-			case ECONNRESET:/*	Connection reset.	*/
-			case EAGAIN:	/*	Bad checksum?  Ignore.	*/
-				continue;
+	versionNbr = ((*cursor) >> 4) & 0x0f;
+	if (versionNbr != 0)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
 
-			default:
-				crashThread(sap, "Receiver thread failed on \
-recvfrom");
-				break;	/*	Out of switch.		*/
-			}
+	/*	Segment type.						*/
 
-			break;		/*	Out of main loop.	*/
-		}
+	segmentType = (*cursor) & 0x0f;
+	cursor++;
+	bytesRemaining--;
 
-		if (sap->state != DgrSapOpen)
-		{
-			break;		/*	Out of main loop.	*/
-		}
+	/*	Engine ID.						*/
 
-		/*	Parse the LTP segment header.			*/
+	if (bytesRemaining < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
 
-		cursor = (unsigned char *) (sap->inputBuffer);
-		bytesRemaining = length;
+	sdnvLength = decodeSdnv(&engineId, cursor);
+	if (sdnvLength < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
 
-		/*	Version number.					*/
+	cursor += sdnvLength;
+	bytesRemaining -= sdnvLength;
 
-		if (bytesRemaining < 1)
-		{
-			continue;	/*	Ignore random guck.	*/
-		}
+	/*	Session Nbr.						*/
 
-		versionNbr = ((*cursor) >> 4) & 0x0f;
-		if (versionNbr != 0)
-		{
-			continue;	/*	Invalid segment.	*/
-		}
+	if (bytesRemaining < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
 
-		/*	Segment type.					*/
+	sdnvLength = decodeSdnv(&sessionNbr, cursor);
+	if (sdnvLength < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
 
-		segmentType = (*cursor) & 0x0f;
-		cursor++;
-		bytesRemaining--;
+	cursor += sdnvLength;
+	bytesRemaining -= sdnvLength;
 
-		/*	Engine ID.					*/
+	/*	Extension counts.					*/
 
-		if (bytesRemaining < 1)
-		{
-			continue;	/*	Invalid segment.	*/
-		}
+	if (bytesRemaining < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
 
-		sdnvLength = decodeSdnv(&engineId, cursor);
-		if (sdnvLength < 1)
-		{
-			continue;	/*	Invalid segment.	*/
-		}
+	extensionCounts = *cursor;
+	if (extensionCounts != 0)
+	{
+		return 0;	/*	No extension support.		*/
+	}
 
-		cursor += sdnvLength;
-		bytesRemaining -= sdnvLength;
+	cursor++;
+	bytesRemaining--;
 
-		/*	Session Nbr.					*/
+	/*	Segment content.					*/
 
-		if (bytesRemaining < 1)
-		{
-			continue;	/*	Invalid segment.	*/
-		}
+	if (bytesRemaining < 1)	/*	No content.			*/
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	/*	Process content as indicated by segment type.		*/
+
+	headerLength = length - bytesRemaining;
+	if (segmentType == 8)	/*	Report.				*/
+	{
+		/*	Get report serial number.			*/
 
-		sdnvLength = decodeSdnv(&sessionNbr, cursor);
+		sdnvLength = decodeSdnv(&rptSerialNbr, cursor);
 		if (sdnvLength < 1)
 		{
-			continue;	/*	Invalid segment.	*/
+			return 0;	/*	Invalid segment.	*/
 		}
 
 		cursor += sdnvLength;
 		bytesRemaining -= sdnvLength;
-
-		/*	Extension counts.				*/
-
-		if (bytesRemaining < 1)
+		if (sendAck(sap, buffer, reportBuffer, headerLength,
+				rptSerialNbr, sockName) < 0)
 		{
-			continue;	/*	Invalid segment.	*/
+			return -1;
 		}
 
-		extensionCounts = *cursor;
-		if (extensionCounts != 0)
+		if (arq(sap, engineId, sessionNbr, DgrHandleRpt))
 		{
-			continue;	/*	No extension support.	*/
+			writeMemo("[i] DGR receiver thread ended.");
+			return -1;
 		}
 
-		cursor++;
-		bytesRemaining--;
+		return 0;
+	}
+
+	/*	Note: we always return report ACKs (9s), for
+	 *	compliance, but we always ignore all received
+	 *	report ACKs.  DGR reports are not retransmitted.
+	 *	If the report isn't received, the data segment
+	 *	is eventually retransmitted and is acknowledged
+	 *	at that time.						*/
 
-		/*	Segment content.				*/
+	if (segmentType != 3)
+	{
+		return 0;	/*	Not supported.			*/
+	}
 
-		if (bytesRemaining < 1)	/*	No content.		*/
-		{
-			continue;	/*	Invalid segment.	*/
-		}
+	/*	Red data, EOB.  Extract sender's port nbr.		*/
 
-		/*	Process content as indicated by segment type.	*/
+	portNbr = ntohs(socketAddress->sin_port);
 
-		headerLength = length - bytesRemaining;
-		if (segmentType == 8)	/*	Report.			*/
-		{
-			/*	Get report serial number.		*/
+	/*	Client service ID.					*/
 
-			sdnvLength = decodeSdnv(&rptSerialNbr, cursor);
-			if (sdnvLength < 1)
-			{
-				continue;	/*	Invalid segment.*/
-			}
+	sdnvLength = decodeSdnv(&clientSvcId, cursor);
+	if (sdnvLength < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
 
-			cursor += sdnvLength;
-			bytesRemaining -= sdnvLength;
-			if (sendAck(sap, reportBuffer, headerLength,
-				rptSerialNbr, sockName, sockaddrlen) < 0)
-			{
-				break;		/*	Main loop.	*/
-			}
+	cursor += sdnvLength;
+	bytesRemaining -= sdnvLength;
+
+	/*	Service data offset.					*/
+
+	if (bytesRemaining < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	sdnvLength = decodeSdnv(&svcDataOffset, cursor);
+	if (sdnvLength < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	if (svcDataOffset != 0)
+	{
+		return 0;	/*	Not supported.			*/
+	}
+
+	cursor += sdnvLength;
+	bytesRemaining -= sdnvLength;
+
+	/*	Service data length.					*/
+
+	if (bytesRemaining < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	sdnvLength = decodeSdnv(&svcDataLength, cursor);
+	if (sdnvLength < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	cursor += sdnvLength;
+	bytesRemaining -= sdnvLength;
+
+	/*	Checkpoint serial number.				*/
+
+	if (bytesRemaining < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+	sdnvLength = decodeSdnv(&ckptSerialNbr, cursor);
+	if (sdnvLength < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	cursor += sdnvLength;
+	bytesRemaining -= sdnvLength;
+
+	/*	Report serial number.					*/
+
+	if (bytesRemaining < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	sdnvLength = decodeSdnv(&rptSerialNbr, cursor);
+	if (sdnvLength < 1)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	cursor += sdnvLength;
+	bytesRemaining -= sdnvLength;
+
+	/*	Client service data.					*/
+
+	if (bytesRemaining < 1 || svcDataLength > bytesRemaining)
+	{
+		return 0;	/*	Invalid segment.		*/
+	}
+
+	if (rptSerialNbr != 0)
+	{
+		return 0;	/*	Not supported.			*/
+	}
+
+	if (_watching())
+	{
+		putchar('s');
+		fflush(stdout);
+	}
+
+	/*	Now send acknowledgment (report).			*/
 
-			if (arq(sap, engineId, sessionNbr, DgrHandleRpt))
+	if (sendReport(sap, buffer, reportBuffer, headerLength,
+			ckptSerialNbr, svcDataLength, sockName) < 0)
+	{
+		return -1;
+	}
+
+	/*	Lend the pooled buffer to the application if
+	 *	possible.						*/
+
+	if (pooled)
+	{
+		delivery.buffer = buffer;
+		delivery.content = (char *) cursor;
+		delivery.length = svcDataLength;
+		delivery.portNbr = portNbr;
+		delivery.ipAddress = ntohl(socketAddress->sin_addr.s_addr);
+		if (ringPut(&sap->delivered, &delivery) == 0)
+		{
+			if (_watching())
 			{
-				writeMemo("[i] DGR receiver thread ended.");
-				break;	/*	Out of main loop.	*/
+				putchar('t');
+				fflush(stdout);
 			}
 
-			continue;
+			return 1;
 		}
+	}
 
-		/*	Note: we always return report ACKs (9s), for
-		 *	compliance, but we always ignore all received
-		 *	report ACKs.  DGR reports are not retransmitted.
-		 *	If the report isn't received, the data segment
-		 *	is eventually retransmitted and is acknowledged
-		 *	at that time.					*/
+	/*	Otherwise create content arrival event.			*/
 
-		if (segmentType != 3)
-		{
-			continue;	/*	Not supported.		*/
-		}
+	reclength = sizeof(struct dgr_rec) + (svcDataLength - 1);
+	rec = (DgrRecord) MTAKE(reclength);
+	if (rec == NULL)
+	{
+		crashThread(sap, "Receiver thread failed creating \
+content arrival event");
+		return -1;
+	}
 
-		/*	Red data, EOB.  Extract sender's port nbr.	*/
+	memset((char *) rec, 0, reclength);
+	rec->type = DgrMsgIn;
+	rec->portNbr = portNbr;
+	rec->ipAddress = ntohl(socketAddress->sin_addr.s_addr);
+	rec->contentLength = svcDataLength;
+	rec->segment.id.engineId = engineId;
+	rec->segment.id.sessionNbr = sessionNbr;
+	memcpy(rec->segment.content, cursor, svcDataLength);
+	if (insertEvent(sap, rec))
+	{
+		writeMemo("[i] DGR receiver thread ended.");
+		return -1;
+	}
 
-		portNbr = ntohs(socketAddress.sin_port);
+	if (_watching())
+	{
+		putchar('t');
+		fflush(stdout);
+	}
 
-		/*	Client service ID.				*/
+	return 0;
+}
 
-		sdnvLength = decodeSdnv(&clientSvcId, cursor);
-		if (sdnvLength < 1)
-		{
-			continue;	/*	Invalid segment.	*/
-		}
+static int	receiveBatch(DgrSAP *sap, char **buffers, int count,
+			struct sockaddr_in *addresses, int *lengths)
+{
+#if defined (linux) && defined (MSG_WAITFORONE)
+	struct mmsghdr	msgs[DGR_RECV_BATCH];
+	struct iovec	iovs[DGR_RECV_BATCH];
+	int		i;
 
-		cursor += sdnvLength;
-		bytesRemaining -= sdnvLength;
+	memset((char *) msgs, 0, count * sizeof(struct mmsghdr));
+	for (i = 0; i < count; i++)
+	{
+		iovs[i].iov_base = buffers[i];
+		iovs[i].iov_len = DGR_BUF_SIZE;
+		msgs[i].msg_hdr.msg_name = (struct sockaddr *) (addresses + i);
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+		msgs[i].msg_hdr.msg_iov = iovs + i;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	/*	Block until at least one datagram has arrived, then
+	 *	take as many more as are already queued.		*/
+
+	count = recvmmsg(sap->udpSocket, msgs, count, MSG_WAITFORONE, NULL);
+	for (i = 0; i < count; i++)
+	{
+		lengths[i] = msgs[i].msg_len;
+	}
+
+	return count;
+#else
+	socklen_t	sockaddrlen = sizeof(struct sockaddr_in);
+
+	lengths[0] = irecvfrom(sap->udpSocket, buffers[0], DGR_BUF_SIZE, 0,
+			(struct sockaddr *) addresses, &sockaddrlen);
+	return (lengths[0] < 0 ? -1 : 1);
+#endif
+}
 
-		/*	Service data offset.				*/
+static void	*receiver(void *parm)
+{
+	DgrSAP			*sap = (DgrSAP *) parm;
+	char			*stash[DGR_RECV_BUFS];
+	int			stashed = 0;
+	char			*buffers[DGR_RECV_BATCH];
+	struct sockaddr_in	addresses[DGR_RECV_BATCH];
+	int			lengths[DGR_RECV_BATCH];
+	int			pooled;
+	int			taken;
+	int			count;
+	int			lent;
+	int			result = 0;
+	int			i;
+	DgrDelivery		delivery;
+#ifndef mingw
+	sigset_t		signals;
 
-		if (bytesRemaining < 1)
+	sigfillset(&signals);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+#endif
+	if (sap->pool)
+	{
+		for (i = 0; i < DGR_RECV_BUFS; i++)
 		{
-			continue;	/*	Invalid segment.	*/
+			stash[stashed++] = sap->pool + (i * DGR_BUF_SIZE);
 		}
+	}
 
-		sdnvLength = decodeSdnv(&svcDataOffset, cursor);
-		if (sdnvLength < 1)
-		{
-			continue;	/*	Invalid segment.	*/
-		}
+	while (1)
+	{
+		/*	Reclaim buffers the application has released.	*/
 
-		if (svcDataOffset != 0)
+		while (ringGet(&sap->returned, &delivery))
 		{
-			continue;	/*	Not supported.		*/
+			stash[stashed++] = delivery.buffer;
 		}
 
-		cursor += sdnvLength;
-		bytesRemaining -= sdnvLength;
-
-		/*	Service data length.				*/
+		/*	Receive into pooled buffers if any are free,
+		 *	else into the SAP's input buffer.		*/
 
-		if (bytesRemaining < 1)
+		if (stashed > 0)
 		{
-			continue;	/*	Invalid segment.	*/
+			pooled = 1;
+			taken = (stashed < DGR_RECV_BATCH ? stashed
+					: DGR_RECV_BATCH);
+			for (i = 0; i < taken; i++)
+			{
+				buffers[i] = stash[--stashed];
+			}
 		}
-
-		sdnvLength = decodeSdnv(&svcDataLength, cursor);
-		if (sdnvLength < 1)
+		else
 		{
-			continue;	/*	Invalid segment.	*/
+			pooled = 0;
+			taken = 1;
+			buffers[0] = sap->inputBuffer;
 		}
 
-		cursor += sdnvLength;
-		bytesRemaining -= sdnvLength;
-
-		/*	Checkpoint serial number.			*/
-
-		if (bytesRemaining < 1)
-		{
-			continue;	/*	Invalid segment.	*/
-		}
-		sdnvLength = decodeSdnv(&ckptSerialNbr, cursor);
-		if (sdnvLength < 1)
+		count = receiveBatch(sap, buffers, taken, addresses, lengths);
+		if (count < 0)
 		{
-			continue;	/*	Invalid segment.	*/
-		}
+			switch (errno)
+			{
+			case EBADF:	/*	Socket has been closed.	*/
+				break;
 
-		cursor += sdnvLength;
-		bytesRemaining -= sdnvLength;
+			case ECONNRESET:/*	Connection reset.	*/
+			case EAGAIN:	/*	Bad checksum?  Ignore.	*/
+			case EINTR:
+				count = 0;
+				break;
 
-		/*	Report serial number.				*/
+			default:
+				crashThread(sap, "Receiver thread failed on \
+recvfrom");
+				break;	/*	Out of switch.		*/
+			}
 
-		if (bytesRemaining < 1)
-		{
-			continue;	/*	Invalid segment.	*/
+			if (count < 0)
+			{
+				break;	/*	Out of main loop.	*/
+			}
 		}
 
-		sdnvLength = decodeSdnv(&rptSerialNbr, cursor);
-		if (sdnvLength < 1)
+		if (sap->state != DgrSapOpen)
 		{
-			continue;	/*	Invalid segment.	*/
+			break;		/*	Out of main loop.	*/
 		}
 
-		cursor += sdnvLength;
-		bytesRemaining -= sdnvLength;
-
-		/*	Client service data.				*/
-
-		if (bytesRemaining < 1)
+		lent = 0;
+		for (i = 0; i < count; i++)
 		{
-			continue;	/*	Invalid segment.	*/
-		}
+			result = handleSegment(sap, buffers[i], lengths[i],
+					addresses + i, pooled);
+			if (result < 0)
+			{
+				break;
+			}
 
-		if (rptSerialNbr != 0)
-		{
-			continue;	/*	Not supported.		*/
+			if (result > 0)
+			{
+				lent++;
+				buffers[i] = NULL;
+			}
 		}
 
-		if (_watching())
+		if (result >= 0 && sap->reportsQueued > 0)
 		{
-			putchar('s');
-			fflush(stdout);
+			result = flushReports(sap);
 		}
 
-		/*	Now send acknowledgment (report).		*/
+		/*	Keep the pooled buffers that weren't lent.	*/
 
-		if (sendReport(sap, reportBuffer, headerLength, ckptSerialNbr,
-				svcDataLength, sockName, sockaddrlen) < 0)
+		if (pooled)
 		{
-			break;		/*	Out of main loop.	*/
+			for (i = 0; i < taken; i++)
+			{
+				if (buffers[i])
+				{
+					stash[stashed++] = buffers[i];
+				}
+			}
 		}
 
-		/*	Create content arrival event.			*/
-
-		reclength = sizeof(struct dgr_rec) + (svcDataLength - 1);
-		rec = (DgrRecord) MTAKE(reclength);
-		if (rec == NULL)
+		if (lent > 0)
 		{
-			crashThread(sap, "Receiver thread failed creating \
-content arrival event");
-			break;		/*	Out of main loop.	*/
+			llcv_signal(sap->inboundCV, inboundReady);
 		}
 
-		memset((char *) rec, 0, reclength);
-		rec->type = DgrMsgIn;
-		rec->portNbr = portNbr;
-		rec->ipAddress = ntohl(socketAddress.sin_addr.s_addr);
-		rec->contentLength = svcDataLength;
-		rec->segment.id.engineId = engineId;
-		rec->segment.id.sessionNbr = sessionNbr;
-		memcpy(rec->segment.content, cursor, svcDataLength);
-		if (insertEvent(sap, rec))
+		if (result < 0)
 		{
-			writeMemo("[i] DGR receiver thread ended.");
 			break;		/*	Out of main loop.	*/
 		}
-
-		if (_watching())
-		{
-			putchar('t');
-			fflush(stdout);
-		}
 	}
 
 	/*	Main loop terminated for some reason; wrap up.		*/
@@ -2133,8 +2803,7 @@ static void	forgetObject(LystElt elt, void *userData)
 
 static void	cleanUpSAP(DgrSAP *sap)
 {
-	int		i;
-	DgrArqBucket	*bucket;
+	int	i;
 
 	if (sap->udpSocket >= 0)
 	{
@@ -2163,15 +2832,24 @@ static void	cleanUpSAP(DgrSAP *sap)
 		llcv_close(sap->inboundCV);
 	}
 
-	for (i = 0, bucket = sap->buckets; i < DGR_BUCKETS; i++, bucket++)
+	if (sap->pool)
+	{
+		free(sap->pool);
+	}
+
+	if (sap->buckets)
 	{
-		if (bucket->msgs)
+		for (i = 0; i < sap->bucketCount; i++)
 		{
-			lyst_delete_set(bucket->msgs, forgetObject, sap);
-			lyst_destroy(bucket->msgs);
+			if (sap->buckets[i])
+			{
+				lyst_delete_set(sap->buckets[i], forgetObject,
+						sap);
+				lyst_destroy(sap->buckets[i]);
+			}
 		}
 
-		pthread_mutex_destroy(&bucket->mutex);
+		MRELEASE(sap->buckets);
 	}
 
 	for (i = 0; i < DGR_BIN_COUNT; i++)
@@ -2179,16 +2857,33 @@ static void	cleanUpSAP(DgrSAP *sap)
 		lyst_destroy(sap->destLysts[i]);
 	}
 
-	if (sap->pendingResends)
+	if (sap->dests)
+	{
+		for (i = 0; i < sap->destsCount; i++)
+		{
+			MRELEASE(sap->dests[i]);
+		}
+
+		MRELEASE(sap->dests);
+	}
+
+	for (i = 0; i < WHEEL_SLOTS; i++)
 	{
-		lyst_delete_set(sap->pendingResends, forgetObject, sap);
-		lyst_destroy(sap->pendingResends);
+		if (sap->pendingResends[i])
+		{
+			lyst_delete_set(sap->pendingResends[i], forgetObject,
+					sap);
+			lyst_destroy(sap->pendingResends[i]);
+		}
 	}
 
 	pthread_mutex_lock(&sap->sapMutex);
 	pthread_cond_destroy(&sap->sapCV);
 	pthread_mutex_destroy(&sap->sapMutex);
 	pthread_mutex_destroy(&sap->pendingResendsMutex);
+	pthread_mutex_destroy(&sap->arqMutex);
+	pthread_mutex_destroy(&sap->deliveryMutex);
+	pthread_cond_destroy(&sap->destsCV);
 	pthread_mutex_destroy(&sap->destsMutex);
 	MRELEASE(sap);
 }
@@ -2202,7 +2897,7 @@ int	dgr_open(uvast ownEngineId, unsigned int clientSvcId,
 	int			mmid;
 	DgrSAP			*sap;
 	int			i;
-	DgrArqBucket		*bucket;
+	struct timeval		currentTime;
 
 	CHKERR(ownEngineId);
 	CHKERR(clientSvcId);
@@ -2245,11 +2940,12 @@ int	dgr_open(uvast ownEngineId, unsigned int clientSvcId,
 	sap->engineId = ownEngineId;
 	sap->clientSvcId = clientSvcId;
 	sap->state = DgrSapOpen;
+	sap->mmid = mmid;
 	sap->mtake = memmgr_take(mmid);
 	sap->mrelease = memmgr_release(mmid);
-	sap->leastActiveDest = -1;
-	sap->mostActiveDest = DGR_MAX_DESTS;
-	initializeDest(&sap->defaultDest, 0, 0);
+	sap->cc = findCc(DGR_DEFAULT_CC);
+	sap->maxBacklog = sap->cc->maxBacklog;
+	initializeDest(sap, &sap->defaultDest, 0, 0);
 
 	/*	Initialize UDP socket for DGR service.			*/
 
@@ -2280,6 +2976,17 @@ int	dgr_open(uvast ownEngineId, unsigned int clientSvcId,
 		return -1;
 	}
 
+	/*	Ask for socket buffers large enough to hold a full
+	 *	window of datagrams.  The system may limit the sizes
+	 *	granted; that only makes loss more likely, so any
+	 *	failure here is ignored.				*/
+
+	i = DGR_SOCKBUF_SIZE;
+	oK(setsockopt(sap->udpSocket, SOL_SOCKET, SO_RCVBUF, (char *) &i,
+			sizeof i));
+	oK(setsockopt(sap->udpSocket, SOL_SOCKET, SO_SNDBUF, (char *) &i,
+			sizeof i));
+
 	/*	Create lists and management structures.			*/
 
 	if ((sap->outboundMsgs = lyst_create_using(mmid)) == NULL)
@@ -2322,28 +3029,63 @@ int	dgr_open(uvast ownEngineId, unsigned int clientSvcId,
 		}
 	}
 
-	for (i = 0, bucket = sap->buckets; i < DGR_BUCKETS; i++, bucket++)
+	/*	Pooled receive buffers are an optimization; if they
+	 *	can't be allocated, every inbound message is copied.
+	 *	The pool is private to this SAP and large, so it is
+	 *	taken from the system heap rather than from the SAP's
+	 *	memory manager, which may be a small fixed partition
+	 *	such as the ION working memory used by AMS modules.	*/
+
+	sap->pool = malloc(DGR_RECV_BUFS * DGR_BUF_SIZE);
+	sap->buckets = (Lyst *) MTAKE(DGR_BUCKETS * sizeof(Lyst));
+	if (sap->buckets == NULL)
+	{
+		putErrmsg("DGR can't create message database.", NULL);
+		cleanUpSAP(sap);
+		return -1;
+	}
+
+	memset((char *) sap->buckets, 0, DGR_BUCKETS * sizeof(Lyst));
+	sap->bucketCount = DGR_BUCKETS;
+	for (i = 0; i < DGR_BUCKETS; i++)
 	{
-		if ((bucket->msgs = lyst_create_using(mmid)) == NULL
-		|| pthread_mutex_init(&bucket->mutex, NULL))
+		if ((sap->buckets[i] = lyst_create_using(mmid)) == NULL)
 		{
-			putSysErrmsg("DGR can't create message bucket", NULL);
+			putErrmsg("DGR can't create message bucket.", NULL);
 			cleanUpSAP(sap);
 			return -1;
 		}
 	}
 
-	if ((sap->pendingResends = lyst_create_using(mmid)) == NULL)
+	sap->dests = (DgrDest **) MTAKE(DGR_DESTS * sizeof(DgrDest *));
+	if (sap->dests == NULL)
 	{
-		putErrmsg("DGR can't create list of resend requests.", NULL);
+		putErrmsg("DGR can't create destinations table.", NULL);
 		cleanUpSAP(sap);
 		return -1;
 	}
 
+	sap->destsLimit = DGR_DESTS;
+	for (i = 0; i < WHEEL_SLOTS; i++)
+	{
+		if ((sap->pendingResends[i] = lyst_create_using(mmid)) == NULL)
+		{
+			putErrmsg("DGR can't create list of resend requests.",
+					NULL);
+			cleanUpSAP(sap);
+			return -1;
+		}
+	}
+
+	getCurrentTime(&currentTime);
+	sap->currentTick = tickOf(&currentTime);
 	if (pthread_mutex_init(&sap->sapMutex, NULL)
 	|| pthread_cond_init(&sap->sapCV, NULL)
 	|| pthread_mutex_init(&sap->pendingResendsMutex, NULL)
-	|| pthread_mutex_init(&sap->destsMutex, NULL))
+	|| pthread_mutex_init(&sap->arqMutex, NULL)
+	|| pthread_mutex_init(&sap->deliveryMutex, NULL)
+	|| pthread_mutex_init(&sap->destsMutex, NULL)
+	|| pthread_cond_init(&sap->destsCV, NULL))
 	{
 		putSysErrmsg("DGR can't initialize mutex(es)", NULL);
 		cleanUpSAP(sap);
@@ -2408,6 +3150,16 @@ void	dgr_close(DgrSAP *sap)
 
 	llcv_signal(sap->inboundCV, time_to_stop);
 
+	/*	Release any dgr_send that is waiting for the backlog
+	 *	to shrink.						*/
+
+	pthread_mutex_lock(&sap->destsMutex);
+	pthread_cond_broadcast(&sap->destsCV);
+	pthread_mutex_unlock(&sap->destsMutex);
+	pthread_mutex_lock(&sap->sapMutex);
+	pthread_cond_broadcast(&sap->sapCV);
+	pthread_mutex_unlock(&sap->sapMutex);
+
 	/*	Tell the sender thread to shut itself down.		*/
 
 	llcv_signal(sap->outboundCV, time_to_stop);
@@ -2440,6 +3192,33 @@ void	dgr_close(DgrSAP *sap)
 	cleanUpSAP(sap);
 }
 
+static void	retractRecord(DgrSAP *sap, DgrRecord rec)
+{
+	DgrDest	*dest;
+	int	destIdx;
+	int	length = rec->contentLength;
+
+	/*	Undoes the accounting for a message that dgr_send
+	 *	could not hand to the sender thread.			*/
+
+	pthread_mutex_lock(&sap->sapMutex);
+	sap->backlog -= (length + sizeof(SegmentId));
+	pthread_cond_signal(&sap->sapCV);
+	pthread_mutex_unlock(&sap->sapMutex);
+	pthread_mutex_lock(&sap->destsMutex);
+	dest = findDest(sap, rec->portNbr, rec->ipAddress, &destIdx);
+	dest->serviceLoad -= length;
+	if (destIdx >= 0)
+	{
+		dest->backlog -= (length + sizeof(SegmentId));
+		dest->msgsInBacklog--;
+	}
+
+	pthread_cond_broadcast(&sap->destsCV);
+	pthread_mutex_unlock(&sap->destsMutex);
+	MRELEASE(rec);
+}
+
 int	dgr_send(DgrSAP *sap, unsigned short toPortNbr,
 		unsigned int toIpAddress, int notificationFlags, char *content,
 		int length, DgrRC *rc)
@@ -2495,17 +3274,37 @@ int	dgr_send(DgrSAP *sap, unsigned short toPortNbr,
 	rec->contentLength = length;
 	memcpy(rec->segment.content, content, length);
 
-	/*	Apply rate control.  First compute delay: multiply
-	 *	content length by computed "retard" rate for this
-	 *	destination, the number of microseconds of delay
-	 *	per byte to impose whenever sending a datagram to
-	 *	the destination, and update statistics for future
-	 *	rate control adjustment.				*/
+	/*	Apply rate control.  First compute delay: the time
+	 *	it takes to transmit this content at the pacing rate
+	 *	computed by the congestion controller for this
+	 *	destination; the delay is imposed whenever sending
+	 *	a datagram to the destination.  Also update
+	 *	statistics for future rate control adjustment.		*/
 
 	pthread_mutex_lock(&sap->destsMutex);
 	dest = findDest(sap, toPortNbr, toIpAddress, &destIdx);
+	if (destIdx < 0)
+	{
+		dest = addNewDest(sap, toPortNbr, toIpAddress, &destIdx);
+		if (dest == NULL)
+		{
+			pthread_mutex_unlock(&sap->destsMutex);
+			putErrmsg("Can't add destination.", NULL);
+			MRELEASE(rec);
+			return -1;
+		}
+	}
+
 	dest->serviceLoad += length;
-	delay = length * dest->retard;
+	if (dest->pacingRate > 0)
+	{
+		delay = (((uvast) length) * 1000000) / dest->pacingRate;
+	}
+	else
+	{
+		delay = 0;
+	}
+
 #if DGRDEBUG
 aggregateDelay += delay;
 #endif
@@ -2526,18 +3325,53 @@ rcSnoozes++;
 		usecSnoozed += clockResolution;
 	}
 
-	if (usecSnoozed > 0)
+	/*	Then wait until the destination's congestion window
+	 *	admits this message.  The dest may have been
+	 *	replaced while we snoozed, so look it up again.	*/
+
+	pthread_mutex_lock(&sap->destsMutex);
+	while (1)
 	{
-		pthread_mutex_lock(&sap->destsMutex);
-		dest->pendingDelay -= usecSnoozed;
-		pthread_mutex_unlock(&sap->destsMutex);
+		dest = findDest(sap, toPortNbr, toIpAddress, &destIdx);
+		if (destIdx < 0)
+		{
+			dest = addNewDest(sap, toPortNbr, toIpAddress,
+					&destIdx);
+			if (dest == NULL)
+			{
+				pthread_mutex_unlock(&sap->destsMutex);
+				putErrmsg("Can't add destination.", NULL);
+				MRELEASE(rec);
+				return -1;
+			}
+		}
+
+		if (usecSnoozed > 0)
+		{
+			dest->pendingDelay -= usecSnoozed;
+			usecSnoozed = 0;
+		}
+
+		if (dest->cwnd == 0 || dest->backlog == 0
+		|| dest->backlog + length <= dest->cwnd
+		|| sap->state != DgrSapOpen)
+		{
+			break;
+		}
+
+		pthread_cond_wait(&sap->destsCV, &sap->destsMutex);
 	}
 
+	dest->backlog += (length + sizeof(SegmentId));
+	dest->msgsInBacklog++;
+	dest->msgsSent++;
+	pthread_mutex_unlock(&sap->destsMutex);
+
 	/*	Safety net: prevent volume of in-process messages
 	 *	from getting out of hand.				*/
 
 	pthread_mutex_lock(&sap->sapMutex);
-	while (sap->backlog > MAX_BACKLOG)
+	while (sap->backlog > sap->maxBacklog && sap->state == DgrSapOpen)
 	{
 		pthread_cond_wait(&sap->sapCV, &sap->sapMutex);
 	}
@@ -2550,30 +3384,30 @@ rcSnoozes++;
 	rec->segment.id.sessionNbr = sap->sessionNbr;
 	pthread_mutex_unlock(&sap->sapMutex);
 
-	/*	Store in a bucket of the DGR ARQ (record) database.
-	 *	Select bucket by computing sessionNbr modulo the
-	 *	number of buckets - 1.					*/
+	/*	Insert the new record in a bucket of the DGR ARQ
+	 *	(record) database, selected by session number.  The
+	 *	database is enlarged first if its buckets are
+	 *	getting long.						*/
 
-	rec->bucket = sap->buckets +
-			(rec->segment.id.sessionNbr & DGR_SESNBR_MASK);
+	pthread_mutex_lock(&sap->arqMutex);
+	if (sap->recordCount > (sap->bucketCount << 2)
+	&& sap->bucketCount < DGR_MAX_BUCKETS)
+	{
+		enlargeArqTable(sap);
+	}
 
-	/*	Insert the new record in the selected database bucket.	*/
+	elt = lyst_insert_last(sap->buckets[rec->segment.id.sessionNbr
+			& (sap->bucketCount - 1)], rec);
+	if (elt)
+	{
+		sap->recordCount++;
+	}
 
-	pthread_mutex_lock(&rec->bucket->mutex);
-	elt = lyst_insert_last(rec->bucket->msgs, rec);
-	pthread_mutex_unlock(&rec->bucket->mutex);
+	pthread_mutex_unlock(&sap->arqMutex);
 	if (elt == NULL)				/*	Bail.	*/
 	{
 		putErrmsg("Can't append outbound record.", NULL);
-		MRELEASE(rec);
-		pthread_mutex_lock(&sap->sapMutex);
-		sap->backlog -= (length + sizeof(SegmentId));
-		pthread_cond_signal(&sap->sapCV);
-		pthread_mutex_unlock(&sap->sapMutex);
-		pthread_mutex_lock(&sap->destsMutex);
-		dest = findDest(sap, toPortNbr, toIpAddress, &destIdx);
-		dest->serviceLoad -= length;
-		pthread_mutex_unlock(&sap->destsMutex);
+		retractRecord(sap, rec);
 		return -1;
 	}
 
@@ -2583,16 +3417,11 @@ rcSnoozes++;
 	if (insertSendReq(sap, rec) < 0)
 	{
 		putErrmsg("Can't append transmission request.", NULL);
+		pthread_mutex_lock(&sap->arqMutex);
 		lyst_delete(elt);
-		MRELEASE(rec);
-		pthread_mutex_lock(&sap->sapMutex);
-		sap->backlog -= (length + sizeof(SegmentId));
-		pthread_cond_signal(&sap->sapCV);
-		pthread_mutex_unlock(&sap->sapMutex);
-		pthread_mutex_lock(&sap->destsMutex);
-		dest = findDest(sap, toPortNbr, toIpAddress, &destIdx);
-		dest->serviceLoad -= length;
-		pthread_mutex_unlock(&sap->destsMutex);
+		sap->recordCount--;
+		pthread_mutex_unlock(&sap->arqMutex);
+		retractRecord(sap, rec);
 		return -1;
 	}
 
@@ -2607,13 +3436,15 @@ rcSnoozes++;
 	return 0;
 }
 
-int	dgr_receive(DgrSAP *sap, unsigned short *fromPortNbr,
-		unsigned int *fromIpAddress, char *content, int *length,
+int	dgr_receive_buffer(DgrSAP *sap, unsigned short *fromPortNbr,
+		unsigned int *fromIpAddress, char **content, int *length,
 		int *errnbr, int timeoutSeconds, DgrRC *rc)
 {
 	int		timeoutUsec;
 	LystElt		elt;
 	DgrRecord	rec;
+	DgrDelivery	delivery;
+	int		delivered;
 
 	CHKERR(sap);
 	CHKERR(fromPortNbr);
@@ -2647,7 +3478,22 @@ int	dgr_receive(DgrSAP *sap, unsigned short *fromPortNbr,
 
 	while (1)
 	{
-		if (llcv_wait(sap->inboundCV, llcv_lyst_not_empty, timeoutUsec))
+		/*	Messages received into pooled buffers are
+		 *	delivered without waiting on the inbound events
+		 *	CV unless there are events to deliver first.	*/
+
+		if (lyst_length(sap->inboundEvents) == 0)
+		{
+			pthread_mutex_lock(&sap->deliveryMutex);
+			delivered = ringGet(&sap->delivered, &delivery);
+			pthread_mutex_unlock(&sap->deliveryMutex);
+			if (delivered)
+			{
+				break;		/*	Out of loop.	*/
+			}
+		}
+
+		if (llcv_wait(sap->inboundCV, inboundReady, timeoutUsec))
 		{
 			if (errno == ETIMEDOUT)
 			{
@@ -2659,40 +3505,62 @@ int	dgr_receive(DgrSAP *sap, unsigned short *fromPortNbr,
 			return -1;
 		}
 
-		/*	Lyst is no longer empty, or SAP is now closed.	*/
+		/*	SAP might have been closed while we were
+		 *	sleeping.					*/
 
-		break;				/*	Out of loop.	*/
-	}
+		if (sap->state == DgrSapDamaged)
+		{
+			writeMemo("[?] DGR access point no longer usable.");
+			*rc = DgrFailed;
+			return 0;
+		}
 
-	/*	SAP might have been closed while we were sleeping.	*/
+		if (sap->state == DgrSapClosed)
+		{
+			writeMemo("[i] DGR access point has been closed.");
+			*rc = DgrFailed;
+			return 0;
+		}
 
-	if (sap->state == DgrSapDamaged)
-	{
-		writeMemo("[?] DGR access point no longer usable.");
-		*rc = DgrFailed;
-		return 0;
+		/*	Interruptions, delivery notices, and inbound
+		 *	messages that couldn't be received into pooled
+		 *	buffers are in the inbound events list.		*/
+
+		llcv_lock(sap->inboundCV);
+		elt = lyst_first(sap->inboundEvents);
+		if (elt)
+		{
+			rec = (DgrRecord) lyst_data(elt);
+			lyst_delete(elt);
+			llcv_unlock(sap->inboundCV);
+			delivered = 0;
+			break;			/*	Out of loop.	*/
+		}
+
+		llcv_unlock(sap->inboundCV);
+
+		/*	Loop to take the inbound message (if any) from
+		 *	the delivery ring.				*/
 	}
 
-	if (sap->state == DgrSapClosed)
+	if (delivered)
 	{
-		writeMemo("[i] DGR access point has been closed.");
-		*rc = DgrFailed;
+		*fromPortNbr = delivery.portNbr;
+		*fromIpAddress = delivery.ipAddress;
+		*content = delivery.content;
+		*length = delivery.length;
+		*rc = DgrDatagramReceived;
 		return 0;
 	}
 
-	llcv_lock(sap->inboundCV);
-	elt = lyst_first(sap->inboundEvents);
-	rec = (DgrRecord) lyst_data(elt);
-	lyst_delete(elt);
-	llcv_unlock(sap->inboundCV);
 	if (rec == NULL)		/*	Interrupted.		*/
 	{
 		*rc =  DgrInterrupted;
 		return 0;
 	}
 
+	*content = rec->segment.content;
 	*length = rec->contentLength;
-	memcpy(content, rec->segment.content, rec->contentLength);
 	switch (rec->type)
 	{
 	case DgrMsgIn:
@@ -2710,10 +3578,62 @@ int	dgr_receive(DgrSAP *sap, unsigned short *fromPortNbr,
 		*rc = DgrDatagramNotAcknowledged;
 	}
 
-	/*	Reclaim memory occupied by the inbound message
-	 *	or delivery failure.					*/
+	return 0;
+}
+
+void	dgr_release_buffer(DgrSAP *sap, char *content)
+{
+	DgrDelivery	delivery;
+	long		offset;
+
+	CHKVOID(sap);
+	CHKVOID(content);
+	offset = (sap->pool ? content - sap->pool : -1);
+	if (offset >= 0 && offset < ((long) DGR_RECV_BUFS) * DGR_BUF_SIZE)
+	{
+		/*	Return pooled buffer to the receiver thread.	*/
+
+		delivery.buffer = sap->pool
+				+ ((offset / DGR_BUF_SIZE) * DGR_BUF_SIZE);
+		pthread_mutex_lock(&sap->deliveryMutex);
+		oK(ringPut(&sap->returned, &delivery));
+		pthread_mutex_unlock(&sap->deliveryMutex);
+		return;
+	}
+
+	/*	Reclaim memory occupied by the inbound message or
+	 *	delivery notice.					*/
+
+	MRELEASE(content - (offsetof(struct dgr_rec, segment)
+			+ offsetof(Segment, content)));
+}
+
+int	dgr_receive(DgrSAP *sap, unsigned short *fromPortNbr,
+		unsigned int *fromIpAddress, char *content, int *length,
+		int *errnbr, int timeoutSeconds, DgrRC *rc)
+{
+	char	*buffer;
+
+	CHKERR(content);
+	if (dgr_receive_buffer(sap, fromPortNbr, fromIpAddress, &buffer,
+			length, errnbr, timeoutSeconds, rc) < 0)
+	{
+		return -1;
+	}
+
+	switch (*rc)
+	{
+	case DgrDatagramReceived:
+	case DgrDatagramAcknowledged:
+	case DgrDatagramNotAcknowledged:
+		memcpy(content, buffer, *length);
+		dgr_release_buffer(sap, buffer);
+		break;
+
+	default:
+		break;
+	}
 
-	MRELEASE(rec);
 	return 0;
 }
 
@@ -2722,3 +3642,36 @@ void	dgr_interrupt(DgrSAP *sap)
 	CHKVOID(sap);
 	CHKVOID(insertEvent(sap, NULL) == 0);
 }
+
+int	dgr_set_congestion_control(DgrSAP *sap, char *name)
+{
+	DgrCc	*cc;
+	int	i;
+
+	CHKERR(sap);
+	CHKERR(name);
+	cc = findCc(name);
+	if (cc == NULL)
+	{
+		putErrmsg("Unknown DGR congestion controller.", name);
+		return -1;
+	}
+
+	/*	Restart congestion control for all destinations.	*/
+
+	pthread_mutex_lock(&sap->destsMutex);
+	sap->cc = cc;
+	for (i = 0; i < sap->destsCount; i++)
+	{
+		cc->start(sap->dests[i]);
+	}
+
+	cc->start(&sap->defaultDest);
+	pthread_cond_broadcast(&sap->destsCV);
+	pthread_mutex_unlock(&sap->destsMutex);
+	pthread_mutex_lock(&sap->sapMutex);
+	sap->maxBacklog = cc->maxBacklog;
+	pthread_cond_broadcast(&sap->sapCV);
+	pthread_mutex_unlock(&sap->sapMutex);
+	return 0;
+}
@@ -253,6 +253,8 @@ typedef struct
 	PsmAddress	rangeIndex;	/*	SM RB tree: IonRXref	*/
 	PsmAddress	timeline;	/*	SM RB tree: IonEvent	*/
 	PsmAddress	probes;		/*	SM list: IonProbe	*/
+	unsigned int	keyGeneration;	/*	Bumped on key edits.	*/
+	unsigned int	ruleGeneration;	/*	Bumped on rule edits.	*/
 } IonVdb;
 
 typedef struct
@@ -338,6 +340,14 @@ extern int		_extractSmallSdnv(unsigned int *into,
 					unsigned char **from,
 					int *nbrOfBytesRemaining,
 					int lineNbr);
+#define extractSdnvs(into, count, from, remnant) \
+if (_extractSdnvs(into, count, (unsigned char **) from, remnant, __LINE__) < 1) \
+return 0
+extern int		_extractSdnvs(	uvast *into,
+					int count,
+					unsigned char **from,
+					int *nbrOfBytesRemaining,
+					int lineNbr);
 
 extern int		ionLocked();
 
@@ -138,6 +138,14 @@ extern int	sec_get_key(char *keyName,
 		 *	key is not found, returns 0.  On system
 		 *	failure returns -1.				*/
 
+extern unsigned int
+		sec_get_keyGeneration();
+		/*	Returns a number that changes whenever any
+		 *	security key is added, updated, or removed,
+		 *	so that volatile copies of key values can
+		 *	be discarded when they may be stale.  Reads
+		 *	nothing from the SDR.				*/
+
 
 extern int	sec_get_bspBabRule(char *srcEid, char *destEid, Object *ruleAddr, Object *eltp);
 
@@ -604,6 +604,24 @@ typedef struct
 
 extern void			encodeSdnv(Sdnv *, uvast);
 extern int			decodeSdnv(uvast *, unsigned char *);
+extern int			decodeBoundedSdnv(uvast *, unsigned char *,
+					int textLength);
+
+/*	Batch SDNV operations: encodeSdnvs encodes count values into
+ *	buffer and returns the length of the encoded text, or 0 if it
+ *	would not all fit.  Note that encodeSdnvs may alter bytes of
+ *	buffer beyond the end of the encoded text (but never beyond
+ *	bufferLength), and on failure the content of buffer is
+ *	undefined.  decodeSdnvs decodes count SDNVs from text and
+ *	returns the number of bytes consumed, or 0 if any of them is
+ *	invalid or extends beyond textLength.				*/
+
+extern int			encodeSdnvs(unsigned char *buffer,
+					int bufferLength,
+					uvast *vals, int count);
+extern int			decodeSdnvs(uvast *vals, int count,
+					unsigned char *text,
+					int textLength);
 
 typedef struct
 {
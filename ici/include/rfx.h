@@ -91,6 +91,27 @@ extern int		rfx_remove_range(time_t fromTime,
 				object from the time-ordered ranges
 				list in the ION database.		*/
 
+/*	*	Function for bulk loading of a contact plan.		*/
+
+extern int		rfx_insert_plan(IonContact *contacts,
+				int contactCount,
+				IonRange *ranges,
+				int rangeCount);
+			/*	Inserts all of the contacts and ranges
+				in the arrays, in a single transaction,
+				as rfx_insert_contact and rfx_insert_range
+				would insert each one.  The arrays are
+				sorted in place unless already sorted
+				by from node, to node, and from time.
+				Rather than inserting the index entries
+				one at a time, the contact and range
+				indexes are rebuilt from the merged
+				entries, and route computation is told
+				of the change to the contact plan only
+				once.
+
+				Returns 0 on success, -1 on any error.	*/
+
 /*	*	Functions for controlling the rfxclock.			*/
 
 extern int		rfx_start();
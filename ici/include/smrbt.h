@@ -74,6 +74,19 @@ extern PsmAddress	Sm_rbt_insert(char *file, int line,
 				PsmAddress data, SmRbtCompareFn compare,
 				void *dataBuffer);
 
+#define sm_rbt_build(partition, rbt, data, count) \
+Sm_rbt_build(__FILE__, __LINE__, partition, rbt, data, count)
+extern int		Sm_rbt_build(char *file, int line,
+				PsmPartition partition, PsmAddress rbt,
+				PsmAddress *data, long count);
+/*	Note: sm_rbt_build populates an empty rbt with the count
+	user data in the data array, which must already be in the
+	order that the rbt's compare function would impose.  This
+	takes time linear in count, rather than the n log n time
+	taken to insert the data one at a time.  Returns 0 on
+	success, -1 on any error, in which case the rbt is left
+	empty.								*/
+
 #define sm_rbt_delete(partition, rbt, compare, dataBuffer, deleteFn, \
 argument) Sm_rbt_delete(__FILE__, __LINE__, partition, rbt, compare, \
 dataBuffer, deleteFn, argument)
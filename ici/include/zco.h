@@ -69,6 +69,31 @@ typedef enum
 	ZcoZcoSource = 3
 } ZcoMedium;
 
+/*	A ZcoDigest computes some function (e.g., an HMAC) of the
+ *	leading bytes of a ZCO as they are copied out by zco_transmit
+ *	and substitutes the result for the bytes that immediately
+ *	follow them.  This enables a digest that is carried at the
+ *	end of a ZCO to be computed in the same pass over the ZCO
+ *	that copies its bytes out for transmission.			*/
+
+typedef void	(*ZcoDigestStartFn)(void *context);
+typedef void	(*ZcoDigestUpdateFn)(void *context, char *bytes,
+			vast length);
+typedef void	(*ZcoDigestFinishFn)(void *context, char *result,
+			vast resultLength);
+
+typedef struct
+{
+	ZcoDigestStartFn	start;
+	ZcoDigestUpdateFn	update;
+	ZcoDigestFinishFn	finish;
+	void			*context;
+	vast			digestLength;	/*	Leading bytes.	*/
+	char			*result;
+	vast			resultLength;
+	int			finished;	/*	Boolean.	*/
+} ZcoDigest;
+
 typedef struct
 {
 	Object	zco;
@@ -77,6 +102,7 @@ typedef struct
 	vast	sourceLengthCopied;		/*	within extents	*/
 	vast	trailersLengthCopied;		/*	within extents	*/
 	vast	lengthCopied;			/*	incl. capsules	*/
+	ZcoDigest	*digest;		/*	Optional.	*/
 } ZcoReader;
 
 /*	Commonly used functions for building, accessing, managing,
@@ -327,6 +353,27 @@ extern void	zco_track_file_offset(ZcoReader *reader);
 			/*	Turn on file offset tracking for this
 			 *	reader.					*/
 
+extern void	zco_digest_transmission(ZcoReader *reader,
+				ZcoDigest *digest);
+			/*	Attaches "digest" to this reader, which
+			 *	must not yet have transmitted any bytes,
+			 *	and calls the digest's start function.
+			 *	As zco_transmit subsequently copies
+			 *	bytes of the ZCO into buffers, the
+			 *	first digestLength bytes are passed to
+			 *	the digest's update function.  When the
+			 *	reader first advances beyond those
+			 *	bytes, the digest's finish function
+			 *	is called to write resultLength bytes
+			 *	into digest->result; those bytes are
+			 *	then copied out in place of the next
+			 *	resultLength bytes of the ZCO.  The
+			 *	ZCO itself is not modified.
+			 *
+			 *	Bytes may not be skipped (by passing
+			 *	a NULL buffer to zco_transmit) while
+			 *	the digest is being computed.		*/
+
 extern vast	zco_transmit(	Sdr sdr,
 				ZcoReader *reader,
 				vast length,
@@ -1463,7 +1463,7 @@ int	_extractSdnv(uvast *into, unsigned char **from, int *remnant,
 		return 0;
 	}
 
-	sdnvLength = decodeSdnv(into, *from);
+	sdnvLength = decodeBoundedSdnv(into, *from, *remnant);
 	if (sdnvLength < 1)
 	{
 		writeMemoNote("[?] Invalid SDNV at line...", itoa(lineNbr));
@@ -1488,7 +1488,7 @@ int	_extractSmallSdnv(unsigned int *into, unsigned char **from,
 		return 0;
 	}
 
-	sdnvLength = decodeSdnv(&val, *from);
+	sdnvLength = decodeBoundedSdnv(&val, *from, *remnant);
 	if (sdnvLength < 1)
 	{
 		writeMemoNote("[?] Invalid SDNV at line...", itoa(lineNbr));
@@ -1501,6 +1501,30 @@ int	_extractSmallSdnv(unsigned int *into, unsigned char **from,
 	return sdnvLength;
 }
 
+int	_extractSdnvs(uvast *into, int count, unsigned char **from,
+		int *remnant, int lineNbr)
+{
+	int	length;
+
+	CHKZERO(into && from && remnant);
+	if (*remnant < count)
+	{
+		writeMemoNote("[?] Missing SDNV at line...", itoa(lineNbr));
+		return 0;
+	}
+
+	length = decodeSdnvs(into, count, *from, *remnant);
+	if (length < 1)
+	{
+		writeMemoNote("[?] Invalid SDNV at line...", itoa(lineNbr));
+		return 0;
+	}
+
+	(*from) += length;
+	(*remnant) -= length;
+	return length;
+}
+
 /*	*	*	Debugging 	*	*	*	*	*/
 
 int	ionLocked()
@@ -278,6 +278,11 @@ void	ionClear(char *srcEid, char *destEid, char *blockType)
 			}
 		}
 
+		if (rmCount > 0)
+		{
+			getIonVdb()->ruleGeneration++;
+		}
+
 		isprintf(rmStr, 5, "%d", rmCount);
 		writeMemoNote("[i] BAB rules removed", rmStr);
 		if (sdr_end_xn(sdr) < 0)
@@ -320,6 +325,11 @@ void	ionClear(char *srcEid, char *destEid, char *blockType)
                         }
                 }
 
+                if (rmCount > 0)
+                {
+                        getIonVdb()->ruleGeneration++;
+                }
+
                 isprintf(rmStr, 5, "%d", rmCount);
                 writeMemoNote("[i] PIB rules removed", rmStr);
                 if (sdr_end_xn(sdr) < 0)
@@ -361,6 +371,11 @@ void	ionClear(char *srcEid, char *destEid, char *blockType)
                         }
                 }
 
+                if (rmCount > 0)
+                {
+                        getIonVdb()->ruleGeneration++;
+                }
+
                 isprintf(rmStr, 5, "%d", rmCount);
                 writeMemoNote("[i] PCB rules removed", rmStr);
                 if (sdr_end_xn(sdr) < 0)
@@ -571,6 +586,7 @@ int	sec_addKey(char *keyName, char *fileName)
 	}
 
 	sdr_write(sdr, keyObj, (char *) &key, sizeof(SecKey));
+	getIonVdb()->keyGeneration++;
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't add key.", NULL);
@@ -633,6 +649,7 @@ int	sec_updateKey(char *keyName, char *fileName)
 	}
 
 	sdr_write(sdr, keyObj, (char *) &key, sizeof(SecKey));
+	getIonVdb()->keyGeneration++;
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't update key.", keyName);
@@ -667,6 +684,7 @@ int	sec_removeKey(char *keyName)
 	}
 
 	sdr_free(sdr, keyObj);
+	getIonVdb()->keyGeneration++;
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't remove key.", NULL);
@@ -707,6 +725,14 @@ int	sec_get_key(char *keyName, int *keyBufferLength, char *keyValueBuffer)
 	return key->length;
 }
 
+unsigned int	sec_get_keyGeneration()
+{
+	IonVdb	*vdb = getIonVdb();
+
+	CHKZERO(vdb);
+	return vdb->keyGeneration;
+}
+
 static int	filterEid(char *outputEid, char *inputEid)
 {
 	int	eidLength = istrlen(inputEid, MAX_SDRSTRING + 1);
@@ -813,16 +839,498 @@ static int	eidsMatch(char *firstEid, int firstEidLen, char *secondEid,
 	return (result == 0);
 }
 
-int	sec_get_bspBabRule(char *srcEid, char *destEid, Object *ruleAddr,
-		Object *eltp)
+/*	*	*	Security rule index	*	*	*	*/
+
+/*	Each process that looks up security rules keeps a volatile
+ *	index of each rules list, so that a lookup neither scans the
+ *	list nor reads the SDR.  An index is discarded and reloaded
+ *	from the SDR whenever the rule generation in the ION volatile
+ *	database no longer matches the generation from which it was
+ *	loaded; every addition or removal of a rule increments the
+ *	rule generation.
+ *
+ *	The semantics of the list scan are preserved exactly: the
+ *	applicable rule is the first rule in list order whose source
+ *	and destination EIDs both match according to eidsMatch.  Once
+ *	any terminating '~' wild card is removed from each EID, two
+ *	EIDs match if and only if one of them is a prefix of the other
+ *	(an EID that is only a wild card becoming the empty string,
+ *	which is a prefix of every EID).  So each index is a trie of
+ *	the rules' destination EIDs with wild cards removed: the rules
+ *	whose destination EIDs match a given EID are those at the
+ *	nodes on the path to that EID and those in the subtree below
+ *	it.  At each node the rules are chained in list order.		*/
+
+typedef struct secRuleNode
+{
+	struct secRuleNode	*child;		/*	First child.	*/
+	struct secRuleNode	*sibling;
+	int			firstRule;	/*	-1 if none.	*/
+	int			lastRule;
+	char			ch;
+} SecRuleNode;
+
+typedef struct
+{
+	Object		ruleAddr;
+	Object		elt;
+	int		blockTypeNbr;
+	int		nextAtNode;	/*	Rule nbr, -1 if none.	*/
+	int		srcEidLen;	/*	Wild card removed.	*/
+	char		*srcEid;
+} SecRuleEntry;
+
+typedef struct
+{
+	int		loaded;		/*	Boolean.		*/
+	unsigned int	generation;
+	int		ruleCount;
+	int		maxRules;
+	SecRuleEntry	*rules;		/*	In list order.		*/
+	SecRuleNode	*root;
+} SecRuleIndex;
+
+static pthread_mutex_t	*_ruleIndexLock()
+{
+	static pthread_mutex_t	lock = PTHREAD_MUTEX_INITIALIZER;
+
+	return &lock;
+}
+
+static SecRuleIndex	*_ruleIndex(int ruleType)
+{
+	static SecRuleIndex	babIndex;
+	static SecRuleIndex	pibIndex;
+	static SecRuleIndex	pcbIndex;
+
+	switch (ruleType)
+	{
+	case BSP_BAB_TYPE:
+		return &babIndex;
+
+	case BSP_PIB_TYPE:
+		return &pibIndex;
+
+	default:
+		return &pcbIndex;
+	}
+}
+
+static int	wildcardFreeLength(char *eid, int eidLen)
+{
+	if (eidLen > 0 && eid[eidLen - 1] == '~')
+	{
+		return eidLen - 1;
+	}
+
+	return eidLen;
+}
+
+static void	destroyRuleNodes(SecRuleNode *node)
+{
+	SecRuleNode	*next;
+
+	while (node)
+	{
+		destroyRuleNodes(node->child);
+		next = node->sibling;
+		MRELEASE(node);
+		node = next;
+	}
+}
+
+static void	clearRuleIndex(SecRuleIndex *index)
+{
+	int	i;
+
+	for (i = 0; i < index->ruleCount; i++)
+	{
+		MRELEASE(index->rules[i].srcEid);
+	}
+
+	if (index->rules)
+	{
+		MRELEASE(index->rules);
+	}
+
+	destroyRuleNodes(index->root);
+	memset((char *) index, 0, sizeof(SecRuleIndex));
+}
+
+static SecRuleNode	*newRuleNode(char ch)
+{
+	SecRuleNode	*node;
+
+	node = (SecRuleNode *) MTAKE(sizeof(SecRuleNode));
+	if (node)
+	{
+		node->child = NULL;
+		node->sibling = NULL;
+		node->firstRule = -1;
+		node->lastRule = -1;
+		node->ch = ch;
+	}
+
+	return node;
+}
+
+static int	indexRule(SecRuleIndex *index, Object ruleAddr, Object elt,
+			int blockTypeNbr, char *srcEid, char *destEid)
+{
+	SecRuleEntry	*rules;
+	SecRuleEntry	*entry;
+	SecRuleNode	*node;
+	SecRuleNode	*child;
+	int		ruleNbr;
+	int		len;
+	int		i;
+
+	if (index->ruleCount == index->maxRules)
+	{
+		i = (index->maxRules == 0 ? 16 : index->maxRules * 2);
+		rules = (SecRuleEntry *) MTAKE(i * sizeof(SecRuleEntry));
+		if (rules == NULL)
+		{
+			putErrmsg("No memory for security rule index.", NULL);
+			return -1;
+		}
+
+		if (index->rules)
+		{
+			memcpy((char *) rules, (char *) index->rules,
+				index->ruleCount * sizeof(SecRuleEntry));
+			MRELEASE(index->rules);
+		}
+
+		index->rules = rules;
+		index->maxRules = i;
+	}
+
+	if (index->root == NULL)
+	{
+		index->root = newRuleNode('\0');
+		if (index->root == NULL)
+		{
+			putErrmsg("No memory for security rule index.", NULL);
+			return -1;
+		}
+	}
+
+	/*	Find or add the trie node for the destination EID.	*/
+
+	node = index->root;
+	len = wildcardFreeLength(destEid, strlen(destEid));
+	for (i = 0; i < len; i++)
+	{
+		for (child = node->child; child; child = child->sibling)
+		{
+			if (child->ch == destEid[i])
+			{
+				break;
+			}
+		}
+
+		if (child == NULL)
+		{
+			child = newRuleNode(destEid[i]);
+			if (child == NULL)
+			{
+				putErrmsg("No memory for security rule index.",
+						NULL);
+				return -1;
+			}
+
+			child->sibling = node->child;
+			node->child = child;
+		}
+
+		node = child;
+	}
+
+	ruleNbr = index->ruleCount;
+	entry = index->rules + ruleNbr;
+	len = wildcardFreeLength(srcEid, strlen(srcEid));
+	entry->srcEid = MTAKE(len + 1);
+	if (entry->srcEid == NULL)
+	{
+		putErrmsg("No memory for security rule index.", NULL);
+		return -1;
+	}
+
+	memcpy(entry->srcEid, srcEid, len);
+	entry->srcEid[len] = '\0';
+	entry->srcEidLen = len;
+	entry->ruleAddr = ruleAddr;
+	entry->elt = elt;
+	entry->blockTypeNbr = blockTypeNbr;
+	entry->nextAtNode = -1;
+	index->ruleCount++;
+
+	/*	Rules are always indexed in list order, so the new
+	 *	rule is last in the chain at its node.			*/
+
+	if (node->lastRule < 0)
+	{
+		node->firstRule = ruleNbr;
+	}
+	else
+	{
+		index->rules[node->lastRule].nextAtNode = ruleNbr;
+	}
+
+	node->lastRule = ruleNbr;
+	return 0;
+}
+
+static int	loadRuleIndex(SecRuleIndex *index, int ruleType)
 {
 	Sdr	sdr = getIonsdr();
 	SecDB	*secdb = _secConstants();
+	Object	rules;
 	Object	elt;
-		OBJ_POINTER(BspBabRule, rule);
-	int	eidLen;
-	char	eidBuffer[SDRSTRING_BUFSZ];
-	int	result = 0;
+	Object	ruleAddr;
+	Object	srcEidObj;
+	Object	destEidObj;
+	int	blockTypeNbr;
+	char	srcEid[SDRSTRING_BUFSZ];
+	char	destEid[SDRSTRING_BUFSZ];
+		OBJ_POINTER(BspBabRule, babRule);
+		OBJ_POINTER(BspPibRule, pibRule);
+		OBJ_POINTER(BspPcbRule, pcbRule);
+
+	CHKERR(ionLocked());
+	clearRuleIndex(index);
+	switch (ruleType)
+	{
+	case BSP_BAB_TYPE:
+		rules = secdb->bspBabRules;
+		break;
+
+	case BSP_PIB_TYPE:
+		rules = secdb->bspPibRules;
+		break;
+
+	default:
+		rules = secdb->bspPcbRules;
+	}
+
+	for (elt = sdr_list_first(sdr, rules); elt;
+			elt = sdr_list_next(sdr, elt))
+	{
+		ruleAddr = sdr_list_data(sdr, elt);
+		switch (ruleType)
+		{
+		case BSP_BAB_TYPE:
+			GET_OBJ_POINTER(sdr, BspBabRule, babRule, ruleAddr);
+			srcEidObj = babRule->securitySrcEid;
+			destEidObj = babRule->securityDestEid;
+			blockTypeNbr = 0;
+			break;
+
+		case BSP_PIB_TYPE:
+			GET_OBJ_POINTER(sdr, BspPibRule, pibRule, ruleAddr);
+			srcEidObj = pibRule->securitySrcEid;
+			destEidObj = pibRule->securityDestEid;
+			blockTypeNbr = pibRule->blockTypeNbr;
+			break;
+
+		default:
+			GET_OBJ_POINTER(sdr, BspPcbRule, pcbRule, ruleAddr);
+			srcEidObj = pcbRule->securitySrcEid;
+			destEidObj = pcbRule->securityDestEid;
+			blockTypeNbr = pcbRule->blockTypeNbr;
+		}
+
+		if (sdr_string_read(sdr, srcEid, srcEidObj) < 0
+		|| sdr_string_read(sdr, destEid, destEidObj) < 0
+		|| indexRule(index, ruleAddr, elt, blockTypeNbr, srcEid,
+				destEid) < 0)
+		{
+			clearRuleIndex(index);
+			putErrmsg("Can't load security rule index.", NULL);
+			return -1;
+		}
+	}
+
+	index->generation = getIonVdb()->ruleGeneration;
+	index->loaded = 1;
+	return 0;
+}
+
+/*	Returns the lesser of bestRule and the number of the first
+ *	applicable rule in the chain of rules at this node.		*/
+
+static int	firstRuleAtNode(SecRuleIndex *index, SecRuleNode *node,
+			char *srcEid, int srcEidLen, int blockTypeNbr,
+			int bestRule)
+{
+	SecRuleEntry	*entry;
+	int		ruleNbr;
+
+	for (ruleNbr = node->firstRule; ruleNbr >= 0;
+			ruleNbr = entry->nextAtNode)
+	{
+		if (bestRule >= 0 && ruleNbr >= bestRule)
+		{
+			break;
+		}
+
+		entry = index->rules + ruleNbr;
+		if (entry->blockTypeNbr == blockTypeNbr
+		&& memcmp(entry->srcEid, srcEid,
+				MIN(entry->srcEidLen, srcEidLen)) == 0)
+		{
+			return ruleNbr;
+		}
+	}
+
+	return bestRule;
+}
+
+static int	firstRuleInSubtree(SecRuleIndex *index, SecRuleNode *node,
+			char *srcEid, int srcEidLen, int blockTypeNbr,
+			int bestRule)
+{
+	SecRuleNode	*child;
+
+	for (child = node->child; child; child = child->sibling)
+	{
+		bestRule = firstRuleAtNode(index, child, srcEid, srcEidLen,
+				blockTypeNbr, bestRule);
+		bestRule = firstRuleInSubtree(index, child, srcEid, srcEidLen,
+				blockTypeNbr, bestRule);
+	}
+
+	return bestRule;
+}
+
+static int	findIndexedRule(int ruleType, char *srcEid, char *destEid,
+			int blockTypeNbr, Object *ruleAddr, Object *eltp)
+{
+	Sdr		sdr = getIonsdr();
+	SecRuleIndex	*index = _ruleIndex(ruleType);
+	pthread_mutex_t	*lock = _ruleIndexLock();
+	SecRuleNode	*node;
+	SecRuleNode	*child;
+	int		srcEidLen;
+	int		destEidLen;
+	int		bestRule = -1;
+	int		inTransaction = 0;
+	int		i;
+
+	*ruleAddr = 0;
+	*eltp = 0;
+	srcEidLen = strlen(srcEid);
+	destEidLen = strlen(destEid);
+	if (srcEidLen == 0 || destEidLen == 0)
+	{
+		return 0;		/*	Matches no rule.	*/
+	}
+
+	srcEidLen = wildcardFreeLength(srcEid, srcEidLen);
+	destEidLen = wildcardFreeLength(destEid, destEidLen);
+	pthread_mutex_lock(lock);
+	if (!index->loaded || index->generation != getIonVdb()->ruleGeneration)
+	{
+		/*	Must reload the index from the SDR.  Lock the
+		 *	SDR before the index, never the reverse.	*/
+
+		pthread_mutex_unlock(lock);
+		CHKERR(sdr_begin_xn(sdr));
+		inTransaction = 1;
+		pthread_mutex_lock(lock);
+		if (!index->loaded
+		|| index->generation != getIonVdb()->ruleGeneration)
+		{
+			if (loadRuleIndex(index, ruleType) < 0)
+			{
+				pthread_mutex_unlock(lock);
+				sdr_exit_xn(sdr);
+				return -1;
+			}
+		}
+	}
+
+	/*	Rules whose destination EIDs are prefixes of destEid.	*/
+
+	node = index->root;
+	for (i = 0; node; i++)
+	{
+		bestRule = firstRuleAtNode(index, node, srcEid, srcEidLen,
+				blockTypeNbr, bestRule);
+		if (i == destEidLen)
+		{
+			break;
+		}
+
+		for (child = node->child; child; child = child->sibling)
+		{
+			if (child->ch == destEid[i])
+			{
+				break;
+			}
+		}
+
+		node = child;
+	}
+
+	/*	Rules whose destination EIDs have destEid as a prefix.	*/
+
+	if (node)
+	{
+		bestRule = firstRuleInSubtree(index, node, srcEid, srcEidLen,
+				blockTypeNbr, bestRule);
+	}
+
+	if (bestRule >= 0)
+	{
+		*ruleAddr = index->rules[bestRule].ruleAddr;
+		*eltp = index->rules[bestRule].elt;
+	}
+
+	pthread_mutex_unlock(lock);
+	if (inTransaction)
+	{
+		sdr_exit_xn(sdr);
+	}
+
+	return (bestRule >= 0);
+}
+
+/*	Called after a rule has been appended to a rules list in a
+ *	transaction that incremented the rule generation from
+ *	"generation".  If this process's index was current, the new
+ *	rule is simply appended to it rather than reloading the index
+ *	on the next lookup.						*/
+
+static void	noteRuleAdded(int ruleType, unsigned int generation,
+			Object ruleAddr, Object elt, int blockTypeNbr,
+			char *srcEid, char *destEid)
+{
+	SecRuleIndex	*index = _ruleIndex(ruleType);
+	pthread_mutex_t	*lock = _ruleIndexLock();
+
+	pthread_mutex_lock(lock);
+	if (index->loaded && index->generation == generation)
+	{
+		if (indexRule(index, ruleAddr, elt, blockTypeNbr, srcEid,
+				destEid) < 0)
+		{
+			index->loaded = 0;
+		}
+		else
+		{
+			index->generation = generation + 1;
+		}
+	}
+
+	pthread_mutex_unlock(lock);
+}
+
+int	sec_get_bspBabRule(char *srcEid, char *destEid, Object *ruleAddr,
+		Object *eltp)
+{
+	SecDB	*secdb = _secConstants();
 
 	/*	This function determines the relevant BspBabRule for
 	 *	the specified receiving endpoint, if any.  Wild card
@@ -838,33 +1346,8 @@ int	sec_get_bspBabRule(char *srcEid, char *destEid, Object *ruleAddr,
 		return 0;
 	}
 
-	CHKERR(sdr_begin_xn(sdr));
-	for (elt = sdr_list_first(sdr, secdb->bspBabRules); elt;
-			elt = sdr_list_next(sdr, elt))
-	{
-		*ruleAddr = sdr_list_data(sdr, elt);
-		GET_OBJ_POINTER(sdr, BspBabRule, rule, *ruleAddr);
-		eidLen = sdr_string_read(sdr, eidBuffer, rule->securityDestEid);
-		/* If destinations match... */
-		if (eidsMatch(eidBuffer, eidLen, destEid, strlen(destEid)))
-		{
-			eidLen = sdr_string_read(sdr, eidBuffer,
-					rule->securitySrcEid);
-			/* If sources match ... */
-			if (eidsMatch(eidBuffer, eidLen, srcEid,
-					strlen(srcEid)))
-			{
-				result = 1;
-				*eltp = elt;	/*	Exact match.	*/
-				break;		/*	Stop searching.	*/
-			}
-		}
-
-		*ruleAddr = 0;
-	}
-
-	sdr_exit_xn(sdr);
-	return result;
+	return findIndexedRule(BSP_BAB_TYPE, srcEid, destEid, 0, ruleAddr,
+			eltp);
 }
 
 /* 1 if found. 0 if not. and -1 on error. */
@@ -895,6 +1378,7 @@ int	sec_addBspBabRule(char *srcEid, char *destEid, char *ciphersuiteName,
 	Object		elt;
 	Object		ruleAddr;
 	int		last;
+	unsigned int	generation;
 
 	CHKERR(srcEid);
 	CHKERR(destEid);
@@ -964,12 +1448,15 @@ single receiver endpoint, not all endpoints on the receiving node", destEid);
 
 	elt = sdr_list_insert_last(sdr, secdb->bspBabRules,ruleObj);
 	sdr_write(sdr, ruleObj, (char *) &rule, sizeof(BspBabRule));
+	generation = getIonVdb()->ruleGeneration++;
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't add rule.", destEid);
 		return -1;
 	}
 
+	noteRuleAdded(BSP_BAB_TYPE, generation, ruleObj, elt, 0, srcEid,
+			destEid);
 	return 1;
 }
 
@@ -1055,6 +1542,7 @@ int	sec_removeBspBabRule(char *srcEid, char *destEid)
 	sdr_free(sdr, rule->securitySrcEid);
 	sdr_free(sdr, rule->securityDestEid);
 	sdr_free(sdr, ruleObj);
+	getIonVdb()->ruleGeneration++;
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't remove rule.", destEid);
@@ -1082,13 +1570,7 @@ int	sec_get_bspPibRxRule(char *secSrcEid, int blockTypeNbr,
 int	sec_get_bspPibRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
 		Object *ruleAddr, Object *eltp)
 {
-	Sdr	sdr = getIonsdr();
 	SecDB	*secdb = _secConstants();
-	Object	elt;
-		OBJ_POINTER(BspPibRule, rule);
-	int	eidLen;
-	char	eidBuffer[SDRSTRING_BUFSZ];
-	int	result = 0;
 
 	/*	This function determines the relevant BspPibRule for
 	 *	the specified receiving endpoint, if any.  Wild card
@@ -1104,36 +1586,8 @@ int	sec_get_bspPibRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
 		return 0;
 	}
 
-	CHKERR(sdr_begin_xn(sdr));
-	for (elt = sdr_list_first(sdr, secdb->bspPibRules); elt;
-			elt = sdr_list_next(sdr, elt))
-	{
-		*ruleAddr = sdr_list_data(sdr, elt);
-		GET_OBJ_POINTER(sdr, BspPibRule, rule, *ruleAddr);
-		eidLen = sdr_string_read(sdr, eidBuffer, rule->securityDestEid);
-
-		/* If destinations match... */
-		if ((rule->blockTypeNbr == blockTypeNbr)
-		&& (eidsMatch(eidBuffer, eidLen, secDestEid,
-				strlen(secDestEid))))
-		{
-			eidLen = sdr_string_read(sdr, eidBuffer,
-					rule->securitySrcEid);
-			/* If sources match ... */
-			if (eidsMatch(eidBuffer, eidLen, secSrcEid,
-					strlen(secSrcEid)) == 1)
-			{
-				result = 1;
-				*eltp = elt;	/*	Exact match.	*/
-				break;		/*	Stop searching.	*/
-			}
-		}
-
-		*ruleAddr = 0;
-	}
-
-	sdr_exit_xn(sdr);
-	return result;
+	return findIndexedRule(BSP_PIB_TYPE, secSrcEid, secDestEid,
+			blockTypeNbr, ruleAddr, eltp);
 }
 
 /* 1 if found. 0 if not. -1 on error. */
@@ -1166,6 +1620,7 @@ int	sec_addBspPibRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
 	BspPibRule	rule;
 	Object		ruleObj;
 	Object		elt;
+	unsigned int	generation;
 
 	CHKERR(secSrcEid);
 	CHKERR(secDestEid);
@@ -1219,12 +1674,15 @@ int	sec_addBspPibRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
 	elt = sdr_list_insert_last(sdr, secdb->bspPibRules,ruleObj);
 
 	sdr_write(sdr, ruleObj, (char *) &rule, sizeof(BspPibRule));
+	generation = getIonVdb()->ruleGeneration++;
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't add rule.", secDestEid);
 		return -1;
 	}
 
+	noteRuleAdded(BSP_PIB_TYPE, generation, ruleObj, elt, blockTypeNbr,
+			secSrcEid, secDestEid);
 	return 1;
 }
 
@@ -1313,6 +1771,7 @@ int	sec_removeBspPibRule(char *secSrcEid, char *secDestEid,
 	sdr_free(sdr, rule->securitySrcEid);
 	sdr_free(sdr, rule->securityDestEid);
 	sdr_free(sdr, ruleObj);
+	getIonVdb()->ruleGeneration++;
 	if (sdr_end_xn(sdr) < 0)
 	{
 		putErrmsg("Can't remove rule.", secDestEid);
@@ -1325,13 +1784,7 @@ int	sec_removeBspPibRule(char *secSrcEid, char *secDestEid,
 int    sec_get_bspPcbRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
                 Object *ruleAddr, Object *eltp)
 {
-        Sdr     sdr = getIonsdr();
         SecDB   *secdb = _secConstants();
-        Object  elt;
-                OBJ_POINTER(BspPcbRule, rule);
-        int     eidLen;
-        char    eidBuffer[SDRSTRING_BUFSZ];
-        int     result = 0;
 
         /*      This function determines the relevant BspPcbRule for
          *      the specified receiving endpoint, if any.  Wild card
@@ -1347,36 +1800,8 @@ int    sec_get_bspPcbRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
 		return 0;
 	}
 
-        CHKERR(sdr_begin_xn(sdr));
-        for (elt = sdr_list_first(sdr, secdb->bspPcbRules); elt;
-                        elt = sdr_list_next(sdr, elt))
-        {
-                *ruleAddr = sdr_list_data(sdr, elt);
-                GET_OBJ_POINTER(sdr, BspPcbRule, rule, *ruleAddr);
-                eidLen = sdr_string_read(sdr, eidBuffer, rule->securityDestEid);
-
-                /* If destinations match... */
-                if ((rule->blockTypeNbr == blockTypeNbr)
-                && (eidsMatch(eidBuffer, eidLen, secDestEid,
-                                strlen(secDestEid))))
-                {
-                        eidLen = sdr_string_read(sdr, eidBuffer,
-                                        rule->securitySrcEid);
-                        /* If sources match ... */
-                        if (eidsMatch(eidBuffer, eidLen, secSrcEid,
-                                        strlen(secSrcEid)) == 1)
-                        {
-                                result = 1;
-                                *eltp = elt;    /*      Exact match.    */
-                                break;          /*      Stop searching. */
-                        }
-                }
-
-                *ruleAddr = 0;
-        }
-
-        sdr_exit_xn(sdr);
-        return result;
+        return findIndexedRule(BSP_PCB_TYPE, secSrcEid, secDestEid,
+                        blockTypeNbr, ruleAddr, eltp);
 }
 
 /* 1 if found. 0 if not. -1 on error. */
@@ -1409,6 +1834,7 @@ int     sec_addBspPcbRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
         BspPcbRule      rule;
         Object          ruleObj;
         Object          elt;            
+        unsigned int    generation;
 
         CHKERR(secSrcEid);
         CHKERR(secDestEid);
@@ -1462,12 +1888,15 @@ int     sec_addBspPcbRule(char *secSrcEid, char *secDestEid, int blockTypeNbr,
         elt = sdr_list_insert_last(sdr, secdb->bspPcbRules,ruleObj);
 
         sdr_write(sdr, ruleObj, (char *) &rule, sizeof(BspPcbRule));
+        generation = getIonVdb()->ruleGeneration++;
         if (sdr_end_xn(sdr) < 0)
         {
                 putErrmsg("Can't add rule.", secDestEid);
                 return -1;
         }
 
+        noteRuleAdded(BSP_PCB_TYPE, generation, ruleObj, elt, blockTypeNbr,
+                        secSrcEid, secDestEid);
         return 1;
 }
 
@@ -1556,6 +1985,7 @@ int     sec_removeBspPcbRule(char *secSrcEid, char *secDestEid,
         sdr_free(sdr, rule->securitySrcEid);
         sdr_free(sdr, rule->securityDestEid);
         sdr_free(sdr, ruleObj);
+        getIonVdb()->ruleGeneration++;
         if (sdr_end_xn(sdr) < 0)
         {
                 putErrmsg("Can't remove rule.", secDestEid);
@@ -1621,35 +1621,110 @@ void	printStackTrace()
 #endif
 }
 
-void	encodeSdnv(Sdnv *sdnv, uvast val)
+/*	SDNV encoding and decoding operate on a whole 64-bit word at
+ *	a time wherever possible.  Up to 8 bytes of SDNV text (56 bits
+ *	of numeric value) are gathered into a single word, the 7-bit
+ *	value groups are compacted (or spread) by three shift-and-mask
+ *	steps, and the terminating byte of an SDNV -- the first byte
+ *	whose high-order bit is zero -- is located by a single count
+ *	of leading zeros rather than by testing one byte per loop
+ *	iteration.  Values too large for this treatment are handled
+ *	one byte at a time, as before.					*/
+
+#define	SDNV_FLAG_BITS	((uvast) 0x8080808080808080ULL)
+#define	SDNV_VALUE_BITS	((uvast) 0x7f7f7f7f7f7f7f7fULL)
+#define	SDNV_WORD_LIMIT	((uvast) 1 << 56)
+
+static int	leadingZeros(uvast word)
+{
+#ifdef __GNUC__
+	return __builtin_clzll((unsigned long long) word);
+#else
+	int	count = 0;
+
+	while ((word & ((uvast) 1 << 63)) == 0)
+	{
+		word <<= 1;
+		count++;
+	}
+
+	return count;
+#endif
+}
+
+static int	sdnvTextLength(uvast val)
+{
+	int	significantBits;
+
+	if (val == 0)
+	{
+		return 1;
+	}
+
+	/*	One byte of SDNV text for each 7 bits (or fraction
+	 *	thereof) of significant numeric value.			*/
+
+	significantBits = 64 - leadingZeros(val);
+	return (significantBits + 6) / 7;
+}
+
+static uvast	spreadSdnv(uvast val, int length)
+{
+	uvast	word;
+
+	/*	Spread the 7-bit value groups of val (which must be
+	 *	less than SDNV_WORD_LIMIT) into the low-order 7 bits
+	 *	of successive bytes of the word, set the high-order
+	 *	(continuation) bit of every byte except the last, and
+	 *	left-justify the resulting SDNV text in the word.	*/
+
+	word = (val & 0x000000000fffffffULL)
+		| ((val & 0x00fffffff0000000ULL) << 4);
+	word = (word & 0x00003fff00003fffULL)
+		| ((word & 0x0fffc0000fffc000ULL) << 2);
+	word = (word & 0x007f007f007f007fULL)
+		| ((word & 0x3f803f803f803f80ULL) << 1);
+	word |= (SDNV_FLAG_BITS >> ((8 - length) << 3)) & ~((uvast) 0xff);
+	return word << ((8 - length) << 3);
+}
+
+static void	storeSdnvWord(unsigned char *text, uvast word)
+{
+	text[0] = (unsigned char) (word >> 56);
+	text[1] = (unsigned char) (word >> 48);
+	text[2] = (unsigned char) (word >> 40);
+	text[3] = (unsigned char) (word >> 32);
+	text[4] = (unsigned char) (word >> 24);
+	text[5] = (unsigned char) (word >> 16);
+	text[6] = (unsigned char) (word >> 8);
+	text[7] = (unsigned char) word;
+}
+
+static void	fillSdnv(unsigned char *text, int length, uvast val)
 {
 	static uvast	sdnvMask = ((uvast) -1) / 128;
-	uvast		remnant;
-	int		i;
+	uvast		word;
 	unsigned char	flag = 0;
-	unsigned char	*text;
-
-	/*	Get length of SDNV text: one byte for each 7 bits of
-	 *	significant numeric value.  On each iteration of the
-	 *	loop, until what's left of the original value is zero,
-	 *	shift the remaining value 7 bits to the right and add
-	 *	1 to the imputed SDNV length.				*/
 
-	CHKVOID(sdnv);
-	sdnv->length = 0;
-	remnant = val;
-	do
+	if (val < SDNV_WORD_LIMIT)
 	{
-		remnant = (remnant >> 7) & sdnvMask;
-		(sdnv->length)++;
-	} while (remnant > 0);
+		word = spreadSdnv(val, length);
+		while (length > 0)
+		{
+			*text = (unsigned char) (word >> 56);
+			word <<= 8;
+			text++;
+			length--;
+		}
+
+		return;
+	}
 
-	/*	Now fill the SDNV text from the numeric value bits.	*/
+	/*	Fill the SDNV text from the numeric value bits,
+	 *	starting from the end.					*/
 
-	text = sdnv->text + sdnv->length;
-	i = sdnv->length;
-	remnant = val;
-	while (i > 0)
+	text += length;
+	while (length > 0)
 	{
 		text--;
 
@@ -1657,31 +1732,76 @@ void	encodeSdnv(Sdnv *sdnv, uvast val)
 		 *	it with high-order bit flag for this position
 		 *	of the SDNV.					*/
 
-		*text = (remnant & 0x7f) | flag;
+		*text = (val & 0x7f) | flag;
 
 		/*	Shift those bits out of the value.		*/
 
-		remnant = (remnant >> 7) & sdnvMask;
+		val = (val >> 7) & sdnvMask;
 		flag = 0x80;		/*	Flag is now 1.		*/
-		i--;
+		length--;
 	}
 }
 
-int	decodeSdnv(uvast *val, unsigned char *sdnvTxt)
+void	encodeSdnv(Sdnv *sdnv, uvast val)
+{
+	CHKVOID(sdnv);
+	sdnv->length = sdnvTextLength(val);
+	fillSdnv(sdnv->text, sdnv->length, val);
+}
+
+static int	decodeSdnvWord(uvast *val, unsigned char *sdnvTxt)
+{
+	uvast	word;
+	uvast	stops;
+	int	sdnvLength;
+
+	/*	Caller guarantees that at least 8 bytes of text are
+	 *	available.  Assemble them in network byte order.	*/
+
+	word = ((uvast) sdnvTxt[0] << 56) | ((uvast) sdnvTxt[1] << 48)
+		| ((uvast) sdnvTxt[2] << 40) | ((uvast) sdnvTxt[3] << 32)
+		| ((uvast) sdnvTxt[4] << 24) | ((uvast) sdnvTxt[5] << 16)
+		| ((uvast) sdnvTxt[6] << 8) | (uvast) sdnvTxt[7];
+	stops = ~word & SDNV_FLAG_BITS;
+	if (stops == 0)
+	{
+		return 0;	/*	SDNV is longer than 8 bytes.	*/
+	}
+
+	/*	Right-justify the SDNV text in the word, strip the
+	 *	flag bits, and compact the 7-bit value groups.		*/
+
+	sdnvLength = (leadingZeros(stops) >> 3) + 1;
+	word = (word >> ((8 - sdnvLength) << 3)) & SDNV_VALUE_BITS;
+	word = (word & 0x007f007f007f007fULL)
+		| ((word & 0x7f007f007f007f00ULL) >> 1);
+	word = (word & 0x00003fff00003fffULL)
+		| ((word & 0x3fff00003fff0000ULL) >> 2);
+	word = (word & 0x000000000fffffffULL)
+		| ((word & 0x0fffffff00000000ULL) >> 4);
+	*val = word;
+	return sdnvLength;
+}
+
+static int	decodeSdnvBytes(uvast *val, unsigned char *sdnvTxt,
+			int maxLength)
 {
 	int		sdnvLength = 0;
 	unsigned char	*cursor;
 
-	CHKZERO(val);
-	CHKZERO(sdnvTxt);
 	*val = 0;
 	cursor = sdnvTxt;
+	if (maxLength > 10)
+	{
+		maxLength = 10;		/*	No more than 70 bits.	*/
+	}
+
 	while (1)
 	{
 		sdnvLength++;
-		if (sdnvLength > 10)
+		if (sdnvLength > maxLength)
 		{
-			return 0;	/*	More than 70 bits.	*/
+			return 0;	/*	Too long or truncated.	*/
 		}
 
 		/*	Shift numeric value 7 bits to the left (that
@@ -1706,6 +1826,118 @@ int	decodeSdnv(uvast *val, unsigned char *sdnvTxt)
 	}
 }
 
+int	decodeSdnv(uvast *val, unsigned char *sdnvTxt)
+{
+	CHKZERO(val);
+	CHKZERO(sdnvTxt);
+	if ((*sdnvTxt & 0x80) == 0)
+	{
+		*val = *sdnvTxt;	/*	Single-byte SDNV.	*/
+		return 1;
+	}
+
+	/*	Length of the available text is unknown, so reading
+	 *	ahead a whole word at a time is unsafe.			*/
+
+	return decodeSdnvBytes(val, sdnvTxt, 10);
+}
+
+static int	decodeSdnvText(uvast *val, unsigned char *sdnvTxt,
+			int textLength)
+{
+	int	sdnvLength;
+
+	if (textLength < 1)
+	{
+		return 0;
+	}
+
+	if ((*sdnvTxt & 0x80) == 0)
+	{
+		*val = *sdnvTxt;	/*	Single-byte SDNV.	*/
+		return 1;
+	}
+
+	if (textLength >= 8)
+	{
+		sdnvLength = decodeSdnvWord(val, sdnvTxt);
+		if (sdnvLength > 0)
+		{
+			return sdnvLength;
+		}
+	}
+
+	return decodeSdnvBytes(val, sdnvTxt, textLength);
+}
+
+int	decodeBoundedSdnv(uvast *val, unsigned char *sdnvTxt, int textLength)
+{
+	CHKZERO(val);
+	CHKZERO(sdnvTxt);
+	return decodeSdnvText(val, sdnvTxt, textLength);
+}
+
+int	encodeSdnvs(unsigned char *buffer, int bufferLength, uvast *vals,
+		int count)
+{
+	int	bytesEncoded = 0;
+	int	length;
+	int	i;
+
+	CHKZERO(buffer);
+	CHKZERO(vals);
+	for (i = 0; i < count; i++)
+	{
+		length = sdnvTextLength(vals[i]);
+		if (vals[i] < SDNV_WORD_LIMIT
+		&& bufferLength - bytesEncoded >= 8)
+		{
+			/*	Store all 8 bytes of the word; any
+			 *	bytes beyond the end of this SDNV are
+			 *	overwritten by the next one, if any.	*/
+
+			storeSdnvWord(buffer + bytesEncoded,
+					spreadSdnv(vals[i], length));
+			bytesEncoded += length;
+			continue;
+		}
+
+		if (bytesEncoded + length > bufferLength)
+		{
+			return 0;	/*	Buffer is too small.	*/
+		}
+
+		fillSdnv(buffer + bytesEncoded, length, vals[i]);
+		bytesEncoded += length;
+	}
+
+	return bytesEncoded;
+}
+
+int	decodeSdnvs(uvast *vals, int count, unsigned char *text,
+		int textLength)
+{
+	int	bytesDecoded = 0;
+	int	length;
+	int	i;
+
+	CHKZERO(vals);
+	CHKZERO(text);
+	for (i = 0; i < count; i++)
+	{
+		length = decodeSdnvText(vals + i, text + bytesDecoded,
+				textLength - bytesDecoded);
+		if (length == 0)
+		{
+			return 0;	/*	Invalid or truncated.	*/
+		}
+
+		bytesDecoded += length;
+	}
+
+	return bytesDecoded;
+}
+
 void	loadScalar(Scalar *s, signed int i)
 {
 	CHKVOID(s);
@@ -509,42 +509,145 @@ PsmAddress	postProbeEvent(IonNode *node, IonSnub *snub)
 
 /*	*	RFX contact list management functions	*	*	*/
 
-static PsmAddress	insertCXref(IonCXref *cxref)
+static int	loadNodes(uvast fromNode, uvast toNode)
 {
-	PsmPartition	ionwm = getIonwm();
 	IonVdb 		*vdb = getIonVdb();
-	IonNode		*node;
 	PsmAddress	nextElt;
-	PsmAddress	cxaddr;
-	Object		iondbObj;
-	IonDB		iondb;
-	PsmAddress	cxelt;
-	PsmAddress	addr;
-	IonEvent	*event;
-	time_t		currentTime = getUTCTime();
-
-	/*	Load the affected nodes.				*/
 
-	node = findNode(vdb, cxref->toNode, &nextElt);
-	if (node == NULL)
+	if (findNode(vdb, toNode, &nextElt) == NULL)
 	{
-		node = addNode(vdb, cxref->toNode);
-		if (node == NULL)
+		if (addNode(vdb, toNode) == NULL)
 		{
-			return 0;
+			return -1;
 		}
 	}
 
-	node = findNode(vdb, cxref->fromNode, &nextElt);
-	if (node == NULL)
+	if (findNode(vdb, fromNode, &nextElt) == NULL)
 	{
-		node = addNode(vdb, cxref->fromNode);
-		if (node == NULL)
+		if (addNode(vdb, fromNode) == NULL)
 		{
-			return 0;
+			return -1;
 		}
 	}
 
+	return 0;
+}
+
+static int	postTimelineEvent(time_t time, IonEventType type,
+			PsmAddress ref)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb 		*vdb = getIonVdb();
+	PsmAddress	addr;
+	IonEvent	*event;
+
+	addr = psm_zalloc(ionwm, sizeof(IonEvent));
+	if (addr == 0)
+	{
+		return -1;
+	}
+
+	event = (IonEvent *) psp(ionwm, addr);
+	event->time = time;
+	event->type = type;
+	event->ref = ref;
+	if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events,
+			event) == 0)
+	{
+		psm_free(ionwm, addr);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*	Deletes from the timeline all events that have been posted for
+ *	a contact index entry.						*/
+
+static void	deleteCXrefEvents(PsmAddress cxaddr)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb 		*vdb = getIonVdb();
+	IonCXref	*cxref;
+	IonEvent	event;
+
+	cxref = (IonCXref *) psp(ionwm, cxaddr);
+	event.ref = cxaddr;
+	if (cxref->startXmit)
+	{
+		event.time = cxref->startXmit;
+		event.type = IonStartXmit;
+		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
+				&event, rfx_erase_data, NULL);
+	}
+
+	if (cxref->stopXmit)
+	{
+		event.time = cxref->stopXmit;
+		event.type = IonStopXmit;
+		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
+				&event, rfx_erase_data, NULL);
+	}
+
+	if (cxref->startFire)
+	{
+		event.time = cxref->startFire;
+		event.type = IonStartFire;
+		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
+				&event, rfx_erase_data, NULL);
+	}
+
+	if (cxref->stopFire)
+	{
+		event.time = cxref->stopFire;
+		event.type = IonStopFire;
+		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
+				&event, rfx_erase_data, NULL);
+	}
+
+	if (cxref->startRecv)
+	{
+		event.time = cxref->startRecv;
+		event.type = IonStartRecv;
+		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
+				&event, rfx_erase_data, NULL);
+	}
+
+	if (cxref->stopRecv)
+	{
+		event.time = cxref->stopRecv;
+		event.type = IonStopRecv;
+		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
+				&event, rfx_erase_data, NULL);
+	}
+
+	if (cxref->purgeTime)
+	{
+		event.time = cxref->purgeTime;
+		event.type = IonPurgeContact;
+		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
+				&event, rfx_erase_data, NULL);
+	}
+}
+
+/*	Creates the contact index entry for a contact, together with
+ *	all of its timeline events, but doesn't insert the entry into
+ *	the contact index.						*/
+
+static PsmAddress	createCXref(IonCXref *cxref)
+{
+	PsmPartition	ionwm = getIonwm();
+	PsmAddress	cxaddr;
+	Object		iondbObj;
+	IonDB		iondb;
+
+	/*	Load the affected nodes.				*/
+
+	if (loadNodes(cxref->fromNode, cxref->toNode) < 0)
+	{
+		return 0;
+	}
+
 	/*	Construct the contact index entry.			*/
 
 	cxaddr = psm_zalloc(ionwm, sizeof(IonCXref));
@@ -583,114 +686,47 @@ static PsmAddress	insertCXref(IonCXref *cxref)
 	}
 
 	memcpy((char *) psp(ionwm, cxaddr), (char *) cxref, sizeof(IonCXref));
-	cxelt = sm_rbt_insert(ionwm, vdb->contactIndex, cxaddr,
-			rfx_order_contacts, cxref);
-	if (cxelt == 0)
-	{
+
+	/*	Insert relevant timeline events.  If any event can't
+	 *	be posted, remove those that were and discard the
+	 *	entry.							*/
+
+	if ((cxref->startXmit && postTimelineEvent(cxref->startXmit,
+			IonStartXmit, cxaddr) < 0)
+	|| (cxref->stopXmit && postTimelineEvent(cxref->stopXmit,
+			IonStopXmit, cxaddr) < 0)
+	|| (cxref->startFire && postTimelineEvent(cxref->startFire,
+			IonStartFire, cxaddr) < 0)
+	|| (cxref->stopFire && postTimelineEvent(cxref->stopFire,
+			IonStopFire, cxaddr) < 0)
+	|| (cxref->purgeTime && postTimelineEvent(cxref->purgeTime,
+			IonPurgeContact, cxaddr) < 0))
+	{
+		deleteCXrefEvents(cxaddr);
 		psm_free(ionwm, cxaddr);
 		return 0;
 	}
 
-	/*	Insert relevant timeline events.			*/
-
-	if (cxref->startXmit)
-	{
-		addr = psm_zalloc(ionwm, sizeof(IonEvent));
-		if (addr == 0)
-		{
-			return 0;
-		}
-
-		event = (IonEvent *) psp(ionwm, addr);
-		event->time = cxref->startXmit;
-		event->type = IonStartXmit;
-		event->ref = cxaddr;
-		if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events,
-				event) == 0)
-		{
-			psm_free(ionwm, addr);
-			return 0;
-		}
-	}
-
-	if (cxref->stopXmit)
-	{
-		addr = psm_zalloc(ionwm, sizeof(IonEvent));
-		if (addr == 0)
-		{
-			return 0;
-		}
-
-		event = (IonEvent *) psp(ionwm, addr);
-		event->time = cxref->stopXmit;
-		event->type = IonStopXmit;
-		event->ref = cxaddr;
-		if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events,
-				event) == 0)
-		{
-			psm_free(ionwm, addr);
-			return 0;
-		}
-	}
-
-	if (cxref->startFire)
-	{
-		addr = psm_zalloc(ionwm, sizeof(IonEvent));
-		if (addr == 0)
-		{
-			return 0;
-		}
+	return cxaddr;
+}
 
-		event = (IonEvent *) psp(ionwm, addr);
-		event->time = cxref->startFire;
-		event->type = IonStartFire;
-		event->ref = cxaddr;
-		if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events,
-				event) == 0)
-		{
-			psm_free(ionwm, addr);
-			return 0;
-		}
-	}
+static PsmAddress	insertCXref(IonCXref *cxref)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb 		*vdb = getIonVdb();
+	PsmAddress	cxaddr;
+	time_t		currentTime = getUTCTime();
 
-	if (cxref->stopFire)
+	cxaddr = createCXref(cxref);
+	if (cxaddr == 0)
 	{
-		addr = psm_zalloc(ionwm, sizeof(IonEvent));
-		if (addr == 0)
-		{
-			return 0;
-		}
-
-		event = (IonEvent *) psp(ionwm, addr);
-		event->time = cxref->stopFire;
-		event->type = IonStopFire;
-		event->ref = cxaddr;
-		if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events,
-				event) == 0)
-		{
-			psm_free(ionwm, addr);
-			return 0;
-		}
+		return 0;
 	}
 
-	if (cxref->purgeTime)
+	if (sm_rbt_insert(ionwm, vdb->contactIndex, cxaddr,
+			rfx_order_contacts, cxref) == 0)
 	{
-		addr = psm_zalloc(ionwm, sizeof(IonEvent));
-		if (addr == 0)
-		{
-			return 0;
-		}
-
-		event = (IonEvent *) psp(ionwm, addr);
-		event->time = cxref->purgeTime;
-		event->type = IonPurgeContact;
-		event->ref = cxaddr;
-		if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events,
-				event) == 0)
-		{
-			psm_free(ionwm, addr);
-			return 0;
-		}
+		return 0;
 	}
 
 	if (cxref->toTime > currentTime)	/*	Affects routes.	*/
@@ -853,7 +889,6 @@ static void	deleteContact(PsmAddress cxaddr)
 	time_t		currentTime = getUTCTime();
 	IonCXref	*cxref;
 	Object		obj;
-	IonEvent	event;
 	IonNeighbor	*neighbor;
 	PsmAddress	nextElt;
 
@@ -865,64 +900,7 @@ static void	deleteContact(PsmAddress cxaddr)
 	sdr_free(sdr, obj);
 	sdr_list_delete(sdr, cxref->contactElt, NULL, NULL);
 
-	/*	Delete contact events from timeline.			*/
-
-	event.ref = cxaddr;
-	if (cxref->startXmit)
-	{
-		event.time = cxref->startXmit;
-		event.type = IonStartXmit;
-		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-				&event, rfx_erase_data, NULL);
-	}
-
-	if (cxref->stopXmit)
-	{
-		event.time = cxref->stopXmit;
-		event.type = IonStopXmit;
-		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-				&event, rfx_erase_data, NULL);
-	}
-
-	if (cxref->startFire)
-	{
-		event.time = cxref->startFire;
-		event.type = IonStartFire;
-		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-				&event, rfx_erase_data, NULL);
-	}
-
-	if (cxref->stopFire)
-	{
-		event.time = cxref->stopFire;
-		event.type = IonStopFire;
-		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-				&event, rfx_erase_data, NULL);
-	}
-
-	if (cxref->startRecv)
-	{
-		event.time = cxref->startRecv;
-		event.type = IonStartRecv;
-		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-				&event, rfx_erase_data, NULL);
-	}
-
-	if (cxref->stopRecv)
-	{
-		event.time = cxref->stopRecv;
-		event.type = IonStopRecv;
-		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-				&event, rfx_erase_data, NULL);
-	}
-
-	if (cxref->purgeTime)
-	{
-		event.time = cxref->purgeTime;
-		event.type = IonPurgeContact;
-		sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-				&event, rfx_erase_data, NULL);
-	}
+	deleteCXrefEvents(cxaddr);
 
 	/*	Apply to current state as necessary.			*/
 
@@ -1032,41 +1010,47 @@ int	rfx_remove_contact(time_t fromTime, uvast fromNode, uvast toNode)
 
 /*	*	RFX range list management functions	*	*	*/
 
-static int	insertRXref(IonRXref *rxref)
+/*	Deletes from the timeline the events that have been posted for
+ *	a range index entry, which are of the asserted range types if
+ *	the range is asserted and of the imputed range types if not.	*/
+
+static void	deleteRXrefEvents(PsmAddress rxaddr, int asserted)
 {
 	PsmPartition	ionwm = getIonwm();
-	IonVdb		*vdb = getIonVdb();
-	IonNode		*node;
-	PsmAddress	nextElt;
-	IonRXref	arg;
-	PsmAddress	rxaddr;
-	PsmAddress	rxelt;
-	PsmAddress	addr;
-	IonEvent	*event;
-	PsmAddress	rxaddr2;
-	IonRXref	*rxref2;
-	time_t		currentTime = getUTCTime();
-
-	/*	Load the affected nodes.				*/
+	IonVdb 		*vdb = getIonVdb();
+	IonRXref	*rxref;
+	IonEvent	event;
 
-	node = findNode(vdb, rxref->toNode, &nextElt);
-	if (node == NULL)
-	{
-		node = addNode(vdb, rxref->toNode);
-		if (node == NULL)
-		{
-			return 0;
-		}
-	}
+	rxref = (IonRXref *) psp(ionwm, rxaddr);
+	event.ref = rxaddr;
+	event.time = rxref->fromTime;
+	event.type = asserted ? IonStartAssertedRange : IonStartImputedRange;
+	sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events, &event,
+			rfx_erase_data, NULL);
+	event.time = rxref->toTime;
+	event.type = asserted ? IonStopAssertedRange : IonStopImputedRange;
+	sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events, &event,
+			rfx_erase_data, NULL);
+}
 
-	node = findNode(vdb, rxref->fromNode, &nextElt);
-	if (node == NULL)
+/*	Creates the range index entry for a range, together with
+ *	its timeline events, but doesn't insert the entry into the
+ *	range index.  The events are those of an asserted range or
+ *	of an imputed range, as indicated; an asserted range may be
+ *	created before its rangeElt is known.				*/
+
+static PsmAddress	createRXref(IonRXref *rxref, int asserted)
+{
+	PsmPartition	ionwm = getIonwm();
+	PsmAddress	rxaddr;
+	IonEventType	startType;
+	IonEventType	stopType;
+
+	/*	Load the affected nodes.				*/
+
+	if (loadNodes(rxref->fromNode, rxref->toNode) < 0)
 	{
-		node = addNode(vdb, rxref->fromNode);
-		if (node == NULL)
-		{
-			return 0;
-		}
+		return 0;
 	}
 
 	/*	Construct the range index entry.			*/
@@ -1078,44 +1062,61 @@ static int	insertRXref(IonRXref *rxref)
 	}
 
 	memcpy((char *) psp(ionwm, rxaddr), (char *) rxref, sizeof(IonRXref));
-	rxelt = sm_rbt_insert(ionwm, vdb->rangeIndex, rxaddr, rfx_order_ranges,
-			rxref);
-	if (rxelt == 0)
-	{
-		psm_free(ionwm, rxaddr);
-		return 0;
-	}
 
-	/*	Insert relevant asserted timeline events.		*/
+	/*	Insert relevant timeline events.			*/
 
-	addr = psm_zalloc(ionwm, sizeof(IonEvent));
-	if (addr == 0)
+	if (asserted)
 	{
-		return 0;
+		startType = IonStartAssertedRange;
+		stopType = IonStopAssertedRange;
+	}
+	else
+	{
+		startType = IonStartImputedRange;
+		stopType = IonStopImputedRange;
 	}
 
-	event = (IonEvent *) psp(ionwm, addr);
-	event->time = rxref->fromTime;
-	event->type = IonStartAssertedRange;
-	event->ref = rxaddr;
-	if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events, event)
-			== 0)
+	if (postTimelineEvent(rxref->fromTime, startType, rxaddr) < 0
+	|| postTimelineEvent(rxref->toTime, stopType, rxaddr) < 0)
 	{
+		deleteRXrefEvents(rxaddr, asserted);
+		psm_free(ionwm, rxaddr);
 		return 0;
 	}
 
-	addr = psm_zalloc(ionwm, sizeof(IonEvent));
-	if (addr == 0)
+	return rxaddr;
+}
+
+static void	reverseRange(IonRXref *rxref, IonRXref *reverse)
+{
+	memset((char *) reverse, 0, sizeof(IonRXref));
+	reverse->fromNode = rxref->toNode;	/*	Reversed.	*/
+	reverse->toNode = rxref->fromNode;	/*	Reversed.	*/
+	reverse->fromTime = rxref->fromTime;
+	reverse->toTime = rxref->toTime;
+	reverse->owlt = rxref->owlt;
+	reverse->rangeElt = 0;		/*	Indicates "imputed".	*/
+}
+
+static int	insertRXref(IonRXref *rxref)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb		*vdb = getIonVdb();
+	PsmAddress	nextElt;
+	PsmAddress	rxaddr;
+	PsmAddress	rxelt;
+	IonRXref	reverse;
+	PsmAddress	rxaddr2;
+	time_t		currentTime = getUTCTime();
+
+	rxaddr = createRXref(rxref, rxref->rangeElt != 0);
+	if (rxaddr == 0)
 	{
 		return 0;
 	}
 
-	event = (IonEvent *) psp(ionwm, addr);
-	event->time = rxref->toTime;
-	event->type = IonStopAssertedRange;
-	event->ref = rxaddr;
-	if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events, event)
-			== 0)
+	if (sm_rbt_insert(ionwm, vdb->rangeIndex, rxaddr, rfx_order_ranges,
+			rxref) == 0)
 	{
 		return 0;
 	}
@@ -1140,78 +1141,28 @@ static int	insertRXref(IonRXref *rxref)
 	 *	assertion as well.  Is the reverse range already
 	 *	asserted?						*/
 
-	arg.fromNode = rxref->toNode;
-	arg.toNode = rxref->fromNode;
-	arg.fromTime = rxref->fromTime;
+	reverseRange(rxref, &reverse);
 	rxelt = sm_rbt_search(ionwm, vdb->rangeIndex, rfx_order_ranges,
-			&arg, &nextElt);
+			&reverse, &nextElt);
 	if (rxelt)	/*	Asserted range exists; we're done.	*/
 	{
 		return rxaddr;
 	}
 
-	/*	Reverse range is not asserted, so it must be imputed.
-	 *
-	 *	First, load index entry for the imputed range.		*/
+	/*	Reverse range is not asserted, so it must be imputed.	*/
 
-	rxaddr2 = psm_zalloc(ionwm, sizeof(IonRXref));
+	rxaddr2 = createRXref(&reverse, 0);
 	if (rxaddr2 == 0)
 	{
 		return 0;
 	}
 
-	rxref2 = (IonRXref *) psp(ionwm, rxaddr2);
-	rxref2->fromNode = rxref->toNode;	/*	Reversed.	*/
-	rxref2->toNode = rxref->fromNode;	/*	Reversed.	*/
-	rxref2->fromTime = rxref->fromTime;
-	rxref2->toTime = rxref->toTime;
-	rxref2->owlt = rxref->owlt;
-	rxref2->rangeElt = 0;		/*	Indicates "imputed".	*/
-	memcpy((char *) psp(ionwm, rxaddr2), (char *) rxref2, sizeof(IonRXref));
-	rxelt = sm_rbt_insert(ionwm, vdb->rangeIndex, rxaddr2, rfx_order_ranges,
-			rxref2);
-	if (rxelt == 0)
-	{
-		psm_free(ionwm, rxaddr2);
-		return 0;
-	}
-
-	/*	Then insert relevant imputed timeline events.		*/
-
-	addr = psm_zalloc(ionwm, sizeof(IonEvent));
-	if (addr == 0)
+	if (sm_rbt_insert(ionwm, vdb->rangeIndex, rxaddr2, rfx_order_ranges,
+			&reverse) == 0)
 	{
 		return 0;
 	}
 
-	event = (IonEvent *) psp(ionwm, addr);
-	event->time = rxref->fromTime;
-	event->type = IonStartImputedRange;
-	event->ref = rxaddr2;
-	if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events, event)
-			== 0)
-	{
-		psm_free(ionwm, addr);
-		return 0;
-	}
-	
-	addr = psm_zalloc(ionwm, sizeof(IonEvent));
-	if (addr == 0)
-	{
-		return 0;
-	}
-
-	event = (IonEvent *) psp(ionwm, addr);
-	event->time = rxref->toTime;
-	event->type = IonStopImputedRange;
-	event->ref = rxaddr2;
-	if (sm_rbt_insert(ionwm, vdb->timeline, addr, rfx_order_events, event)
-			== 0)
-	{
-		psm_free(ionwm, addr);
-		return 0;
-	}
-
 	return rxaddr;
 }
 
@@ -1419,7 +1370,6 @@ static void	deleteRange(PsmAddress rxaddr, int conditional)
 	time_t		currentTime = getUTCTime();
 	IonRXref	*rxref;
 	Object		obj;
-	IonEvent	event;
 	IonNeighbor	*neighbor;
 	PsmAddress	nextElt;
 
@@ -1443,31 +1393,7 @@ static void	deleteRange(PsmAddress rxaddr, int conditional)
 
 	/*	Delete range events from timeline.			*/
 
-	event.ref = rxaddr;
-	event.time = rxref->fromTime;
-	if (rxref->rangeElt)
-	{
-		event.type = IonStartAssertedRange;
-	}
-	else
-	{
-		event.type = IonStartImputedRange;
-	}
-
-	sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-			&event, rfx_erase_data, NULL);
-	event.time = rxref->toTime;
-	if (rxref->rangeElt)
-	{
-		event.type = IonStopAssertedRange;
-	}
-	else
-	{
-		event.type = IonStopImputedRange;
-	}
-
-	sm_rbt_delete(ionwm, vdb->timeline, rfx_order_events,
-			&event, rfx_erase_data, NULL);
+	deleteRXrefEvents(rxaddr, rxref->rangeElt != 0);
 
 	/*	Apply to current state as necessary.			*/
 
@@ -1628,6 +1554,808 @@ int	rfx_remove_range(time_t fromTime, uvast fromNode, uvast toNode)
 	return 0;
 }
 
+/*	*	RFX contact plan loading functions	*	*	*/
+
+static int	orderPlanEntries(uvast fromNode1, uvast toNode1,
+			time_t fromTime1, uvast fromNode2, uvast toNode2,
+			time_t fromTime2)
+{
+	if (fromNode1 != fromNode2)
+	{
+		return (fromNode1 < fromNode2 ? -1 : 1);
+	}
+
+	if (toNode1 != toNode2)
+	{
+		return (toNode1 < toNode2 ? -1 : 1);
+	}
+
+	if (fromTime1 != fromTime2)
+	{
+		return (fromTime1 < fromTime2 ? -1 : 1);
+	}
+
+	return 0;
+}
+
+static int	orderContacts(const void *a, const void *b)
+{
+	IonContact	*contact1 = (IonContact *) a;
+	IonContact	*contact2 = (IonContact *) b;
+
+	return orderPlanEntries(contact1->fromNode, contact1->toNode,
+			contact1->fromTime, contact2->fromNode,
+			contact2->toNode, contact2->fromTime);
+}
+
+static int	orderRanges(const void *a, const void *b)
+{
+	IonRange	*range1 = (IonRange *) a;
+	IonRange	*range2 = (IonRange *) b;
+
+	return orderPlanEntries(range1->fromNode, range1->toNode,
+			range1->fromTime, range2->fromNode,
+			range2->toNode, range2->fromTime);
+}
+
+static int	orderRXrefs(const void *a, const void *b)
+{
+	PsmPartition	ionwm = getIonwm();
+
+	return rfx_order_ranges(ionwm, *((PsmAddress *) a),
+			psp(ionwm, *((PsmAddress *) b)));
+}
+
+/*	Sorts the entries of a plan unless they are already in the
+ *	order of the index into which they are to be loaded.		*/
+
+static void	sortPlan(void *entries, int count, size_t entrySize,
+			int (*compare)(const void *, const void *))
+{
+	char	*cursor = (char *) entries;
+	int	i;
+
+	for (i = 1; i < count; i++)
+	{
+		if (compare(cursor, cursor + entrySize) > 0)
+		{
+			qsort(entries, count, entrySize, compare);
+			return;
+		}
+
+		cursor += entrySize;
+	}
+}
+
+/*	Deletes an imputed range that has been overridden by a range
+ *	assertion, together with the associated events, once it has
+ *	been dropped from the range index.				*/
+
+static void	discardImputedRange(PsmAddress rxaddr)
+{
+	deleteRXrefEvents(rxaddr, 0);
+	psm_free(getIonwm(), rxaddr);
+}
+
+/*	The entries that loading a contact plan adds to one index of
+ *	the contact plan, and the red-black tree built to replace that
+ *	index, neither of which is in effect until the plan is
+ *	committed.							*/
+
+typedef struct
+{
+	PsmAddress	*created;	/*	New index entries.	*/
+	long		createdCount;
+	long		assertedCount;	/*	Ranges created first.	*/
+	PsmAddress	*overridden;	/*	Imputed ranges dropped.	*/
+	long		overriddenCount;
+	PsmAddress	index;		/*	New red-black tree.	*/
+} PlanIndex;
+
+/*	Builds a new red-black tree bottom-up from the addresses of
+ *	all of an index's entries, in order.				*/
+
+static PsmAddress	buildIndex(PsmAddress *entries, long count)
+{
+	PsmPartition	ionwm = getIonwm();
+	PsmAddress	rbt;
+
+	rbt = sm_rbt_create(ionwm);
+	if (rbt == 0)
+	{
+		return 0;
+	}
+
+	if (sm_rbt_build(ionwm, rbt, entries, count) < 0)
+	{
+		sm_rbt_destroy(ionwm, rbt, NULL, NULL);
+		return 0;
+	}
+
+	return rbt;
+}
+
+/*	Replaces an index with the tree built for it, if any, and
+ *	deletes the imputed ranges that the tree no longer contains.	*/
+
+static void	commitPlanIndex(PsmAddress *index, PlanIndex *plan)
+{
+	PsmPartition	ionwm = getIonwm();
+	long		i;
+
+	if (plan->index)
+	{
+		sm_rbt_destroy(ionwm, *index, NULL, NULL);
+		*index = plan->index;
+	}
+
+	for (i = 0; i < plan->overriddenCount; i++)
+	{
+		discardImputedRange(plan->overridden[i]);
+	}
+
+	free(plan->created);
+}
+
+/*	Deletes the entries and tree built for an index, together with
+ *	the entries' timeline events, leaving the index as it was.	*/
+
+static void	discardContacts(PlanIndex *plan)
+{
+	PsmPartition	ionwm = getIonwm();
+	long		i;
+
+	for (i = 0; i < plan->createdCount; i++)
+	{
+		deleteCXrefEvents(plan->created[i]);
+		psm_free(ionwm, plan->created[i]);
+	}
+
+	if (plan->index)
+	{
+		sm_rbt_destroy(ionwm, plan->index, NULL, NULL);
+	}
+
+	free(plan->created);
+}
+
+static void	discardRanges(PlanIndex *plan)
+{
+	PsmPartition	ionwm = getIonwm();
+	long		i;
+
+	for (i = 0; i < plan->createdCount; i++)
+	{
+		deleteRXrefEvents(plan->created[i], i < plan->assertedCount);
+		psm_free(ionwm, plan->created[i]);
+	}
+
+	if (plan->index)
+	{
+		sm_rbt_destroy(ionwm, plan->index, NULL, NULL);
+	}
+
+	free(plan->created);
+}
+
+/*	Merges the contacts of a plan, in order, with the entries of
+ *	the contact index, creating a contact index entry for every
+ *	contact that rfx_insert_contact would have inserted, and then
+ *	builds a new contact index from the merged entries.  Nothing
+ *	is written to the database: the new entries' contacts are
+ *	recorded only once the plan is known to fit in working memory.	*/
+
+static int	stageContacts(IonContact *contacts, int count, PlanIndex *plan,
+			int *affectsRoutes)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb 		*vdb = getIonVdb();
+	time_t		currentTime = getUTCTime();
+	PsmAddress	*merged;
+	long		mergedCount = 0;
+	PsmAddress	elt;
+	int		order = 1;
+	IonContact	*contact;
+	IonCXref	arg;
+	IonCXref	*cxref;
+	char		contactIdString[128];
+	PsmAddress	cxaddr;
+	int		i;
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	sortPlan(contacts, count, sizeof(IonContact), orderContacts);
+
+	/*	The merged array is only needed while the index is
+	 *	built, so it is taken from the private heap rather
+	 *	than from ION working memory.				*/
+
+	merged = (PsmAddress *) malloc((sm_rbt_length(ionwm, vdb->contactIndex)
+			+ count) * sizeof(PsmAddress));
+	plan->created = (PsmAddress *) malloc(count * sizeof(PsmAddress));
+	if (merged == NULL || plan->created == NULL)
+	{
+		if (merged)
+		{
+			free(merged);
+		}
+
+		putErrmsg("Can't allocate merged contact index.", NULL);
+		return -1;
+	}
+
+	elt = sm_rbt_first(ionwm, vdb->contactIndex);
+	for (i = 0, contact = contacts; i < count; i++, contact++)
+	{
+		isprintf(contactIdString, sizeof contactIdString,
+				"at %lu, %lu->%lu", contact->fromTime,
+				contact->fromNode, contact->toNode);
+		if (contact->fromTime == 0 || contact->toTime <= contact->fromTime
+		|| contact->fromNode == 0 || contact->toNode == 0)
+		{
+			writeMemoNote("[?] Invalid contact", contactIdString);
+			continue;
+		}
+
+		memset((char *) &arg, 0, sizeof(IonCXref));
+		arg.fromNode = contact->fromNode;
+		arg.toNode = contact->toNode;
+		arg.fromTime = contact->fromTime;
+		arg.toTime = contact->toTime;
+		arg.xmitRate = contact->xmitRate;
+
+		/*	Existing contacts that precede this one keep
+		 *	their order in the index.			*/
+
+		while (elt)
+		{
+			order = rfx_order_contacts(ionwm,
+					sm_rbt_data(ionwm, elt), &arg);
+			if (order >= 0)
+			{
+				break;
+			}
+
+			merged[mergedCount++] = sm_rbt_data(ionwm, elt);
+			elt = sm_rbt_next(ionwm, elt);
+		}
+
+		/*	Make sure contact isn't in the index already
+		 *	and doesn't overlap with any contact that is.	*/
+
+		cxref = NULL;
+		if (elt && order == 0)
+		{
+			cxref = (IonCXref *) psp(ionwm, sm_rbt_data(ionwm, elt));
+		}
+		else if (mergedCount > 0 && rfx_order_contacts(ionwm,
+				merged[mergedCount - 1], &arg) == 0)
+		{
+			cxref = (IonCXref *) psp(ionwm,
+					merged[mergedCount - 1]);
+		}
+
+		if (cxref)	/*	Contact is in database already.	*/
+		{
+			if (cxref->xmitRate != contact->xmitRate)
+			{
+				writeMemoNote("[?] Contact data rate not \
+revised", contactIdString);
+			}
+
+			continue;
+		}
+
+		if (elt)
+		{
+			cxref = (IonCXref *) psp(ionwm, sm_rbt_data(ionwm, elt));
+			if (arg.fromNode == cxref->fromNode
+			&& arg.toNode == cxref->toNode
+			&& arg.toTime > cxref->fromTime)
+			{
+				writeMemoNote("[?] Overlapping contact",
+						utoa(arg.fromNode));
+				continue;
+			}
+		}
+
+		if (mergedCount > 0)
+		{
+			cxref = (IonCXref *) psp(ionwm, merged[mergedCount - 1]);
+			if (arg.fromNode == cxref->fromNode
+			&& arg.toNode == cxref->toNode
+			&& arg.fromTime < cxref->toTime)
+			{
+				writeMemoNote("[?] Overlapping contact",
+						utoa(arg.fromNode));
+				continue;
+			}
+		}
+
+		/*	Contact isn't already in database; okay to add.	*/
+
+		cxaddr = createCXref(&arg);
+		if (cxaddr == 0)
+		{
+			break;
+		}
+
+		merged[mergedCount++] = cxaddr;
+		plan->created[plan->createdCount++] = cxaddr;
+		if (arg.toTime > currentTime)	/*	Affects routes.	*/
+		{
+			*affectsRoutes = 1;
+		}
+	}
+
+	if (i < count)
+	{
+		free(merged);
+		putErrmsg("Can't load contact.", contactIdString);
+		return -1;
+	}
+
+	if (plan->createdCount == 0)	/*	Index is unchanged.	*/
+	{
+		free(merged);
+		return 0;
+	}
+
+	while (elt)
+	{
+		merged[mergedCount++] = sm_rbt_data(ionwm, elt);
+		elt = sm_rbt_next(ionwm, elt);
+	}
+
+	plan->index = buildIndex(merged, mergedCount);
+	free(merged);
+	if (plan->index == 0)
+	{
+		putErrmsg("Can't rebuild contact index.", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*	Writes the contacts of all new contact index entries to the
+ *	database's contacts list.					*/
+
+static int	recordContacts(PlanIndex *plan)
+{
+	Sdr		sdr = getIonsdr();
+	PsmPartition	ionwm = getIonwm();
+	Object		iondbObj;
+	IonDB		iondb;
+	IonCXref	*cxref;
+	IonContact	contact;
+	Object		obj;
+	long		i;
+
+	iondbObj = getIonDbObject();
+	sdr_read(sdr, (char *) &iondb, iondbObj, sizeof(IonDB));
+	for (i = 0; i < plan->createdCount; i++)
+	{
+		cxref = (IonCXref *) psp(ionwm, plan->created[i]);
+		memset((char *) &contact, 0, sizeof(IonContact));
+		contact.fromTime = cxref->fromTime;
+		contact.toTime = cxref->toTime;
+		contact.fromNode = cxref->fromNode;
+		contact.toNode = cxref->toNode;
+		contact.xmitRate = cxref->xmitRate;
+		obj = sdr_malloc(sdr, sizeof(IonContact));
+		if (obj == 0)
+		{
+			putErrmsg("Can't record contact.", NULL);
+			return -1;
+		}
+
+		sdr_write(sdr, obj, (char *) &contact, sizeof(IonContact));
+		cxref->contactElt = sdr_list_insert_last(sdr, iondb.contacts,
+				obj);
+		if (cxref->contactElt == 0)
+		{
+			putErrmsg("Can't record contact.", NULL);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*	Returns 1 if the range index entries in the array include one
+ *	for the same nodes and start time as the indicated range.	*/
+
+static int	findRXref(PsmAddress *entries, long count, IonRXref *rxref)
+{
+	PsmPartition	ionwm = getIonwm();
+	long		low = 0;
+	long		high = count - 1;
+	long		mid;
+	int		order;
+
+	while (low <= high)
+	{
+		mid = low + ((high - low) / 2);
+		order = rfx_order_ranges(ionwm, entries[mid], rxref);
+		if (order == 0)
+		{
+			return 1;
+		}
+
+		if (order < 0)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return 0;
+}
+
+/*	Merges the ranges of a plan with the entries of the range
+ *	index as stageContacts does for contacts.  A range assertion
+ *	overrides an imputed range for the same nodes and time, and
+ *	the reverse range is imputed for every canonical range that
+ *	is inserted, unless it too is asserted.				*/
+
+static int	stageRanges(IonRange *ranges, int count, PlanIndex *plan,
+			int *affectsRoutes)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb		*vdb = getIonVdb();
+	time_t		currentTime = getUTCTime();
+	PsmAddress	*merged;
+	long		mergedCount = 0;
+	PsmAddress	*imputed;
+	long		imputedCount = 0;
+	PsmAddress	elt;
+	int		order = 1;
+	IonRange	*range;
+	IonRXref	arg;
+	IonRXref	*rxref;
+	IonRXref	reverse;
+	char		rangeIdString[128];
+	PsmAddress	rxaddr;
+	long		j;
+	long		k;
+	int		i;
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	sortPlan(ranges, count, sizeof(IonRange), orderRanges);
+
+	/*	Merged array has room for every existing range, every
+	 *	range in the plan, and every range imputed from them.
+	 *	Like the work area, it is taken from the private heap.	*/
+
+	merged = (PsmAddress *) malloc((sm_rbt_length(ionwm, vdb->rangeIndex)
+			+ (2 * count)) * sizeof(PsmAddress));
+	plan->created = (PsmAddress *) malloc(3 * count * sizeof(PsmAddress));
+	if (merged == NULL || plan->created == NULL)
+	{
+		if (merged)
+		{
+			free(merged);
+		}
+
+		putErrmsg("Can't allocate merged range index.", NULL);
+		return -1;
+	}
+
+	plan->overridden = plan->created + (2 * count);
+	elt = sm_rbt_first(ionwm, vdb->rangeIndex);
+	for (i = 0, range = ranges; i < count; i++, range++)
+	{
+		isprintf(rangeIdString, sizeof rangeIdString,
+				"from %lu, %lu->%lu", range->fromTime,
+				range->fromNode, range->toNode);
+		if (range->fromTime == 0 || range->toTime <= range->fromTime
+		|| range->fromNode == 0 || range->toNode == 0)
+		{
+			writeMemoNote("[?] Invalid range", rangeIdString);
+			continue;
+		}
+
+		memset((char *) &arg, 0, sizeof(IonRXref));
+		arg.fromNode = range->fromNode;
+		arg.toNode = range->toNode;
+		arg.fromTime = range->fromTime;
+		arg.toTime = range->toTime;
+		arg.owlt = range->owlt;
+
+		/*	Existing ranges that precede this one keep
+		 *	their order in the index.			*/
+
+		while (elt)
+		{
+			order = rfx_order_ranges(ionwm,
+					sm_rbt_data(ionwm, elt), &arg);
+			if (order >= 0)
+			{
+				break;
+			}
+
+			merged[mergedCount++] = sm_rbt_data(ionwm, elt);
+			elt = sm_rbt_next(ionwm, elt);
+		}
+
+		/*	Make sure range isn't in the index already
+		 *	and doesn't overlap with any range that is.	*/
+
+		rxref = NULL;
+		if (elt && order == 0)
+		{
+			rxaddr = sm_rbt_data(ionwm, elt);
+			rxref = (IonRXref *) psp(ionwm, rxaddr);
+			if (rxref->rangeElt == 0)	/*	Imputed.	*/
+			{
+				/*	Overridden by this assertion;
+				 *	drop it from the index.		*/
+
+				plan->overridden[plan->overriddenCount++]
+						= rxaddr;
+				elt = sm_rbt_next(ionwm, elt);
+				rxref = NULL;
+			}
+		}
+		else if (mergedCount > 0 && rfx_order_ranges(ionwm,
+				merged[mergedCount - 1], &arg) == 0)
+		{
+			rxref = (IonRXref *) psp(ionwm,
+					merged[mergedCount - 1]);
+		}
+
+		if (rxref)	/*	Range is asserted already.	*/
+		{
+			if (rxref->owlt != range->owlt)
+			{
+				writeMemoNote("[?] Range OWLT not revised",
+						rangeIdString);
+			}
+
+			continue;
+		}
+
+		if (elt)
+		{
+			rxref = (IonRXref *) psp(ionwm, sm_rbt_data(ionwm, elt));
+			if (arg.fromNode == rxref->fromNode
+			&& arg.toNode == rxref->toNode
+			&& arg.toTime > rxref->fromTime)
+			{
+				writeMemoNote("[?] Overlapping range",
+						utoa(arg.fromNode));
+				continue;
+			}
+		}
+
+		if (mergedCount > 0)
+		{
+			rxref = (IonRXref *) psp(ionwm, merged[mergedCount - 1]);
+			if (arg.fromNode == rxref->fromNode
+			&& arg.toNode == rxref->toNode
+			&& arg.fromTime < rxref->toTime)
+			{
+				writeMemoNote("[?] Overlapping range",
+						utoa(arg.fromNode));
+				continue;
+			}
+		}
+
+		/*	Range isn't already in database; okay to add.	*/
+
+		rxaddr = createRXref(&arg, 1);
+		if (rxaddr == 0)
+		{
+			break;
+		}
+
+		merged[mergedCount++] = rxaddr;
+		plan->created[plan->createdCount++] = rxaddr;
+		if (arg.toTime > currentTime)	/*	Affects routes.	*/
+		{
+			*affectsRoutes = 1;
+		}
+	}
+
+	plan->assertedCount = plan->createdCount;
+	if (i < count)
+	{
+		free(merged);
+		putErrmsg("Can't load range.", rangeIdString);
+		return -1;
+	}
+
+	if (plan->createdCount == 0)	/*	Index is unchanged.	*/
+	{
+		free(merged);
+		return 0;
+	}
+
+	while (elt)
+	{
+		merged[mergedCount++] = sm_rbt_data(ionwm, elt);
+		elt = sm_rbt_next(ionwm, elt);
+	}
+
+	/*	Impute the reverse of every canonical range inserted,
+	 *	unless the reverse range is asserted.			*/
+
+	imputed = plan->created + plan->assertedCount;
+	for (i = 0; i < plan->assertedCount; i++)
+	{
+		rxref = (IonRXref *) psp(ionwm, plan->created[i]);
+		if (rxref->fromNode > rxref->toNode)
+		{
+			continue;	/*	Non-canonical.		*/
+		}
+
+		reverseRange(rxref, &reverse);
+		if (findRXref(merged, mergedCount, &reverse))
+		{
+			continue;
+		}
+
+		rxaddr = createRXref(&reverse, 0);
+		if (rxaddr == 0)
+		{
+			free(merged);
+			putErrmsg("Can't impute range.", NULL);
+			return -1;
+		}
+
+		imputed[imputedCount++] = rxaddr;
+		plan->createdCount++;
+	}
+
+	/*	Merge the imputed ranges into the merged array, from
+	 *	the end back.						*/
+
+	qsort(imputed, imputedCount, sizeof(PsmAddress), orderRXrefs);
+	j = mergedCount - 1;
+	k = mergedCount + imputedCount - 1;
+	mergedCount += imputedCount;
+	while (imputedCount > 0)
+	{
+		if (j >= 0 && orderRXrefs(merged + j,
+				imputed + (imputedCount - 1)) > 0)
+		{
+			merged[k--] = merged[j--];
+		}
+		else
+		{
+			merged[k--] = imputed[--imputedCount];
+		}
+	}
+
+	plan->index = buildIndex(merged, mergedCount);
+	free(merged);
+	if (plan->index == 0)
+	{
+		putErrmsg("Can't rebuild range index.", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*	Writes the ranges of all new asserted range index entries to
+ *	the database's ranges list.					*/
+
+static int	recordRanges(PlanIndex *plan)
+{
+	Sdr		sdr = getIonsdr();
+	PsmPartition	ionwm = getIonwm();
+	Object		iondbObj;
+	IonDB		iondb;
+	IonRXref	*rxref;
+	IonRange	range;
+	Object		obj;
+	long		i;
+
+	iondbObj = getIonDbObject();
+	sdr_read(sdr, (char *) &iondb, iondbObj, sizeof(IonDB));
+	for (i = 0; i < plan->assertedCount; i++)
+	{
+		rxref = (IonRXref *) psp(ionwm, plan->created[i]);
+		memset((char *) &range, 0, sizeof(IonRange));
+		range.fromTime = rxref->fromTime;
+		range.toTime = rxref->toTime;
+		range.fromNode = rxref->fromNode;
+		range.toNode = rxref->toNode;
+		range.owlt = rxref->owlt;
+		obj = sdr_malloc(sdr, sizeof(IonRange));
+		if (obj == 0)
+		{
+			putErrmsg("Can't record range.", NULL);
+			return -1;
+		}
+
+		sdr_write(sdr, obj, (char *) &range, sizeof(IonRange));
+		rxref->rangeElt = sdr_list_insert_last(sdr, iondb.ranges, obj);
+		if (rxref->rangeElt == 0)
+		{
+			putErrmsg("Can't record range.", NULL);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int	rfx_insert_plan(IonContact *contacts, int contactCount,
+		IonRange *ranges, int rangeCount)
+{
+	Sdr		sdr = getIonsdr();
+	IonVdb		*vdb = getIonVdb();
+	PlanIndex	contactPlan;
+	PlanIndex	rangePlan;
+	int		affectsRoutes = 0;
+
+	CHKERR(contacts || contactCount == 0);
+	CHKERR(contactCount >= 0);
+	CHKERR(ranges || rangeCount == 0);
+	CHKERR(rangeCount >= 0);
+	memset((char *) &contactPlan, 0, sizeof(PlanIndex));
+	memset((char *) &rangePlan, 0, sizeof(PlanIndex));
+	CHKERR(sdr_begin_xn(sdr));
+
+	/*	Everything the plan needs in working memory is
+	 *	allocated before anything is written to the database,
+	 *	because canceling a transaction that has modified a
+	 *	non-reversible SDR is an unrecoverable error.  A plan
+	 *	that doesn't fit in working memory is simply rejected,
+	 *	leaving both the indexes and the database unchanged.	*/
+
+	if (stageContacts(contacts, contactCount, &contactPlan,
+			&affectsRoutes) < 0
+	|| stageRanges(ranges, rangeCount, &rangePlan, &affectsRoutes) < 0)
+	{
+		discardContacts(&contactPlan);
+		discardRanges(&rangePlan);
+		sdr_exit_xn(sdr);
+		putErrmsg("Can't insert contact plan.", NULL);
+		return -1;
+	}
+
+	if (recordContacts(&contactPlan) < 0 || recordRanges(&rangePlan) < 0)
+	{
+		discardContacts(&contactPlan);
+		discardRanges(&rangePlan);
+		sdr_cancel_xn(sdr);
+		putErrmsg("Can't insert contact plan.", NULL);
+		return -1;
+	}
+
+	commitPlanIndex(&(vdb->contactIndex), &contactPlan);
+	commitPlanIndex(&(vdb->rangeIndex), &rangePlan);
+	if (affectsRoutes)
+	{
+		/*	A single change to the contact plan, for
+		 *	purposes of route computation.			*/
+
+		vdb->lastEditTime = getUTCTime();
+	}
+
+	if (sdr_end_xn(sdr) < 0)
+	{
+		putErrmsg("Can't insert contact plan.", NULL);
+		return -1;
+	}
+
+	return 0;
+}
+
 /*	*	*	RFX control functions	*	*	*	*/
 
 static int	loadRange(Object elt)
@@ -560,6 +560,136 @@ PsmAddress	Sm_rbt_insert(char *file, int line, PsmPartition partition,
 	return node;
 }
 
+/*	Bottom-up construction of a tree from data that are already
+ *	in order: each subtree is rooted at the median of its data,
+ *	so every level of the tree is full except possibly the
+ *	deepest, and coloring all nodes at that depth RED and all
+ *	others BLACK satisfies the red-black invariants without any
+ *	rotation.							*/
+
+static void	freeSubtree(char *file, int line, PsmPartition partition,
+			PsmAddress node)
+{
+	SmRbtNode	*nodePtr;
+
+	if (node == 0)
+	{
+		return;
+	}
+
+	nodePtr = (SmRbtNode *) psp(partition, node);
+	freeSubtree(file, line, partition, nodePtr->child[LEFT]);
+	freeSubtree(file, line, partition, nodePtr->child[RIGHT]);
+	eraseTreeNode(nodePtr);
+	Psm_free(file, line, partition, node);
+}
+
+static PsmAddress	buildSubtree(char *file, int line,
+				PsmPartition partition, PsmAddress rbt,
+				PsmAddress parent, PsmAddress *data,
+				long count, int depth, int redDepth)
+{
+	long		median = count / 2;
+	PsmAddress	node;
+	SmRbtNode	*nodePtr;
+	PsmAddress	child[2] = { 0, 0 };
+
+	node = Psm_zalloc(file, line, partition, sizeof(SmRbtNode));
+	if (node == 0)
+	{
+		putErrmsg("Can't allocate space for rbt node.", NULL);
+		return 0;
+	}
+
+	if (median > 0)
+	{
+		child[LEFT] = buildSubtree(file, line, partition, rbt, node,
+				data, median, depth + 1, redDepth);
+		if (child[LEFT] == 0)
+		{
+			Psm_free(file, line, partition, node);
+			return 0;
+		}
+	}
+
+	if (count - (median + 1) > 0)
+	{
+		child[RIGHT] = buildSubtree(file, line, partition, rbt, node,
+				data + median + 1, count - (median + 1),
+				depth + 1, redDepth);
+		if (child[RIGHT] == 0)
+		{
+			freeSubtree(file, line, partition, child[LEFT]);
+			Psm_free(file, line, partition, node);
+			return 0;
+		}
+	}
+
+	nodePtr = (SmRbtNode *) psp(partition, node);
+	nodePtr->rbt = rbt;
+	nodePtr->parent = parent;
+	nodePtr->child[LEFT] = child[LEFT];
+	nodePtr->child[RIGHT] = child[RIGHT];
+	nodePtr->data = data[median];
+	nodePtr->isRed = (depth > 0 && depth == redDepth);
+	return node;
+}
+
+int	Sm_rbt_build(char *file, int line, PsmPartition partition,
+		PsmAddress rbt, PsmAddress *data, long count)
+{
+	SmRbt		*rbtPtr;
+	int		redDepth = 0;
+	long		levelCount;
+	PsmAddress	root;
+
+	CHKERR(partition);
+	CHKERR(rbt);
+	CHKERR(data || count == 0);
+	CHKERR(count >= 0);
+	rbtPtr = (SmRbt *) psp(partition, rbt);
+	CHKERR(rbtPtr);
+	if (lockSmrbt(rbtPtr) == ERROR)
+	{
+		return -1;
+	}
+
+	if (rbtPtr->root != 0)
+	{
+		unlockSmrbt(rbtPtr);
+		putErrmsg("Can only build an empty rbt.", NULL);
+		return -1;
+	}
+
+	if (count == 0)
+	{
+		unlockSmrbt(rbtPtr);
+		return 0;
+	}
+
+	/*	The deepest level of the tree is level floor(log2 of
+	 *	count), the root node being at level zero.		*/
+
+	for (levelCount = count; levelCount > 1; levelCount >>= 1)
+	{
+		redDepth++;
+	}
+
+	root = buildSubtree(file, line, partition, rbt, 0, data, count, 0,
+			redDepth);
+	if (root == 0)
+	{
+		unlockSmrbt(rbtPtr);
+		putErrmsg("Can't build rbt.", NULL);
+		return -1;
+	}
+
+	rbtPtr->root = root;
+	rbtPtr->length = count;
+	unlockSmrbt(rbtPtr);
+	return 0;
+}
+
 void	Sm_rbt_delete(char *file, int line, PsmPartition partition,
 		PsmAddress rbt, SmRbtCompareFn compare, void *dataBuffer,
 		SmRbtDeleteFn deleteFn, void *arg)
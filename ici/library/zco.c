@@ -1599,8 +1599,73 @@ void	zco_track_file_offset(ZcoReader *reader)
 	}
 }
 
+void	zco_digest_transmission(ZcoReader *reader, ZcoDigest *digest)
+{
+	CHKVOID(reader);
+	CHKVOID(reader->lengthCopied == 0);
+	CHKVOID(digest);
+	CHKVOID(digest->update);
+	CHKVOID(digest->finish);
+	CHKVOID(digest->resultLength == 0 || digest->result != NULL);
+	digest->finished = 0;
+	if (digest->start)
+	{
+		digest->start(digest->context);
+	}
+
+	reader->digest = digest;
+}
+
+static void	digestTransmittedBytes(ZcoDigest *digest, char *bytes,
+			vast offset, vast length)
+{
+	vast	bytesToDigest;
+	vast	resultOffset;
+	vast	resultBytes;
+
+	if (offset < digest->digestLength)
+	{
+		bytesToDigest = digest->digestLength - offset;
+		if (bytesToDigest > length)
+		{
+			bytesToDigest = length;
+		}
+
+		digest->update(digest->context, bytes, bytesToDigest);
+		bytes += bytesToDigest;
+		offset += bytesToDigest;
+		length -= bytesToDigest;
+	}
+
+	if (length == 0)
+	{
+		return;
+	}
+
+	if (!digest->finished)
+	{
+		digest->finish(digest->context, digest->result,
+				digest->resultLength);
+		digest->finished = 1;
+	}
+
+	resultOffset = offset - digest->digestLength;
+	if (resultOffset < digest->resultLength)
+	{
+		resultBytes = digest->resultLength - resultOffset;
+		if (resultBytes > length)
+		{
+			resultBytes = length;
+		}
+
+		memcpy(bytes, digest->result + resultOffset, resultBytes);
+	}
+}
+
 vast	zco_transmit(Sdr sdr, ZcoReader *reader, vast length, char *buffer)
 {
+	char		*start = buffer;
+	vast		startOffset;
 	Zco		zco;
 	vast		bytesToSkip;
 	vast		bytesToTransmit;
@@ -1619,6 +1684,16 @@ vast	zco_transmit(Sdr sdr, ZcoReader *reader, vast length, char *buffer)
 		return 0;
 	}
 
+	startOffset = reader->lengthCopied;
+	if (reader->digest && buffer == NULL
+	&& startOffset < reader->digest->digestLength
+			+ reader->digest->resultLength)
+	{
+		putErrmsg("Can't skip bytes of ZCO that is being digested.",
+				NULL);
+		return -1;
+	}
+
 	sdr_read(sdr, (char *) &zco, reader->zco, sizeof(Zco));
 	bytesToSkip = reader->lengthCopied;
 	bytesToTransmit = length;
@@ -1741,6 +1816,12 @@ vast	zco_transmit(Sdr sdr, ZcoReader *reader, vast length, char *buffer)
 		return 0;
 	}
 
+	if (reader->digest && start && bytesTransmitted > 0)
+	{
+		digestTransmittedBytes(reader->digest, start, startOffset,
+				bytesTransmitted);
+	}
+
 	return bytesTransmitted;
 }
 
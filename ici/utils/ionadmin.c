@@ -106,6 +106,14 @@ relative times (+ss) are computed.");
 	PUTS("\t   a range <from time> <until time> <from node#> <to node#> \
 <OWLT, i.e., range in light seconds>");
 	PUTS("\t\tTime format is either +ss or yyyy/mm/dd-hh:mm:ss.");
+	PUTS("\tb\tBulk load contact plan");
+	PUTS("\t   b <contact plan file name>");
+	PUTS("\t\tEach line of the file is either");
+	PUTS("\t\tcontact,<from time>,<until time>,<from node#>,<to node#>,\
+<xmit rate in bytes per second>");
+	PUTS("\t\tor");
+	PUTS("\t\trange,<from time>,<until time>,<from node#>,<to node#>,<OWLT>");
+	PUTS("\t\tor a comment, starting with '#'.");
 	PUTS("\td\tDelete");
 	PUTS("\ti\tInfo");
 	PUTS("\t   {d|i} contact <from time> <from node#> <to node#>");
@@ -220,6 +228,224 @@ static void	executeAdd(int tokenCount, char **tokens)
 	SYNTAX_ERROR;
 }
 
+#define	PLAN_FIELDS	(6)
+
+/*	Parses one line of a contact plan file.  Returns 1 for a
+ *	contact, 2 for a range, 0 for a comment or blank line, -1
+ *	if the line is not valid.  If entry is NULL, the line is
+ *	only classified: its times, nodes, and rate are not parsed.	*/
+
+static int	parsePlanLine(char *line, time_t refTime, IonContact *entry)
+{
+	char	*fields[PLAN_FIELDS];
+	char	*cursor = line;
+	int	fieldCount = 0;
+	int	len;
+
+	len = strlen(line);
+	while (len > 0 && isspace((int) line[len - 1]))
+	{
+		len--;
+	}
+
+	line[len] = '\0';
+	if (len == 0 || line[0] == '#')
+	{
+		return 0;
+	}
+
+	while (fieldCount < PLAN_FIELDS)
+	{
+		fields[fieldCount++] = cursor;
+		cursor = strchr(cursor, ',');
+		if (cursor == NULL)
+		{
+			break;
+		}
+
+		*cursor = '\0';
+		cursor++;
+	}
+
+	if (fieldCount != PLAN_FIELDS || cursor != NULL)
+	{
+		return -1;
+	}
+
+	if (entry == NULL)
+	{
+		if (strcmp(fields[0], "contact") == 0)
+		{
+			return 1;
+		}
+
+		return (strcmp(fields[0], "range") == 0 ? 2 : -1);
+	}
+
+	entry->fromTime = readTimestampUTC(fields[1], refTime);
+	entry->toTime = readTimestampUTC(fields[2], refTime);
+	if (entry->toTime <= entry->fromTime)
+	{
+		return -1;
+	}
+
+	entry->fromNode = strtouvast(fields[3]);
+	entry->toNode = strtouvast(fields[4]);
+	if (strcmp(fields[0], "contact") == 0)
+	{
+		entry->xmitRate = strtol(fields[5], NULL, 0);
+		return 1;
+	}
+
+	if (strcmp(fields[0], "range") == 0)
+	{
+		entry->xmitRate = atoi(fields[5]);	/*	OWLT.	*/
+		return 2;
+	}
+
+	return -1;
+}
+
+/*	Reads the plan file twice: once to count its contacts and
+ *	ranges, then again to parse and load them.  Timestamps are
+ *	parsed only on the second pass, as parsing them takes much
+ *	of the time taken to load a large plan.  The file is read
+ *	through stdio rather than by igets, which reads one byte per
+ *	system call, because a plan may comprise millions of lines.	*/
+
+static void	executeBulkLoad(int tokenCount, char **tokens)
+{
+	time_t		refTime;
+	FILE		*planFile;
+	char		line[256];
+	char		buffer[80];
+	int		lineNbr;
+	int		counts[3];
+	int		contactCount = 0;
+	int		rangeCount = 0;
+	IonContact	*contacts = NULL;
+	IonRange	*ranges = NULL;
+	IonContact	entry;
+	IonRange	*range;
+	int		pass;
+	int		result;
+
+	if (tokenCount < 2)
+	{
+		printText("Load what?");
+		return;
+	}
+
+	if (tokenCount != 2)
+	{
+		SYNTAX_ERROR;
+		return;
+	}
+
+	planFile = fopen(tokens[1], "r");
+	if (planFile == NULL)
+	{
+		PERROR("Can't open contact plan file");
+		return;
+	}
+
+	refTime = _referenceTime(NULL);
+	for (pass = 0; pass < 2; pass++)
+	{
+		counts[0] = counts[1] = counts[2] = 0;
+		lineNbr = 0;
+		rewind(planFile);
+		while (fgets(line, sizeof line, planFile))
+		{
+			lineNbr++;
+			result = parsePlanLine(line, refTime,
+					pass == 0 ? NULL : &entry);
+			if (result < 0)
+			{
+				isprintf(buffer, sizeof buffer, "Invalid \
+contact plan entry at line %d.", lineNbr);
+				printText(buffer);
+				fclose(planFile);
+				if (contacts)
+				{
+					free(contacts);
+				}
+
+				return;
+			}
+
+			if (result == 0 || pass == 0)
+			{
+				counts[result]++;
+				continue;
+			}
+
+			/*	The buffer is sized by the first pass; if
+			 *	the file has grown since then, stop.	*/
+
+			if (result == 1)
+			{
+				if (counts[1] == contactCount)
+				{
+					break;
+				}
+
+				contacts[counts[1]++] = entry;
+				continue;
+			}
+
+			if (counts[2] == rangeCount)
+			{
+				break;
+			}
+
+			range = ranges + counts[2]++;
+			range->fromTime = entry.fromTime;
+			range->toTime = entry.toTime;
+			range->fromNode = entry.fromNode;
+			range->toNode = entry.toNode;
+			range->owlt = entry.xmitRate;
+		}
+
+		if (pass > 0)
+		{
+			break;
+		}
+
+		/*	Contacts and ranges share a single buffer,
+		 *	taken from the private heap rather than from
+		 *	ION working memory because a large plan may
+		 *	need many megabytes of staging space.		*/
+
+		contactCount = counts[1];
+		rangeCount = counts[2];
+		contacts = (IonContact *) malloc((contactCount
+				* sizeof(IonContact))
+				+ (rangeCount * sizeof(IonRange)) + 1);
+		if (contacts == NULL)
+		{
+			putErrmsg("Can't allocate space for contact plan.",
+					tokens[1]);
+			fclose(planFile);
+			return;
+		}
+
+		ranges = (IonRange *) (contacts + contactCount);
+	}
+
+	fclose(planFile);
+	if (rfx_insert_plan(contacts, counts[1], ranges, counts[2]) < 0)
+	{
+		putErrmsg("Can't load contact plan.", tokens[1]);
+	}
+	else if (counts[1] > 0)
+	{
+		oK(_forecastNeeded(1));
+	}
+
+	free(contacts);
+}
+
 static void	executeDelete(int tokenCount, char **tokens)
 {
 	time_t	refTime;
@@ -1003,6 +1229,14 @@ no time.");
 
 			return 0;
 
+		case 'b':
+			if (ionAttach() == 0)
+			{
+				executeBulkLoad(tokenCount, tokens);
+			}
+
+			return 0;
+
 		case 'd':
 			if (ionAttach() == 0)
 			{
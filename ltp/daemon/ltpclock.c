@@ -204,6 +204,11 @@ static int	manageLinks(Sdr sdr, time_t currentTime)
 		vspan->receptionRate = neighbor->recvRate;
 		vspan->owltInbound = neighbor->owltInbound;
 		vspan->owltOutbound = neighbor->owltOutbound;
+
+		/*	Resize the export session window to suit the
+		 *	current rate and round-trip time.		*/
+
+		ltpAdjustExportWindow(&span, vspan);
 	}
 
 	if (sdr_end_xn(sdr) < 0)
@@ -31,7 +31,7 @@ int	ltp_engine_is_started()
 	return (vdb && vdb->clockPid != ERROR);
 }
 
-static int	sduCanBeAppendedToBlock(LtpSpan *span,
+static int	sduCanBeAppendedToBlock(LtpSpan *span, LtpVspan *vspan,
 			unsigned int clientSvcId,
 			unsigned int redPartLength)
 {
@@ -71,16 +71,24 @@ static int	sduCanBeAppendedToBlock(LtpSpan *span,
 		 *	resource allocation (no retransmission
 		 *	buffers are maintained).  The LTP flow
 		 *	control window applies only to the flow
-		 *	of red data.					*/
+		 *	of red data.
+		 *
+		 *	The session limit is the span's current
+		 *	export window, which is the span's max
+		 *	export sessions unless the window is being
+		 *	auto-tuned.  Noting that red data had to
+		 *	wait for the window enables ltpclock to
+		 *	probe for a larger window.			*/
 
 		if (sdr_list_length(sdr, span->exportSessions)
-				> span->maxExportSessions)
+				> vspan->exportWindow)
 		{
 			if (redPartLength == 0)	/*	All-green SDU.	*/
 			{
 				return 1;	/*	Okay.		*/
 			}
 
+			vspan->exportWindowFull = 1;
 			return 0;	/*	Red data; no good.	*/
 		}
 
@@ -192,7 +200,7 @@ int	ltp_send(uvast destinationEngineId, unsigned int clientSvcId,
 			 *	session buffer (block) into which
 			 *	service data can be inserted.		*/
 
-			if (sduCanBeAppendedToBlock(&span, clientSvcId,
+			if (sduCanBeAppendedToBlock(&span, vspan, clientSvcId,
 					redPartLength))
 			{
 				break;		/*	Out of loop.	*/
@@ -214,6 +214,13 @@ static int	raiseSpan(Object spanElt, LtpVdb *ltpvdb)
 	vspan->stats = span.stats;
 	vspan->updateStats = span.updateStats;
 	vspan->engineId = span.engineId;
+	vspan->exportWindow = span.maxExportSessions;
+	if (span.maxExportWindow > 0
+	&& vspan->exportWindow > span.maxExportWindow)
+	{
+		vspan->exportWindow = span.maxExportWindow;
+	}
+
 	vspan->segmentBuffer = psm_malloc(ltpwm, span.maxSegmentSize);
 	if (vspan->segmentBuffer == 0)
 	{
@@ -887,7 +894,14 @@ void	checkReservationLimit()
 	{
 		GET_OBJ_POINTER(ltpSdr, LtpSpan, span, sdr_list_data(ltpSdr,
 				elt));
-		totalSessionsAvbl -= span->maxExportSessions;
+		if (span->maxExportWindow > span->maxExportSessions)
+		{
+			totalSessionsAvbl -= span->maxExportWindow;
+		}
+		else
+		{
+			totalSessionsAvbl -= span->maxExportSessions;
+		}
 	}
 
 	if (totalSessionsAvbl < 0)
@@ -1115,6 +1129,11 @@ string too long.", lsoCmd);
 	}
 
 	sdr_write(ltpSdr, addr, (char *) &spanBuf, sizeof(LtpSpan));
+	if (spanBuf.maxExportWindow == 0)
+	{
+		vspan->exportWindow = spanBuf.maxExportSessions;
+	}
+
 	if (sdr_end_xn(ltpSdr) < 0)
 	{
 		putErrmsg("Can't update span.", itoa(engineId));
@@ -1124,6 +1143,157 @@ string too long.", lsoCmd);
 	return 1;
 }
 
+int	updateSpanWindow(uvast engineId, unsigned int maxExportWindow)
+{
+	Sdr		ltpSdr = getIonsdr();
+	LtpVspan	*vspan;
+	PsmAddress	vspanElt;
+	Object		addr;
+	LtpSpan		spanBuf;
+
+	CHKERR(sdr_begin_xn(ltpSdr));
+	findSpan(engineId, &vspan, &vspanElt);
+	if (vspanElt == 0)	/*	This is an unknown span.	*/
+	{
+		sdr_exit_xn(ltpSdr);
+		writeMemoNote("[?] Unknown span", itoa(engineId));
+		return 0;
+	}
+
+	addr = (Object) sdr_list_data(ltpSdr, vspan->spanElt);
+	sdr_stage(ltpSdr, (char *) &spanBuf, addr, sizeof(LtpSpan));
+	spanBuf.maxExportWindow = maxExportWindow;
+	sdr_write(ltpSdr, addr, (char *) &spanBuf, sizeof(LtpSpan));
+
+	/*	Auto-tuning starts from the configured session limit
+	 *	(bounded by the new ceiling) and reverts to it when
+	 *	auto-tuning is disabled.				*/
+
+	vspan->exportWindow = spanBuf.maxExportSessions;
+	if (maxExportWindow > 0 && vspan->exportWindow > maxExportWindow)
+	{
+		vspan->exportWindow = maxExportWindow;
+	}
+
+	vspan->exportWindowFull = 0;
+	sm_SemGive(vspan->bufOpenRedSemaphore);
+	if (sdr_end_xn(ltpSdr) < 0)
+	{
+		putErrmsg("Can't update span window.", itoa(engineId));
+		return -1;
+	}
+
+	return 1;
+}
+
+/*	The export session window controller.  The number of
+ *	export sessions needed to keep a span's link busy is the
+ *	bandwidth-delay product of the span divided by the nominal
+ *	block size (the aggregation size limit): no session can
+ *	close until the report for its final checkpoint arrives, one
+ *	round trip after the block was transmitted.  One additional
+ *	session is needed for the block currently being aggregated.
+ *
+ *	Transmission rate is measured (exponentially smoothed) from
+ *	the bytes actually dequeued by the LSO.  Round-trip time is
+ *	measured from checkpoint/report exchanges, falling back to
+ *	the contact plan's OWLTs and the queuing latencies until
+ *	the first report has been received.  Because the measured
+ *	rate can never exceed what the current window admits, the
+ *	window is additionally probed upward by one session each
+ *	second in which a sender was blocked at the window limit.
+ *	The window grows immediately to the computed need but
+ *	shrinks by only one session per second, so that transient
+ *	lulls in traffic don't collapse it.			*/
+
+void	ltpAdjustExportWindow(LtpSpan *span, LtpVspan *vspan)
+{
+	Sdr		ltpSdr = getIonsdr();
+	LtpDB		ltpdb;
+	unsigned int	rtt;
+	uvast		bdp;
+	unsigned int	needed;
+	unsigned int	sessions;
+
+	CHKVOID(ionLocked());
+	CHKVOID(span);
+	CHKVOID(vspan);
+	sessions = sdr_list_length(ltpSdr, span->exportSessions);
+	if (sessions > vspan->peakExportSessions)
+	{
+		vspan->peakExportSessions = sessions;
+	}
+
+	if (vspan->localXmitRate > 0)	/*	Link is up.		*/
+	{
+		if (vspan->measuredXmitRate == 0)
+		{
+			vspan->measuredXmitRate = vspan->xmitBytesSampled;
+		}
+		else
+		{
+			vspan->measuredXmitRate += ((int)
+					(vspan->xmitBytesSampled
+					- vspan->measuredXmitRate)) / 8;
+		}
+	}
+
+	vspan->xmitBytesSampled = 0;
+	if (span->maxExportWindow == 0)	/*	Not auto-tuned.		*/
+	{
+		vspan->exportWindow = span->maxExportSessions;
+		vspan->exportWindowFull = 0;
+		return;
+	}
+
+	if (vspan->measuredRtt > 0)
+	{
+		rtt = vspan->measuredRtt;
+	}
+	else
+	{
+		sdr_read(ltpSdr, (char *) &ltpdb, getLtpDbObject(),
+				sizeof(LtpDB));
+		rtt = vspan->owltOutbound + vspan->owltInbound
+				+ span->remoteQtime + ltpdb.ownQtime;
+		if (rtt == 0)
+		{
+			rtt = 1;
+		}
+	}
+
+	bdp = ((uvast) (vspan->measuredXmitRate)) * rtt;
+	needed = 1 + (bdp / span->aggrSizeLimit);
+	if (bdp % span->aggrSizeLimit)
+	{
+		needed++;
+	}
+
+	if (vspan->exportWindowFull && needed <= vspan->exportWindow)
+	{
+		needed = vspan->exportWindow + 1;
+	}
+
+	vspan->exportWindowFull = 0;
+	if (needed > span->maxExportWindow)
+	{
+		needed = span->maxExportWindow;
+	}
+
+	if (needed > vspan->exportWindow)
+	{
+		vspan->exportWindow = needed;
+
+		/*	Enable a blocked client to start a new session.	*/
+
+		sm_SemGive(vspan->bufOpenRedSemaphore);
+	}
+	else if (needed < vspan->exportWindow)
+	{
+		vspan->exportWindow--;
+	}
+}
+
 int	removeSpan(uvast engineId)
 {
 	Sdr		ltpSdr = getIonsdr();
@@ -2236,31 +2406,23 @@ static void	serializeHeader(LtpXmitSeg *segment, Sdnv *engineIdSdnv,
 
 static void	serializeDataSegment(LtpXmitSeg *segment, char *buf)
 {
-	char	*cursor = buf;
-	Sdnv	sdnv;
+	char		*cursor = buf;
+	uvast		fields[5];
+	int		fieldCount = 3;
+	unsigned char	fieldsText[sizeof fields / sizeof(uvast) * 10];
+	int		fieldsLength;
 
 	/*	Origin is the local engine.				*/
 
 	serializeHeader(segment, &((_ltpConstants())->ownEngineIdSdnv),
 			&cursor);
 
-	/*	Append client service number.				*/
-
-	encodeSdnv(&sdnv, segment->pdu.clientSvcId);
-	memcpy(cursor, sdnv.text, sdnv.length);
-	cursor += sdnv.length;
-
-	/*	Append offset of data within block.			*/
-
-	encodeSdnv(&sdnv, segment->pdu.offset);
-	memcpy(cursor, sdnv.text, sdnv.length);
-	cursor += sdnv.length;
+	/*	Append client service number, offset of data within
+	 *	block, and length of data.				*/
 
-	/*	Append length of data.					*/
-
-	encodeSdnv(&sdnv, segment->pdu.length);
-	memcpy(cursor, sdnv.text, sdnv.length);
-	cursor += sdnv.length;
+	fields[0] = segment->pdu.clientSvcId;
+	fields[1] = segment->pdu.offset;
+	fields[2] = segment->pdu.length;
 
 	/*	If checkpoint, append checkpoint and report serial
 	 *	numbers.						*/
@@ -2268,18 +2430,18 @@ static void	serializeDataSegment(LtpXmitSeg *segment, char *buf)
 	if (!(segment->pdu.segTypeCode & LTP_EXC_FLAG)	/*	Red.	*/
 	&& segment->pdu.segTypeCode > 0)	/*	Checkpoint.	*/
 	{
-		/*	Append checkpoint serial number.		*/
-
-		encodeSdnv(&sdnv, segment->pdu.ckptSerialNbr);
-		memcpy(cursor, sdnv.text, sdnv.length);
-		cursor += sdnv.length;
+		fields[3] = segment->pdu.ckptSerialNbr;
+		fields[4] = segment->pdu.rptSerialNbr;
+		fieldCount = 5;
+	}
 
-		/*	Append report serial number.			*/
+	/*	Encode into a scratch buffer: encodeSdnvs may write
+	 *	past the end of the encoded text, which here would
+	 *	overwrite the start of the client service data.		*/
 
-		encodeSdnv(&sdnv, segment->pdu.rptSerialNbr);
-		memcpy(cursor, sdnv.text, sdnv.length);
-		cursor += sdnv.length;
-	}
+	fieldsLength = encodeSdnvs(fieldsText, sizeof fieldsText, fields,
+			fieldCount);
+	memcpy(cursor, (char *) fieldsText, fieldsLength);
 
 	/*	Note: client service data was copied into the trailing
 	 *	bytes of the buffer before this function was called.	*/
@@ -2885,6 +3047,7 @@ int	ltpDequeueOutboundSegment(LtpVspan *vspan, char **buf)
 		}
 	}
 
+	vspan->xmitBytesSampled += segmentLength;
 	if (sdr_end_xn(ltpSdr))
 	{
 		putErrmsg("Can't get outbound segment for span.", NULL);
@@ -3352,6 +3515,267 @@ putErrmsg(buf, itoa(session->sessionNbr));
 	return 0;
 }
 
+static int	addReceivedRun(LtpReceptionClaim **runs, int *runCount,
+			int *runsAllocated, unsigned int runStart,
+			unsigned int runEnd)
+{
+	LtpReceptionClaim	*newRuns;
+	int			newAllocation;
+
+	if (*runCount == *runsAllocated)
+	{
+		newAllocation = (*runsAllocated == 0) ? MAX_CLAIMS_PER_RS * 2
+				: *runsAllocated * 2;
+		newRuns = (LtpReceptionClaim *) MTAKE(newAllocation
+				* sizeof(LtpReceptionClaim));
+		if (newRuns == NULL)
+		{
+			if (*runs)
+			{
+				MRELEASE(*runs);
+				*runs = NULL;
+			}
+
+			return -1;
+		}
+
+		if (*runs)
+		{
+			memcpy((char *) newRuns, (char *) *runs,
+				*runCount * sizeof(LtpReceptionClaim));
+			MRELEASE(*runs);
+		}
+
+		*runs = newRuns;
+		*runsAllocated = newAllocation;
+	}
+
+	(*runs)[*runCount].offset = runStart;
+	(*runs)[*runCount].length = runEnd - runStart;
+	(*runCount)++;
+	return 0;
+}
+
+static int	collectReceivedRuns(ImportSession *session,
+			unsigned int lowerBound, unsigned int reportUpperBound,
+			LtpReceptionClaim **runs, int *runCount)
+{
+	Sdr		ltpSdr = getIonsdr();
+	int		runsAllocated = 0;
+	unsigned int	runStart = lowerBound;
+	unsigned int	runEnd = lowerBound;
+	unsigned int	segStart;
+	unsigned int	segEnd;
+	Object		elt;
+			OBJ_POINTER(LtpRecvSeg, ds);
+
+	/*	Compile the contiguous extents of red data received
+	 *	within the scope of the report, in offset order.	*/
+
+	*runs = NULL;
+	*runCount = 0;
+	for (elt = sdr_list_first(ltpSdr, session->redSegments); elt;
+			elt = sdr_list_next(ltpSdr, elt))
+	{
+		GET_OBJ_POINTER(ltpSdr, LtpRecvSeg, ds,
+				sdr_list_data(ltpSdr, elt));
+		segStart = ds->pdu.offset;
+		segEnd = segStart + ds->pdu.length;
+		if (segEnd <= lowerBound)
+		{
+			continue;	/*	Not in report bounds.	*/
+		}
+
+		if (segStart >= reportUpperBound)
+		{
+			break;	/*	No need to check any further.	*/
+		}
+
+		if (segStart < lowerBound)
+		{
+			segStart = lowerBound;
+		}
+
+		if (segStart <= runEnd)
+		{
+			if (segEnd > runEnd)
+			{
+				runEnd = segEnd;
+			}
+
+			continue;	/*	Contiguous extents.	*/
+		}
+
+		/*	Gap found; end of received run, so note it
+		 *	unless it is of zero length (i.e., at start).	*/
+
+		if (runEnd != runStart)
+		{
+			if (addReceivedRun(runs, runCount, &runsAllocated,
+					runStart, runEnd) < 0)
+			{
+				return -1;
+			}
+		}
+
+		runStart = segStart;
+		runEnd = segEnd;
+	}
+
+	if (runEnd != runStart)
+	{
+		if (addReceivedRun(runs, runCount, &runsAllocated, runStart,
+				runEnd) < 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int	compareRunLengths(const void *a, const void *b)
+{
+	LtpReceptionClaim	*run1 = *((LtpReceptionClaim **) a);
+	LtpReceptionClaim	*run2 = *((LtpReceptionClaim **) b);
+
+	if (run1->length != run2->length)
+	{
+		return (run1->length < run2->length) ? -1 : 1;
+	}
+
+	return (run1->offset < run2->offset) ? -1 : 1;
+}
+
+static int	coalesceReceivedRuns(LtpReceptionClaim *runs, int runCount,
+			unsigned int scope)
+{
+	int			excess = runCount - MAX_CLAIMS_PER_RS;
+	unsigned int		budget = scope / LTP_OVERREPORT_DIVISOR;
+	unsigned int		omitted = 0;
+	LtpReceptionClaim	**order;
+	int			i;
+	int			j;
+
+	/*	Each received run omitted from the report merges the
+	 *	gaps on either side of it into a single gap, at the
+	 *	cost of causing the sender to retransmit the run's
+	 *	data.  So we omit the shortest runs first, until the
+	 *	report fits in a single report segment or the over-
+	 *	reporting budget is exhausted.  The last run is never
+	 *	omitted, as it establishes the report's upper bound.	*/
+
+	if (excess <= 0 || budget == 0)
+	{
+		return runCount;
+	}
+
+	order = (LtpReceptionClaim **) MTAKE((runCount - 1)
+			* sizeof(LtpReceptionClaim *));
+	if (order == NULL)
+	{
+		return runCount;	/*	Just don't coalesce.	*/
+	}
+
+	for (i = 0; i < runCount - 1; i++)
+	{
+		order[i] = runs + i;
+	}
+
+	qsort((char *) order, runCount - 1, sizeof(LtpReceptionClaim *),
+			compareRunLengths);
+	for (i = 0; i < runCount - 1 && excess > 0; i++)
+	{
+		if (omitted + order[i]->length > budget)
+		{
+			break;		/*	No longer affordable.	*/
+		}
+
+		omitted += order[i]->length;
+		order[i]->length = 0;	/*	Omit from report.	*/
+		excess--;
+	}
+
+	MRELEASE(order);
+	for (i = 0, j = 0; i < runCount; i++)
+	{
+		if (runs[i].length > 0)
+		{
+			runs[j] = runs[i];
+			j++;
+		}
+	}
+
+	return j;
+}
+
+static int	postReceptionClaims(ImportSession *session,
+			Object sessionObj, LtpXmitSeg *rsBuf,
+			int baseOhdLength, int checkpointSerialNbrLength,
+			LtpReceptionClaim *runs, int runCount)
+{
+	int			claimCount = 0;
+	LtpReceptionClaim	*run;
+	int			i;
+
+	for (i = 0, run = runs; i < runCount; i++, run++)
+	{
+		if (constructReceptionClaim(rsBuf, run->offset,
+				run->offset + run->length) < 0)
+		{
+			return -1;
+		}
+
+		claimCount++;
+		rsBuf->pdu.upperBound = run->offset + run->length;
+		if (claimCount < MAX_CLAIMS_PER_RS || i == runCount - 1)
+		{
+			continue;
+		}
+
+		/*	Must ship this RS and start another, whose
+		 *	scope begins where this one's ends.		*/
+
+		if (constructRs(rsBuf, claimCount, session) < 0)
+		{
+			return -1;
+		}
+
+		/*	We know the session now has a lastRptSerialNbr.	*/
+
+		session->lastRptSerialNbr++;
+		if (session->lastRptSerialNbr == 0)
+		{
+			if (cancelSessionByReceiver(session, sessionObj,
+					LtpRetransmitLimitExceeded) < 0)
+			{
+				return -1;
+			}
+
+			return 1;	/*	Session is canceled.	*/
+		}
+
+		if (initializeRs(rsBuf, baseOhdLength,
+				session->lastRptSerialNbr,
+				checkpointSerialNbrLength,
+				rsBuf->pdu.upperBound) < 0)
+		{
+			return -1;
+		}
+
+		claimCount = 0;
+	}
+
+	/*	Ship final RS of this report.				*/
+
+	if (constructRs(rsBuf, claimCount, session) < 0)
+	{
+		return -1;
+	}
+
+	return 0;
+}
+
 static int	sendReport(ImportSession *session, Object sessionObj,
 			unsigned int checkpointSerialNbr,
 			unsigned int reportSerialNbr,
@@ -3366,10 +3790,9 @@ static int	sendReport(ImportSession *session, Object sessionObj,
 	int		baseOhdLength;
 	LtpXmitSeg	rsBuf;
 	Sdnv		checkpointSerialNbrSdnv;
-	unsigned int	lowerBound;
-	unsigned int	upperBound;
-	int		claimCount;
-			OBJ_POINTER(LtpRecvSeg, ds);
+	LtpReceptionClaim	*runs;
+	int		runCount;
+	int		result;
 #if LTPDEBUG
 int		shortfall;
 char		buf[256];
@@ -3428,7 +3851,26 @@ putErrmsg("Too many reports, canceling session.", itoa(session->sessionNbr));
 		}
 	}
 
-	upperBound = lowerBound = reportLowerBound;
+	/*	Compile the report's reception claims.			*/
+
+	if (collectReceivedRuns(session, reportLowerBound, reportUpperBound,
+			&runs, &runCount) < 0)
+	{
+		putErrmsg("Can't compile reception claims.", NULL);
+		return -1;
+	}
+
+	if (runCount == 0)		/*	Nothing to report.	*/
+	{
+#if LTPDEBUG
+putErrmsg("No report, upper bound == lower bound.", itoa(session->sessionNbr));
+#endif
+		return 0;
+	}
+
+	runCount = coalesceReceivedRuns(runs, runCount,
+			runs[runCount - 1].offset + runs[runCount - 1].length
+			- reportLowerBound);
 	GET_OBJ_POINTER(ltpSdr, LtpSpan, span, session->span);
 	baseOhdLength = 1 + span->engineIdSdnv.length
 			+ session->sessionNbrSdnv.length + 1;
@@ -3444,108 +3886,27 @@ putErrmsg("Too many reports, canceling session.", itoa(session->sessionNbr));
 	rsBuf.pdu.ckptSerialNbr = checkpointSerialNbr;
 	encodeSdnv(&checkpointSerialNbrSdnv, checkpointSerialNbr);
 
-	/*	Initialize the first report segment and start adding
+	/*	Initialize the first report segment and post the
 	 *	reception claims.					*/
 
 	if (initializeRs(&rsBuf, baseOhdLength, session->lastRptSerialNbr,
-			checkpointSerialNbrSdnv.length, lowerBound) < 0)
+			checkpointSerialNbrSdnv.length, reportLowerBound) < 0)
 	{
+		MRELEASE(runs);
 		return -1;
 	}
 
-	claimCount = 0;
-	for (elt = sdr_list_first(ltpSdr, session->redSegments); elt;
-			elt = sdr_list_next(ltpSdr, elt))
-	{
-		GET_OBJ_POINTER(ltpSdr, LtpRecvSeg, ds,
-				sdr_list_data(ltpSdr, elt));
-		if (ds->pdu.offset + ds->pdu.length <= lowerBound)
-		{
-			continue;	/*	Not in report bounds.	*/
-		}
-
-		if (ds->pdu.offset >= reportUpperBound)
-		{
-			break;	/*	No need to check any further.	*/
-		}
-
-		if (ds->pdu.offset == upperBound)
-		{
-			upperBound += ds->pdu.length;
-			continue;	/*	Contiguous extents.	*/
-		}
-
-		/*	Gap found; end of reception claim, so post it
-		 *	unless it is of zero length (i.e., at start).	*/
-
-		if (upperBound != lowerBound)
-		{
-			if (constructReceptionClaim(&rsBuf, lowerBound,
-					upperBound) < 0)
-			{
-				return -1;
-			}
-
-			claimCount++;
-			rsBuf.pdu.upperBound = upperBound;
-		}
-
-		lowerBound = ds->pdu.offset;
-		upperBound = lowerBound + ds->pdu.length;
-		if (claimCount < MAX_CLAIMS_PER_RS)
-		{
-			continue;
-		}
-
-		/*	Must ship this RS and start another.		*/
-
-		if (constructRs(&rsBuf, claimCount, session) < 0)
-		{
-			return -1;
-		}
-
-		/*	We know the session now has a lastRptSerialNbr.	*/
-
-		session->lastRptSerialNbr++;
-		if (session->lastRptSerialNbr == 0)
-		{
-			return cancelSessionByReceiver(session, sessionObj,
-					LtpRetransmitLimitExceeded);
-		}
-
-		if (initializeRs(&rsBuf, baseOhdLength,
-				session->lastRptSerialNbr,
-				checkpointSerialNbrSdnv.length, lowerBound) < 0)
-		{
-			return -1;
-		}
-
-		claimCount = 0;
-	}
-
-	if (upperBound == lowerBound)	/*	Nothing to report.	*/
-	{
-#if LTPDEBUG
-putErrmsg("No report, upper bound == lower bound.", itoa(session->sessionNbr));
-#endif
-		return 0;
-	}
-
-	/*	Add last reception claim.				*/
-
-	if (constructReceptionClaim(&rsBuf, lowerBound, upperBound) < 0)
+	result = postReceptionClaims(session, sessionObj, &rsBuf,
+			baseOhdLength, checkpointSerialNbrSdnv.length, runs,
+			runCount);
+	MRELEASE(runs);
+	switch (result)
 	{
+	case -1:
 		return -1;
-	}
-
-	claimCount++;
-	rsBuf.pdu.upperBound = upperBound;
-
-	/*	Ship final RS of this report.				*/
 
-	if (constructRs(&rsBuf, claimCount, session) < 0)
-	{
-		return -1;
+	case 1:				/*	Session canceled.	*/
+		return 0;
 	}
 
 #if LTPDEBUG
@@ -4099,8 +4460,9 @@ static int	handleDataSegment(uvast sourceEngineId, LtpDB *ltpdb,
 {
 	Sdr		ltpSdr = getIonsdr();
 	LtpVdb		*ltpvdb = _ltpvdb(NULL);
-	unsigned int	ckptSerialNbr;
-	unsigned int	rptSerialNbr;
+	uvast		fields[3];
+	unsigned int	ckptSerialNbr = 0;
+	unsigned int	rptSerialNbr = 0;
 	LtpVspan	*vspan;
 	PsmAddress	vspanElt;
 	VImportSession	*vsession;
@@ -4117,15 +4479,17 @@ static int	handleDataSegment(uvast sourceEngineId, LtpDB *ltpdb,
 
 	/*	First finish parsing the segment.			*/
 
-	extractSmallSdnv(&(pdu->clientSvcId), cursor, bytesRemaining);
-	extractSmallSdnv(&(pdu->offset), cursor, bytesRemaining);
-	extractSmallSdnv(&(pdu->length), cursor, bytesRemaining);
+	extractSdnvs(fields, 3, cursor, bytesRemaining);
+	pdu->clientSvcId = fields[0];		/*	Truncate.	*/
+	pdu->offset = fields[1];
+	pdu->length = fields[2];
 	if (pdu->segTypeCode > 0 && !(pdu->segTypeCode & LTP_EXC_FLAG))
 	{
 		/*	This segment is an LTP checkpoint.		*/
 
-		extractSmallSdnv(&ckptSerialNbr, cursor, bytesRemaining);
-		extractSmallSdnv(&rptSerialNbr, cursor, bytesRemaining);
+		extractSdnvs(fields, 2, cursor, bytesRemaining);
+		ckptSerialNbr = fields[0];
+		rptSerialNbr = fields[1];
 	}
 
 	/*	At this point, the remaining bytes should all be
@@ -4957,6 +5321,93 @@ putErrmsg("Discarding stray segment.", itoa(sessionNbr));
 	}
 }
 
+static int	mergeClaims(LtpReceptionClaim *oldClaims, int oldCount,
+			LtpReceptionClaim *newClaims, int newCount,
+			LtpReceptionClaim *merged)
+{
+	int			i = 0;
+	int			j = 0;
+	int			mergedCount = 0;
+	LtpReceptionClaim	*next;
+	unsigned int		nextEnd;
+	LtpReceptionClaim	*current = NULL;
+	unsigned int		currentEnd = 0;
+
+	/*	Both arrays of claims are in ascending offset order,
+	 *	so a single sweep over their union, in offset order,
+	 *	yields the consolidated claims: each claim either
+	 *	overlaps or abuts the current consolidated claim (and
+	 *	extends it) or else starts a new one.			*/
+
+	while (i < oldCount || j < newCount)
+	{
+		if (j == newCount
+		|| (i < oldCount && oldClaims[i].offset < newClaims[j].offset))
+		{
+			next = oldClaims + i;
+			i++;
+		}
+		else
+		{
+			next = newClaims + j;
+			j++;
+		}
+
+		nextEnd = next->offset + next->length;
+		if (current && next->offset <= currentEnd)
+		{
+			if (nextEnd > currentEnd)
+			{
+				currentEnd = nextEnd;
+				current->length = currentEnd - current->offset;
+			}
+
+			continue;
+		}
+
+		current = merged + mergedCount;
+		mergedCount++;
+		current->offset = next->offset;
+		current->length = next->length;
+		currentEnd = nextEnd;
+	}
+
+	return mergedCount;
+}
+
+static void	noteRoundTrip(LtpDB *ltpdb, LtpVspan *vspan,
+			LtpTimer *timer)
+{
+	int	sample;
+
+	/*	The checkpoint's expected arrival time at the remote
+	 *	engine was computed as transmission time plus outbound
+	 *	OWLT plus half of own queuing latency (ignoring radiation
+	 *	time), so backing those terms out of the elapsed time
+	 *	yields the round trip observed for this checkpoint.	*/
+
+	sample = (getUTCTime() - timer->segArrivalTime) + vspan->owltOutbound
+			+ ((ltpdb->ownQtime >> 1) & 0x7fffffff);
+	if (sample < 1)
+	{
+		sample = 1;
+	}
+
+	if (vspan->measuredRtt == 0)
+	{
+		vspan->measuredRtt = sample;
+	}
+	else	/*	Smooth as in RFC 6298: 7/8 old + 1/8 new.	*/
+	{
+		vspan->measuredRtt = ((vspan->measuredRtt * 7) + sample
+				+ 4) >> 3;
+		if (vspan->measuredRtt == 0)
+		{
+			vspan->measuredRtt = 1;
+		}
+	}
+}
+
 static int	handleRS(LtpDB *ltpdb, unsigned int sessionNbr,
 			LtpRecvSeg *segment, LtpPdu *pdu, char **cursor,
 			int *bytesRemaining)
@@ -4964,6 +5415,7 @@ static int	handleRS(LtpDB *ltpdb, unsigned int sessionNbr,
 	Sdr			ltpSdr = getIonsdr();
 	LtpVdb			*ltpvdb = _ltpvdb(NULL);
 	int			ltpMemIdx = getIonMemoryMgr();
+	uvast			fields[5];
 	unsigned int		rptSerialNbr;
 	unsigned int		ckptSerialNbr;
 	unsigned int		rptUpperBound;
@@ -4979,17 +5431,17 @@ static int	handleRS(LtpDB *ltpdb, unsigned int sessionNbr,
 	Object			elt;
 	Object			dsObj;
 	LtpXmitSeg		dsBuf;
-	Lyst			claims;
+	int			oldClaimCount;
+	LtpReceptionClaim	*oldClaims;
+	LtpReceptionClaim	*claims;
+	int			mergedClaimCount;
 	Object			claimObj;
 	Object			nextElt;
 	LtpReceptionClaim	*claim;
 	unsigned int		claimEnd;
-	LtpReceptionClaim	*newClaim;
-	unsigned int		newClaimEnd;
-	LystElt			elt2;
-	LystElt			nextElt2;
 	int			i;
 	Lyst			extents;
+	LystElt			extentElt;
 	ExportExtent		*extent;
 	unsigned int		startOfGap;
 #if LTPDEBUG
@@ -5001,11 +5453,12 @@ putErrmsg("Handling report.", utoa(sessionNbr));
 	 *	reception claims in the report into an array of new
 	 *	claims.							*/
 
-	extractSmallSdnv(&rptSerialNbr, cursor, bytesRemaining);
-	extractSmallSdnv(&ckptSerialNbr, cursor, bytesRemaining);
-	extractSmallSdnv(&rptUpperBound, cursor, bytesRemaining);
-	extractSmallSdnv(&rptLowerBound, cursor, bytesRemaining);
-	extractSmallSdnv(&claimCount, cursor, bytesRemaining);
+	extractSdnvs(fields, 5, cursor, bytesRemaining);
+	rptSerialNbr = fields[0];		/*	Truncate.	*/
+	ckptSerialNbr = fields[1];
+	rptUpperBound = fields[2];
+	rptLowerBound = fields[3];
+	claimCount = fields[4];
 	newClaims = (LtpReceptionClaim *)
 			MTAKE(claimCount* sizeof(LtpReceptionClaim));
 	if (newClaims == NULL)
@@ -5099,6 +5552,11 @@ putErrmsg("Discarding report.", NULL);
 		 *	retransmit it.					*/
 
 		sdr_stage(ltpSdr, (char *) &dsBuf, dsObj, sizeof(LtpXmitSeg));
+		if (dsBuf.pdu.timer.segArrivalTime != 0)
+		{
+			noteRoundTrip(ltpdb, vspan, &dsBuf.pdu.timer);
+		}
+
 		dsBuf.pdu.timer.segArrivalTime = 0;
 		sdr_write(ltpSdr, dsObj, (char *) &dsBuf, sizeof(LtpXmitSeg));
 	}
@@ -5118,159 +5576,66 @@ putErrmsg("Discarding report.", NULL);
 
 	/*	Retrieve all previously received reception claims
 	 *	for this transmission session, loading them into a
-	 *	temporary linked list within which the new and old
-	 *	claims will be merged.  While loading the old claims
-	 *	into the list, delete them from the database; they
-	 *	will be replaced by the final contents of the linked
-	 *	list.							*/
+	 *	temporary array, and merge them with the new claims
+	 *	into a second array of consolidated claims.  While
+	 *	loading the old claims into the array, delete them
+	 *	from the database; they will be replaced by the
+	 *	consolidated claims.					*/
 
-	if ((claims = lyst_create_using(ltpMemIdx)) == NULL)
+	oldClaimCount = sdr_list_length(ltpSdr, sessionBuf.claims);
+	oldClaims = (LtpReceptionClaim *) MTAKE((oldClaimCount + 1)
+			* sizeof(LtpReceptionClaim));
+	claims = (LtpReceptionClaim *) MTAKE((oldClaimCount + claimCount)
+			* sizeof(LtpReceptionClaim));
+	if (oldClaims == NULL || claims == NULL)
 	{
-		putErrmsg("Can't start list of reception claims.", NULL);
+		putErrmsg("Can't merge reception claims.", NULL);
+		if (oldClaims)
+		{
+			MRELEASE(oldClaims);
+		}
+
+		if (claims)
+		{
+			MRELEASE(claims);
+		}
+
 		MRELEASE(newClaims);
 		sdr_cancel_xn(ltpSdr);
 		return -1;
 	}
 
-	for (elt = sdr_list_first(ltpSdr, sessionBuf.claims); elt;
-			elt = nextElt)
+	for (i = 0, elt = sdr_list_first(ltpSdr, sessionBuf.claims); elt;
+			i++, elt = nextElt)
 	{
 		nextElt = sdr_list_next(ltpSdr, elt);
 		claimObj = sdr_list_data(ltpSdr, elt);
-		claim = (LtpReceptionClaim *) MTAKE(sizeof(LtpReceptionClaim));
-		if (claim == NULL || (lyst_insert_last(claims, claim)) == NULL)
-		{
-			putErrmsg("Can't insert reception claim.", NULL);
-			MRELEASE(newClaims);
-			sdr_cancel_xn(ltpSdr);
-			return -1;
-		}
-
-		sdr_read(ltpSdr, (char *) claim, claimObj,
+		sdr_read(ltpSdr, (char *) (oldClaims + i), claimObj,
 				sizeof(LtpReceptionClaim));
 		sdr_free(ltpSdr, claimObj);
 		sdr_list_delete(ltpSdr, elt, NULL, NULL);
 	}
 
-	/*	Now merge the new claims in the array with the old
-	 *	claims in the list.  The final contents of the linked
-	 *	list will be the consolidated claims resulting from
-	 *	merging the old claims from the database with the new
-	 *	claims in the report.					*/
-
-	for (i = 0, newClaim = newClaims; i < claimCount; i++, newClaim++)
-	{
-		newClaimEnd = newClaim->offset + newClaim->length;
-		for (elt2 = lyst_first(claims); elt2; elt2 = nextElt2)
-		{
-			nextElt2 = lyst_next(elt2);
-			claim = (LtpReceptionClaim *) lyst_data(elt2);
-			claimEnd = claim->offset + claim->length;
-			if (claimEnd < newClaim->offset)
-			{
-				/*	This old claim is unaffected
-				 *	by the new claims; it remains
-				 *	in the list.			*/
-
-				continue;
-			}
-
-			if (claim->offset > newClaimEnd)
-			{
-				/*	Must insert new claim into
-				 *	list before this old one.	*/
-
-				break;	/*	Out of old-claims loop.	*/
-			}
-
-			/*	New claim overlaps with this existing
-			 *	claim, so consolidate the existing
-			 *	claim with the new claim (in place,
-			 *	in the array), delete the old claim
-			 *	from the list, and look at the next
-			 *	existing claim.				*/
-
-			if (claim->offset < newClaim->offset)
-			{
-				/*	Start of consolidated claim
-				 *	is earlier than start of new
-				 *	claim.				*/
-
-				newClaim->offset = claim->offset;
-			}
-
-			if (claimEnd > newClaimEnd)
-			{
-				/*	End of consolidated claim
-				 *	is later than end of new
-				 *	claim.				*/
-
-				newClaim->length += (claimEnd - newClaimEnd);
-			}
-
-			MRELEASE(claim);
-			lyst_delete(elt2);
-		}
-
-		/*	newClaim has now been consolidated with all
-		 *	prior claims with which it overlapped, and all
-		 *	of those prior claims have been removed from
-		 *	the list.  Now we can insert the consolidated
-		 *	new claim into the list.			*/
-
-		claim = (LtpReceptionClaim *) MTAKE(sizeof(LtpReceptionClaim));
-		if (claim == NULL)
-		{
-			putErrmsg("Can't create reception claim.", NULL);
-			MRELEASE(newClaims);
-			sdr_cancel_xn(ltpSdr);
-			return -1;
-		}
-
-		claim->offset = newClaim->offset;
-		claim->length = newClaim->length;
-		if (elt2)
-		{
-			if (lyst_insert_before(elt2, claim) == NULL)
-			{
-				putErrmsg("Can't create reception claim.",
-						NULL);
-				MRELEASE(newClaims);
-				sdr_cancel_xn(ltpSdr);
-				return -1;
-			}
-		}
-		else
-		{
-			if (lyst_insert_last(claims, claim) == NULL)
-			{
-				putErrmsg("Can't create reception claim.",
-						NULL);
-				MRELEASE(newClaims);
-				sdr_cancel_xn(ltpSdr);
-				return -1;
-			}
-		}
-	}
+	mergedClaimCount = mergeClaims(oldClaims, oldClaimCount, newClaims,
+			claimCount, claims);
 
-	/*	The claims list now contains the consolidated claims
+	/*	The claims array now contains the consolidated claims
 	 *	for all data reception for this export session.  The
-	 *	array of new claims is no longer needed.		*/
+	 *	old and new claims arrays are no longer needed.		*/
 
+	MRELEASE(oldClaims);
 	MRELEASE(newClaims);
-	elt2 = lyst_first(claims);
-	claim = (LtpReceptionClaim *) lyst_data(elt2);
+	claim = claims;
 
 	/*	If reception of all data in the block is claimed (i.e,
-	 *	there is now only one claim in the list and that claim
+	 *	there is now only one claim in the array and that claim
 	 *	-- the first -- encompasses the entire red part of the
 	 *	block), end the export session.				*/
 
 	if (claim->offset == 0 && claim->length == sessionBuf.redPartLength)
 	{
 		ltpSpanTally(vspan, POS_RPT_RECV, 0);
-		MRELEASE(claim);	/*	(Sole claim in list.)	*/
-		lyst_destroy(claims);
+		MRELEASE(claims);
 		stopExportSession(&sessionBuf);
 		closeExportSession(sessionObj);
 		ltpSpanTally(vspan, EXPORT_COMPLETE, 0);
@@ -5298,21 +5663,9 @@ putErrmsg("Discarding report.", NULL);
 			== MAX_NBR_OF_CHECKPOINTS)
 	{
 		/*	Limit reached, can't retransmit any more.
-		 *	Just destroy the claims list and cancel. 	*/
+		 *	Just destroy the claims array and cancel. 	*/
 
-		while (1)
-		{
-			MRELEASE(claim);
-			elt2 = lyst_next(elt2);
-			if (elt2 == NULL)
-			{
-				break;
-			}
-
-			claim = (LtpReceptionClaim *) lyst_data(elt2);
-		}
-
-		lyst_destroy(claims);
+		MRELEASE(claims);
 		if (cancelSessionBySender(&sessionBuf, sessionObj,
 				LtpRetransmitLimitExceeded))
 		{
@@ -5340,6 +5693,7 @@ putErrmsg("Incomplete reception.  Claims:", utoa(claimCount));
 	if ((extents = lyst_create_using(ltpMemIdx)) == NULL)
 	{
 		putErrmsg("Can't start list of retransmission extents.", NULL);
+		MRELEASE(claims);
 		sdr_cancel_xn(ltpSdr);
 		return -1;
 	}
@@ -5350,7 +5704,7 @@ putErrmsg("Incomplete reception.  Claims:", utoa(claimCount));
 	 *	and adding retransmission extents for the gaps between
 	 *	the claims.						*/
 
-	while (1)
+	for (i = 0; i < mergedClaimCount; i++, claim++)
 	{
 #if LTPDEBUG
 sprintf(buf, "-   offset %u length %u", claim->offset, claim->length);
@@ -5360,6 +5714,7 @@ putErrmsg(buf, itoa(sessionBuf.sessionNbr));
 		if (insertClaim(&sessionBuf, claim) < 0)
 		{
 			putErrmsg("Can't create new reception claim.", NULL);
+			MRELEASE(claims);
 			sdr_cancel_xn(ltpSdr);
 			return -1;
 		}
@@ -5371,6 +5726,7 @@ putErrmsg(buf, itoa(sessionBuf.sessionNbr));
 			{
 				putErrmsg("Can't add retransmission extent.",
 						NULL);
+				MRELEASE(claims);
 				sdr_cancel_xn(ltpSdr);
 				return -1;
 			}
@@ -5381,6 +5737,7 @@ putErrmsg(buf, itoa(sessionBuf.sessionNbr));
 			{
 				putErrmsg("Can't add retransmission extent.",
 						NULL);
+				MRELEASE(claims);
 				sdr_cancel_xn(ltpSdr);
 				return -1;
 			}
@@ -5394,18 +5751,9 @@ putErrmsg(buf, itoa(sessionBuf.sessionNbr));
 				startOfGap = claimEnd;	/*	New gap.*/
 			}
 		}
-
-		MRELEASE(claim);
-		elt2 = lyst_next(elt2);
-		if (elt2 == NULL)
-		{
-			break;
-		}
-
-		claim = (LtpReceptionClaim *) lyst_data(elt2);
 	}
 
-	lyst_destroy(claims);
+	MRELEASE(claims);
 
 	/*	List of retransmission extents is now complete;
 	 *	retransmit data as needed.  				*/
@@ -5421,9 +5769,10 @@ putErrmsg(buf, itoa(sessionBuf.sessionNbr));
 	/*	Finally, destroy retransmission extents list and
 	 *	return.							*/
 
-	for (elt2 = lyst_first(extents); elt2; elt2 = lyst_next(elt2))
+	for (extentElt = lyst_first(extents); extentElt;
+			extentElt = lyst_next(extentElt))
 	{
-		MRELEASE((char *) lyst_data(elt2));
+		MRELEASE((char *) lyst_data(extentElt));
 	}
 
 	lyst_destroy(extents);
@@ -95,6 +95,8 @@ void ltpnm_span_get (unsigned int   engineIdWanted,
     LtpSpanStats    stats;
     Object          elt2;
     ImportSession   isession;
+    LtpVspan      * vspan;
+    PsmAddress      vspanElt;
     
     CHKVOID(engineIdWanted > 0);
     CHKVOID(results);
@@ -125,6 +127,31 @@ void ltpnm_span_get (unsigned int   engineIdWanted,
                 sdr_read(sdr, (char *) & isession, sdr_list_data(sdr, elt2), sizeof(ImportSession));
 		results->currentInboundSegments += sdr_list_length(sdr, isession.redSegments);
 	    }
+
+            /* Export session window: the current flow control limit
+               and how much of it is in use. */
+
+            results->maxExportSessionWindow  = span.maxExportWindow;
+            results->exportSessionWindow     = span.maxExportSessions;
+            results->peakExportSessions      = 0;
+            results->exportWindowUtilization = 0;
+            results->measuredXmitRate        = 0;
+            results->measuredRoundTripTime   = 0;
+            findSpan(span.engineId, &vspan, &vspanElt);
+            if (vspanElt)
+            {
+                results->exportSessionWindow   = vspan->exportWindow;
+                results->peakExportSessions    = vspan->peakExportSessions;
+                results->measuredXmitRate      = vspan->measuredXmitRate;
+                results->measuredRoundTripTime = vspan->measuredRtt;
+            }
+
+            if (results->exportSessionWindow > 0)
+            {
+                results->exportWindowUtilization =
+                    (results->currentExportSessions * 100)
+                    / results->exportSessionWindow;
+            }
         
             sdr_exit_xn(sdr);
 
@@ -189,6 +216,8 @@ void ltpnm_span_reset (unsigned int engineIdWanted, int * success)
     LtpSpanStats    stats;
     Tally         * tally;
     int             tallyLoop;
+    LtpVspan      * vspan;
+    PsmAddress      vspanElt;
 
     CHKVOID(engineIdWanted > 0);
     CHKVOID(success);
@@ -212,6 +241,12 @@ void ltpnm_span_reset (unsigned int engineIdWanted, int * success)
             }
 
             sdr_write(sdr, span.stats, (char *) & stats, sizeof(LtpSpanStats));
+            findSpan(span.engineId, &vspan, &vspanElt);
+            if (vspanElt)
+            {
+                vspan->peakExportSessions = 0;
+            }
+
             if (sdr_end_xn(sdr) != 0)
 	    {
                 putErrmsg("ltpnm_span_reset: sdr_end_xn failed", NULL);
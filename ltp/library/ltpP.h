@@ -36,6 +36,16 @@ extern "C" {
 #define MAX_CLAIMS_PER_RS	20
 #define	MAX_TIMEOUTS		2
 
+/*	To keep a highly fragmented reception from being reported in
+ *	a storm of report segments, the receiver may omit claims for
+ *	small received extents -- i.e., report some received data as
+ *	missing -- provided the total length of the omitted extents
+ *	doesn't exceed 1/LTP_OVERREPORT_DIVISOR of the report's scope.	*/
+
+#ifndef LTP_OVERREPORT_DIVISOR
+#define	LTP_OVERREPORT_DIVISOR	16
+#endif
+
 /*	LTP segment structure definitions.				*/
 
 typedef struct
@@ -298,6 +308,7 @@ typedef struct
 	int		purge;		/*	Boolean.		*/
 	Object		lsoCmd;		/*	For starting the LSO.	*/
 	unsigned int	maxExportSessions;
+	unsigned int	maxExportWindow;/*	0 = no auto-tuning.	*/
 	unsigned int	maxImportSessions;
 	unsigned int	aggrSizeLimit;	/*	Bytes.			*/
 	unsigned int	aggrTimeLimit;	/*	Seconds.		*/
@@ -373,6 +384,24 @@ typedef struct
 	PsmAddress	importSessions;	/*	RBT of VImportSessions	*/
 	PsmAddress	avblIdxRbts;	/*	SmList of empty RBTs	*/
 
+	/*	The exportWindow of an LtpVspan is the number of
+	 *	export sessions that may concurrently be active on
+	 *	the span, i.e., the LTP flow control window.  When
+	 *	the span's maxExportWindow is zero, the window is
+	 *	simply the span's maxExportSessions.  Otherwise the
+	 *	window is recomputed once per second by ltpclock
+	 *	(see ltpAdjustExportWindow) from the measured rate
+	 *	of segment transmission and the measured round-trip
+	 *	time, so that the number of sessions in flight
+	 *	tracks the bandwidth-delay product of the span.	*/
+
+	unsigned int	exportWindow;	/*	Current session limit.	*/
+	unsigned int	xmitBytesSampled;/*	Since last adjustment.	*/
+	unsigned int	measuredXmitRate;/*	Bytes per second.	*/
+	unsigned int	measuredRtt;	/*	In seconds.		*/
+	int		exportWindowFull;/*	Boolean: sender blocked.*/
+	unsigned int	peakExportSessions;
+
 	/*	For detecting miscolored segments.			*/
 
 	unsigned int	greenSessionNbr;
@@ -543,8 +572,12 @@ extern int		updateSpan(uvast engineId,
 				unsigned int aggrSizeLimit,
 				unsigned int aggrTimeLimit,
 				char *lsoCmd, unsigned int qTime, int purge);
+extern int		updateSpanWindow(uvast engineId,
+				unsigned int maxExportWindow);
 extern int		removeSpan(uvast engineId);
 extern void		checkReservationLimit();
+extern void		ltpAdjustExportWindow(LtpSpan *span,
+				LtpVspan *vspan);
 
 extern int		ltpStartSpan(uvast engineId);
 extern void		ltpStopSpan(uvast engineId);
@@ -26,6 +26,13 @@ typedef struct
     unsigned long       currentImportSessions;
     unsigned long       currentInboundSegments;
 
+    unsigned long       exportSessionWindow;
+    unsigned long       maxExportSessionWindow;   /* 0 = not auto-tuned */
+    unsigned long       peakExportSessions;
+    unsigned long       exportWindowUtilization;  /* percent */
+    unsigned long       measuredXmitRate;         /* bytes per second */
+    unsigned long       measuredRoundTripTime;    /* seconds */
+
     time_t              lastResetTime;
 
     unsigned long       outputSegQueuedCount;
@@ -0,0 +1,35 @@
+/*
+	loopbacklsa.c:	shared-memory ring attachment functions
+			for the loopback link service adapters.
+
+	Copyright (c) 2026, California Institute of Technology.
+	ALL RIGHTS RESERVED.  U.S. Government Sponsorship
+	acknowledged.
+									*/
+#include "loopbacklsa.h"
+
+int	loopbackAttachRing(uvast engineId, LoopbackRing **ring, int *ringId)
+{
+	int	key = LOOPBACKLSA_KEY_BASE + (int) (engineId & 0xffff);
+	char	*mem = NULL;
+
+	CHKERR(ring);
+	CHKERR(ringId);
+	if (sm_ShmAttach(key, sizeof(LoopbackRing) + LOOPBACKLSA_RINGSZ,
+			&mem, ringId) < 0)
+	{
+		putErrmsg("Can't attach to loopback ring.", utoa(key));
+		return -1;
+	}
+
+	*ring = (LoopbackRing *) mem;
+	return 0;
+}
+
+void	loopbackDetachRing(LoopbackRing *ring)
+{
+	if (ring)
+	{
+		sm_ShmDetach((char *) ring);
+	}
+}
@@ -0,0 +1,72 @@
+/*
+ 	loopbacklsa.h:	common definitions for loopback link service
+			adapter modules, which convey LTP segments
+			between LTP engines on the same host through
+			ring buffers in shared memory, with no network
+			stack involved.
+
+	Copyright (c) 2026, California Institute of Technology.
+	ALL RIGHTS RESERVED.  U.S. Government Sponsorship
+	acknowledged.
+ 									*/
+#ifndef _LOOPBACKLSA_H_
+#define _LOOPBACKLSA_H_
+
+#include "ltpP.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*	Each engine's loopbacklsi owns one inbound ring, identified
+ *	by a shared-memory key computed from the engine number; every
+ *	loopbacklso whose span's remote engine is that engine writes
+ *	segments into that ring.  So engine numbers of engines that
+ *	exchange segments by loopback must differ modulo 65536.	*/
+
+#define	LOOPBACKLSA_KEY_BASE	(0x4c4f0000)
+#define	LOOPBACKLSA_RINGSZ	(4 * 1024 * 1024)
+#define	LOOPBACKLSA_BUFSZ	((256 * 256) - 1)
+#define	LOOPBACKLSA_MAGIC	(0x4c425249)
+
+#define	LOOPBACKLSA_WRAP	(-1)
+
+typedef struct
+{
+	int		length;		/*	LOOPBACKLSA_WRAP or len	*/
+	int		reordered;	/*	Boolean.		*/
+	struct timeval	deliveryTime;
+} LoopbackSegHeader;
+
+/*	Records in the ring are padded to 8-byte boundaries.  The
+ *	segment bytes immediately follow the LoopbackSegHeader.	*/
+
+#define	LOOPBACKLSA_RECLEN(segLen)	((sizeof(LoopbackSegHeader) \
+	+ (segLen) + 7) & ~7)
+
+typedef struct
+{
+	int		magic;		/*	Ring is initialized.	*/
+	int		capacity;	/*	Bytes in data area.	*/
+	int		head;		/*	Offset of oldest record.*/
+	int		tail;		/*	Offset for next record.	*/
+	int		used;		/*	Bytes, incl. wrap waste.*/
+	int		lsiRunning;	/*	Boolean.		*/
+	int		lsiWaiting;	/*	Boolean.		*/
+	int		lsosWaiting;	/*	Count.			*/
+	sm_SemId	mutex;
+	sm_SemId	dataReady;
+	sm_SemId	spaceFree;
+} LoopbackRing;
+
+#define	LOOPBACKLSA_DATA(ring)	(((char *) (ring)) + sizeof(LoopbackRing))
+
+extern int	loopbackAttachRing(uvast engineId, LoopbackRing **ring,
+			int *ringId);
+extern void	loopbackDetachRing(LoopbackRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _LOOPBACKLSA_H */
@@ -0,0 +1,367 @@
+/*
+	loopbacklsi.c:	LTP loopback link service input daemon.
+			Receives segments from the local engine's
+			inbound ring in shared memory, into which
+			they are written by the loopbacklso daemons
+			of other LTP engines on the same host.
+
+	Copyright (c) 2026, California Institute of Technology.
+	ALL RIGHTS RESERVED.  U.S. Government Sponsorship
+	acknowledged.
+									*/
+#include "loopbacklsa.h"
+
+static LoopbackRing	*_ring(LoopbackRing **newRing)
+{
+	static LoopbackRing	*ring = NULL;
+
+	if (newRing)
+	{
+		ring = *newRing;
+	}
+
+	return ring;
+}
+
+static void	interruptThread()
+{
+	LoopbackRing	*ring = _ring(NULL);
+
+	isignal(SIGTERM, interruptThread);
+	if (ring)
+	{
+		sm_SemEnd(ring->dataReady);
+	}
+}
+
+static int	initializeRing(LoopbackRing *ring)
+{
+	if (ring->magic != LOOPBACKLSA_MAGIC)
+	{
+		ring->mutex = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
+		ring->dataReady = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
+		ring->spaceFree = sm_SemCreate(SM_NO_KEY, SM_SEM_FIFO);
+		if (ring->mutex == SM_SEM_NONE
+		|| ring->dataReady == SM_SEM_NONE
+		|| ring->spaceFree == SM_SEM_NONE)
+		{
+			putErrmsg("Can't create loopback ring semaphores.",
+					NULL);
+			return -1;
+		}
+
+		sm_SemTake(ring->dataReady);	/*	Lock.		*/
+		sm_SemTake(ring->spaceFree);	/*	Lock.		*/
+		ring->capacity = LOOPBACKLSA_RINGSZ;
+		ring->lsiWaiting = 0;
+		ring->lsosWaiting = 0;
+		ring->magic = LOOPBACKLSA_MAGIC;
+	}
+	else
+	{
+		/*	Ring left over from a prior loopbacklsi; any
+		 *	segments still in it are discarded.		*/
+
+		sm_SemUnend(ring->dataReady);
+		if (sm_SemTake(ring->mutex) < 0)
+		{
+			putErrmsg("Can't lock loopback ring.", NULL);
+			return -1;
+		}
+	}
+
+	ring->head = 0;
+	ring->tail = 0;
+	ring->used = 0;
+	ring->lsiRunning = 1;
+	sm_SemGive(ring->mutex);
+	return 0;
+}
+
+static int	waitUntilDue(struct timeval *deliveryTime)
+{
+	struct timeval	currentTime;
+	long		usecs;
+
+	if (deliveryTime->tv_sec == 0)
+	{
+		return 0;	/*	No simulated delay.		*/
+	}
+
+	getCurrentTime(&currentTime);
+	usecs = ((deliveryTime->tv_sec - currentTime.tv_sec) * 1000000)
+			+ (deliveryTime->tv_usec - currentTime.tv_usec);
+	if (usecs > 0)
+	{
+		microsnooze(usecs);
+	}
+
+	return 0;
+}
+
+static int	releaseSpace(LoopbackRing *ring, int newHead, int consumed)
+{
+	if (sm_SemTake(ring->mutex) < 0)
+	{
+		putErrmsg("Can't lock loopback ring.", NULL);
+		return -1;
+	}
+
+	ring->head = newHead;
+	ring->used -= consumed;
+	if (ring->lsosWaiting > 0)
+	{
+		sm_SemGive(ring->spaceFree);
+	}
+
+	sm_SemGive(ring->mutex);
+	return 0;
+}
+
+#if defined (VXWORKS) || defined (RTEMS) || defined (bionic)
+int	loopbacklsi(int a1, int a2, int a3, int a4, int a5,
+		int a6, int a7, int a8, int a9, int a10)
+{
+#else
+int	main(int argc, char *argv[])
+{
+#endif
+	LtpVdb			*vdb;
+	LoopbackRing		*ring;
+	int			ringId;
+	char			*data;
+	LoopbackSegHeader	*header;
+	char			*heldSegment;
+	int			heldLength = 0;
+	int			available;
+	int			consumed;
+	int			offset;
+	int			recLength;
+	unsigned long		segmentsReceived = 0;
+	int			running = 1;
+
+	/*	Note that ltpadmin must be run before the first
+	 *	invocation of ltplsi, to initialize the LTP database
+	 *	(as necessary) and dynamic database.			*/
+
+	if (ltpInit(0) < 0)
+	{
+		putErrmsg("loopbacklsi can't initialize LTP.", NULL);
+		return 1;
+	}
+
+	vdb = getLtpVdb();
+	if (vdb->lsiPid != ERROR && vdb->lsiPid != sm_TaskIdSelf())
+	{
+		putErrmsg("LSI task is already started.", itoa(vdb->lsiPid));
+		return 1;
+	}
+
+	if (loopbackAttachRing(vdb->ownEngineId, &ring, &ringId) < 0
+	|| initializeRing(ring) < 0)
+	{
+		putErrmsg("loopbacklsi can't initialize inbound ring.", NULL);
+		return 1;
+	}
+
+	heldSegment = MTAKE(LOOPBACKLSA_BUFSZ);
+	if (heldSegment == NULL)
+	{
+		loopbackDetachRing(ring);
+		putErrmsg("loopbacklsi can't get reordering buffer.", NULL);
+		return 1;
+	}
+
+	data = LOOPBACKLSA_DATA(ring);
+
+	/*	Set up signal handling; SIGTERM is shutdown signal.	*/
+
+	oK(_ring(&ring));
+	isignal(SIGTERM, interruptThread);
+	{
+		char	txt[500];
+
+		isprintf(txt, sizeof(txt),
+			"[i] loopbacklsi is running, engine " UVAST_FIELDSPEC
+			", ring key %u.", vdb->ownEngineId, LOOPBACKLSA_KEY_BASE
+			+ (unsigned int) (vdb->ownEngineId & 0xffff));
+		writeMemo(txt);
+	}
+
+	/*	Can now start receiving segments.  On failure, take
+	 *	down the LSI.						*/
+
+	while (running)
+	{
+		if (sm_SemEnded(ring->dataReady))
+		{
+			running = 0;		/*	Normal stop.	*/
+			continue;
+		}
+
+		if (sm_SemTake(ring->mutex) < 0)
+		{
+			putErrmsg("Can't lock loopback ring.", NULL);
+			running = 0;
+			continue;
+		}
+
+		available = ring->used;
+		offset = ring->head;
+		if (available == 0)
+		{
+			if (heldLength > 0)
+			{
+				/*	Nothing arrived after the held
+				 *	segment; deliver it now.	*/
+
+				sm_SemGive(ring->mutex);
+				if (ltpHandleInboundSegment(heldSegment,
+						heldLength) < 0)
+				{
+					putErrmsg("Can't handle inbound \
+segment.", NULL);
+					running = 0;
+				}
+
+				heldLength = 0;
+				continue;
+			}
+
+			ring->lsiWaiting = 1;
+			sm_SemGive(ring->mutex);
+			if (sm_SemTake(ring->dataReady) < 0)
+			{
+				putErrmsg("Can't wait for loopback data.",
+						NULL);
+				running = 0;
+				continue;
+			}
+
+			if (sm_SemEnded(ring->dataReady))
+			{
+				running = 0;	/*	Normal stop.	*/
+			}
+
+			continue;
+		}
+
+		sm_SemGive(ring->mutex);
+
+		/*	Records between head and head + available are
+		 *	ours alone until we release them, so they are
+		 *	handled directly from shared memory without
+		 *	holding the ring's mutex.			*/
+
+		consumed = 0;
+		while (consumed < available && running)
+		{
+			header = (LoopbackSegHeader *) (data + offset);
+			if (header->length == LOOPBACKLSA_WRAP)
+			{
+				consumed += ring->capacity - offset;
+				offset = 0;
+				continue;
+			}
+
+			recLength = LOOPBACKLSA_RECLEN(header->length);
+			oK(waitUntilDue(&header->deliveryTime));
+			if (header->reordered && heldLength == 0)
+			{
+				/*	Hold this segment back until
+				 *	the next one is delivered.	*/
+
+				memcpy(heldSegment, (char *) (header + 1),
+						header->length);
+				heldLength = header->length;
+			}
+			else
+			{
+				if (ltpHandleInboundSegment((char *)
+						(header + 1),
+						header->length) < 0)
+				{
+					putErrmsg("Can't handle inbound \
+segment.", NULL);
+					running = 0;
+					continue;
+				}
+
+				segmentsReceived++;
+				if (heldLength > 0)
+				{
+					if (ltpHandleInboundSegment(
+						heldSegment, heldLength) < 0)
+					{
+						putErrmsg("Can't handle \
+inbound segment.", NULL);
+						running = 0;
+						continue;
+					}
+
+					segmentsReceived++;
+					heldLength = 0;
+				}
+			}
+
+			consumed += recLength;
+			offset += recLength;
+			if (offset == ring->capacity)
+			{
+				offset = 0;
+			}
+
+			/*	Release space in large batches only,
+			 *	to minimize locking of the ring.	*/
+
+			if (consumed >= (ring->capacity >> 2))
+			{
+				if (releaseSpace(ring, offset, consumed) < 0)
+				{
+					running = 0;
+					continue;
+				}
+
+				available -= consumed;
+				consumed = 0;
+			}
+		}
+
+		if (consumed > 0)
+		{
+			if (releaseSpace(ring, offset, consumed) < 0)
+			{
+				running = 0;
+			}
+		}
+
+		/*	Make sure other tasks have a chance to run.	*/
+
+		sm_TaskYield();
+	}
+
+	/*	Time to shut down.  Wake up any LSOs waiting for
+	 *	space, so that they start discarding segments.		*/
+
+	if (sm_SemTake(ring->mutex) == 0)
+	{
+		ring->lsiRunning = 0;
+		sm_SemGive(ring->spaceFree);
+		sm_SemGive(ring->mutex);
+	}
+
+	MRELEASE(heldSegment);
+	loopbackDetachRing(ring);
+	{
+		char	txt[500];
+
+		isprintf(txt, sizeof(txt),
+			"[i] loopbacklsi has ended; %lu segments received.",
+			segmentsReceived);
+		writeMemo(txt);
+	}
+
+	writeErrmsgMemos();
+	ionDetach();
+	return 0;
+}
@@ -0,0 +1,401 @@
+/*
+	loopbacklso.c:	LTP loopback link service output daemon.
+			Dedicated to transmission of segments to a
+			single remote LTP engine on the same host, by
+			writing them into the inbound ring in shared
+			memory that is read by that engine's
+			loopbacklsi.  Optionally simulates segment
+			loss, reordering, propagation delay, and a
+			limited transmission rate.
+
+	Copyright (c) 2026, California Institute of Technology.
+	ALL RIGHTS RESERVED.  U.S. Government Sponsorship
+	acknowledged.
+									*/
+#include "loopbacklsa.h"
+
+typedef struct
+{
+	double		lossPct;
+	double		reorderPct;
+	unsigned int	delayMsec;
+	unsigned int	txbps;
+	unsigned long	segmentsSent;
+	unsigned long	segmentsLost;
+	unsigned long	segmentsReordered;
+	unsigned long	segmentsDiscarded;
+} LinkProfile;
+
+static sm_SemId		loopbacklsoSemaphore(sm_SemId *semid)
+{
+	static sm_SemId	semaphore = -1;
+
+	if (semid)
+	{
+		semaphore = *semid;
+	}
+
+	return semaphore;
+}
+
+static LoopbackRing	*_ring(LoopbackRing **newRing)
+{
+	static LoopbackRing	*ring = NULL;
+
+	if (newRing)
+	{
+		ring = *newRing;
+	}
+
+	return ring;
+}
+
+static void	shutDownLso()	/*	Commands LSO termination.	*/
+{
+	LoopbackRing	*ring = _ring(NULL);
+
+	sm_SemEnd(loopbacklsoSemaphore(NULL));
+	if (ring && ring->magic == LOOPBACKLSA_MAGIC)
+	{
+		sm_SemGive(ring->spaceFree);
+	}
+}
+
+static int	chance(double pct)
+{
+	if (pct <= 0.0)
+	{
+		return 0;
+	}
+
+	return ((rand() % 10000) < (int) (pct * 100.0));
+}
+
+static int	sendSegmentByLoopback(LoopbackRing *ring, char *segment,
+			int length, LinkProfile *profile)
+{
+	int			recLength = LOOPBACKLSA_RECLEN(length);
+	char			*data = LOOPBACKLSA_DATA(ring);
+	int			waiting = 0;
+	int			wrapWaste;
+	LoopbackSegHeader	*header;
+
+	while (1)
+	{
+		if (ring->magic != LOOPBACKLSA_MAGIC)
+		{
+			profile->segmentsDiscarded++;
+			return 0;	/*	No LSI yet; discard.	*/
+		}
+
+		if (sm_SemTake(ring->mutex) < 0)
+		{
+			putErrmsg("Can't lock loopback ring.", NULL);
+			return -1;
+		}
+
+		if (waiting)
+		{
+			ring->lsosWaiting--;
+			waiting = 0;
+		}
+
+		if (!ring->lsiRunning
+		|| sm_SemEnded(loopbacklsoSemaphore(NULL)))
+		{
+			sm_SemGive(ring->mutex);
+			profile->segmentsDiscarded++;
+			return 0;	/*	Receiver is down.	*/
+		}
+
+		if (ring->tail + recLength > ring->capacity)
+		{
+			wrapWaste = ring->capacity - ring->tail;
+		}
+		else
+		{
+			wrapWaste = 0;
+		}
+
+		if (ring->used + wrapWaste + recLength <= ring->capacity)
+		{
+			break;		/*	Room for the segment.	*/
+		}
+
+		/*	Ring is full; wait for the LSI to consume
+		 *	some segments.					*/
+
+		ring->lsosWaiting++;
+		waiting = 1;
+		sm_SemGive(ring->mutex);
+		if (sm_SemTake(ring->spaceFree) < 0)
+		{
+			putErrmsg("Can't wait for loopback ring space.", NULL);
+			return -1;
+		}
+	}
+
+	/*	Ring is locked and there is room for the segment.	*/
+
+	if (wrapWaste > 0)
+	{
+		header = (LoopbackSegHeader *) (data + ring->tail);
+		header->length = LOOPBACKLSA_WRAP;
+		ring->used += wrapWaste;
+		ring->tail = 0;
+	}
+
+	header = (LoopbackSegHeader *) (data + ring->tail);
+	header->length = length;
+	header->reordered = chance(profile->reorderPct);
+	if (header->reordered)
+	{
+		profile->segmentsReordered++;
+	}
+
+	if (profile->delayMsec > 0)
+	{
+		getCurrentTime(&header->deliveryTime);
+		header->deliveryTime.tv_usec += (profile->delayMsec % 1000)
+				* 1000;
+		header->deliveryTime.tv_sec += (profile->delayMsec / 1000)
+				+ (header->deliveryTime.tv_usec / 1000000);
+		header->deliveryTime.tv_usec %= 1000000;
+	}
+	else
+	{
+		header->deliveryTime.tv_sec = 0;
+		header->deliveryTime.tv_usec = 0;
+	}
+
+	memcpy((char *) (header + 1), segment, length);
+	ring->tail += recLength;
+	if (ring->tail == ring->capacity)
+	{
+		ring->tail = 0;
+	}
+
+	ring->used += recLength;
+	if (ring->lsiWaiting)
+	{
+		ring->lsiWaiting = 0;
+		sm_SemGive(ring->dataReady);
+	}
+
+	sm_SemGive(ring->mutex);
+	profile->segmentsSent++;
+	return length;
+}
+
+static int	run_loopbacklso(int argc, char **argv)
+{
+	uvast		remoteEngineId = 0;
+	LinkProfile	profile;
+	Sdr		sdr;
+	LtpVspan	*vspan;
+	PsmAddress	vspanElt;
+	LoopbackRing	*ring;
+	int		ringId;
+	int		segmentLength;
+	char		*segment;
+	int		running = 1;
+	float		sleepSecPerBit = 0;
+	float		sleep_secs;
+	unsigned int	usecs;
+
+	memset((char *) &profile, 0, sizeof(LinkProfile));
+	if (argc > 1 && argc <= 6)
+	{
+		/*	Remote engine ID is always the last argument,
+		 *	as appended by LTP when the LSO is started.
+		 *	With too many arguments there's no telling
+		 *	which one LTP appended, so none is taken.	*/
+
+		remoteEngineId = strtouvast(argv[argc - 1]);
+	}
+
+	switch (argc)
+	{
+	case 6:
+		profile.txbps = strtoul(argv[4], NULL, 0);
+
+	case 5:
+		profile.delayMsec = strtoul(argv[3], NULL, 0);
+
+	case 4:
+		profile.reorderPct = atof(argv[2]);
+
+	case 3:
+		profile.lossPct = atof(argv[1]);
+
+	default:
+		break;
+	}
+
+	if (remoteEngineId == 0)
+	{
+		PUTS("Usage: loopbacklso [<loss %> [<reorder %> [<delay msec> \
+[<txbps (0=unlimited)>]]]] <remote engine ID>");
+		return 0;
+	}
+
+	/*	Note that ltpadmin must be run before the first
+	 *	invocation of ltplso, to initialize the LTP database
+	 *	(as necessary) and dynamic database.			*/
+
+	if (ltpInit(0) < 0)
+	{
+		putErrmsg("loopbacklso can't initialize LTP.", NULL);
+		return 1;
+	}
+
+	sdr = getIonsdr();
+	CHKZERO(sdr_begin_xn(sdr));	/*	Just to lock memory.	*/
+	findSpan(remoteEngineId, &vspan, &vspanElt);
+	if (vspanElt == 0)
+	{
+		sdr_exit_xn(sdr);
+		putErrmsg("No such engine in database.", itoa(remoteEngineId));
+		return 1;
+	}
+
+	if (vspan->lsoPid != ERROR && vspan->lsoPid != sm_TaskIdSelf())
+	{
+		sdr_exit_xn(sdr);
+		putErrmsg("LSO task is already started for this span.",
+				itoa(vspan->lsoPid));
+		return 1;
+	}
+
+	sdr_exit_xn(sdr);
+
+	/*	All command-line arguments are now validated.  Attach
+	 *	to the remote engine's inbound ring; the remote
+	 *	engine's loopbacklsi initializes it, possibly later.	*/
+
+	if (loopbackAttachRing(remoteEngineId, &ring, &ringId) < 0)
+	{
+		putErrmsg("loopbacklso can't attach to remote ring.", NULL);
+		return 1;
+	}
+
+	/*	Set up signal handling.  SIGTERM is shutdown signal.	*/
+
+	oK(loopbacklsoSemaphore(&(vspan->segSemaphore)));
+	oK(_ring(&ring));
+	signal(SIGTERM, shutDownLso);
+	srand(time(NULL));
+
+	/*	Can now begin transmitting to remote engine.		*/
+
+	{
+		char	memoBuf[1024];
+
+		isprintf(memoBuf, sizeof(memoBuf),
+			"[i] loopbacklso is running, rengine=" UVAST_FIELDSPEC
+			", loss=%.2f%%, reorder=%.2f%%, delay=%u ms, txbps=%u \
+(0=unlimited).", remoteEngineId, profile.lossPct, profile.reorderPct,
+			profile.delayMsec, profile.txbps);
+		writeMemo(memoBuf);
+	}
+
+	if (profile.txbps)
+	{
+		sleepSecPerBit = 1.0 / profile.txbps;
+	}
+
+	while (running && !(sm_SemEnded(vspan->segSemaphore)))
+	{
+		segmentLength = ltpDequeueOutboundSegment(vspan, &segment);
+		if (segmentLength < 0)
+		{
+			running = 0;	/*	Terminate LSO.		*/
+			continue;
+		}
+
+		if (segmentLength == 0)		/*	Interrupted.	*/
+		{
+			continue;
+		}
+
+		if (segmentLength > LOOPBACKLSA_BUFSZ)
+		{
+			putErrmsg("Segment is too big for loopback LSO.",
+					itoa(segmentLength));
+			running = 0;	/*	Terminate LSO.		*/
+			continue;
+		}
+
+		if (chance(profile.lossPct))
+		{
+			profile.segmentsLost++;
+		}
+		else
+		{
+			if (sendSegmentByLoopback(ring, segment, segmentLength,
+					&profile) < 0)
+			{
+				running = 0;	/*	Terminate LSO.	*/
+				continue;
+			}
+		}
+
+		if (profile.txbps)
+		{
+			sleep_secs = sleepSecPerBit * (segmentLength * 8);
+			usecs = sleep_secs * 1000000.0;
+			if (usecs == 0)
+			{
+				usecs = 1;
+			}
+
+			microsnooze(usecs);
+		}
+
+		/*	Make sure other tasks have a chance to run.	*/
+
+		sm_TaskYield();
+	}
+
+	loopbackDetachRing(ring);
+	{
+		char	memoBuf[1024];
+
+		isprintf(memoBuf, sizeof(memoBuf),
+			"[i] loopbacklso has ended; segments sent %lu, lost \
+%lu, reordered %lu, discarded %lu.", profile.segmentsSent,
+			profile.segmentsLost, profile.segmentsReordered,
+			profile.segmentsDiscarded);
+		writeMemo(memoBuf);
+	}
+
+	writeErrmsgMemos();
+	return 0;
+}
+
+#if defined (VXWORKS) || defined (RTEMS) || defined (bionic)
+int	loopbacklso(int a1, int a2, int a3, int a4, int a5,
+		int a6, int a7, int a8, int a9, int a10)
+{
+	char	*argv[6];
+	int	argc;
+
+	argv[0] = "loopbacklso";
+	argv[1] = (char *) a1;
+	argv[2] = (char *) a2;
+	argv[3] = (char *) a3;
+	argv[4] = (char *) a4;
+	argv[5] = (char *) a5;
+	for (argc = 1; argc < 6 && argv[argc] != NULL; argc++)
+	{
+		;
+	}
+
+	return run_loopbacklso(argc, argv);
+}
+#else
+int	main(int argc, char *argv[])
+{
+	return run_loopbacklso(argc, argv);
+}
+#endif
@@ -0,0 +1,484 @@
+/*
+	ltpbench.c:	sender for LTP engine benchmark test.  Like
+			ltpdriver, but keeps a bounded number of
+			service data units in flight and, as each
+			export session completes, measures the time
+			from submission to completion; at the end of
+			the run it reports segment and block rates,
+			host CPU consumed per byte, and percentiles
+			of SDU completion latency.  Intended for use
+			over the loopback LSA, so that the cost of the
+			LTP engine itself can be measured apart from
+			that of the network.
+
+	Copyright (c) 2026, California Institute of Technology.
+	ALL RIGHTS RESERVED.  U.S. Government Sponsorship
+	acknowledged.
+									*/
+#include "platform.h"
+#include "zco.h"
+#include "ltpP.h"
+
+#define	DEFAULT_ADU_LENGTH	(60000)
+#define	DEFAULT_SDUS_IN_FLIGHT	(64)
+
+typedef struct
+{
+	Object		zco;
+	struct timeval	startTime;
+	int		done;		/*	Boolean.		*/
+} SduRecord;
+
+static int	_running(int *newState)
+{
+	static int	state = 1;
+
+	if (newState)
+	{
+		state = *newState;
+	}
+
+	return state;
+}
+
+static int	_clientId(int *newId)
+{
+	static int	id = 0;
+
+	if (newId)
+	{
+		id = *newId;
+	}
+
+	return id;
+}
+
+static void	handleQuit()
+{
+	int	stop = 0;
+
+	oK(_running(&stop));
+	ltp_interrupt(_clientId(NULL));
+}
+
+static unsigned long	getSegmentsSent(uvast destEngineId)
+{
+	Sdr		sdr = getIonsdr();
+	LtpVspan	*vspan;
+	PsmAddress	vspanElt;
+	LtpSpanStats	stats;
+
+	CHKZERO(sdr_begin_xn(sdr));
+	findSpan(destEngineId, &vspan, &vspanElt);
+	if (vspanElt == 0 || vspan->stats == 0)
+	{
+		sdr_exit_xn(sdr);
+		return 0;
+	}
+
+	sdr_read(sdr, (char *) &stats, vspan->stats, sizeof(LtpSpanStats));
+	sdr_exit_xn(sdr);
+	return stats.tallies[OUT_SEG_POPPED].totalCount;
+}
+
+static int	getHostCpuTicks(unsigned long *ticks)
+{
+#if defined (linux)
+	FILE		*statFile;
+	unsigned long	user, nice, system, idle, iowait, irq, softirq;
+
+	/*	Busy time of all CPUs, in clock ticks.  This includes
+	 *	the receiving engine's daemons as well as the local
+	 *	engine's, which is the point when testing over the
+	 *	loopback LSA.						*/
+
+	statFile = fopen("/proc/stat", "r");
+	if (statFile == NULL)
+	{
+		return 0;
+	}
+
+	if (fscanf(statFile, "cpu %lu %lu %lu %lu %lu %lu %lu", &user, &nice,
+			&system, &idle, &iowait, &irq, &softirq) != 7)
+	{
+		fclose(statFile);
+		return 0;
+	}
+
+	fclose(statFile);
+	*ticks = user + nice + system + irq + softirq;
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+static long	elapsedUsec(struct timeval *from, struct timeval *to)
+{
+	return ((to->tv_sec - from->tv_sec) * 1000000)
+			+ (to->tv_usec - from->tv_usec);
+}
+
+static int	compareLatencies(const void *a, const void *b)
+{
+	long	latency1 = *((long *) a);
+	long	latency2 = *((long *) b);
+
+	if (latency1 == latency2)
+	{
+		return 0;
+	}
+
+	return (latency1 < latency2) ? -1 : 1;
+}
+
+static void	printPercentile(char *label, long *latencies, int count,
+			int pct)
+{
+	int	idx = ((count * pct) + 99) / 100 - 1;
+
+	if (idx < 0)
+	{
+		idx = 0;
+	}
+
+	PUTMEMO(label, itoa(latencies[idx]));
+}
+
+static void	printResults(int sduLength, int sdusCompleted,
+			int sdusCanceled, int blocksCompleted,
+			unsigned long segmentsSent, long interval,
+			unsigned long cpuTicks, int cpuTicksKnown,
+			long *latencies)
+{
+	double	seconds = interval / 1000000.0;
+	double	bytes = ((double) sduLength) * sdusCompleted;
+	char	buffer[128];
+
+	PUTMEMO("Data size (bytes)", itoa(sduLength));
+	PUTMEMO("SDUs completed", itoa(sdusCompleted));
+	PUTMEMO("SDUs canceled", itoa(sdusCanceled));
+	PUTMEMO("Blocks completed", itoa(blocksCompleted));
+	isprintf(buffer, sizeof buffer, "%lu", segmentsSent);
+	PUTMEMO("Segments sent", buffer);
+	isprintf(buffer, sizeof buffer, "%.3f", seconds);
+	PUTMEMO("Time (seconds)", buffer);
+	if (interval <= 0 || sdusCompleted == 0)
+	{
+		PUTS("Interval is too short to measure rates.");
+		return;
+	}
+
+	isprintf(buffer, sizeof buffer, "%.0f", bytes / seconds);
+	PUTMEMO("Throughput (bytes per second)", buffer);
+	isprintf(buffer, sizeof buffer, "%.0f", segmentsSent / seconds);
+	PUTMEMO("Segments per second", buffer);
+	isprintf(buffer, sizeof buffer, "%.1f", blocksCompleted / seconds);
+	PUTMEMO("Blocks per second", buffer);
+	if (cpuTicksKnown)
+	{
+		isprintf(buffer, sizeof buffer, "%.2f", (cpuTicks
+				* (1000000000.0 / sysconf(_SC_CLK_TCK)))
+				/ bytes);
+		PUTMEMO("Host CPU (nsec per byte)", buffer);
+	}
+
+	qsort((char *) latencies, sdusCompleted, sizeof(long),
+			compareLatencies);
+	printPercentile("Latency p50 (usec)", latencies, sdusCompleted, 50);
+	printPercentile("Latency p90 (usec)", latencies, sdusCompleted, 90);
+	printPercentile("Latency p99 (usec)", latencies, sdusCompleted, 99);
+	printPercentile("Latency max (usec)", latencies, sdusCompleted, 100);
+}
+
+static int	run_ltpbench(uvast destEngineId, int clientId, int cycles,
+			int sduLength, int maxInFlight)
+{
+	static char	buffer[DEFAULT_ADU_LENGTH] = "test...";
+	Sdr		sdr;
+	int		aduFile;
+	int		bytesRemaining;
+	int		bytesToWrite;
+	Object		fileRef;
+	SduRecord	*sdus;
+	long		*latencies;
+	int		sdusSent = 0;
+	int		sdusCompleted = 0;
+	int		sdusCanceled = 0;
+	int		oldestPending = 0;
+	int		blocksCompleted = 0;
+	unsigned int	lastSessionNbr = 0;
+	unsigned long	segmentsAtStart;
+	unsigned long	cpuAtStart = 0;
+	unsigned long	cpuAtEnd = 0;
+	int		cpuTicksKnown;
+	struct timeval	startTime;
+	struct timeval	endTime;
+	struct timeval	now;
+	Object		zco;
+	LtpSessionId	sessionId;
+	LtpNoticeType	type;
+	unsigned char	reasonCode;
+	unsigned char	endOfBlock;
+	unsigned int	dataOffset;
+	unsigned int	dataLength;
+	Object		data;
+	int		i;
+
+	if (destEngineId == 0 || clientId < 1 || cycles < 1 || sduLength < 1
+	|| maxInFlight < 1)
+	{
+		PUTS("Usage: ltpbench <destination engine ID> <client ID> \
+<number of cycles> [<payload size> [<max SDUs in flight>]]");
+		PUTS("  Payload size defaults to 60000 bytes.");
+		PUTS("  Max SDUs in flight defaults to 64.");
+		PUTS("");
+		PUTS("  Expected destination (receiving) application is");
+		PUTS("  ltpcounter.");
+		return 0;
+	}
+
+	if (ltp_attach() < 0)
+	{
+		putErrmsg("ltpbench can't initialize LTP.", NULL);
+		return 1;
+	}
+
+	if (ltp_open(clientId) < 0)
+	{
+		putErrmsg("ltpbench can't open client access.", itoa(clientId));
+		return 1;
+	}
+
+	oK(_clientId(&clientId));
+	sdus = (SduRecord *) calloc(cycles, sizeof(SduRecord));
+	latencies = (long *) calloc(cycles, sizeof(long));
+	if (sdus == NULL || latencies == NULL)
+	{
+		putErrmsg("ltpbench can't allocate SDU records.", itoa(cycles));
+		return 1;
+	}
+
+	sdr = getIonsdr();
+	aduFile = iopen("ltpbenchSduFile", O_WRONLY | O_CREAT, 0666);
+	if (aduFile < 0)
+	{
+		putSysErrmsg("Can't create ADU file", NULL);
+		return 1;
+	}
+
+	bytesRemaining = sduLength;
+	while (bytesRemaining > 0)
+	{
+		if (bytesRemaining < DEFAULT_ADU_LENGTH)
+		{
+			bytesToWrite = bytesRemaining;
+		}
+		else
+		{
+			bytesToWrite = DEFAULT_ADU_LENGTH;
+		}
+
+		if (write(aduFile, buffer, bytesToWrite) < 0)
+		{
+			close(aduFile);
+			putSysErrmsg("Error writing to ADU file", NULL);
+			return 1;
+		}
+
+		bytesRemaining -= bytesToWrite;
+	}
+
+	close(aduFile);
+	CHKZERO(sdr_begin_xn(sdr));
+	fileRef = zco_create_file_ref(sdr, "ltpbenchSduFile", NULL);
+	if (sdr_end_xn(sdr) < 0 || fileRef == 0)
+	{
+		putErrmsg("ltpbench can't create file ref.", NULL);
+		return 1;
+	}
+
+	isignal(SIGINT, handleQuit);
+	segmentsAtStart = getSegmentsSent(destEngineId);
+	cpuTicksKnown = getHostCpuTicks(&cpuAtStart);
+	getCurrentTime(&startTime);
+	while (_running(NULL) && sdusCompleted + sdusCanceled < cycles)
+	{
+		/*	Keep the pipeline full.				*/
+
+		while (_running(NULL) && sdusSent < cycles
+		&& sdusSent - (sdusCompleted + sdusCanceled) < maxInFlight)
+		{
+			zco = ionCreateZco(ZcoFileSource, fileRef, 0,
+					sduLength, NULL);
+			if (zco == 0)
+			{
+				putErrmsg("ltpbench can't create ZCO.", NULL);
+				handleQuit();
+				continue;
+			}
+
+			sdus[sdusSent].zco = zco;
+			getCurrentTime(&(sdus[sdusSent].startTime));
+			switch (ltp_send(destEngineId, clientId, zco,
+					sduLength, &sessionId))
+			{
+			case 0:
+				putErrmsg("ltpbench can't send SDU.",
+						itoa(sduLength));
+				sdus[sdusSent].done = 1;
+				sdusCanceled++;
+				break;		/*	Out of switch.	*/
+
+			case -1:
+				putErrmsg("ltp_send failed.", NULL);
+				handleQuit();
+				continue;
+			}
+
+			sdusSent++;
+		}
+
+		/*	Collect a completion notice.			*/
+
+		if (ltp_get_notice(clientId, &type, &sessionId, &reasonCode,
+				&endOfBlock, &dataOffset, &dataLength, &data)
+				< 0)
+		{
+			putErrmsg("Can't get LTP notice.", NULL);
+			handleQuit();
+			continue;
+		}
+
+		switch (type)
+		{
+		case LtpExportSessionComplete:
+		case LtpExportSessionCanceled:
+			getCurrentTime(&now);
+			if (sessionId.sessionNbr != lastSessionNbr)
+			{
+				lastSessionNbr = sessionId.sessionNbr;
+				if (type == LtpExportSessionComplete)
+				{
+					blocksCompleted++;
+				}
+			}
+
+			/*	Completions arrive nearly in order,
+			 *	so the search for the matching SDU
+			 *	is short.				*/
+
+			for (i = oldestPending; i < sdusSent; i++)
+			{
+				if (!sdus[i].done && sdus[i].zco == data)
+				{
+					break;
+				}
+			}
+
+			if (i < sdusSent)
+			{
+				sdus[i].done = 1;
+				if (type == LtpExportSessionComplete)
+				{
+					latencies[sdusCompleted] = elapsedUsec(
+						&(sdus[i].startTime), &now);
+					sdusCompleted++;
+				}
+				else
+				{
+					sdusCanceled++;
+				}
+			}
+
+			while (oldestPending < sdusSent
+			&& sdus[oldestPending].done)
+			{
+				oldestPending++;
+			}
+
+			if (data)
+			{
+				ltp_release_data(data);
+			}
+
+			break;
+
+		case LtpRecvRedPart:
+		case LtpRecvGreenSegment:
+			ltp_release_data(data);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	getCurrentTime(&endTime);
+	if (cpuTicksKnown)
+	{
+		cpuTicksKnown = getHostCpuTicks(&cpuAtEnd);
+	}
+
+	writeErrmsgMemos();
+	printResults(sduLength, sdusCompleted, sdusCanceled, blocksCompleted,
+			getSegmentsSent(destEngineId) - segmentsAtStart,
+			elapsedUsec(&startTime, &endTime),
+			cpuAtEnd - cpuAtStart, cpuTicksKnown, latencies);
+	free(sdus);
+	free(latencies);
+	CHKZERO(sdr_begin_xn(sdr));
+	zco_destroy_file_ref(sdr, fileRef);
+	if (sdr_end_xn(sdr) < 0)
+	{
+		putErrmsg("ltpbench can't destroy file reference.", NULL);
+	}
+
+	ltp_close(clientId);
+	ltp_detach();
+	return 0;
+}
+
+#if defined (VXWORKS) || defined (RTEMS)
+int	ltpbench(int a1, int a2, int a3, int a4, int a5,
+		int a6, int a7, int a8, int a9, int a10)
+{
+	uvast		destEngineId = (uvast) a1;
+	int		clientId = a2;
+	int		cycles = a3;
+	int		aduLen = (a4 == 0 ? DEFAULT_ADU_LENGTH : a4);
+	int		maxInFlight = (a5 == 0 ? DEFAULT_SDUS_IN_FLIGHT : a5);
+#else
+int	main(int argc, char **argv)
+{
+	uvast		destEngineId = 0;
+	int		clientId = 0;
+	int		cycles = 0;
+	int		aduLen = DEFAULT_ADU_LENGTH;
+	int		maxInFlight = DEFAULT_SDUS_IN_FLIGHT;
+
+	if (argc > 6) argc = 6;
+	switch (argc)
+	{
+	case 6:
+		maxInFlight = strtol(argv[5], NULL, 0);
+
+	case 5:
+	  	aduLen = strtol(argv[4], NULL, 0);
+
+	case 4:
+	  	cycles = strtol(argv[3], NULL, 0);
+
+	case 3:
+		clientId = strtol(argv[2], NULL, 0);
+
+	case 2:
+		destEngineId = strtouvast(argv[1]);
+
+	default:
+		break;
+	}
+#endif
+	return run_ltpbench(destEngineId, clientId, cycles, aduLen,
+			maxInFlight);
+}
@@ -83,6 +83,9 @@ See man(5) for ltprc.");
 	PUTS("\tm\tManage");
 	PUTS("\t   m screening { y | n }");
 	PUTS("\t   m ownqtime <own queuing latency, in seconds>");
+	PUTS("\t   m window <engine ID#> <max export session window>");
+	PUTS("\t\tA window of zero disables auto-tuning of the span's \
+export session window.");
 	PUTS("\ts\tStart");
 	PUTS("\t   s '<LSI command>'");
 	PUTS("\tx\tStop");
@@ -319,6 +322,18 @@ static void	printSpan(LtpVspan *vspan)
 	isprintf(buffer, sizeof buffer, "\tmax export sessions: %u",
 			span->maxExportSessions);
 	printText(buffer);
+	if (span->maxExportWindow > 0)
+	{
+		isprintf(buffer, sizeof buffer, "\texport session window: %u  \
+max window: %u  peak sessions: %u", vspan->exportWindow,
+				span->maxExportWindow,
+				vspan->peakExportSessions);
+		printText(buffer);
+		isprintf(buffer, sizeof buffer, "\tmeasured xmit rate: %u  \
+measured round trip: %u", vspan->measuredXmitRate, vspan->measuredRtt);
+		printText(buffer);
+	}
+
 	isprintf(buffer, sizeof buffer, "\tmax import sessions: %u",
 			span->maxImportSessions);
 	printText(buffer);
@@ -499,6 +514,31 @@ static void	manageOwnqtime(int tokenCount, char **tokens)
 	}
 }
 
+static void	manageWindow(int tokenCount, char **tokens)
+{
+	uvast	engineId;
+	int	maxExportWindow;
+
+	if (tokenCount != 4)
+	{
+		SYNTAX_ERROR;
+		return;
+	}
+
+	engineId = strtouvast(tokens[2]);
+	maxExportWindow = strtol(tokens[3], NULL, 0);
+	if (maxExportWindow < 0)
+	{
+		putErrmsg("Max export session window invalid.", tokens[3]);
+		return;
+	}
+
+	if (updateSpanWindow(engineId, maxExportWindow) < 0)
+	{
+		putErrmsg("Can't change export session window.", NULL);
+	}
+}
+
 static void	executeManage(int tokenCount, char **tokens)
 {
 	if (tokenCount < 2)
@@ -519,6 +559,12 @@ static void	executeManage(int tokenCount, char **tokens)
 		return;
 	}
 
+	if (strcmp(tokens[1], "window") == 0)
+	{
+		manageWindow(tokenCount, tokens);
+		return;
+	}
+
 	SYNTAX_ERROR;
 }
 
@@ -806,6 +852,7 @@ command.");
 			if (attachToLtp() == 0)
 			{
 				executeManage(tokenCount, tokens);
+				*checkNeeded = 1;
 			}
 
 			return 0;
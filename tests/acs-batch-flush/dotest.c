@@ -0,0 +1,282 @@
+/*
+
+	acs-batch-flush/dotest.c:	ACS batched flush test.
+
+	Notes custody signals for a custodian on the loopback node
+	as offerNoteAcs does, and verifies that all of the
+	custodian's pending aggregate custody signals are sent
+	together by the custodian's acsDelay timer, that a signal
+	reaching the custodian's acsSize is sent on its own, and
+	that a custody ID that would make a signal exceed acsSize
+	starts a new signal instead.  The ACS bundles are received
+	by the custodian endpoint and decoded to check that every
+	custody ID noted was signaled and that no ACS exceeded
+	acsSize.
+
+									*/
+
+#include "check.h"
+#include "testutil.h"
+#include "acsP.h"
+
+#define	ACS_SIZE	(40)
+#define	ACS_DELAY	(2)
+#define	MAX_ID		(1000)
+
+static char	custodianEid[] = "ipn:1.2";
+static Sdr	acsSdr;
+static Sdr	bpSdr;
+
+/*	The custody signal noting procedure of offerNoteAcs.		*/
+
+static void	noteCustodyId(unsigned int id, int succeeded,
+			BpCtReason reasonCode)
+{
+	Object			pendingCustAddr;
+	SdrAcsPendingCust	pendingCust;
+	CtebScratchpad		cteb;
+
+	cteb.id = id;
+	fail_unless(sdr_begin_xn(bpSdr));
+	fail_unless(sdr_begin_xn(acsSdr));
+	pendingCustAddr = getOrMakeCustodianByEid(getPendingCustodians(),
+			custodianEid);
+	fail_unless(pendingCustAddr != 0);
+	sdr_peek(acsSdr, pendingCust, pendingCustAddr);
+	fail_unless(appendToSdrAcsSignals(pendingCust.signals, pendingCustAddr,
+			reasonCode, succeeded, &cteb) == 0);
+	fail_unless(trySendAcs(pendingCustAddr) == 0);
+	fail_unless(sdr_end_xn(acsSdr) >= 0);
+	fail_unless(sdr_end_xn(bpSdr) >= 0);
+}
+
+static unsigned long	pendingLength(int succeeded, BpCtReason reasonCode)
+{
+	Object			pendingCustAddr;
+	SdrAcsPendingCust	pendingCust;
+	Object			signalAddr;
+	SdrAcsSignal		signal;
+
+	fail_unless(sdr_begin_xn(acsSdr));
+	pendingCustAddr = findCustodianByEid(getPendingCustodians(),
+			custodianEid);
+	fail_unless(pendingCustAddr != 0);
+	sdr_peek(acsSdr, pendingCust, pendingCustAddr);
+	signal.serializedLength = 0;
+	if (findSdrAcsSignal(pendingCust.signals, reasonCode, succeeded,
+			&signalAddr))
+	{
+		sdr_peek(acsSdr, signal, signalAddr);
+	}
+
+	sdr_exit_xn(acsSdr);
+	return signal.serializedLength;
+}
+
+static long	pendingSignals(Object *acsDue)
+{
+	Object			pendingCustAddr;
+	SdrAcsPendingCust	pendingCust;
+	long			count;
+
+	fail_unless(sdr_begin_xn(acsSdr));
+	pendingCustAddr = findCustodianByEid(getPendingCustodians(),
+			custodianEid);
+	fail_unless(pendingCustAddr != 0);
+	sdr_peek(acsSdr, pendingCust, pendingCustAddr);
+	count = sdr_list_length(acsSdr, pendingCust.signals);
+	*acsDue = pendingCust.acsDue;
+	sdr_exit_xn(acsSdr);
+	return count;
+}
+
+/*	Receives one ACS bundle and marks the custody IDs it signals.	*/
+
+static int	receiveAcs(BpSAP sap, int timeout, unsigned char *signaled)
+{
+	BpDelivery	dlv;
+	ZcoReader	reader;
+	unsigned char	buffer[256];
+	unsigned char	*cursor;
+	int		length;
+	uvast		delta;
+	uvast		fillLength;
+	uvast		lastFill = 0;
+	uvast		id;
+	int		sdnvLength;
+
+	/*	A reception interrupted by a stale semaphore give is
+	 *	simply retried.						*/
+
+	do
+	{
+		fail_unless(bp_receive(sap, &dlv, timeout) >= 0);
+	} while (dlv.result == BpReceptionInterrupted);
+
+	if (dlv.result != BpPayloadPresent)
+	{
+		return 0;
+	}
+
+	fail_unless(dlv.adminRecord);
+	fail_unless(sdr_begin_xn(bpSdr));
+	length = zco_source_data_length(bpSdr, dlv.adu);
+	fail_unless(length > 2 && length <= ACS_SIZE);
+	zco_start_receiving(dlv.adu, &reader);
+	fail_unless(zco_receive_source(bpSdr, &reader, length,
+			(char *) buffer) == length);
+	fail_unless(sdr_end_xn(bpSdr) >= 0);
+	bp_release_delivery(&dlv, 1);
+	fail_unless(buffer[0] >> 4 == BP_AGGREGATE_CUSTODY_SIGNAL);
+	for (cursor = buffer + 2; cursor < buffer + length; )
+	{
+		sdnvLength = decodeSdnv(&delta, cursor);
+		fail_unless(sdnvLength > 0);
+		cursor += sdnvLength;
+		sdnvLength = decodeSdnv(&fillLength, cursor);
+		fail_unless(sdnvLength > 0);
+		cursor += sdnvLength;
+		for (id = lastFill + delta; id < lastFill + delta + fillLength;
+				id++)
+		{
+			fail_unless(id < MAX_ID && signaled[id] == 0);
+			signaled[id] = buffer[1];
+		}
+
+		lastFill += delta + fillLength - 1;
+	}
+
+	fail_unless(cursor == buffer + length);
+	return 1;
+}
+
+int	main(int argc, char **argv)
+{
+	BpSAP		sap;
+	unsigned char	signaled[MAX_ID];
+	unsigned char	sack = 0x80;
+	Object		acsDue;
+	Object		pendingCustAddr;
+	unsigned long	length;
+	time_t		noted;
+	int		ids = 0;
+	int		bundles = 0;
+	unsigned int	id;
+
+	ionstart_default_config("loopback-ltp/loopback.ionrc", NULL,
+			"loopback-ltp/loopback.ltprc",
+			"loopback-ltp/loopback.bprc",
+			"loopback-ltp/loopback.ipnrc", NULL);
+	fail_unless(bp_attach() >= 0);
+	fail_unless(acsInitialize(0, 0) == 0);
+	fail_unless(acsAttach() == 0);
+	acsSdr = getAcssdr();
+	bpSdr = bp_get_sdr();
+	fail_unless(bp_open(custodianEid, &sap) >= 0);
+	fail_unless(updateCustodianAcsSize(custodianEid, ACS_SIZE) == 0);
+	fail_unless(updateCustodianAcsDelay(custodianEid, ACS_DELAY) == 0);
+	memset(signaled, 0, sizeof signaled);
+
+	/*	Signals of three kinds share one countdown to a flush.	*/
+
+	noted = time(NULL);
+	for (id = 1; id <= 5; id++, ids++)
+	{
+		noteCustodyId(id, 1, 0);
+	}
+
+	noteCustodyId(10, 0, CtDepletedStorage);
+	noteCustodyId(20, 0, CtNoKnownRoute);
+	ids += 2;
+	fail_unless(pendingSignals(&acsDue) == 3);
+	fail_unless(acsDue != 0);
+	fail_unless(receiveAcs(sap, ACS_DELAY + 10, signaled) == 1);
+	fail_unless(time(NULL) >= noted + ACS_DELAY - 1);
+	fail_unless(pendingSignals(&acsDue) == 0);
+	fail_unless(acsDue == 0);
+	fail_unless(receiveAcs(sap, 5, signaled) == 1);
+	fail_unless(receiveAcs(sap, 5, signaled) == 1);
+	bundles += 3;
+	for (id = 1; id <= 5; id++)
+	{
+		fail_unless(signaled[id] == sack);
+	}
+
+	fail_unless(signaled[10] == CtDepletedStorage);
+	fail_unless(signaled[20] == CtNoKnownRoute);
+
+	/*	A signal growing to acsSize is sent on its own, well
+	 *	before acsDelay elapses; the custodian's other signal
+	 *	waits.  Each custody ID below adds a 2-byte fill to a
+	 *	payload that starts at 4 bytes.				*/
+
+	fail_unless(updateCustodianAcsDelay(custodianEid, 60) == 0);
+	noteCustodyId(500, 0, CtNoKnownRoute);
+	ids++;
+	for (id = 100; ; id += 2)
+	{
+		noteCustodyId(id, 1, 0);
+		ids++;
+		if (pendingSignals(&acsDue) == 1)
+		{
+			break;
+		}
+	}
+
+	fail_unless((id - 100) / 2 + 1 == (ACS_SIZE - 4) / 2 + 1);
+	fail_unless(acsDue != 0);
+	fail_unless(receiveAcs(sap, 5, signaled) == 1);
+	bundles++;
+	for (id = 100; id <= 100 + 2 * ((ACS_SIZE - 4) / 2); id += 2)
+	{
+		fail_unless(signaled[id] == sack);
+	}
+
+	fail_unless(signaled[500] == 0);
+
+	/*	Custody IDs from 200 on are 2-byte deltas, so the first
+	 *	fill is 3 bytes and the signal's length stays odd.  The
+	 *	ID that would take it past acsSize is left out of the
+	 *	signal that is sent and starts a new one.		*/
+
+	for (id = 200; ; id += 2)
+	{
+		length = pendingLength(1, 0);
+		noteCustodyId(id, 1, 0);
+		ids++;
+		if (pendingLength(1, 0) < length)
+		{
+			break;
+		}
+	}
+
+	fail_unless(length == ACS_SIZE - 1);
+	fail_unless(pendingSignals(&acsDue) == 2);
+	fail_unless(receiveAcs(sap, 5, signaled) == 1);
+	bundles++;
+	fail_unless(signaled[id - 2] == sack);
+	fail_unless(signaled[id] == 0);
+
+	/*	The rest go out together when the custodian is flushed.	*/
+
+	fail_unless(sdr_begin_xn(acsSdr));
+	pendingCustAddr = findCustodianByEid(getPendingCustodians(),
+			custodianEid);
+	sdr_exit_xn(acsSdr);
+	fail_unless(flushAcs(pendingCustAddr) == 0);
+	fail_unless(pendingSignals(&acsDue) == 0);
+	fail_unless(receiveAcs(sap, 5, signaled) == 1);
+	fail_unless(receiveAcs(sap, 5, signaled) == 1);
+	bundles += 2;
+	fail_unless(signaled[500] == CtNoKnownRoute);
+	fail_unless(signaled[id] == sack);
+
+	printf("Custody IDs noted: %d, ACS bundles received: %d\n", ids,
+			bundles);
+
+	bp_close(sap);
+	writeErrmsgMemos();
+	bp_detach();
+	ionstop();
+	CHECK_FINISH;
+}
@@ -0,0 +1,356 @@
+/*
+
+	acs-fill-index/dotest.c:	ACS fill index test.
+
+	Verifies that custody IDs appended to an aggregate custody
+	signal through the fill index yield exactly the fills, and
+	the serialized ACS, that a walk of the list of fills yields.
+	Then reports the time taken to append shuffled custody IDs
+	both ways, and to append 1M shuffled custody IDs through the
+	index.
+
+									*/
+
+#include "check.h"
+#include "testutil.h"
+#include "acsP.h"
+
+#define	ACS_HEAPWORDS	(4000000)
+#define	CHECK_IDS	(20000)
+#define	REF_BENCH_IDS	(10000)
+#define	BENCH_IDS	(1000000)
+
+static Sdr	acsSdr;
+static Sdr	bpSdr;
+static Object	custodianAddr;	/*	acsSize 0: no size limit.	*/
+
+/*	The placement procedure that preceded the fill index.		*/
+
+static int	refAppend(Object fills, unsigned int id)
+{
+	Object		elt;
+	Object		nextElt;
+	Object		addr;
+	Object		nextAddr;
+	SdrAcsFill	fill;
+	SdrAcsFill	nextFill;
+	SdrAcsFill	newFill = { id, 1 };
+	unsigned int	until;
+
+	for (elt = sdr_list_first(acsSdr, fills); elt;
+			elt = sdr_list_next(acsSdr, elt))
+	{
+		addr = sdr_list_data(acsSdr, elt);
+		sdr_peek(acsSdr, fill, addr);
+		if (fill.start > id)
+		{
+			if (fill.start == id + 1)
+			{
+				fill.start = id;
+				fill.length++;
+				sdr_poke(acsSdr, addr, fill);
+				return 0;
+			}
+
+			break;
+		}
+
+		until = fill.start + fill.length - 1;
+		if (until >= id)
+		{
+			return -2;
+		}
+
+		nextElt = sdr_list_next(acsSdr, elt);
+		nextAddr = nextElt ? sdr_list_data(acsSdr, nextElt) : 0;
+		if (nextAddr)
+		{
+			sdr_peek(acsSdr, nextFill, nextAddr);
+		}
+
+		if (until + 1 == id)
+		{
+			if (nextAddr && nextFill.start == id + 1)
+			{
+				fill.length += 1 + nextFill.length;
+				sdr_list_delete(acsSdr, nextElt, NULL, NULL);
+				sdr_free(acsSdr, nextAddr);
+			}
+			else
+			{
+				fill.length++;
+			}
+
+			sdr_poke(acsSdr, addr, fill);
+			return 0;
+		}
+
+		if (nextAddr && nextFill.start == id + 1)
+		{
+			nextFill.start = id;
+			nextFill.length++;
+			sdr_poke(acsSdr, nextAddr, nextFill);
+			return 0;
+		}
+
+		if (nextAddr == 0 || nextFill.start > id)
+		{
+			addr = sdr_malloc(acsSdr, sizeof newFill);
+			fail_unless(addr != 0);
+			sdr_poke(acsSdr, addr, newFill);
+			fail_unless(sdr_list_insert_after(acsSdr, elt, addr) != 0);
+			return 0;
+		}
+	}
+
+	addr = sdr_malloc(acsSdr, sizeof newFill);
+	fail_unless(addr != 0);
+	sdr_poke(acsSdr, addr, newFill);
+	fail_unless(sdr_list_insert_first(acsSdr, fills, addr) != 0);
+	return 0;
+}
+
+/*	Both appends run in the transactions that offerNoteAcs uses.	*/
+
+static int	indexedAppend(Object signals, unsigned int id)
+{
+	CtebScratchpad	cteb;
+	int		result;
+
+	cteb.id = id;
+	fail_unless(sdr_begin_xn(bpSdr));
+	fail_unless(sdr_begin_xn(acsSdr));
+	result = appendToSdrAcsSignals(signals, custodianAddr,
+			CtRedundantReception, 1, &cteb);
+	fail_unless(result != -1);
+	fail_unless(sdr_end_xn(acsSdr) >= 0);
+	fail_unless(sdr_end_xn(bpSdr) >= 0);
+	return result;
+}
+
+static int	listAppend(Object fills, unsigned int id)
+{
+	int	result;
+
+	fail_unless(sdr_begin_xn(bpSdr));
+	fail_unless(sdr_begin_xn(acsSdr));
+	result = refAppend(fills, id);
+	fail_unless(sdr_end_xn(acsSdr) >= 0);
+	fail_unless(sdr_end_xn(bpSdr) >= 0);
+	return result;
+}
+
+static Object	signalOf(Object signals)
+{
+	Object	signalAddr;
+
+	fail_unless(sdr_begin_xn(acsSdr));
+	fail_unless(findSdrAcsSignal(signals, CtRedundantReception, 1,
+			&signalAddr) != 0);
+	sdr_exit_xn(acsSdr);
+	return signalAddr;
+}
+
+static Object	refSignal(Object fills, unsigned long serializedLength)
+{
+	SdrAcsSignal	signal;
+	Object		signalAddr;
+
+	memset((char *) &signal, 0, sizeof signal);
+	signal.succeeded = 1;
+	signal.reasonCode = CtRedundantReception;
+	signal.acsFills = fills;
+	signal.serializedLength = serializedLength;
+	fail_unless(sdr_begin_xn(acsSdr));
+	signalAddr = sdr_malloc(acsSdr, sizeof signal);
+	fail_unless(signalAddr != 0);
+	sdr_poke(acsSdr, signalAddr, signal);
+	fail_unless(sdr_end_xn(acsSdr) >= 0);
+	return signalAddr;
+}
+
+static char	*serialize(Object signalAddr, unsigned long *length)
+{
+	Object		zco;
+	ZcoReader	reader;
+	char		*buffer;
+
+	fail_unless(sdr_begin_xn(bpSdr));
+	fail_unless(sdr_begin_xn(acsSdr));
+	*length = serializeAcs(signalAddr, &zco);
+	fail_unless(*length > 0);
+	buffer = malloc(*length);
+	fail_unless(buffer != NULL);
+	zco_start_receiving(zco, &reader);
+	fail_unless(zco_receive_source(bpSdr, &reader, *length, buffer)
+			== *length);
+	zco_destroy(bpSdr, zco);
+	fail_unless(sdr_end_xn(acsSdr) >= 0);
+	fail_unless(sdr_end_xn(bpSdr) >= 0);
+	return buffer;
+}
+
+static unsigned long	compareFills(Object fills, Object refFills)
+{
+	Object		elt;
+	Object		refElt;
+	SdrAcsFill	fill;
+	SdrAcsFill	refFill;
+	unsigned long	count = 0;
+
+	fail_unless(sdr_begin_xn(acsSdr));
+	for (elt = sdr_list_first(acsSdr, fills),
+			refElt = sdr_list_first(acsSdr, refFills);
+			elt && refElt; elt = sdr_list_next(acsSdr, elt),
+			refElt = sdr_list_next(acsSdr, refElt))
+	{
+		sdr_peek(acsSdr, fill, sdr_list_data(acsSdr, elt));
+		sdr_peek(acsSdr, refFill, sdr_list_data(acsSdr, refElt));
+		fail_unless(fill.start == refFill.start);
+		fail_unless(fill.length == refFill.length);
+		count++;
+	}
+
+	fail_unless(elt == 0 && refElt == 0);
+	sdr_exit_xn(acsSdr);
+	return count;
+}
+
+static Object	newList()
+{
+	Object	list;
+
+	fail_unless(sdr_begin_xn(acsSdr));
+	list = sdr_list_create(acsSdr);
+	fail_unless(list != 0);
+	fail_unless(sdr_end_xn(acsSdr) >= 0);
+	return list;
+}
+
+int	main(int argc, char **argv)
+{
+	Object		signals;
+	Object		refFills;
+	SdrAcsSignal	signal;
+	Object		signalAddr;
+	unsigned int	*ids;
+	unsigned int	id;
+	char		*serialized;
+	char		*refSerialized;
+	unsigned long	length;
+	unsigned long	refLength;
+	unsigned long	fillCount;
+	struct timeval	start;
+	long		listUsec;
+	long		indexUsec;
+	int		i;
+
+	srand(44);
+	ionstart("acs.ionrc", NULL, NULL, NULL, NULL, NULL);
+	fail_unless(acsInitialize(ACS_HEAPWORDS, 0) == 0);
+	fail_unless(acsAttach() == 0);
+	acsSdr = getAcssdr();
+	bpSdr = getIonsdr();
+	fail_unless(updateCustodianAcsSize("ipn:1.2", 0) == 0);
+	fail_unless(sdr_begin_xn(acsSdr));
+	custodianAddr = findCustodianByEid(getPendingCustodians(), "ipn:1.2");
+	sdr_exit_xn(acsSdr);
+	fail_unless(custodianAddr != 0);
+	ids = malloc(BENCH_IDS * sizeof(unsigned int));
+	fail_unless(ids != NULL);
+
+	/*	Random custody IDs, with gaps and duplicates, yield the
+	 *	same fills and serialization both ways.			*/
+
+	signals = newList();
+	refFills = newList();
+	for (i = 0; i < CHECK_IDS; i++)
+	{
+		id = rand() % (2 * CHECK_IDS);
+		fail_unless(indexedAppend(signals, id) == listAppend(refFills,
+				id));
+	}
+
+	signalAddr = signalOf(signals);
+	fail_unless(sdr_begin_xn(acsSdr));
+	sdr_peek(acsSdr, signal, signalAddr);
+	sdr_exit_xn(acsSdr);
+	fillCount = compareFills(signal.acsFills, refFills);
+	fail_unless(fillCount > 1);
+	serialized = serialize(signalAddr, &length);
+	fail_unless(length == signal.serializedLength);
+	refSerialized = serialize(refSignal(refFills, length), &refLength);
+	fail_unless(length == refLength);
+	fail_unless(memcmp(serialized, refSerialized, length) == 0);
+	free(serialized);
+	free(refSerialized);
+
+	/*	Time taken to append shuffled custody IDs by walking the
+	 *	list and through the index.				*/
+
+	for (i = 0; i < REF_BENCH_IDS; i++)
+	{
+		ids[i] = i;
+	}
+
+	shuffle(ids, REF_BENCH_IDS);
+	refFills = newList();
+	getCurrentTime(&start);
+	for (i = 0; i < REF_BENCH_IDS; i++)
+	{
+		fail_unless(listAppend(refFills, ids[i]) == 0);
+	}
+
+	listUsec = elapsedUsec(&start);
+	signals = newList();
+	getCurrentTime(&start);
+	for (i = 0; i < REF_BENCH_IDS; i++)
+	{
+		fail_unless(indexedAppend(signals, ids[i]) == 0);
+	}
+
+	indexUsec = elapsedUsec(&start);
+	printf("Shuffled custody IDs: %d\n", REF_BENCH_IDS);
+	printf("usec per append: list walk %.2f, index %.2f\n",
+			((double) listUsec) / REF_BENCH_IDS,
+			((double) indexUsec) / REF_BENCH_IDS);
+
+	/*	1M shuffled custody IDs through the index coalesce into
+	 *	a single fill.						*/
+
+	for (i = 0; i < BENCH_IDS; i++)
+	{
+		ids[i] = i;
+	}
+
+	shuffle(ids, BENCH_IDS);
+	signals = newList();
+	getCurrentTime(&start);
+	for (i = 0; i < BENCH_IDS; i++)
+	{
+		fail_unless(indexedAppend(signals, ids[i]) == 0);
+	}
+
+	indexUsec = elapsedUsec(&start);
+	fail_unless(indexedAppend(signals, ids[0]) == -2);
+	signalAddr = signalOf(signals);
+	fail_unless(sdr_begin_xn(acsSdr));
+	sdr_peek(acsSdr, signal, signalAddr);
+	fail_unless(sdr_list_length(acsSdr, signal.acsFills) == 1);
+	{
+		SdrAcsFill	fill;
+
+		sdr_peek(acsSdr, fill, sdr_list_data(acsSdr,
+				sdr_list_first(acsSdr, signal.acsFills)));
+		fail_unless(fill.start == 0 && fill.length == BENCH_IDS);
+	}
+
+	sdr_exit_xn(acsSdr);
+	printf("Shuffled custody IDs: %d, usec per append: index %.2f\n",
+			BENCH_IDS, ((double) indexUsec) / BENCH_IDS);
+
+	free(ids);
+	writeErrmsgMemos();
+	ionstop();
+	CHECK_FINISH;
+}
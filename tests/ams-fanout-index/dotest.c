@@ -0,0 +1,171 @@
+/*
+
+	ams-fanout-index/dotest.c:	AMS fan-out index test.
+
+	Verifies that module keys distinguish the same module number
+	in different units and stay within MODULE_KEY_LIMIT, so that
+	the bitmap that suppresses duplicate copies of a published
+	message never confuses two modules.  Then indexes the elements
+	of a list under the module key of every module in the message
+	space, growing the index from the empty zero-filled state, and
+	verifies that every key finds its own element, that removed
+	keys are no longer found while the others still are, and that
+	a cleared index is empty again and can be reused.
+
+									*/
+
+#include <platform.h>
+#include "amscommon.h"
+#include "check.h"
+#include "testutil.h"
+
+#define	KEY_COUNT	MODULE_KEY_LIMIT
+
+static void	checkEmpty(AmsIndex *index)
+{
+	int	unitNbr;
+
+	fail_unless(index->bucketCount == 0);
+	fail_unless(index->entryCount == 0);
+	fail_unless(index->buckets == NULL);
+	for (unitNbr = 0; unitNbr <= MAX_UNIT_NBR; unitNbr++)
+	{
+		fail_unless(amsIndexFind(index, MODULE_KEY(unitNbr, 1))
+				== NULL);
+	}
+}
+
+static void	checkModuleKeys()
+{
+	unsigned char	*seen;
+	int		unitNbr;
+	int		moduleNbr;
+	int		key;
+
+	seen = (unsigned char *) calloc(MODULE_KEY_LIMIT, 1);
+	fail_unless(seen != NULL);
+	for (unitNbr = 0; unitNbr <= MAX_UNIT_NBR; unitNbr++)
+	{
+		for (moduleNbr = 0; moduleNbr <= MAX_MODULE_NBR; moduleNbr++)
+		{
+			key = MODULE_KEY(unitNbr, moduleNbr);
+			fail_unless(key >= 0 && key < MODULE_KEY_LIMIT);
+			fail_unless(seen[key] == 0);
+			seen[key] = 1;
+		}
+	}
+
+	free(seen);
+}
+
+/*	Fills the index with one element per module key, in an order
+ *	that interleaves the units, returning the elements by key.	*/
+
+static void	fillIndex(AmsIndex *index, Lyst elements, LystElt *elts)
+{
+	int	unitNbr;
+	int	moduleNbr;
+	int	key;
+	int	bucketCount;
+
+	for (moduleNbr = 0; moduleNbr <= MAX_MODULE_NBR; moduleNbr++)
+	{
+		for (unitNbr = 0; unitNbr <= MAX_UNIT_NBR; unitNbr++)
+		{
+			key = MODULE_KEY(unitNbr, moduleNbr);
+			elts[key] = lyst_insert_last(elements,
+					(void *) ((long) key));
+			fail_unless(elts[key] != NULL);
+			fail_unless(amsIndexInsert(index, key, elts[key])
+					== 0);
+
+			/*	Bucket count is always a power of 2
+			 *	at least as large as the entry count.	*/
+
+			bucketCount = index->bucketCount;
+			fail_unless(bucketCount >= index->entryCount);
+			fail_unless((bucketCount & (bucketCount - 1)) == 0);
+		}
+	}
+
+	fail_unless(index->entryCount == KEY_COUNT);
+}
+
+int	main(int argc, char **argv)
+{
+	AmsIndex	index;
+	Lyst		elements;
+	LystElt		*elts;
+	int		key;
+
+	checkModuleKeys();
+	ionstart_default_config("loopback-ltp/loopback.ionrc", NULL, NULL,
+			NULL, NULL, NULL);
+	fail_unless(ionAttach() >= 0);
+	elements = lyst_create_using(getIonMemoryMgr());
+	fail_unless(elements != NULL);
+	elts = (LystElt *) calloc(KEY_COUNT, sizeof(LystElt));
+	fail_unless(elts != NULL);
+
+	/*	A zero-filled index is empty and valid.			*/
+
+	memset((char *) &index, 0, sizeof index);
+	checkEmpty(&index);
+	amsIndexRemove(&index, MODULE_KEY(1, 1));
+	amsIndexClear(&index);
+	checkEmpty(&index);
+
+	fillIndex(&index, elements, elts);
+	for (key = 0; key < KEY_COUNT; key++)
+	{
+		fail_unless(amsIndexFind(&index, key) == elts[key]);
+		fail_unless((long) lyst_data(elts[key]) == key);
+	}
+
+	fail_unless(amsIndexFind(&index, KEY_COUNT) == NULL);
+	fail_unless(amsIndexFind(&index, -1) == NULL);
+
+	/*	Remove the modules with odd module numbers.		*/
+
+	for (key = 1; key < KEY_COUNT; key += 2)
+	{
+		amsIndexRemove(&index, key);
+	}
+
+	amsIndexRemove(&index, 1);		/*	Already gone.	*/
+	amsIndexRemove(&index, KEY_COUNT);	/*	Never there.	*/
+	fail_unless(index.entryCount == KEY_COUNT / 2);
+	for (key = 0; key < KEY_COUNT; key++)
+	{
+		if (key & 1)
+		{
+			fail_unless(amsIndexFind(&index, key) == NULL);
+		}
+		else
+		{
+			fail_unless(amsIndexFind(&index, key) == elts[key]);
+		}
+	}
+
+	/*	A removed key may be indexed again.			*/
+
+	fail_unless(amsIndexInsert(&index, 1, elts[1]) == 0);
+	fail_unless(amsIndexFind(&index, 1) == elts[1]);
+	fail_unless(index.entryCount == (KEY_COUNT / 2) + 1);
+
+	amsIndexClear(&index);
+	checkEmpty(&index);
+	lyst_clear(elements);
+	fillIndex(&index, elements, elts);
+	for (key = 0; key < KEY_COUNT; key++)
+	{
+		fail_unless(amsIndexFind(&index, key) == elts[key]);
+	}
+
+	amsIndexClear(&index);
+	lyst_destroy(elements);
+	free(elts);
+	ionDetach();
+	ionstop();
+	CHECK_FINISH;
+}
@@ -0,0 +1,325 @@
+/*
+
+	ams-vectored-send/dotest.c:	AMS vectored transport send test.
+
+	Sends messages of several lengths to many recipients at once
+	through the UDP and TCP transport services' sendAmsvFn, each
+	recipient's copy carrying a different first header byte, as
+	ams_publish does for subscribers whose transmission rules
+	differ in priority.  There are more UDP recipients than fit
+	in a single sendmmsg batch, and one UDP recipient to which
+	connectivity has been lost.  Verifies that every reachable
+	recipient receives exactly one copy, with its own header
+	byte, the shared rest of the header and content, and a
+	checksum computed over the whole copy; then sends the same
+	copies one at a time through sendAmsFn and verifies that
+	the results are identical.
+
+									*/
+
+#include <platform.h>
+#include <poll.h>
+#include "amsP.h"
+#include "check.h"
+#include "testutil.h"
+
+#define	LOOPBACK_ADDR	(0x7f000001)
+#define	UDP_RECIPIENTS	(150)		/*	> UDPTS_SENDV_BATCH	*/
+#define	TCP_RECIPIENTS	(8)
+#define	LOST_RECIPIENT	(70)		/*	Lost connectivity.	*/
+#define	HEADER_LENGTH	(16)
+#define	MAX_CONTENT	(8192)
+#define	MAX_WAIT	(5000)		/*	Milliseconds.		*/
+
+extern void	udptsLoadTs(TransSvc *ts);
+extern void	tcptsLoadTs(TransSvc *ts);
+
+static int	contentLengths[] = { 0, 1, 999, MAX_CONTENT };
+
+static TransSvc		udpTs;
+static TransSvc		tcpTs;
+static AmsSAP		*sap;
+
+static int		udpSockets[UDP_RECIPIENTS];
+static AmsEndpoint	udpEndpoints[UDP_RECIPIENTS];
+static AmsRecipient	udpRecipients[UDP_RECIPIENTS];
+static int		tcpListeners[TCP_RECIPIENTS];
+static int		tcpSockets[TCP_RECIPIENTS];
+static AmsEndpoint	tcpEndpoints[TCP_RECIPIENTS];
+static AmsRecipient	tcpRecipients[TCP_RECIPIENTS];
+
+static unsigned short	bindLoopback(int fd)
+{
+	struct sockaddr_in	socketName;
+	socklen_t		nameLength = sizeof socketName;
+
+	memset((char *) &socketName, 0, sizeof socketName);
+	socketName.sin_family = AF_INET;
+	socketName.sin_addr.s_addr = htonl(LOOPBACK_ADDR);
+	fail_unless(bind(fd, (struct sockaddr *) &socketName,
+			sizeof socketName) == 0);
+	fail_unless(getsockname(fd, (struct sockaddr *) &socketName,
+			&nameLength) == 0);
+	return ntohs(socketName.sin_port);
+}
+
+static void	initEndpoint(AmsEndpoint *ep, TransSvc *ts, char *ept)
+{
+	memset((char *) ep, 0, sizeof(AmsEndpoint));
+	ep->ts = ts;
+	ep->ept = strdup(ept);
+	fail_unless(ep->ept != NULL);
+	fail_unless(ts->parseAmsEndpointFn(ep) == 0);
+}
+
+static void	initInterface(AmsInterface *tsif, TransSvc *ts)
+{
+	char	epspec[] = "127.0.0.1";
+
+	tsif->ts = ts;
+	tsif->amsSap = sap;
+	fail_unless(ts->amsInitFn(tsif, epspec) == 0);
+}
+
+/*	Builds the copy of the message that a recipient should get.	*/
+
+static int	expectedMessage(char *buffer, unsigned char headerByte,
+			char *header, char *content, int contentLength)
+{
+	int		length = HEADER_LENGTH + contentLength;
+	unsigned short	checksum;
+
+	memcpy(buffer, header, HEADER_LENGTH);
+	buffer[0] = headerByte;
+	memcpy(buffer + HEADER_LENGTH, content, contentLength);
+	checksum = htons(computeAmsChecksum((unsigned char *) buffer, length));
+	memcpy(buffer + length, (char *) &checksum, 2);
+	return length + 2;
+}
+
+static void	receiveDatagram(int fd, char *expected, int length)
+{
+	char		buffer[HEADER_LENGTH + MAX_CONTENT + 3];
+	struct pollfd	fds;
+	int		received;
+
+	fds.fd = fd;
+	fds.events = POLLIN;
+	fail_unless(poll(&fds, 1, MAX_WAIT) == 1);
+	received = recv(fd, buffer, sizeof buffer, 0);
+	fail_unless(received == length);
+	fail_unless(memcmp(buffer, expected, length) == 0);
+}
+
+static void	receiveSegment(int fd, char *expected, int length)
+{
+	char		buffer[2 + HEADER_LENGTH + MAX_CONTENT + 2];
+	unsigned short	preamble;
+	int		received = 0;
+	int		result;
+
+	while (received < length + 2)
+	{
+		result = recv(fd, buffer + received, (length + 2) - received,
+				0);
+		fail_unless(result > 0);
+		if (result <= 0)
+		{
+			return;
+		}
+
+		received += result;
+	}
+
+	memcpy((char *) &preamble, buffer, 2);
+	fail_unless(ntohs(preamble) == length);
+	fail_unless(memcmp(buffer + 2, expected, length) == 0);
+}
+
+static void	checkNothingMore()
+{
+	struct pollfd	fds;
+	int		i;
+
+	fds.events = POLLIN;
+	for (i = 0; i < UDP_RECIPIENTS; i++)
+	{
+		fds.fd = udpSockets[i];
+		fail_unless(poll(&fds, 1, 0) == 0);
+	}
+
+	for (i = 0; i < TCP_RECIPIENTS; i++)
+	{
+		fds.fd = tcpSockets[i];
+		fail_unless(poll(&fds, 1, 0) == 0);
+	}
+}
+
+static void	sendMessage(int contentLength)
+{
+	char	header[HEADER_LENGTH];
+	char	content[MAX_CONTENT];
+	char	expected[HEADER_LENGTH + MAX_CONTENT + 2];
+	char	single[HEADER_LENGTH];
+	int	length;
+	int	i;
+
+	for (i = 0; i < HEADER_LENGTH; i++)
+	{
+		header[i] = rand();
+	}
+
+	for (i = 0; i < contentLength; i++)
+	{
+		content[i] = rand();
+	}
+
+	for (i = 0; i < UDP_RECIPIENTS; i++)
+	{
+		udpRecipients[i].headerByte = rand();
+	}
+
+	for (i = 0; i < TCP_RECIPIENTS; i++)
+	{
+		tcpRecipients[i].headerByte = rand();
+	}
+
+	fail_unless(udpTs.sendAmsvFn(udpRecipients, UDP_RECIPIENTS, sap,
+			header, HEADER_LENGTH, content, contentLength) == 0);
+	fail_unless(tcpTs.sendAmsvFn(tcpRecipients, TCP_RECIPIENTS, sap,
+			header, HEADER_LENGTH, content, contentLength) == 0);
+
+	/*	The first TCP transmission opens the connections.	*/
+
+	for (i = 0; i < TCP_RECIPIENTS; i++)
+	{
+		if (tcpSockets[i] < 0)
+		{
+			tcpSockets[i] = accept(tcpListeners[i], NULL, NULL);
+			fail_unless(tcpSockets[i] >= 0);
+		}
+	}
+
+	for (i = 0; i < UDP_RECIPIENTS; i++)
+	{
+		if (i == LOST_RECIPIENT)
+		{
+			continue;
+		}
+
+		length = expectedMessage(expected, udpRecipients[i].headerByte,
+				header, content, contentLength);
+		receiveDatagram(udpSockets[i], expected, length);
+	}
+
+	for (i = 0; i < TCP_RECIPIENTS; i++)
+	{
+		length = expectedMessage(expected, tcpRecipients[i].headerByte,
+				header, content, contentLength);
+		receiveSegment(tcpSockets[i], expected, length);
+	}
+
+	checkNothingMore();
+
+	/*	Sending each copy individually gives the same result.	*/
+
+	memcpy(single, header, HEADER_LENGTH);
+	for (i = 0; i < UDP_RECIPIENTS; i++)
+	{
+		if (i == LOST_RECIPIENT)
+		{
+			continue;
+		}
+
+		single[0] = udpRecipients[i].headerByte;
+		fail_unless(udpTs.sendAmsFn(udpEndpoints + i, sap, 0, single,
+				HEADER_LENGTH, content, contentLength) == 0);
+		length = expectedMessage(expected, udpRecipients[i].headerByte,
+				header, content, contentLength);
+		receiveDatagram(udpSockets[i], expected, length);
+	}
+
+	for (i = 0; i < TCP_RECIPIENTS; i++)
+	{
+		single[0] = tcpRecipients[i].headerByte;
+		fail_unless(tcpTs.sendAmsFn(tcpEndpoints + i, sap, 0, single,
+				HEADER_LENGTH, content, contentLength) == 0);
+		length = expectedMessage(expected, tcpRecipients[i].headerByte,
+				header, content, contentLength);
+		receiveSegment(tcpSockets[i], expected, length);
+	}
+
+	checkNothingMore();
+}
+
+int	main(int argc, char **argv)
+{
+	char	ept[32];
+	int	i;
+
+	srand(40);
+	ionstart_default_config("loopback-ltp/loopback.ionrc", NULL, NULL,
+			NULL, NULL, NULL);
+	fail_unless(ionAttach() >= 0);
+	udptsLoadTs(&udpTs);
+	tcptsLoadTs(&tcpTs);
+	sap = (AmsSAP *) calloc(1, sizeof(AmsSAP));
+	fail_unless(sap != NULL);
+	initInterface(sap->amsTsifs, &udpTs);
+	initInterface(sap->amsTsifs + 1, &tcpTs);
+	sap->transportServiceCount = 2;
+
+	for (i = 0; i < UDP_RECIPIENTS; i++)
+	{
+		udpSockets[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		fail_unless(udpSockets[i] >= 0);
+		isprintf(ept, sizeof ept, "127.0.0.1:%hu",
+				bindLoopback(udpSockets[i]));
+		initEndpoint(udpEndpoints + i, &udpTs, ept);
+		udpRecipients[i].endpoint = udpEndpoints + i;
+	}
+
+	udpTs.clearAmsEndpointFn(udpEndpoints + LOST_RECIPIENT);
+	udpEndpoints[LOST_RECIPIENT].tsep = NULL;
+	for (i = 0; i < TCP_RECIPIENTS; i++)
+	{
+		tcpListeners[i] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		fail_unless(tcpListeners[i] >= 0);
+		isprintf(ept, sizeof ept, "%u:%hu", LOOPBACK_ADDR,
+				bindLoopback(tcpListeners[i]));
+		fail_unless(listen(tcpListeners[i], 1) == 0);
+		tcpSockets[i] = -1;
+		initEndpoint(tcpEndpoints + i, &tcpTs, ept);
+		tcpRecipients[i].endpoint = tcpEndpoints + i;
+	}
+
+	for (i = 0; i < sizeof contentLengths / sizeof(int); i++)
+	{
+		sendMessage(contentLengths[i]);
+	}
+
+	for (i = 0; i < UDP_RECIPIENTS; i++)
+	{
+		if (i != LOST_RECIPIENT)
+		{
+			udpTs.clearAmsEndpointFn(udpEndpoints + i);
+		}
+
+		free(udpEndpoints[i].ept);
+		closesocket(udpSockets[i]);
+	}
+
+	for (i = 0; i < TCP_RECIPIENTS; i++)
+	{
+		tcpTs.clearAmsEndpointFn(tcpEndpoints + i);
+		free(tcpEndpoints[i].ept);
+		closesocket(tcpSockets[i]);
+		closesocket(tcpListeners[i]);
+	}
+
+	closesocket((long) (sap->amsTsifs[0].sap));
+	free(sap);
+	ionDetach();
+	ionstop();
+	CHECK_FINISH;
+}
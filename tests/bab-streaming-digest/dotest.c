@@ -0,0 +1,230 @@
+/*
+
+	bab-streaming-digest/dotest.c:	BAB digest streaming test.
+
+	Verifies that a BAB security result computed by a ZCO digest
+	in the course of copying a catenated bundle out for
+	transmission is identical to the result computed by a
+	separate pass over the bundle, and that the digest alters
+	no other bytes of the bundle.  Then reports the throughput
+	of secured-bundle transmission from a multi-megabyte file-
+	backed payload with and without the digest hook.
+
+									*/
+
+#include <bp.h>
+#include "check.h"
+#include "testutil.h"
+#include "extbspbab.h"
+
+#define	PAYLOAD_FILE	"bab-payload.dat"
+#define	PAYLOAD_LENGTH	(8 * 1024 * 1024)
+#define	HEADER_LENGTH	64
+#define	TRAILER_PREFIX	10
+#define	RESULT_LENGTH	(1 + 1 + BAB_HMAC_SHA1_RESULT_LEN)
+#define	TRAILER_LENGTH	(TRAILER_PREFIX + RESULT_LENGTH)
+#define	XMIT_BUFSZ	(64 * 1024)
+#define	BENCH_PASSES	10
+
+static char	key[] = "bab-streaming-digest-test-key";
+
+static Object	createBundleZco(Sdr sdr)
+{
+	char	buffer[XMIT_BUFSZ];
+	char	header[HEADER_LENGTH];
+	char	trailer[TRAILER_LENGTH];
+	int	fd;
+	int	written = 0;
+	int	i;
+	Object	fileRef;
+	Object	zco;
+
+	fd = iopen(PAYLOAD_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	fail_unless(fd >= 0);
+	while (written < PAYLOAD_LENGTH)
+	{
+		for (i = 0; i < sizeof buffer; i++)
+		{
+			buffer[i] = rand();
+		}
+
+		fail_unless(write(fd, buffer, sizeof buffer) == sizeof buffer);
+		written += sizeof buffer;
+	}
+
+	close(fd);
+	for (i = 0; i < HEADER_LENGTH; i++)
+	{
+		header[i] = rand();
+	}
+
+	/*	The trailer is a post-payload BAB whose security
+	 *	result is still zero-filled.				*/
+
+	for (i = 0; i < TRAILER_PREFIX; i++)
+	{
+		trailer[i] = rand();
+	}
+
+	memset(trailer + TRAILER_PREFIX, 0, RESULT_LENGTH);
+	fail_unless(sdr_begin_xn(sdr));
+	fileRef = zco_create_file_ref(sdr, PAYLOAD_FILE, NULL);
+	fail_unless(fileRef != 0);
+	zco = zco_create(sdr, ZcoFileSource, fileRef, 0, PAYLOAD_LENGTH);
+	fail_unless(zco != 0 && zco != (Object) -1);
+	fail_unless(zco_prepend_header(sdr, zco, header, HEADER_LENGTH) == 0);
+	fail_unless(zco_append_trailer(sdr, zco, trailer, TRAILER_LENGTH)
+			== 0);
+	fail_unless(sdr_end_xn(sdr) >= 0);
+	return zco;
+}
+
+/*	Copies the entire bundle out as a CLO would, optionally into
+ *	a single contiguous copy of the bundle.				*/
+
+static void	transmitBundle(Sdr sdr, Object zco, ZcoDigest *digest,
+			char *copy)
+{
+	char		buffer[XMIT_BUFSZ];
+	ZcoReader	reader;
+	vast		bytesRemaining;
+	vast		bytesToLoad;
+	vast		bytesLoaded;
+	vast		offset = 0;
+
+	fail_unless(sdr_begin_xn(sdr));
+	bytesRemaining = zco_length(sdr, zco);
+	zco_start_transmitting(zco, &reader);
+	zco_track_file_offset(&reader);
+	if (digest)
+	{
+		zco_digest_transmission(&reader, digest);
+	}
+
+	sdr_exit_xn(sdr);
+	while (bytesRemaining > 0)
+	{
+		bytesToLoad = bytesRemaining;
+		if (bytesToLoad > XMIT_BUFSZ)
+		{
+			bytesToLoad = XMIT_BUFSZ;
+		}
+
+		fail_unless(sdr_begin_xn(sdr));
+		bytesLoaded = zco_transmit(sdr, &reader, bytesToLoad, buffer);
+		fail_unless(sdr_end_xn(sdr) >= 0);
+		fail_unless(bytesLoaded == bytesToLoad);
+		if (copy)
+		{
+			memcpy(copy + offset, buffer, bytesLoaded);
+		}
+
+		offset += bytesLoaded;
+		bytesRemaining -= bytesLoaded;
+	}
+}
+
+int	main(int argc, char **argv)
+{
+	Sdr		sdr;
+	Object		zco;
+	vast		bundleLength;
+	unsigned int	dataLength;
+	unsigned char	*expected;
+	unsigned int	expectedLength;
+	char		*plain;
+	char		*streamed;
+	ZcoDigest	digest;
+	struct timeval	start;
+	long		separateUsec;
+	long		streamedUsec;
+	int		pass;
+	double		megabytes;
+
+	srand(41);
+	ionstart_default_config("loopback-ltp/loopback.ionrc", NULL, NULL,
+			NULL, NULL, NULL);
+	fail_unless(ionAttach() >= 0);
+	sdr = getIonsdr();
+	zco = createBundleZco(sdr);
+	fail_unless(sdr_begin_xn(sdr));
+	bundleLength = zco_length(sdr, zco);
+	sdr_exit_xn(sdr);
+	fail_unless(bundleLength == HEADER_LENGTH + PAYLOAD_LENGTH
+			+ TRAILER_LENGTH);
+	dataLength = bundleLength - RESULT_LENGTH;
+
+	/*	The security result computed in a separate pass.	*/
+
+	expected = bsp_babGetSecResult(zco, dataLength, key, sizeof key,
+			&expectedLength);
+	fail_unless(expected != NULL);
+	fail_unless(expectedLength == BAB_HMAC_SHA1_RESULT_LEN);
+
+	/*	The security result computed in the transmission pass.	*/
+
+	plain = malloc(bundleLength);
+	streamed = malloc(bundleLength);
+	fail_unless(plain != NULL && streamed != NULL);
+	transmitBundle(sdr, zco, NULL, plain);
+	memset((char *) &digest, 0, sizeof digest);
+	fail_unless(bsp_babStreamSecResult(&digest, dataLength, key,
+			sizeof key, RESULT_LENGTH) == 1);
+	transmitBundle(sdr, zco, &digest, streamed);
+	fail_unless(digest.finished);
+	fail_unless(memcmp(plain, streamed, dataLength) == 0);
+	fail_unless(streamed[dataLength] == BSP_CSPARM_INT_SIG);
+	fail_unless(streamed[dataLength + 1] == BAB_HMAC_SHA1_RESULT_LEN);
+	fail_unless(memcmp(streamed + dataLength + 2, expected,
+			BAB_HMAC_SHA1_RESULT_LEN) == 0);
+
+	/*	Bytes can't be skipped while the digest is pending.	*/
+
+	{
+		ZcoReader	reader;
+
+		fail_unless(sdr_begin_xn(sdr));
+		zco_start_transmitting(zco, &reader);
+		zco_digest_transmission(&reader, &digest);
+		fail_unless(zco_transmit(sdr, &reader, 1, NULL) < 0);
+		sdr_exit_xn(sdr);
+	}
+
+	/*	Throughput with a separate digest pass and without.	*/
+
+	getCurrentTime(&start);
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+	{
+		MRELEASE(expected);
+		expected = bsp_babGetSecResult(zco, dataLength, key,
+				sizeof key, &expectedLength);
+		fail_unless(expected != NULL);
+		transmitBundle(sdr, zco, NULL, NULL);
+	}
+
+	separateUsec = elapsedUsec(&start);
+	getCurrentTime(&start);
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+	{
+		transmitBundle(sdr, zco, &digest, NULL);
+	}
+
+	streamedUsec = elapsedUsec(&start);
+	megabytes = (((double) bundleLength) * BENCH_PASSES) / 1000000.0;
+	printf("Secured bundle: %lu bytes, file-backed, passes: %d\n",
+			(unsigned long) bundleLength, BENCH_PASSES);
+	printf("MB/sec: separate digest pass %.1f, streaming digest %.1f\n",
+			megabytes / (separateUsec / 1000000.0),
+			megabytes / (streamedUsec / 1000000.0));
+
+	MRELEASE(expected);
+	free(plain);
+	free(streamed);
+	fail_unless(sdr_begin_xn(sdr));
+	zco_destroy(sdr, zco);
+	fail_unless(sdr_end_xn(sdr) >= 0);
+	writeErrmsgMemos();
+	ionDetach();
+	ionstop();
+	CHECK_FINISH;
+}
@@ -0,0 +1,276 @@
+/*
+
+	bp-primary-block-cache/dotest.c:	Primary block cache test.
+
+	Dequeues bundles for transmission from an outduct as a CLO
+	does, reporting every transmission as failed so that each
+	bundle is re-forwarded and catenated again.  Verifies that
+	every catenated bundle begins with exactly the primary block
+	that serialization of the bundle's current fields yields,
+	that the serialized block is reused on retransmission, and
+	that it is serialized anew once a field encoded in it has
+	been changed and the block invalidated.  Then reports the
+	time taken per bundle to serialize the primary block and to
+	retrieve the serialized block.
+
+									*/
+
+#include "check.h"
+#include "testutil.h"
+#include "bpP.h"
+
+#define	BUNDLES		(200)
+#define	BENCH_BLOCKS	(1000000)
+#define	ADU_TEXT	"primary block cache test ADU"
+
+static char	sourceEid[] = "ipn:1.1";
+static char	destEid[] = "ipn:2.1";
+static char	protocolName[] = "udp";
+static char	ductName[] = "127.0.0.1:4556";
+
+/*	The primary block serialization procedure that catenateBundle
+ *	performed on every transmission before the serialized block
+ *	was retained, for a bundle whose EIDs are all CBHE-conformant.	*/
+
+static int	refSerialize(Bundle *bundle, unsigned char *buffer)
+{
+	Sdnv		flagsSdnv;
+	Sdnv		lengthSdnv;
+	Sdnv		sdnvs[14];
+	int		sdnvCount = 12;
+	int		residualLength = 0;
+	unsigned char	*cursor = buffer;
+	int		i;
+
+	fail_unless(bundle->dictionaryLength == 0);
+	encodeSdnv(&flagsSdnv, bundle->bundleProcFlags);
+	encodeSdnv(&(sdnvs[0]), bundle->destination.c.nodeNbr);
+	encodeSdnv(&(sdnvs[1]), bundle->destination.c.serviceNbr);
+	encodeSdnv(&(sdnvs[2]), bundle->id.source.c.nodeNbr);
+	encodeSdnv(&(sdnvs[3]), bundle->id.source.c.serviceNbr);
+	encodeSdnv(&(sdnvs[4]), bundle->reportTo.c.nodeNbr);
+	encodeSdnv(&(sdnvs[5]), bundle->reportTo.c.serviceNbr);
+	encodeSdnv(&(sdnvs[6]), bundle->custodian.c.nodeNbr);
+	encodeSdnv(&(sdnvs[7]), bundle->custodian.c.serviceNbr);
+	encodeSdnv(&(sdnvs[8]), bundle->id.creationTime.seconds);
+	encodeSdnv(&(sdnvs[9]), bundle->id.creationTime.count);
+	encodeSdnv(&(sdnvs[10]), bundle->timeToLive);
+	encodeSdnv(&(sdnvs[11]), bundle->dictionaryLength);
+	if (bundle->bundleProcFlags & BDL_IS_FRAGMENT)
+	{
+		encodeSdnv(&(sdnvs[12]), bundle->id.fragmentOffset);
+		encodeSdnv(&(sdnvs[13]), bundle->totalAduLength);
+		sdnvCount = 14;
+	}
+
+	for (i = 0; i < sdnvCount; i++)
+	{
+		residualLength += sdnvs[i].length;
+	}
+
+	encodeSdnv(&lengthSdnv, residualLength);
+	*cursor++ = 6;				/*	Version.	*/
+	memcpy(cursor, flagsSdnv.text, flagsSdnv.length);
+	cursor += flagsSdnv.length;
+	memcpy(cursor, lengthSdnv.text, lengthSdnv.length);
+	cursor += lengthSdnv.length;
+	for (i = 0; i < sdnvCount; i++)
+	{
+		memcpy(cursor, sdnvs[i].text, sdnvs[i].length);
+		cursor += sdnvs[i].length;
+	}
+
+	return cursor - buffer;
+}
+
+static int	bundleIndex(Object *bundleObjs, Object bundleObj)
+{
+	int	i;
+
+	for (i = 0; i < BUNDLES; i++)
+	{
+		if (bundleObjs[i] == bundleObj)
+		{
+			return i;
+		}
+	}
+
+	fail_unless(i < BUNDLES);
+	return -1;
+}
+
+/*	Dequeues and checks one transmission of every bundle.  On the
+ *	first pass, the custodian of every other bundle is changed
+ *	and its primary block invalidated after transmission.  On the
+ *	second pass, the primary block serialized on the first pass
+ *	must be reused for every bundle that was not changed.		*/
+
+static void	transmitAll(VOutduct *vduct, Outflow *flows, Object *bundleObjs,
+			Object *blocks, int pass)
+{
+	Sdr		sdr = getIonsdr();
+	Object		zco;
+	BpExtendedCOS	extendedCOS;
+	char		destDuctName[SDRSTRING_BUFSZ];
+	Object		bundleObj;
+	Bundle		bundle;
+	ZcoReader	reader;
+	unsigned char	expected[128];
+	unsigned char	cached[128];
+	unsigned char	sent[128];
+	int		length;
+	int		idx;
+	int		i;
+
+	for (i = 0; i < BUNDLES; i++)
+	{
+		do
+		{
+			fail_unless(bpDequeue(vduct, flows, &zco,
+					&extendedCOS, destDuctName, 0, -1)
+					>= 0);
+		} while (zco == 0);
+
+		fail_unless(sdr_begin_xn(sdr));
+		fail_unless(retrieveInTransitBundle(zco, &bundleObj) == 0);
+		idx = bundleIndex(bundleObjs, bundleObj);
+		sdr_stage(sdr, (char *) &bundle, bundleObj, sizeof(Bundle));
+		fail_unless(bundle.primaryBlock != 0);
+		length = refSerialize(&bundle, expected);
+		fail_unless(bundle.primaryBlockLength == length);
+		sdr_read(sdr, (char *) cached, bundle.primaryBlock, length);
+		fail_unless(memcmp(cached, expected, length) == 0);
+		zco_start_transmitting(zco, &reader);
+		fail_unless(zco_transmit(sdr, &reader, length, (char *) sent)
+				== length);
+		fail_unless(memcmp(sent, expected, length) == 0);
+		if (pass == 0)
+		{
+			blocks[idx] = bundle.primaryBlock;
+			if (idx % 2)
+			{
+				bundle.custodian.c.nodeNbr = 1;
+				bundle.custodian.c.serviceNbr = 0;
+				invalidatePrimaryBlock(&bundle);
+				sdr_write(sdr, bundleObj, (char *) &bundle,
+						sizeof(Bundle));
+			}
+		}
+		else
+		{
+			fail_unless(bundle.custodian.c.nodeNbr
+					== (idx % 2 ? 1 : 0));
+			if (idx % 2 == 0)
+			{
+				fail_unless(bundle.primaryBlock == blocks[idx]);
+			}
+		}
+
+		fail_unless(sdr_end_xn(sdr) >= 0);
+		fail_unless(bpHandleXmitFailure(zco) == 0);
+		fail_unless(sdr_begin_xn(sdr));
+		zco_destroy(sdr, zco);
+		fail_unless(sdr_end_xn(sdr) >= 0);
+	}
+}
+
+int	main(int argc, char **argv)
+{
+	Sdr		sdr;
+	BpSAP		sap;
+	VOutduct	*vduct;
+	PsmAddress	vductElt;
+	Object		outductObj;
+	Outduct		outduct;
+	Outflow		flows[3];
+	Object		extent;
+	Object		adu;
+	Object		bundleObjs[BUNDLES];
+	Object		blocks[BUNDLES];
+	Bundle		bundle;
+	unsigned char	buffer[128];
+	struct timeval	start;
+	long		serializeUsec;
+	long		cacheUsec;
+	int		i;
+
+	ionstart("pbc.ionrc", NULL, NULL, "pbc.bprc", "pbc.ipnrc", NULL);
+	fail_unless(bp_attach() >= 0);
+	sdr = bp_get_sdr();
+	fail_unless(bp_open(sourceEid, &sap) >= 0);
+	findOutduct(protocolName, ductName, &vduct, &vductElt);
+	fail_unless(vductElt != 0);
+
+	/*	The test serves the outduct as its CLO, without
+	 *	transmission rate control.				*/
+
+	vduct->xmitThrottle.nominalRate = -1;
+	fail_unless(sdr_begin_xn(sdr));
+	outductObj = sdr_list_data(sdr, vduct->outductElt);
+	sdr_read(sdr, (char *) &outduct, outductObj, sizeof(Outduct));
+	sdr_exit_xn(sdr);
+	memset((char *) flows, 0, sizeof flows);
+	flows[0].outboundBundles = outduct.bulkQueue;
+	flows[1].outboundBundles = outduct.stdQueue;
+	flows[2].outboundBundles = outduct.urgentQueue;
+	for (i = 0; i < 3; i++)
+	{
+		flows[i].svcFactor = 1 << i;
+	}
+
+	for (i = 0; i < BUNDLES; i++)
+	{
+		fail_unless(sdr_begin_xn(sdr));
+		extent = sdr_malloc(sdr, sizeof ADU_TEXT);
+		fail_unless(extent != 0);
+		sdr_write(sdr, extent, ADU_TEXT, sizeof ADU_TEXT);
+		adu = zco_create(sdr, ZcoSdrSource, extent, 0, sizeof ADU_TEXT);
+		fail_unless(sdr_end_xn(sdr) >= 0);
+		fail_unless(adu != 0 && adu != (Object) ERROR);
+		fail_unless(bp_send(sap, destEid, NULL, 86400, BP_STD_PRIORITY,
+				NoCustodyRequested, 0, 0, NULL, adu,
+				&(bundleObjs[i])) > 0);
+	}
+
+	/*	Every transmission begins with the bundle's current
+	 *	primary block, serialized only when not yet cached.	*/
+
+	transmitAll(vduct, flows, bundleObjs, blocks, 0);
+	transmitAll(vduct, flows, bundleObjs, blocks, 1);
+	printf("Bundles transmitted twice: %d\n", BUNDLES);
+
+	/*	Time taken to serialize a primary block and to retrieve
+	 *	the serialized block.					*/
+
+	fail_unless(sdr_begin_xn(sdr));
+	sdr_read(sdr, (char *) &bundle, bundleObjs[0], sizeof(Bundle));
+	fail_unless(bundle.primaryBlock != 0);
+	getCurrentTime(&start);
+	for (i = 0; i < BENCH_BLOCKS; i++)
+	{
+		fail_unless(refSerialize(&bundle, buffer)
+				== bundle.primaryBlockLength);
+	}
+
+	serializeUsec = elapsedUsec(&start);
+	getCurrentTime(&start);
+	for (i = 0; i < BENCH_BLOCKS; i++)
+	{
+		sdr_read(sdr, (char *) buffer, bundle.primaryBlock,
+				bundle.primaryBlockLength);
+	}
+
+	cacheUsec = elapsedUsec(&start);
+	sdr_exit_xn(sdr);
+	printf("Primary blocks: %d of %d bytes\n", BENCH_BLOCKS,
+			bundle.primaryBlockLength);
+	printf("nsec per primary block: serialize %.1f, cached %.1f\n",
+			(serializeUsec * 1000.0) / BENCH_BLOCKS,
+			(cacheUsec * 1000.0) / BENCH_BLOCKS);
+
+	bp_close(sap);
+	writeErrmsgMemos();
+	bp_detach();
+	ionstop();
+	CHECK_FINISH;
+}
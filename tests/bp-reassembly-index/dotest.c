@@ -0,0 +1,229 @@
+/*
+
+	bp-reassembly-index/dotest.c:	Reassembly index test.
+
+	Acquires the first fragments of 10000 bundles, then their
+	second fragments in shuffled order, through an induct's
+	acquisition work area, and verifies that every original
+	bundle is reassembled and delivered intact.  Reports the
+	time taken per fragment acquired while few and while many
+	bundles are in reassembly at once.
+
+									*/
+
+#include "check.h"
+#include "testutil.h"
+#include "bpP.h"
+
+#define	BUNDLES		(10000)
+#define	BATCH		(1000)
+#define	FRAGMENT_LENGTH	(32)
+#define	ADU_LENGTH	(2 * FRAGMENT_LENGTH)
+#define	SOURCE_NODE	(2)
+#define	LIFETIME	(86400)
+
+static char	destEid[] = "ipn:1.1";
+static char	schemeName[] = "ipn";
+static char	destNss[] = "1.1";
+static char	protocolName[] = "ltp";
+static char	ductName[] = "1";
+
+static unsigned char	aduByte(unsigned int count, int offset)
+{
+	return (count * 7) + offset;
+}
+
+/*	Serializes one fragment of an original bundle whose creation
+ *	timestamp count is count: a CBHE primary block and a payload
+ *	block carrying FRAGMENT_LENGTH bytes of the ADU.		*/
+
+static int	serializeFragment(unsigned char *buffer, unsigned int seconds,
+			unsigned int count, int fragmentOffset)
+{
+	uvast		fields[14] = { 1, 1, SOURCE_NODE, 1, 0, 0, 0, 0,
+				seconds, count, LIFETIME, 0, fragmentOffset,
+				ADU_LENGTH };
+	unsigned char	rest[sizeof fields * 2];
+	int		restLength;
+	unsigned char	*cursor = buffer;
+	uvast		header[2];
+	int		i;
+
+	restLength = encodeSdnvs(rest, sizeof rest, fields, 14);
+	fail_unless(restLength > 0);
+	*cursor++ = 6;				/*	Version.	*/
+	header[0] = BDL_IS_FRAGMENT | BDL_DEST_IS_SINGLETON;
+	header[1] = restLength;
+	cursor += encodeSdnvs(cursor, 16, header, 2);
+	memcpy(cursor, rest, restLength);
+	cursor += restLength;
+	*cursor++ = 1;				/*	Payload block.	*/
+	header[0] = BLK_IS_LAST;
+	header[1] = FRAGMENT_LENGTH;
+	cursor += encodeSdnvs(cursor, 16, header, 2);
+	for (i = 0; i < FRAGMENT_LENGTH; i++)
+	{
+		*cursor++ = aduByte(count, fragmentOffset + i);
+	}
+
+	return cursor - buffer;
+}
+
+static void	acquire(AcqWorkArea *work, unsigned char *bundle, int length)
+{
+	fail_unless(bpBeginAcq(work, 0, NULL) == 0);
+	fail_unless(bpContinueAcq(work, (char *) bundle, length) == 0);
+	fail_unless(bpEndAcq(work) == 0);
+}
+
+static long	incompletes()
+{
+	Sdr		sdr = getIonsdr();
+	VScheme		*vscheme;
+	VEndpoint	*vpoint;
+	PsmAddress	elt;
+	Endpoint	endpoint;
+	long		count;
+
+	fail_unless(sdr_begin_xn(sdr));
+	findScheme(schemeName, &vscheme, &elt);
+	fail_unless(elt != 0);
+	findEndpoint(NULL, destNss, vscheme, &vpoint, &elt);
+	fail_unless(elt != 0);
+	sdr_read(sdr, (char *) &endpoint, sdr_list_data(sdr,
+			vpoint->endpointElt), sizeof(Endpoint));
+	count = sdr_list_length(sdr, endpoint.incompletes);
+	sdr_exit_xn(sdr);
+	return count;
+}
+
+/*	Acquires one fragment of each bundle in the order given, and
+ *	returns the time taken per fragment in the first and the last
+ *	batch of fragments.						*/
+
+static void	acquireFragments(AcqWorkArea *work, unsigned int seconds,
+			unsigned int *counts, int fragmentOffset,
+			double *firstUsec, double *lastUsec)
+{
+	unsigned char	bundle[256];
+	int		length;
+	struct timeval	start;
+	int		i;
+
+	for (i = 0; i < BUNDLES; i++)
+	{
+		length = serializeFragment(bundle, seconds, counts[i],
+				fragmentOffset);
+		if (i % BATCH == 0)
+		{
+			getCurrentTime(&start);
+		}
+
+		acquire(work, bundle, length);
+		if (i == BATCH - 1)
+		{
+			*firstUsec = ((double) elapsedUsec(&start)) / BATCH;
+		}
+
+		if (i == BUNDLES - 1)
+		{
+			*lastUsec = ((double) elapsedUsec(&start)) / BATCH;
+		}
+	}
+}
+
+int	main(int argc, char **argv)
+{
+	Sdr		sdr;
+	BpSAP		sap;
+	VInduct		*vduct;
+	PsmAddress	vductElt;
+	AcqWorkArea	*work;
+	DtnTime		now;
+	BpDelivery	dlv;
+	ZcoReader	reader;
+	unsigned char	adu[ADU_LENGTH];
+	unsigned char	*delivered;
+	unsigned int	*counts;
+	double		firstUsec;
+	double		lastUsec;
+	int		i;
+
+	srand(46);
+	ionadmin("reass.ionrc");
+	ltpadmin_default_config("loopback-ltp/loopback.ltprc");
+	bpadmin_default_config("loopback-ltp/loopback.bprc");
+	fail_unless(bp_attach() >= 0);
+	sdr = bp_get_sdr();
+	fail_unless(bp_open(destEid, &sap) >= 0);
+	findInduct(protocolName, ductName, &vduct, &vductElt);
+	fail_unless(vductElt != 0);
+	work = bpGetAcqArea(vduct);
+	fail_unless(work != NULL);
+
+	/*	Give bpclock time to open the induct's reception
+	 *	throttle for the contact.				*/
+
+	snooze(2);
+	counts = malloc(BUNDLES * sizeof(unsigned int));
+	delivered = calloc(BUNDLES, 1);
+	fail_unless(counts != NULL && delivered != NULL);
+	for (i = 0; i < BUNDLES; i++)
+	{
+		counts[i] = i;
+	}
+
+	/*	First fragments of all bundles, each starting a new
+	 *	reassembly.						*/
+
+	getCurrentDtnTime(&now);
+	acquireFragments(work, now.seconds, counts, 0, &firstUsec, &lastUsec);
+	fail_unless(incompletes() == BUNDLES);
+	printf("Bundles in reassembly: %d\n", BUNDLES);
+	printf("usec per first fragment: 0-%d pending %.2f, %d-%d pending \
+%.2f\n", BATCH, firstUsec, BUNDLES - BATCH, BUNDLES, lastUsec);
+
+	/*	Second fragments in shuffled order, each completing a
+	 *	reassembly.						*/
+
+	shuffle(counts, BUNDLES);
+	acquireFragments(work, now.seconds, counts, FRAGMENT_LENGTH,
+			&firstUsec, &lastUsec);
+	fail_unless(incompletes() == 0);
+	printf("usec per last fragment: %d-%d pending %.2f, 0-%d pending \
+%.2f\n", BUNDLES, BUNDLES - BATCH, firstUsec, BATCH, lastUsec);
+
+	/*	Every original bundle is delivered exactly once.	*/
+
+	for (i = 0; i < BUNDLES; i++)
+	{
+		fail_unless(bp_receive(sap, &dlv, BP_POLL) >= 0);
+		fail_unless(dlv.result == BpPayloadPresent);
+		fail_unless(dlv.bundleCreationTime.count < BUNDLES);
+		fail_unless(delivered[dlv.bundleCreationTime.count] == 0);
+		delivered[dlv.bundleCreationTime.count] = 1;
+		fail_unless(sdr_begin_xn(sdr));
+		fail_unless(zco_source_data_length(sdr, dlv.adu) == ADU_LENGTH);
+		zco_start_receiving(dlv.adu, &reader);
+		fail_unless(zco_receive_source(sdr, &reader, ADU_LENGTH,
+				(char *) adu) == ADU_LENGTH);
+		fail_unless(sdr_end_xn(sdr) >= 0);
+		fail_unless(adu[0] == aduByte(dlv.bundleCreationTime.count, 0));
+		fail_unless(adu[ADU_LENGTH - 1]
+			== aduByte(dlv.bundleCreationTime.count,
+			ADU_LENGTH - 1));
+		bp_release_delivery(&dlv, 1);
+	}
+
+	fail_unless(bp_receive(sap, &dlv, BP_POLL) >= 0);
+	fail_unless(dlv.result != BpPayloadPresent);
+
+	free(counts);
+	free(delivered);
+	bpReleaseAcqArea(work);
+	bp_close(sap);
+	writeErrmsgMemos();
+	bp_detach();
+	ionstop();
+	CHECK_FINISH;
+}
@@ -0,0 +1,240 @@
+/*
+
+	bp-zero-copy-reassembly/dotest.c:	Zero-copy reassembly test.
+
+	Fragments a 100 MB bundle whose payload resides in a file
+	into 1 KB fragments, each acquired through an induct's
+	acquisition work area as a ZCO whose payload is an extent
+	of that file, and verifies that the original bundle is
+	reassembled and delivered intact.  Checks that reassembly
+	grows the SDR heap's high-water mark by far less than the
+	length of the ADU, i.e., that no payload bytes are copied
+	into the heap, and reports the time taken to acquire all
+	fragments and to acquire the final, completing fragment.
+
+									*/
+
+#include "check.h"
+#include "testutil.h"
+#include "bpP.h"
+
+#define	ADU_FILE	"zcr.adu"
+#define	ADU_LENGTH	(100 * 1024 * 1024)
+#define	FRAGMENT_LENGTH	(1024)
+#define	FRAGMENTS	(ADU_LENGTH / FRAGMENT_LENGTH)
+#define	SOURCE_NODE	(2)
+#define	LIFETIME	(86400)
+#define	BUFLEN		(65536)
+
+static char	destEid[] = "ipn:1.1";
+static char	protocolName[] = "ltp";
+static char	ductName[] = "1";
+static char	aduFile[] = ADU_FILE;
+
+static unsigned char	aduByte(unsigned int offset)
+{
+	return (offset % 251) ^ (offset / FRAGMENT_LENGTH);
+}
+
+static void	writeAduFile()
+{
+	unsigned char	buffer[BUFLEN];
+	unsigned int	offset;
+	int		fd;
+	int		i;
+
+	fd = iopen(ADU_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	fail_unless(fd >= 0);
+	for (offset = 0; offset < ADU_LENGTH; offset += BUFLEN)
+	{
+		for (i = 0; i < BUFLEN; i++)
+		{
+			buffer[i] = aduByte(offset + i);
+		}
+
+		fail_unless(write(fd, buffer, BUFLEN) == BUFLEN);
+	}
+
+	close(fd);
+}
+
+/*	Serializes all of one fragment of the original bundle but its
+ *	payload: a CBHE primary block and the header of a payload block
+ *	carrying FRAGMENT_LENGTH bytes of the ADU.			*/
+
+static int	serializeHeader(unsigned char *buffer, unsigned int seconds,
+			unsigned int fragmentOffset)
+{
+	uvast		fields[14] = { 1, 1, SOURCE_NODE, 1, 0, 0, 0, 0,
+				seconds, 0, LIFETIME, 0, fragmentOffset,
+				ADU_LENGTH };
+	unsigned char	rest[sizeof fields * 2];
+	int		restLength;
+	unsigned char	*cursor = buffer;
+	uvast		header[2];
+
+	restLength = encodeSdnvs(rest, sizeof rest, fields, 14);
+	fail_unless(restLength > 0);
+	*cursor++ = 6;				/*	Version.	*/
+	header[0] = BDL_IS_FRAGMENT | BDL_DEST_IS_SINGLETON;
+	header[1] = restLength;
+	cursor += encodeSdnvs(cursor, 16, header, 2);
+	memcpy(cursor, rest, restLength);
+	cursor += restLength;
+	*cursor++ = 1;				/*	Payload block.	*/
+	header[0] = BLK_IS_LAST;
+	header[1] = FRAGMENT_LENGTH;
+	cursor += encodeSdnvs(cursor, 16, header, 2);
+	return cursor - buffer;
+}
+
+/*	Acquires one fragment as a ZCO comprising its header, in the
+ *	SDR heap, and its payload, an extent of the ADU file.		*/
+
+static void	acquire(AcqWorkArea *work, Object fileRef, unsigned int seconds,
+			unsigned int fragmentOffset)
+{
+	Sdr		sdr = getIonsdr();
+	unsigned char	header[128];
+	int		headerLength;
+	Object		headerObj;
+	Object		zco;
+
+	headerLength = serializeHeader(header, seconds, fragmentOffset);
+	fail_unless(sdr_begin_xn(sdr));
+	headerObj = sdr_malloc(sdr, headerLength);
+	fail_unless(headerObj != 0);
+	sdr_write(sdr, headerObj, (char *) header, headerLength);
+	zco = zco_create(sdr, ZcoSdrSource, headerObj, 0, headerLength);
+	fail_unless(zco != 0 && zco != (Object) ERROR);
+	fail_unless(zco_append_extent(sdr, zco, ZcoFileSource, fileRef,
+			fragmentOffset, FRAGMENT_LENGTH) > 0);
+	fail_unless(sdr_end_xn(sdr) >= 0);
+	fail_unless(bpBeginAcq(work, 0, NULL) == 0);
+	fail_unless(bpLoadAcq(work, zco) == 0);
+	fail_unless(bpEndAcq(work) == 0);
+}
+
+static vast	heapHighWaterMark()
+{
+	Sdr		sdr = getIonsdr();
+	SdrUsageSummary	usage;
+
+	fail_unless(sdr_begin_xn(sdr));
+	sdr_usage(sdr, &usage);
+	sdr_exit_xn(sdr);
+	return usage.sdrSize - usage.unusedSize;
+}
+
+int	main(int argc, char **argv)
+{
+	Sdr		sdr;
+	BpSAP		sap;
+	VInduct		*vduct;
+	PsmAddress	vductElt;
+	AcqWorkArea	*work;
+	Object		fileRef;
+	DtnTime		now;
+	BpDelivery	dlv;
+	ZcoReader	reader;
+	unsigned char	buffer[BUFLEN];
+	unsigned int	offset;
+	vast		highWaterMark;
+	vast		growth;
+	struct timeval	start;
+	struct timeval	lastStart;
+	long		totalUsec;
+	long		lastUsec;
+	int		i;
+
+	writeAduFile();
+	ionadmin("zcr.ionrc");
+	ltpadmin_default_config("loopback-ltp/loopback.ltprc");
+	bpadmin_default_config("loopback-ltp/loopback.bprc");
+	fail_unless(bp_attach() >= 0);
+	sdr = bp_get_sdr();
+	fail_unless(bp_open(destEid, &sap) >= 0);
+	findInduct(protocolName, ductName, &vduct, &vductElt);
+	fail_unless(vductElt != 0);
+	work = bpGetAcqArea(vduct);
+	fail_unless(work != NULL);
+	fail_unless(sdr_begin_xn(sdr));
+	fileRef = zco_create_file_ref(sdr, aduFile, NULL);
+	fail_unless(sdr_end_xn(sdr) >= 0);
+	fail_unless(fileRef != 0);
+
+	/*	Give bpclock time to open the induct's reception
+	 *	throttle for the contact.				*/
+
+	snooze(2);
+
+	/*	All fragments but the last are held in reassembly.	*/
+
+	getCurrentDtnTime(&now);
+	getCurrentTime(&start);
+	for (i = 0; i < FRAGMENTS - 1; i++)
+	{
+		acquire(work, fileRef, now.seconds, i * FRAGMENT_LENGTH);
+	}
+
+	fail_unless(bp_receive(sap, &dlv, BP_POLL) >= 0);
+	fail_unless(dlv.result != BpPayloadPresent);
+
+	/*	The last fragment completes reassembly.			*/
+
+	highWaterMark = heapHighWaterMark();
+	getCurrentTime(&lastStart);
+	acquire(work, fileRef, now.seconds, i * FRAGMENT_LENGTH);
+	lastUsec = elapsedUsec(&lastStart);
+	totalUsec = elapsedUsec(&start);
+	growth = heapHighWaterMark() - highWaterMark;
+	printf("Fragments: %d of %d bytes, ADU length %d\n", FRAGMENTS,
+			FRAGMENT_LENGTH, ADU_LENGTH);
+	printf("msec to acquire all fragments %.1f, final fragment %.1f\n",
+			totalUsec / 1000.0, lastUsec / 1000.0);
+	printf("SDR heap high-water mark growth in reassembly: %ld bytes\n",
+			(long) growth);
+	fail_unless(growth < ADU_LENGTH / 10);
+
+	/*	The original bundle is delivered intact.		*/
+
+	do
+	{
+		fail_unless(bp_receive(sap, &dlv, BP_POLL) >= 0);
+	} while (dlv.result == BpReceptionInterrupted);
+
+	fail_unless(dlv.result == BpPayloadPresent);
+	fail_unless(sdr_begin_xn(sdr));
+	fail_unless(zco_source_data_length(sdr, dlv.adu) == ADU_LENGTH);
+	zco_start_receiving(dlv.adu, &reader);
+	for (offset = 0; offset < ADU_LENGTH; offset += BUFLEN)
+	{
+		fail_unless(zco_receive_source(sdr, &reader, BUFLEN,
+				(char *) buffer) == BUFLEN);
+		for (i = 0; i < BUFLEN; i++)
+		{
+			if (buffer[i] != aduByte(offset + i))
+			{
+				break;
+			}
+		}
+
+		fail_unless(i == BUFLEN);
+	}
+
+	fail_unless(sdr_end_xn(sdr) >= 0);
+	bp_release_delivery(&dlv, 1);
+	fail_unless(bp_receive(sap, &dlv, BP_POLL) >= 0);
+	fail_unless(dlv.result != BpPayloadPresent);
+
+	fail_unless(sdr_begin_xn(sdr));
+	zco_destroy_file_ref(sdr, fileRef);
+	fail_unless(sdr_end_xn(sdr) >= 0);
+	bpReleaseAcqArea(work);
+	bp_close(sap);
+	writeErrmsgMemos();
+	bp_detach();
+	ionstop();
+	unlink(ADU_FILE);
+	CHECK_FINISH;
+}
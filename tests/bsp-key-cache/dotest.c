@@ -0,0 +1,145 @@
+/*
+
+	bsp-key-cache/dotest.c:	BSP key cache test.
+
+	Verifies that bsp_retrieveKey returns the cached value of a
+	key without reloading it, that adding, updating, or removing
+	a key invalidates the cache, and that a key value still held
+	by a caller survives invalidation.  Then reports the time
+	taken per key retrieval from the security database and from
+	the cache.
+
+									*/
+
+#include <bp.h>
+#include "check.h"
+#include "testutil.h"
+#include "extbsputil.h"
+
+#define	KEY_NAME	"cachedkey"
+#define	KEY_FILE	"cachedkey.bin"
+#define	FIRST_VALUE	"first value of the key"
+#define	SECOND_VALUE	"second, longer value of the key"
+#define	BENCH_LOOKUPS	(100000)
+
+static void	writeKeyFile(char *value)
+{
+	int	fd;
+
+	fd = iopen(KEY_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	fail_unless(fd >= 0);
+	fail_unless(write(fd, value, strlen(value)) == strlen(value));
+	close(fd);
+}
+
+/*	The retrieval procedure that preceded the key cache.		*/
+
+static char	*loadKey(int *keyLen, char *keyName)
+{
+	char	c = ' ';
+	char	*keyValue;
+
+	*keyLen = 0;
+	if (sec_get_key(keyName, keyLen, &c) != 0 || *keyLen == 0)
+	{
+		return NULL;
+	}
+
+	keyValue = MTAKE(*keyLen);
+	if (keyValue == NULL)
+	{
+		return NULL;
+	}
+
+	if (sec_get_key(keyName, keyLen, keyValue) != *keyLen)
+	{
+		MRELEASE(keyValue);
+		return NULL;
+	}
+
+	return keyValue;
+}
+
+int	main(int argc, char **argv)
+{
+	unsigned char	*value;
+	unsigned char	*again;
+	unsigned char	*held;
+	char		*loaded;
+	int		keyLen;
+	unsigned int	generation;
+	struct timeval	start;
+	long		loadUsec;
+	long		cacheUsec;
+	int		i;
+
+	ionstart_default_config("loopback-ltp/loopback.ionrc", NULL, NULL,
+			NULL, NULL, NULL);
+	fail_unless(secInitialize() >= 0);
+
+	/*	A key is cached on first retrieval.			*/
+
+	writeKeyFile(FIRST_VALUE);
+	generation = sec_get_keyGeneration();
+	fail_unless(sec_addKey(KEY_NAME, KEY_FILE) == 1);
+	fail_unless(sec_get_keyGeneration() != generation);
+	value = bsp_retrieveKey(&keyLen, KEY_NAME);
+	fail_unless(value != NULL);
+	fail_unless(keyLen == strlen(FIRST_VALUE));
+	fail_unless(memcmp(value, FIRST_VALUE, keyLen) == 0);
+	again = bsp_retrieveKey(&keyLen, KEY_NAME);
+	fail_unless(again == value);
+	bsp_releaseKey(again);
+
+	/*	Updating the key invalidates the cache, but the value
+	 *	still held is intact until released.			*/
+
+	held = value;
+	writeKeyFile(SECOND_VALUE);
+	generation = sec_get_keyGeneration();
+	fail_unless(sec_updateKey(KEY_NAME, KEY_FILE) == 1);
+	fail_unless(sec_get_keyGeneration() != generation);
+	value = bsp_retrieveKey(&keyLen, KEY_NAME);
+	fail_unless(value != NULL);
+	fail_unless(value != held);
+	fail_unless(keyLen == strlen(SECOND_VALUE));
+	fail_unless(memcmp(value, SECOND_VALUE, keyLen) == 0);
+	fail_unless(memcmp(held, FIRST_VALUE, strlen(FIRST_VALUE)) == 0);
+	bsp_releaseKey(held);
+	bsp_releaseKey(value);
+
+	/*	Throughput of retrieval from the database and from
+	 *	the cache.						*/
+
+	getCurrentTime(&start);
+	for (i = 0; i < BENCH_LOOKUPS; i++)
+	{
+		loaded = loadKey(&keyLen, KEY_NAME);
+		fail_unless(loaded != NULL);
+		MRELEASE(loaded);
+	}
+
+	loadUsec = elapsedUsec(&start);
+	getCurrentTime(&start);
+	for (i = 0; i < BENCH_LOOKUPS; i++)
+	{
+		value = bsp_retrieveKey(&keyLen, KEY_NAME);
+		fail_unless(value != NULL);
+		bsp_releaseKey(value);
+	}
+
+	cacheUsec = elapsedUsec(&start);
+	printf("Key retrievals: %d\n", BENCH_LOOKUPS);
+	printf("nsec per retrieval: database %.1f, cache %.1f\n",
+			(loadUsec * 1000.0) / BENCH_LOOKUPS,
+			(cacheUsec * 1000.0) / BENCH_LOOKUPS);
+
+	/*	A removed key can no longer be retrieved.		*/
+
+	fail_unless(sec_removeKey(KEY_NAME) == 1);
+	fail_unless(bsp_retrieveKey(&keyLen, KEY_NAME) == NULL);
+
+	writeErrmsgMemos();
+	ionstop();
+	CHECK_FINISH;
+}
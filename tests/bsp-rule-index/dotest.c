@@ -0,0 +1,404 @@
+/*
+
+	bsp-rule-index/dotest.c:	security rule index test.
+
+	Verifies that the indexed lookups of BAB, PIB, and PCB rules
+	select the same rule as a scan of the rules list, for random
+	rule sets with overlapping wild-card EIDs, as rules are added
+	and removed.  Then reports the time taken per BAB rule lookup
+	by the scan and by the index for a large rule set.
+
+									*/
+
+#include <ion.h>
+#include "ionsec.h"
+#include "check.h"
+#include "testutil.h"
+
+#define	ROUNDS		(5)
+#define	RULES_PER_ROUND	(150)
+#define	QUERIES		(2000)
+#define	BENCH_RULES	(3000)
+#define	BENCH_LOOKUPS	(2000)
+
+static int	blockTypes[] = { 1, 3, 10 };
+
+/*	The rule lookup that preceded the rule index.			*/
+
+static int	referenceEidsMatch(char *firstEid, int firstEidLen,
+			char *secondEid, int secondEidLen)
+{
+	int	firstPos = -1;
+	int	secondPos = -1;
+	int	result;
+
+	if (firstEidLen <= 0 || secondEidLen <= 0)
+	{
+		return 0;
+	}
+
+	if (firstEid[firstEidLen - 1] == '~')
+	{
+		firstPos = firstEidLen - 1;
+	}
+
+	if (secondEid[secondEidLen - 1] == '~')
+	{
+		secondPos = secondEidLen - 1;
+	}
+
+	if (firstPos == 0 || secondPos == 0)
+	{
+		result = 0;
+	}
+	else if (firstPos > 0 && secondPos > 0)
+	{
+		result = strncmp(firstEid, secondEid, MIN(firstPos, secondPos));
+	}
+	else if (firstPos > 0)
+	{
+		result = strncmp(firstEid, secondEid, MIN(firstPos,
+				secondEidLen));
+	}
+	else if (secondPos > 0)
+	{
+		result = strncmp(firstEid, secondEid, MIN(firstEidLen,
+				secondPos));
+	}
+	else
+	{
+		result = strncmp(firstEid, secondEid, MIN(firstEidLen,
+				secondEidLen));
+	}
+
+	return (result == 0);
+}
+
+static Object	rulesList(int ruleType)
+{
+	Sdr	sdr = getIonsdr();
+	SecDB	secdb;
+
+	sdr_read(sdr, (char *) &secdb, getSecDbObject(), sizeof(SecDB));
+	switch (ruleType)
+	{
+	case BSP_BAB_TYPE:
+		return secdb.bspBabRules;
+
+	case BSP_PIB_TYPE:
+		return secdb.bspPibRules;
+
+	default:
+		return secdb.bspPcbRules;
+	}
+}
+
+static void	readRule(int ruleType, Object ruleAddr, char *srcEid,
+			char *destEid, int *blockTypeNbr)
+{
+	Sdr		sdr = getIonsdr();
+	BspBabRule	babRule;
+	BspPibRule	pibRule;
+	BspPcbRule	pcbRule;
+
+	switch (ruleType)
+	{
+	case BSP_BAB_TYPE:
+		sdr_read(sdr, (char *) &babRule, ruleAddr, sizeof babRule);
+		sdr_string_read(sdr, srcEid, babRule.securitySrcEid);
+		sdr_string_read(sdr, destEid, babRule.securityDestEid);
+		*blockTypeNbr = 0;
+		break;
+
+	case BSP_PIB_TYPE:
+		sdr_read(sdr, (char *) &pibRule, ruleAddr, sizeof pibRule);
+		sdr_string_read(sdr, srcEid, pibRule.securitySrcEid);
+		sdr_string_read(sdr, destEid, pibRule.securityDestEid);
+		*blockTypeNbr = pibRule.blockTypeNbr;
+		break;
+
+	default:
+		sdr_read(sdr, (char *) &pcbRule, ruleAddr, sizeof pcbRule);
+		sdr_string_read(sdr, srcEid, pcbRule.securitySrcEid);
+		sdr_string_read(sdr, destEid, pcbRule.securityDestEid);
+		*blockTypeNbr = pcbRule.blockTypeNbr;
+	}
+}
+
+static int	referenceLookup(int ruleType, char *srcEid, char *destEid,
+			int blockTypeNbr, Object *ruleAddr, Object *eltp)
+{
+	Sdr	sdr = getIonsdr();
+	Object	elt;
+	char	ruleSrcEid[SDRSTRING_BUFSZ];
+	char	ruleDestEid[SDRSTRING_BUFSZ];
+	int	ruleBlockTypeNbr;
+	int	result = 0;
+
+	*ruleAddr = 0;
+	*eltp = 0;
+	fail_unless(sdr_begin_xn(sdr));
+	for (elt = sdr_list_first(sdr, rulesList(ruleType)); elt;
+			elt = sdr_list_next(sdr, elt))
+	{
+		readRule(ruleType, sdr_list_data(sdr, elt), ruleSrcEid,
+				ruleDestEid, &ruleBlockTypeNbr);
+		if (ruleBlockTypeNbr == blockTypeNbr
+		&& referenceEidsMatch(ruleDestEid, strlen(ruleDestEid),
+				destEid, strlen(destEid))
+		&& referenceEidsMatch(ruleSrcEid, strlen(ruleSrcEid),
+				srcEid, strlen(srcEid)))
+		{
+			*ruleAddr = sdr_list_data(sdr, elt);
+			*eltp = elt;
+			result = 1;
+			break;
+		}
+	}
+
+	sdr_exit_xn(sdr);
+	return result;
+}
+
+static int	indexedLookup(int ruleType, char *srcEid, char *destEid,
+			int blockTypeNbr, Object *ruleAddr, Object *eltp)
+{
+	switch (ruleType)
+	{
+	case BSP_BAB_TYPE:
+		return sec_get_bspBabRule(srcEid, destEid, ruleAddr, eltp);
+
+	case BSP_PIB_TYPE:
+		return sec_get_bspPibRule(srcEid, destEid, blockTypeNbr,
+				ruleAddr, eltp);
+
+	default:
+		return sec_get_bspPcbRule(srcEid, destEid, blockTypeNbr,
+				ruleAddr, eltp);
+	}
+}
+
+/*	Random EIDs drawn from a small space, so that many rules
+ *	overlap, including EIDs that are prefixes of one another.	*/
+
+static void	randomEid(char *eid, int wildcardsOkay)
+{
+	int	node = 1 + (rand() % 25);
+	int	svc = rand() % 12;
+
+	switch (rand() % (wildcardsOkay ? 7 : 3))
+	{
+	case 0:
+	case 1:
+		isprintf(eid, 32, "ipn:%d.%d", node, svc);
+		break;
+
+	case 2:
+		isprintf(eid, 32, "dtn://node%d/app%d", node, svc);
+		break;
+
+	case 3:
+		isprintf(eid, 32, "ipn:%d.~", node);
+		break;
+
+	case 4:
+		isprintf(eid, 32, "ipn:%d*", node);
+		break;
+
+	case 5:
+		isprintf(eid, 32, "dtn://node%d/~", node);
+		break;
+
+	default:
+		istrcpy(eid, (rand() % 2) ? "~" : "ipn:~", 32);
+	}
+}
+
+static void	addRandomRule(int ruleType)
+{
+	char	srcEid[32];
+	char	destEid[32];
+	int	blockTypeNbr = blockTypes[rand() % 3];
+
+	randomEid(srcEid, 1);
+	randomEid(destEid, 1);
+	switch (ruleType)
+	{
+	case BSP_BAB_TYPE:
+		fail_unless(sec_addBspBabRule(srcEid, destEid, "HMAC_SHA1",
+				"key") >= 0);
+		break;
+
+	case BSP_PIB_TYPE:
+		fail_unless(sec_addBspPibRule(srcEid, destEid, blockTypeNbr,
+				"PIB-RSA-SHA256", "key") >= 0);
+		break;
+
+	default:
+		fail_unless(sec_addBspPcbRule(srcEid, destEid, blockTypeNbr,
+				"PCB-RSA-AES128-PAYLOAD-PIB-PCB", "key") >= 0);
+	}
+}
+
+static void	removeRandomRule(int ruleType)
+{
+	Sdr	sdr = getIonsdr();
+	Object	elt;
+	int	count;
+	char	srcEid[SDRSTRING_BUFSZ];
+	char	destEid[SDRSTRING_BUFSZ];
+	int	blockTypeNbr;
+
+	fail_unless(sdr_begin_xn(sdr));
+	count = sdr_list_length(sdr, rulesList(ruleType));
+	if (count == 0)
+	{
+		sdr_exit_xn(sdr);
+		return;
+	}
+
+	for (elt = sdr_list_first(sdr, rulesList(ruleType)), count = rand()
+			% count; count > 0; count--)
+	{
+		elt = sdr_list_next(sdr, elt);
+	}
+
+	readRule(ruleType, sdr_list_data(sdr, elt), srcEid, destEid,
+			&blockTypeNbr);
+	sdr_exit_xn(sdr);
+	switch (ruleType)
+	{
+	case BSP_BAB_TYPE:
+		fail_unless(sec_removeBspBabRule(srcEid, destEid) == 1);
+		break;
+
+	case BSP_PIB_TYPE:
+		fail_unless(sec_removeBspPibRule(srcEid, destEid, blockTypeNbr)
+				== 1);
+		break;
+
+	default:
+		fail_unless(sec_removeBspPcbRule(srcEid, destEid, blockTypeNbr)
+				== 1);
+	}
+}
+
+static void	checkLookups(int ruleType)
+{
+	char	srcEid[32];
+	char	destEid[32];
+	int	blockTypeNbr;
+	Object	expectedAddr;
+	Object	expectedElt;
+	Object	ruleAddr;
+	Object	elt;
+	int	expected;
+	int	i;
+
+	for (i = 0; i < QUERIES; i++)
+	{
+		/*	Mostly concrete EIDs, as in bundle processing,
+		 *	but also the wild cards used in rule editing.	*/
+
+		randomEid(srcEid, (i % 4) == 0);
+		randomEid(destEid, (i % 4) == 1);
+		blockTypeNbr = (ruleType == BSP_BAB_TYPE ? 0
+				: blockTypes[rand() % 3]);
+		expected = referenceLookup(ruleType, srcEid, destEid,
+				blockTypeNbr, &expectedAddr, &expectedElt);
+		fail_unless(indexedLookup(ruleType, srcEid, destEid,
+				blockTypeNbr, &ruleAddr, &elt) == expected);
+		fail_unless(ruleAddr == expectedAddr);
+		fail_unless(elt == expectedElt);
+	}
+}
+
+static void	runBenchmark()
+{
+	char		srcEid[32];
+	char		destEid[32];
+	Object		ruleAddr;
+	Object		elt;
+	struct timeval	start;
+	long		scanUsec;
+	long		indexUsec;
+	int		i;
+
+	ionClear("~", "~", "bab");
+	for (i = 0; i < BENCH_RULES; i++)
+	{
+		istrcpy(srcEid, "~", sizeof srcEid);
+		isprintf(destEid, sizeof destEid, "ipn:%d.~", i);
+		fail_unless(sec_addBspBabRule(srcEid, destEid, "HMAC_SHA1",
+				"key") == 1);
+	}
+
+	getCurrentTime(&start);
+	for (i = 0; i < BENCH_LOOKUPS; i++)
+	{
+		isprintf(destEid, sizeof destEid, "ipn:%d.1",
+				(i * 7919) % BENCH_RULES);
+		fail_unless(referenceLookup(BSP_BAB_TYPE, "ipn:1.1", destEid, 0,
+				&ruleAddr, &elt) == 1);
+	}
+
+	scanUsec = elapsedUsec(&start);
+	getCurrentTime(&start);
+	for (i = 0; i < BENCH_LOOKUPS; i++)
+	{
+		isprintf(destEid, sizeof destEid, "ipn:%d.1",
+				(i * 7919) % BENCH_RULES);
+		fail_unless(sec_get_bspBabRule("ipn:1.1", destEid, &ruleAddr,
+				&elt) == 1);
+	}
+
+	indexUsec = elapsedUsec(&start);
+	printf("BAB rules: %d, lookups: %d\n", BENCH_RULES, BENCH_LOOKUPS);
+	printf("usec per lookup: list scan %.2f, index %.2f\n",
+			((double) scanUsec) / BENCH_LOOKUPS,
+			((double) indexUsec) / BENCH_LOOKUPS);
+}
+
+int	main(int argc, char **argv)
+{
+	int	ruleTypes[] = { BSP_BAB_TYPE, BSP_PIB_TYPE, BSP_PCB_TYPE };
+	int	round;
+	int	t;
+	int	i;
+
+	srand(43);
+	ionstart_default_config("loopback-ltp/loopback.ionrc", NULL, NULL,
+			NULL, NULL, NULL);
+	fail_unless(secInitialize() >= 0);
+	for (round = 0; round < ROUNDS; round++)
+	{
+		for (t = 0; t < 3; t++)
+		{
+			for (i = 0; i < RULES_PER_ROUND; i++)
+			{
+				addRandomRule(ruleTypes[t]);
+			}
+
+			checkLookups(ruleTypes[t]);
+			for (i = 0; i < RULES_PER_ROUND / 3; i++)
+			{
+				removeRandomRule(ruleTypes[t]);
+			}
+
+			checkLookups(ruleTypes[t]);
+		}
+	}
+
+	/*	Clearing rules must also invalidate the index.		*/
+
+	ionClear("ipn:1~", "~", "~");
+	for (t = 0; t < 3; t++)
+	{
+		checkLookups(ruleTypes[t]);
+	}
+
+	runBenchmark();
+	writeErrmsgMemos();
+	ionstop();
+	CHECK_FINISH;
+}
@@ -0,0 +1,137 @@
+/*
+
+	cfdp-checksum-buffer/dotest.c:	CFDP buffer checksum test.
+
+	Verifies that cfdp_update_checksum_buffer computes the same
+	checksum and final offset as passing each octet in turn to
+	cfdp_update_checksum, for every combination of buffer
+	address alignment, starting file offset, and length up to
+	MAX_SHORT, for long buffers of odd length, for random data
+	checksummed in random chunks, and for data of all 1s, which
+	maximizes carries between byte lanes.
+
+									*/
+
+#include <platform.h>
+#include <cfdp.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	DATA_LENGTH	(1024 * 1024 + 3)
+#define	MAX_SHORT	(67)
+#define	CHUNKINGS	(200)
+
+static unsigned int	referenceChecksum(unsigned char *buffer, int length,
+				unsigned int *offset, unsigned int checksum)
+{
+	int	i;
+
+	for (i = 0; i < length; i++)
+	{
+		cfdp_update_checksum(buffer[i], offset, &checksum);
+	}
+
+	return checksum;
+}
+
+/*	Checksums one buffer both ways, starting from the same file
+ *	offset and running checksum, and compares the results.		*/
+
+static void	compareChecksums(unsigned char *buffer, int length,
+			unsigned int offset, unsigned int checksum)
+{
+	unsigned int	refOffset = offset;
+	unsigned int	refChecksum;
+
+	refChecksum = referenceChecksum(buffer, length, &refOffset, checksum);
+	cfdp_update_checksum_buffer(buffer, length, &offset, &checksum);
+	fail_unless(checksum == refChecksum);
+	fail_unless(offset == refOffset);
+}
+
+/*	Checksums the whole buffer in chunks of random length and
+ *	compares the result to the octet-at-a-time checksum.		*/
+
+static void	compareChunked(unsigned char *buffer, int length,
+			unsigned int refChecksum)
+{
+	unsigned int	offset = 0;
+	unsigned int	checksum = 0;
+	int		done = 0;
+	int		chunk;
+
+	while (done < length)
+	{
+		chunk = rand() % 5000;
+		if (chunk > length - done)
+		{
+			chunk = length - done;
+		}
+
+		cfdp_update_checksum_buffer(buffer + done, chunk, &offset,
+				&checksum);
+		done += chunk;
+	}
+
+	fail_unless(checksum == refChecksum);
+	fail_unless(offset == length);
+}
+
+int	main(int argc, char **argv)
+{
+	unsigned char	*data;
+	unsigned int	refOffset;
+	unsigned int	refChecksum;
+	int		align;
+	int		offset;
+	int		length;
+	int		i;
+
+	/*	Room to start the data at any of 4 address alignments.	*/
+
+	data = (unsigned char *) malloc(DATA_LENGTH + 4);
+	fail_unless(data != NULL);
+	srand(1);
+	for (i = 0; i < DATA_LENGTH + 4; i++)
+	{
+		data[i] = rand() & 0xff;
+	}
+
+	for (align = 0; align < 4; align++)
+	{
+		for (offset = 0; offset < 8; offset++)
+		{
+			for (length = 0; length <= MAX_SHORT; length++)
+			{
+				compareChecksums(data + align, length, offset,
+						0x89abcdef);
+			}
+		}
+	}
+
+	for (align = 0; align < 4; align++)
+	{
+		for (offset = 0; offset < 4; offset++)
+		{
+			compareChecksums(data + align, DATA_LENGTH, offset, 0);
+			compareChecksums(data + align, 65535, offset, 0);
+			compareChecksums(data + align, 4093, offset, 0);
+		}
+	}
+
+	refOffset = 0;
+	refChecksum = referenceChecksum(data, DATA_LENGTH, &refOffset, 0);
+	for (i = 0; i < CHUNKINGS; i++)
+	{
+		compareChunked(data, DATA_LENGTH, refChecksum);
+	}
+
+	memset(data, 0xff, DATA_LENGTH + 4);
+	for (align = 0; align < 4; align++)
+	{
+		compareChecksums(data + align, DATA_LENGTH, align, 0);
+	}
+
+	free(data);
+	CHECK_FINISH;
+}
@@ -0,0 +1,282 @@
+/*
+
+	dgr-loopback/dotest.c:	DGR loopback retransmission test.
+
+	Sends messages between two DGR service access points on the
+	loopback interface, at most MAX_OUTSTANDING unacknowledged at
+	any time, through a relay that discards one of every
+	DROP_INTERVAL datagrams sent toward the receiver, once with
+	each congestion controller.  Verifies that every message is
+	acknowledged, that none is reported undeliverable, and that
+	the receiver gets every message intact, so each discarded
+	datagram must have been retransmitted.  Then reports the
+	rate at which the messages were acknowledged.
+
+									*/
+
+#include <platform.h>
+#include <poll.h>
+#include <dgr.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	LOOPBACK_ADDR	(0x7f000001)
+#define	MSG_COUNT	(2000)
+#define	MSG_LENGTH	(1000)
+#define	DROP_INTERVAL	(50)
+#define	MAX_OUTSTANDING	(100)		/*	Keeps backlog small.	*/
+#define	MAX_IDLE	(30)		/*	Seconds.		*/
+
+static char		*controllers[] = { "cubic", "legacy" };
+
+static int		running = 1;
+static int		relaySocket;
+static unsigned short	receiverPort;
+static int		dropped;
+static unsigned char	received[2 * MSG_COUNT];
+static int		receivedCount;
+
+static void	fillMessage(char *content, unsigned int seqNbr)
+{
+	int	i;
+
+	content[0] = (seqNbr >> 24) & 0xff;
+	content[1] = (seqNbr >> 16) & 0xff;
+	content[2] = (seqNbr >> 8) & 0xff;
+	content[3] = seqNbr & 0xff;
+	for (i = 4; i < MSG_LENGTH; i++)
+	{
+		content[i] = (seqNbr + i) & 0xff;
+	}
+}
+
+static unsigned int	messageSeqNbr(char *content)
+{
+	unsigned char	*bytes = (unsigned char *) content;
+
+	return (bytes[0] << 24) + (bytes[1] << 16) + (bytes[2] << 8)
+			+ bytes[3];
+}
+
+/*	Forwards datagrams from the sender to the receiver, discarding
+ *	every DROP_INTERVALth one, and returns the receiver's reports
+ *	to the sender.							*/
+
+static void	*relay(void *parm)
+{
+	struct sockaddr_in	from;
+	struct sockaddr_in	sender;
+	struct sockaddr_in	receiver;
+	socklen_t		fromLength;
+	struct pollfd		fds;
+	char			buffer[65536];
+	int			length;
+	int			forwarded = 0;
+
+	memset((char *) &sender, 0, sizeof sender);
+	memset((char *) &receiver, 0, sizeof receiver);
+	receiver.sin_family = AF_INET;
+	receiver.sin_addr.s_addr = htonl(LOOPBACK_ADDR);
+	receiver.sin_port = htons(receiverPort);
+	fds.fd = relaySocket;
+	fds.events = POLLIN;
+	while (running)
+	{
+		if (poll(&fds, 1, 100) < 1)
+		{
+			continue;
+		}
+
+		fromLength = sizeof from;
+		length = recvfrom(relaySocket, buffer, sizeof buffer, 0,
+				(struct sockaddr *) &from, &fromLength);
+		if (length < 0)
+		{
+			continue;
+		}
+
+		if (from.sin_port == receiver.sin_port)
+		{
+			if (sender.sin_port != 0)
+			{
+				oK(sendto(relaySocket, buffer, length, 0,
+					(struct sockaddr *) &sender,
+					sizeof sender));
+			}
+
+			continue;
+		}
+
+		sender = from;
+		forwarded++;
+		if (forwarded % DROP_INTERVAL == 0)
+		{
+			dropped++;
+			continue;
+		}
+
+		oK(sendto(relaySocket, buffer, length, 0,
+				(struct sockaddr *) &receiver, sizeof receiver));
+	}
+
+	return NULL;
+}
+
+static void	*receive(void *parm)
+{
+	Dgr		dgr = (Dgr) parm;
+	char		content[65536];
+	unsigned short	fromPortNbr;
+	unsigned int	fromIpAddress;
+	int		length;
+	int		errnbr;
+	DgrRC		rc;
+	char		expected[MSG_LENGTH];
+	unsigned int	seqNbr;
+
+	while (running)
+	{
+		fail_unless(dgr_receive(dgr, &fromPortNbr, &fromIpAddress,
+				content, &length, &errnbr, 1, &rc) == 0);
+		if (rc != DgrDatagramReceived)
+		{
+			continue;
+		}
+
+		fail_unless(length == MSG_LENGTH);
+		seqNbr = messageSeqNbr(content);
+		fail_unless(seqNbr < 2 * MSG_COUNT);
+		fillMessage(expected, seqNbr);
+		fail_unless(memcmp(content, expected, MSG_LENGTH) == 0);
+		if (received[seqNbr] == 0)
+		{
+			received[seqNbr] = 1;
+			receivedCount++;
+		}
+	}
+
+	return NULL;
+}
+
+static void	runTransfer(Dgr sender, unsigned short relayPort, int pass)
+{
+	char		content[MSG_LENGTH];
+	unsigned short	fromPortNbr;
+	unsigned int	fromIpAddress;
+	int		length;
+	int		errnbr;
+	DgrRC		rc;
+	int		sent = 0;
+	int		acknowledged = 0;
+	int		failed = 0;
+	int		idle = 0;
+	int		firstDropped = dropped;
+	int		firstReceived = receivedCount;
+	struct timeval	start;
+	long		usec;
+
+	fail_unless(dgr_set_congestion_control(sender, controllers[pass])
+			== 0);
+	getCurrentTime(&start);
+	while (acknowledged + failed < MSG_COUNT && idle < MAX_IDLE)
+	{
+		while (sent < MSG_COUNT
+		&& sent - (acknowledged + failed) < MAX_OUTSTANDING)
+		{
+			fillMessage(content, (pass * MSG_COUNT) + sent);
+			fail_unless(dgr_send(sender, relayPort, LOOPBACK_ADDR,
+					DGR_NOTE_ALL, content, MSG_LENGTH, &rc)
+					== 0);
+			fail_unless(rc == DgrDatagramSent);
+			sent++;
+		}
+
+		fail_unless(dgr_receive(sender, &fromPortNbr, &fromIpAddress,
+				content, &length, &errnbr, 1, &rc) == 0);
+		switch (rc)
+		{
+		case DgrDatagramAcknowledged:
+			fail_unless(messageSeqNbr(content) / MSG_COUNT == pass);
+			acknowledged++;
+			idle = 0;
+			break;
+
+		case DgrDatagramNotAcknowledged:
+			failed++;
+			idle = 0;
+			break;
+
+		case DgrTimedOut:
+			idle++;
+			break;
+
+		default:
+			fail_unless(0);
+		}
+	}
+
+	usec = elapsedUsec(&start);
+	for (idle = 0; receivedCount - firstReceived < MSG_COUNT
+			&& idle < MAX_IDLE; idle++)
+	{
+		snooze(1);
+	}
+
+	fail_unless(acknowledged == MSG_COUNT);
+	fail_unless(failed == 0);
+	fail_unless(receivedCount - firstReceived == MSG_COUNT);
+	fail_unless(dropped - firstDropped > 0);
+	printf("%s: %d messages of %d bytes, %d datagrams dropped, \
+acknowledged in %.2f sec: %.2f MB/s\n", controllers[pass], MSG_COUNT,
+			MSG_LENGTH, dropped - firstDropped, usec / 1000000.0,
+			((double) MSG_COUNT * MSG_LENGTH) / usec);
+}
+
+int	main(int argc, char **argv)
+{
+	Dgr			sender;
+	Dgr			receiver;
+	DgrRC			rc;
+	unsigned int		ipAddress;
+	unsigned short		relayPort;
+	struct sockaddr_in	socketAddress;
+	socklen_t		nameLength = sizeof socketAddress;
+	pthread_t		relayThread;
+	pthread_t		receiverThread;
+	int			pass;
+
+	fail_unless(dgr_open(1, 2, 0, LOOPBACK_ADDR, NULL, &receiver, &rc)
+			== 0);
+	fail_unless(rc == DgrOpened);
+	dgr_getsockname(receiver, &receiverPort, &ipAddress);
+	fail_unless(dgr_open(2, 2, 0, LOOPBACK_ADDR, NULL, &sender, &rc)
+			== 0);
+	fail_unless(rc == DgrOpened);
+
+	relaySocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	fail_unless(relaySocket >= 0);
+	memset((char *) &socketAddress, 0, sizeof socketAddress);
+	socketAddress.sin_family = AF_INET;
+	socketAddress.sin_addr.s_addr = htonl(LOOPBACK_ADDR);
+	fail_unless(bind(relaySocket, (struct sockaddr *) &socketAddress,
+			sizeof socketAddress) == 0);
+	fail_unless(getsockname(relaySocket,
+			(struct sockaddr *) &socketAddress, &nameLength) == 0);
+	relayPort = ntohs(socketAddress.sin_port);
+	fail_unless(pthread_begin(&relayThread, NULL, relay, NULL) == 0);
+	fail_unless(pthread_begin(&receiverThread, NULL, receive, receiver)
+			== 0);
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		runTransfer(sender, relayPort, pass);
+	}
+
+	running = 0;
+	pthread_join(relayThread, NULL);
+	pthread_join(receiverThread, NULL);
+	closesocket(relaySocket);
+	dgr_close(sender);
+	dgr_close(receiver);
+	CHECK_FINISH;
+}
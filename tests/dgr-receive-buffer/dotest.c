@@ -0,0 +1,234 @@
+/*
+
+	dgr-receive-buffer/dotest.c:	DGR receive buffer lending test.
+
+	Sends messages between two DGR service access points on the
+	loopback interface and takes them with dgr_receive_buffer.
+	First holds every received buffer until all HELD_MSGS messages
+	have arrived, which is more than DGR can lend from its pool,
+	and verifies that every held buffer is distinct and its
+	content still intact.  Then releases all of them and verifies
+	that messages received and released one at a time are also
+	delivered intact.  Delivery notices taken at the sender with
+	dgr_receive_buffer must carry the content of the messages
+	they acknowledge.
+
+									*/
+
+#include <platform.h>
+#include <dgr.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	LOOPBACK_ADDR	(0x7f000001)
+#define	POOLED_BUFS	(16)		/*	DGR_RECV_BUFS		*/
+#define	HELD_MSGS	(3 * POOLED_BUFS)
+#define	MSG_COUNT	(2 * HELD_MSGS)
+#define	MAX_IDLE	(10)		/*	Seconds.		*/
+
+static int	messageLength(unsigned int seqNbr)
+{
+	return 64 + (seqNbr * 13);
+}
+
+static void	fillMessage(char *content, unsigned int seqNbr)
+{
+	int	length = messageLength(seqNbr);
+	int	i;
+
+	content[0] = (seqNbr >> 8) & 0xff;
+	content[1] = seqNbr & 0xff;
+	for (i = 2; i < length; i++)
+	{
+		content[i] = (seqNbr * 7 + i) & 0xff;
+	}
+}
+
+static unsigned int	messageSeqNbr(char *content)
+{
+	unsigned char	*bytes = (unsigned char *) content;
+
+	return (bytes[0] << 8) + bytes[1];
+}
+
+static int	messageIsIntact(char *content, int length)
+{
+	char		expected[65535];
+	unsigned int	seqNbr = messageSeqNbr(content);
+
+	if (seqNbr >= MSG_COUNT || length != messageLength(seqNbr))
+	{
+		return 0;
+	}
+
+	fillMessage(expected, seqNbr);
+	return (memcmp(content, expected, length) == 0);
+}
+
+static void	sendMessages(Dgr sender, unsigned short receiverPort,
+			unsigned int first, int count)
+{
+	char		content[65535];
+	DgrRC		rc;
+	int		i;
+
+	for (i = 0; i < count; i++)
+	{
+		fillMessage(content, first + i);
+		fail_unless(dgr_send(sender, receiverPort, LOOPBACK_ADDR,
+				DGR_NOTE_ALL, content,
+				messageLength(first + i), &rc) == 0);
+		fail_unless(rc == DgrDatagramSent);
+	}
+}
+
+/*	Takes one inbound message, returning its lent buffer.		*/
+
+static char	*receiveMessage(Dgr receiver, int *length)
+{
+	unsigned short	fromPortNbr;
+	unsigned int	fromIpAddress;
+	char		*content;
+	int		errnbr;
+	DgrRC		rc;
+	int		idle;
+
+	for (idle = 0; idle < MAX_IDLE; idle++)
+	{
+		fail_unless(dgr_receive_buffer(receiver, &fromPortNbr,
+				&fromIpAddress, &content, length, &errnbr, 1,
+				&rc) == 0);
+		if (rc == DgrDatagramReceived)
+		{
+			return content;
+		}
+
+		fail_unless(rc == DgrTimedOut);
+	}
+
+	return NULL;
+}
+
+/*	Takes the delivery notices for "count" messages.		*/
+
+static void	collectAcks(Dgr sender, unsigned char *acked, int count)
+{
+	unsigned short	fromPortNbr;
+	unsigned int	fromIpAddress;
+	char		*content;
+	int		length;
+	int		errnbr;
+	DgrRC		rc;
+	unsigned int	seqNbr;
+	int		idle = 0;
+
+	while (count > 0 && idle < MAX_IDLE)
+	{
+		fail_unless(dgr_receive_buffer(sender, &fromPortNbr,
+				&fromIpAddress, &content, &length, &errnbr, 1,
+				&rc) == 0);
+		if (rc == DgrTimedOut)
+		{
+			idle++;
+			continue;
+		}
+
+		fail_unless(rc == DgrDatagramAcknowledged);
+		fail_unless(messageIsIntact(content, length));
+		seqNbr = messageSeqNbr(content);
+		fail_unless(acked[seqNbr] == 0);
+		acked[seqNbr] = 1;
+		dgr_release_buffer(sender, content);
+		count--;
+	}
+
+	fail_unless(count == 0);
+}
+
+int	main(int argc, char **argv)
+{
+	Dgr		sender;
+	Dgr		receiver;
+	DgrRC		rc;
+	unsigned int	ipAddress;
+	unsigned short	receiverPort;
+	char		*held[HELD_MSGS];
+	int		heldLengths[HELD_MSGS];
+	unsigned char	received[MSG_COUNT];
+	unsigned char	acked[MSG_COUNT];
+	char		*content;
+	int		length;
+	unsigned int	seqNbr;
+	int		i;
+	int		j;
+
+	memset(received, 0, sizeof received);
+	memset(acked, 0, sizeof acked);
+	fail_unless(dgr_open(1, 2, 0, LOOPBACK_ADDR, NULL, &receiver, &rc)
+			== 0);
+	fail_unless(rc == DgrOpened);
+	dgr_getsockname(receiver, &receiverPort, &ipAddress);
+	fail_unless(dgr_open(2, 2, 0, LOOPBACK_ADDR, NULL, &sender, &rc)
+			== 0);
+	fail_unless(rc == DgrOpened);
+
+	/*	Hold more buffers than DGR can lend.			*/
+
+	sendMessages(sender, receiverPort, 0, HELD_MSGS);
+	for (i = 0; i < HELD_MSGS; i++)
+	{
+		held[i] = receiveMessage(receiver, heldLengths + i);
+		fail_unless(held[i] != NULL);
+		if (held[i] == NULL)
+		{
+			break;
+		}
+
+		fail_unless(messageIsIntact(held[i], heldLengths[i]));
+		seqNbr = messageSeqNbr(held[i]);
+		fail_unless(received[seqNbr] == 0);
+		received[seqNbr] = 1;
+		for (j = 0; j < i; j++)
+		{
+			fail_unless(held[j] != held[i]);
+		}
+	}
+
+	for (j = 0; j < i; j++)
+	{
+		fail_unless(messageIsIntact(held[j], heldLengths[j]));
+		dgr_release_buffer(receiver, held[j]);
+	}
+
+	collectAcks(sender, acked, HELD_MSGS);
+
+	/*	Released buffers are lent again.			*/
+
+	sendMessages(sender, receiverPort, HELD_MSGS, MSG_COUNT - HELD_MSGS);
+	for (i = HELD_MSGS; i < MSG_COUNT; i++)
+	{
+		content = receiveMessage(receiver, &length);
+		fail_unless(content != NULL);
+		if (content == NULL)
+		{
+			break;
+		}
+
+		fail_unless(messageIsIntact(content, length));
+		seqNbr = messageSeqNbr(content);
+		fail_unless(received[seqNbr] == 0);
+		received[seqNbr] = 1;
+		dgr_release_buffer(receiver, content);
+	}
+
+	collectAcks(sender, acked, MSG_COUNT - HELD_MSGS);
+	for (i = 0; i < MSG_COUNT; i++)
+	{
+		fail_unless(received[i] == 1);
+		fail_unless(acked[i] == 1);
+	}
+
+	dgr_close(sender);
+	dgr_close(receiver);
+	CHECK_FINISH;
+}
@@ -0,0 +1,205 @@
+/*
+
+	imc-fanout/dotest.c:	Multicast fan-out test.
+
+	Sends bundles from one sender to a multicast group of 500
+	member nodes, each reached by way of one of four outducts,
+	and verifies that imcfw queues exactly one copy of each
+	bundle for transmission via each outduct, every copy
+	carrying the entire payload.  Reports the time taken per
+	multicast bundle forwarded.
+
+									*/
+
+#include "check.h"
+#include "testutil.h"
+#include "imcP.h"
+
+#define	GROUP_NBR	(7)
+#define	MEMBERS		(500)
+#define	FIRST_MEMBER	(2)
+#define	OUTDUCTS	(4)
+#define	BUNDLES		(20)
+#define	IPNRC		"fan.ipnrc"
+#define	ADU_TEXT	"multicast fan-out test ADU"
+
+static char	sourceEid[] = "ipn:1.1";
+static char	destEid[] = "imc:7.1";
+static char	protocolName[] = "udp";
+
+static void	ductName(char *buffer, int i)
+{
+	isprintf(buffer, 32, "127.0.0.1:%d", 5001 + i);
+}
+
+/*	Writes a plan for every group member, assigning the members
+ *	to the outducts in rotation.					*/
+
+static void	writePlans()
+{
+	FILE	*fp;
+	char	name[32];
+	int	i;
+
+	fp = fopen(IPNRC, "w");
+	fail_unless(fp != NULL);
+	for (i = 0; i < MEMBERS; i++)
+	{
+		ductName(name, i % OUTDUCTS);
+		fprintf(fp, "a plan %d %s/%s\n", FIRST_MEMBER + i,
+				protocolName, name);
+	}
+
+	fclose(fp);
+}
+
+/*	Joins the group and enrolls every member node in it, as
+ *	imcHandlePetition would on receiving each member's petition.	*/
+
+static void	createGroup()
+{
+	Sdr		sdr = getIonsdr();
+	Object		groupAddr;
+	Object		elt;
+	ImcGroup	group;
+	NodeId		member;
+	Object		obj;
+	int		i;
+
+	fail_unless(imcInit() == 0);
+	fail_unless(imcJoin(GROUP_NBR) == 0);
+	fail_unless(sdr_begin_xn(sdr));
+	imcFindGroup(GROUP_NBR, &groupAddr, &elt);
+	fail_unless(elt != 0);
+	sdr_read(sdr, (char *) &group, groupAddr, sizeof(ImcGroup));
+	for (i = 0; i < MEMBERS; i++)
+	{
+		member.nbr = FIRST_MEMBER + i;
+		obj = sdr_malloc(sdr, sizeof(NodeId));
+		fail_unless(obj != 0);
+		sdr_write(sdr, obj, (char *) &member, sizeof(NodeId));
+		fail_unless(sdr_list_insert_last(sdr, group.members, obj) != 0);
+	}
+
+	fail_unless(sdr_end_xn(sdr) >= 0);
+}
+
+static long	forwardQueueLength()
+{
+	Sdr		sdr = getIonsdr();
+	VScheme		*vscheme;
+	PsmAddress	elt;
+	Scheme		scheme;
+	long		count;
+
+	fail_unless(sdr_begin_xn(sdr));
+	findScheme("imc", &vscheme, &elt);
+	fail_unless(elt != 0);
+	sdr_read(sdr, (char *) &scheme, sdr_list_data(sdr, vscheme->schemeElt),
+			sizeof(Scheme));
+	count = sdr_list_length(sdr, scheme.forwardQueue);
+	sdr_exit_xn(sdr);
+	return count;
+}
+
+/*	Returns the number of bundles queued for transmission via one
+ *	outduct, checking that each is a copy of a multicast bundle.	*/
+
+static long	copiesQueued(int i)
+{
+	Sdr		sdr = getIonsdr();
+	char		name[32];
+	VOutduct	*vduct;
+	PsmAddress	vductElt;
+	Outduct		outduct;
+	Object		elt;
+	Bundle		bundle;
+	long		count = 0;
+
+	ductName(name, i);
+	findOutduct(protocolName, name, &vduct, &vductElt);
+	fail_unless(vductElt != 0);
+	fail_unless(sdr_begin_xn(sdr));
+	sdr_read(sdr, (char *) &outduct, sdr_list_data(sdr,
+			vduct->outductElt), sizeof(Outduct));
+	fail_unless(sdr_list_length(sdr, outduct.bulkQueue) == 0);
+	fail_unless(sdr_list_length(sdr, outduct.urgentQueue) == 0);
+	for (elt = sdr_list_first(sdr, outduct.stdQueue); elt;
+			elt = sdr_list_next(sdr, elt))
+	{
+		sdr_read(sdr, (char *) &bundle, sdr_list_data(sdr, elt),
+				sizeof(Bundle));
+		fail_unless(bundle.destination.cbhe);
+		fail_unless(bundle.destination.c.nodeNbr == GROUP_NBR);
+		fail_unless(bundle.payload.length == sizeof ADU_TEXT);
+		fail_unless(zco_source_data_length(sdr, bundle.payload.content)
+				== sizeof ADU_TEXT);
+		count++;
+	}
+
+	sdr_exit_xn(sdr);
+	return count;
+}
+
+int	main(int argc, char **argv)
+{
+	Sdr		sdr;
+	BpSAP		sap;
+	Object		extent;
+	Object		adu;
+	Object		bundleObj;
+	struct timeval	start;
+	long		usec;
+	long		copies = 0;
+	int		i;
+
+	writePlans();
+	ionstart("fan.ionrc", NULL, NULL, "fan.bprc", IPNRC, NULL);
+	fail_unless(bp_attach() >= 0);
+	sdr = bp_get_sdr();
+	fail_unless(bp_open(sourceEid, &sap) >= 0);
+	createGroup();
+
+	/*	Forwarding of all bundles is complete once the imc
+	 *	scheme's forwarding queue is empty.			*/
+
+	getCurrentTime(&start);
+	for (i = 0; i < BUNDLES; i++)
+	{
+		fail_unless(sdr_begin_xn(sdr));
+		extent = sdr_malloc(sdr, sizeof ADU_TEXT);
+		fail_unless(extent != 0);
+		sdr_write(sdr, extent, ADU_TEXT, sizeof ADU_TEXT);
+		adu = zco_create(sdr, ZcoSdrSource, extent, 0, sizeof ADU_TEXT);
+		fail_unless(sdr_end_xn(sdr) >= 0);
+		fail_unless(adu != 0 && adu != (Object) ERROR);
+		fail_unless(bp_send(sap, destEid, NULL, 86400, BP_STD_PRIORITY,
+				NoCustodyRequested, 0, 0, NULL, adu, &bundleObj) > 0);
+	}
+
+	while (forwardQueueLength() > 0)
+	{
+		microsnooze(1000);
+	}
+
+	usec = elapsedUsec(&start);
+
+	/*	One copy of every bundle is queued per outduct.		*/
+
+	for (i = 0; i < OUTDUCTS; i++)
+	{
+		fail_unless(copiesQueued(i) == BUNDLES);
+		copies += BUNDLES;
+	}
+
+	printf("Group members: %d, outducts: %d\n", MEMBERS, OUTDUCTS);
+	printf("Bundles sent: %d, copies queued: %ld\n", BUNDLES, copies);
+	printf("msec per multicast bundle forwarded: %.2f\n",
+			(usec / 1000.0) / BUNDLES);
+
+	bp_close(sap);
+	writeErrmsgMemos();
+	bp_detach();
+	ionstop();
+	CHECK_FINISH;
+}
@@ -0,0 +1,411 @@
+/*
+
+	ion-bulk-contact-plan/dotest.c:	Bulk contact plan test.
+
+	Loads contact plans of 10,000 and 1,000 contacts by ionadmin's
+	bulk load command, the second plan listing its contacts and
+	ranges in reverse order, after adding 1,000 contacts by
+	individual ionadmin add commands.  Verifies that the contact
+	and range indexes hold every contact and range added, plus
+	the imputed reverse of every canonical range, in order; that
+	reloading a plan changes nothing; that a range asserted in a
+	plan overrides an imputed range; that a plan too large for
+	ION working memory is rejected, leaving the indexes unchanged
+	and the database usable; and that contacts added one at a
+	time after a bulk load are indexed correctly.
+
+	Run as "dotest bench" to load plans of 10,000, 100,000, and
+	1,000,000 contacts instead, after adding 10,000 contacts one
+	at a time, in a node configured with working memory enough
+	for all of them, and report the time taken by each.
+
+									*/
+
+#include "check.h"
+#include "testutil.h"
+#include "rfx.h"
+
+#define	PAIRS		(100)
+#define	LINE_NODES	(1000)
+#define	MORE_CONTACTS	(1000)
+#define	SPACING		(100)
+#define	DURATION	(50)
+#define	XMIT_RATE	(1000)
+#define	OWLT		(1)
+#define	OVERRIDE_OWLT	(2)
+#define	OVERSIZE_PLAN	(100000)	/*	Exceeds working memory.	*/
+#define	TEST_PLANS	(2)
+#define	BENCH_PLANS	(3)
+
+static int	testContacts[TEST_PLANS] = { 10000, 1000 };
+static int	benchContacts[BENCH_PLANS] = { 10000, 100000, 1000000 };
+static time_t	startTime;
+
+/*	Every plan comprises PAIRS pairs of nodes, from each of ten
+ *	nodes to each of ten others, with one range for each pair
+ *	and an equal share of the plan's contacts.			*/
+
+static uvast	planNodes(int plan)
+{
+	return 1000 * (plan + 2);
+}
+
+static uvast	fromNode(uvast nodes, int pair)
+{
+	return nodes + (pair / 10);
+}
+
+static uvast	toNode(uvast nodes, int pair)
+{
+	return nodes + 10 + (pair % 10);
+}
+
+static time_t	contactStart(int contact)
+{
+	return startTime + (contact * SPACING);
+}
+
+static void	writeLine(FILE *fp, char *format, char *type, time_t fromTime,
+			time_t toTime, uvast from, uvast to, unsigned int value)
+{
+	char	fromBuffer[TIMESTAMPBUFSZ];
+	char	toBuffer[TIMESTAMPBUFSZ];
+
+	writeTimestampUTC(fromTime, fromBuffer);
+	writeTimestampUTC(toTime, toBuffer);
+	fprintf(fp, format, type, fromBuffer, toBuffer, from, to, value);
+}
+
+static void	writePlan(FILE *fp, char *format, uvast nodes, int contacts,
+			int reversed)
+{
+	int	perPair = contacts / PAIRS;
+	int	pair;
+	int	i;
+	int	j;
+
+	for (i = 0; i < PAIRS; i++)
+	{
+		pair = reversed ? PAIRS - (i + 1) : i;
+		writeLine(fp, format, "range", contactStart(0),
+				contactStart(perPair), fromNode(nodes, pair),
+				toNode(nodes, pair), OWLT);
+	}
+
+	for (i = 0; i < contacts; i++)
+	{
+		j = reversed ? contacts - (i + 1) : i;
+		pair = j / perPair;
+		writeLine(fp, format, "contact", contactStart(j % perPair),
+				contactStart(j % perPair) + DURATION,
+				fromNode(nodes, pair), toNode(nodes, pair),
+				XMIT_RATE);
+	}
+}
+
+static void	writeFile(char *name, char *text)
+{
+	FILE	*fp;
+
+	fp = fopen(name, "w");
+	fail_unless(fp != NULL);
+	fputs(text, fp);
+	fclose(fp);
+}
+
+static long	runIonadmin(char *rcName)
+{
+	struct timeval	start;
+
+	getCurrentTime(&start);
+	ionadmin(rcName);
+	return elapsedUsec(&start);
+}
+
+/*	Checks that both indexes are in order and returns the number
+ *	of entries in each.						*/
+
+static void	checkIndexes(long *contacts, long *ranges)
+{
+	Sdr		sdr = getIonsdr();
+	PsmPartition	ionwm = getIonwm();
+	IonVdb		*vdb = getIonVdb();
+	PsmAddress	elt;
+	PsmAddress	prev = 0;
+	long		count;
+
+	fail_unless(sdr_begin_xn(sdr));
+	count = 0;
+	for (elt = sm_rbt_first(ionwm, vdb->contactIndex); elt;
+			elt = sm_rbt_next(ionwm, elt))
+	{
+		if (prev)
+		{
+			fail_unless(rfx_order_contacts(ionwm, prev,
+				psp(ionwm, sm_rbt_data(ionwm, elt))) < 0);
+		}
+
+		prev = sm_rbt_data(ionwm, elt);
+		count++;
+	}
+
+	fail_unless(count == sm_rbt_length(ionwm, vdb->contactIndex));
+	*contacts = count;
+	count = 0;
+	prev = 0;
+	for (elt = sm_rbt_first(ionwm, vdb->rangeIndex); elt;
+			elt = sm_rbt_next(ionwm, elt))
+	{
+		if (prev)
+		{
+			fail_unless(rfx_order_ranges(ionwm, prev,
+				psp(ionwm, sm_rbt_data(ionwm, elt))) < 0);
+		}
+
+		prev = sm_rbt_data(ionwm, elt);
+		count++;
+	}
+
+	fail_unless(count == sm_rbt_length(ionwm, vdb->rangeIndex));
+	*ranges = count;
+	sdr_exit_xn(sdr);
+}
+
+static IonCXref	*findContact(uvast from, uvast to, time_t fromTime)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb		*vdb = getIonVdb();
+	IonCXref	arg;
+	PsmAddress	elt;
+	PsmAddress	nextElt;
+
+	memset((char *) &arg, 0, sizeof(IonCXref));
+	arg.fromNode = from;
+	arg.toNode = to;
+	arg.fromTime = fromTime;
+	elt = sm_rbt_search(ionwm, vdb->contactIndex, rfx_order_contacts,
+			&arg, &nextElt);
+	if (elt == 0)
+	{
+		return NULL;
+	}
+
+	return (IonCXref *) psp(ionwm, sm_rbt_data(ionwm, elt));
+}
+
+static IonRXref	*findRange(uvast from, uvast to, time_t fromTime)
+{
+	PsmPartition	ionwm = getIonwm();
+	IonVdb		*vdb = getIonVdb();
+	IonRXref	arg;
+	PsmAddress	elt;
+	PsmAddress	nextElt;
+
+	memset((char *) &arg, 0, sizeof(IonRXref));
+	arg.fromNode = from;
+	arg.toNode = to;
+	arg.fromTime = fromTime;
+	elt = sm_rbt_search(ionwm, vdb->rangeIndex, rfx_order_ranges,
+			&arg, &nextElt);
+	if (elt == 0)
+	{
+		return NULL;
+	}
+
+	return (IonRXref *) psp(ionwm, sm_rbt_data(ionwm, elt));
+}
+
+/*	Checks the first and last contacts of every pair of nodes in
+ *	a plan, and the asserted and imputed ranges between them.  The
+ *	reverse range for the first pair may have been asserted.	*/
+
+static void	checkPlan(uvast nodes, int contacts, int overridden)
+{
+	Sdr		sdr = getIonsdr();
+	int		perPair = contacts / PAIRS;
+	IonCXref	*cxref;
+	IonRXref	*rxref;
+	int		pair;
+
+	fail_unless(sdr_begin_xn(sdr));
+	for (pair = 0; pair < PAIRS; pair++)
+	{
+		cxref = findContact(fromNode(nodes, pair), toNode(nodes, pair),
+				contactStart(0));
+		fail_unless(cxref != NULL);
+		fail_unless(cxref->toTime == contactStart(0) + DURATION);
+		fail_unless(cxref->xmitRate == XMIT_RATE);
+		fail_unless(cxref->contactElt != 0);
+		cxref = findContact(fromNode(nodes, pair), toNode(nodes, pair),
+				contactStart(perPair - 1));
+		fail_unless(cxref != NULL);
+		fail_unless(findContact(fromNode(nodes, pair),
+				toNode(nodes, pair), contactStart(perPair))
+				== NULL);
+		rxref = findRange(fromNode(nodes, pair), toNode(nodes, pair),
+				contactStart(0));
+		fail_unless(rxref != NULL);
+		fail_unless(rxref->rangeElt != 0);
+		rxref = findRange(toNode(nodes, pair), fromNode(nodes, pair),
+				contactStart(0));
+		fail_unless(rxref != NULL);
+		if (pair == 0 && overridden)
+		{
+			fail_unless(rxref->rangeElt != 0);
+			fail_unless(rxref->owlt == OVERRIDE_OWLT);
+		}
+		else
+		{
+			fail_unless(rxref->rangeElt == 0);
+			fail_unless(rxref->owlt == OWLT);
+		}
+	}
+
+	sdr_exit_xn(sdr);
+}
+
+/*	Writes a plan to a file, and an ionrc file that bulk loads
+ *	the plan, whose name is left in the name buffer.		*/
+
+static void	writeBulkLoad(char *name, int nameLength, uvast nodes,
+			int contacts, int reversed)
+{
+	FILE	*fp;
+	char	text[64];
+
+	isprintf(name, nameLength, "bcp-%d.csv", contacts);
+	fp = fopen(name, "w");
+	fail_unless(fp != NULL);
+	writePlan(fp, "%s,%s,%s,%lu,%lu,%u\n", nodes, contacts, reversed);
+	fclose(fp);
+	isprintf(text, sizeof text, "b bcp-%d.csv\n", contacts);
+	isprintf(name, nameLength, "bcp-%d.ionrc", contacts);
+	writeFile(name, text);
+}
+
+int	main(int argc, char **argv)
+{
+	int		bench = (argc > 1 && strcmp(argv[1], "bench") == 0);
+	int		*planContacts = bench ? benchContacts : testContacts;
+	int		plans = bench ? BENCH_PLANS : TEST_PLANS;
+	int		lineContacts = bench ? 10000 : 1000;
+	FILE		*fp;
+	char		name[32];
+	long		usec;
+	long		contacts;
+	long		ranges;
+	long		expectedContacts;
+	long		expectedRanges;
+	int		i;
+
+	ionstart(bench ? "bcpbench.ionrc" : "bcp.ionrc", NULL, NULL, NULL,
+			NULL, NULL);
+	fail_unless(ionAttach() >= 0);
+	startTime = getUTCTime() + 3600;
+
+	/*	Contacts added one at a time.				*/
+
+	fp = fopen("bcp-lines.ionrc", "w");
+	fail_unless(fp != NULL);
+	writePlan(fp, "a %s %s %s %lu %lu %u\n", LINE_NODES, lineContacts, 0);
+	fclose(fp);
+	usec = runIonadmin("bcp-lines.ionrc");
+	printf("msec to add %d contacts one at a time: %.1f\n", lineContacts,
+			usec / 1000.0);
+	checkIndexes(&contacts, &ranges);
+	fail_unless(contacts == lineContacts);
+	fail_unless(ranges == 2 * PAIRS);
+	expectedContacts = contacts;
+	expectedRanges = ranges;
+
+	/*	Contact plans loaded in bulk.				*/
+
+	for (i = 0; i < plans; i++)
+	{
+		writeBulkLoad(name, sizeof name, planNodes(i), planContacts[i],
+				i == 1);
+		usec = runIonadmin(name);
+		printf("msec to bulk load %d contacts: %.1f\n",
+				planContacts[i], usec / 1000.0);
+		checkIndexes(&contacts, &ranges);
+		expectedContacts += planContacts[i];
+		expectedRanges += 2 * PAIRS;
+		fail_unless(contacts == expectedContacts);
+		fail_unless(ranges == expectedRanges);
+	}
+
+	/*	Reloading a plan changes nothing.			*/
+
+	isprintf(name, sizeof name, "bcp-%d.ionrc", planContacts[0]);
+	usec = runIonadmin(name);
+	printf("msec to reload %d contacts: %.1f\n", planContacts[0],
+			usec / 1000.0);
+	checkIndexes(&contacts, &ranges);
+	fail_unless(contacts == expectedContacts);
+	fail_unless(ranges == expectedRanges);
+
+	/*	Asserting the reverse range for the first pair of
+	 *	nodes in the first plan overrides the imputed range.	*/
+
+	fp = fopen("bcp-override.csv", "w");
+	fail_unless(fp != NULL);
+	writeLine(fp, "%s,%s,%s,%lu,%lu,%u\n", "range", contactStart(0),
+			contactStart(planContacts[0] / PAIRS),
+			toNode(planNodes(0), 0), fromNode(planNodes(0), 0),
+			OVERRIDE_OWLT);
+	fclose(fp);
+	writeFile("bcp-override.ionrc", "b bcp-override.csv\n");
+	runIonadmin("bcp-override.ionrc");
+	checkIndexes(&contacts, &ranges);
+	fail_unless(contacts == expectedContacts);
+	fail_unless(ranges == expectedRanges);
+	for (i = 0; i < plans; i++)
+	{
+		checkPlan(planNodes(i), planContacts[i], i == 0);
+	}
+
+	/*	A plan that doesn't fit in working memory is rejected
+	 *	without changing either index, and without leaving
+	 *	the database locked.					*/
+
+	if (!bench)
+	{
+		writeBulkLoad(name, sizeof name, planNodes(plans),
+				OVERSIZE_PLAN, 0);
+		runIonadmin(name);
+		checkIndexes(&contacts, &ranges);
+		fail_unless(contacts == expectedContacts);
+		fail_unless(ranges == expectedRanges);
+		for (i = 0; i < plans; i++)
+		{
+			checkPlan(planNodes(i), planContacts[i], i == 0);
+		}
+	}
+
+	/*	Contacts added one at a time to the bulk-loaded index,
+	 *	between the node pairs of the last plan.		*/
+
+	fp = fopen("bcp-more.ionrc", "w");
+	fail_unless(fp != NULL);
+	for (i = 0; i < MORE_CONTACTS; i++)
+	{
+		writeLine(fp, "a %s %s %s %lu %lu %u\n", "contact",
+				contactStart(i), contactStart(i) + DURATION,
+				planNodes(plans - 1) + 10,
+				planNodes(plans - 1) + 1, XMIT_RATE);
+	}
+
+	fclose(fp);
+	runIonadmin("bcp-more.ionrc");
+	checkIndexes(&contacts, &ranges);
+	expectedContacts += MORE_CONTACTS;
+	fail_unless(contacts == expectedContacts);
+	fail_unless(ranges == expectedRanges);
+	printf("Contacts indexed: %ld, ranges indexed: %ld\n", contacts,
+			ranges);
+
+	writeErrmsgMemos();
+	ionDetach();
+	ionstop();
+	CHECK_FINISH;
+}
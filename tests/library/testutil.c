@@ -0,0 +1,32 @@
+/*
+
+	testutil.c:	Helper functions shared by tests.
+
+									*/
+
+#include <bp.h>
+#include "testutil.h"
+
+long elapsedUsec(struct timeval *start)
+{
+	struct timeval	end;
+
+	getCurrentTime(&end);
+	return ((end.tv_sec - start->tv_sec) * 1000000)
+			+ (end.tv_usec - start->tv_usec);
+}
+
+void shuffle(unsigned int *values, int count)
+{
+	int		i;
+	int		j;
+	unsigned int	value;
+
+	for (i = count - 1; i > 0; i--)
+	{
+		j = rand() % (i + 1);
+		value = values[i];
+		values[i] = values[j];
+		values[j] = value;
+	}
+}
@@ -83,3 +83,10 @@ const char *get_configs_path_prefix();
 
 /* Loads a security key defined in a default configuration. */
 int sec_addKey_default_config(char *keyName, char *fileName);
+
+/* Returns the number of microseconds elapsed since start, which was set
+ * by getCurrentTime(). */
+long elapsedUsec(struct timeval *start);
+
+/* Puts the count values in random order, using rand(). */
+void shuffle(unsigned int *values, int count);
@@ -0,0 +1,253 @@
+/*
+
+	sdnv-batch/dotest.c:	SDNV encoding and decoding test.
+
+	Verifies that the word-at-a-time SDNV encoder and decoders,
+	and the batch SDNV functions, agree with the byte-at-a-time
+	reference algorithm for values of every length, and that
+	truncated SDNVs are rejected.  Then reports the time taken
+	per SDNV by the reference algorithm and by the batch functions.
+
+									*/
+
+#include <platform.h>
+#include "check.h"
+#include "testutil.h"
+
+#define	BENCH_VALUES	(1000000)
+#define	BENCH_PASSES	(10)
+
+static int	referenceEncode(unsigned char *text, uvast val)
+{
+	static uvast	sdnvMask = ((uvast) -1) / 128;
+	uvast		remnant;
+	unsigned char	flag = 0;
+	int		length = 0;
+	int		i;
+
+	remnant = val;
+	do
+	{
+		remnant = (remnant >> 7) & sdnvMask;
+		length++;
+	} while (remnant > 0);
+
+	remnant = val;
+	for (i = length - 1; i >= 0; i--)
+	{
+		text[i] = (remnant & 0x7f) | flag;
+		remnant = (remnant >> 7) & sdnvMask;
+		flag = 0x80;
+	}
+
+	return length;
+}
+
+static int	referenceDecode(uvast *val, unsigned char *text)
+{
+	int	length = 0;
+
+	*val = 0;
+	while (length < 10)
+	{
+		*val = (*val << 7) | (text[length] & 0x7f);
+		if ((text[length++] & 0x80) == 0)
+		{
+			return length;
+		}
+	}
+
+	return 0;
+}
+
+static uvast	randomValue()
+{
+	uvast	val;
+	int	bits;
+
+	val = ((uvast) rand() << 42) ^ ((uvast) rand() << 21) ^ rand();
+	val ^= (uvast) rand() << 60;
+	bits = rand() % 65;
+	if (bits < 64)
+	{
+		val &= ((uvast) 1 << bits) - 1;
+	}
+
+	return val;
+}
+
+static void	checkValue(uvast val)
+{
+	unsigned char	expected[10];
+	unsigned char	padded[32];
+	int		expectedLength;
+	Sdnv		sdnv;
+	uvast		decoded;
+
+	expectedLength = referenceEncode(expected, val);
+	encodeSdnv(&sdnv, val);
+	fail_unless(sdnv.length == expectedLength);
+	fail_unless(memcmp(sdnv.text, expected, expectedLength) == 0);
+
+	fail_unless(decodeSdnv(&decoded, expected) == expectedLength);
+	fail_unless(decoded == val);
+
+	/*	Exercise the word-at-a-time decoder, with trailing
+	 *	bytes that look like the continuation of an SDNV.	*/
+
+	memset(padded, 0xff, sizeof padded);
+	memcpy(padded, expected, expectedLength);
+	fail_unless(decodeBoundedSdnv(&decoded, padded, sizeof padded)
+			== expectedLength);
+	fail_unless(decoded == val);
+
+	/*	Exercise the byte-at-a-time fallback.			*/
+
+	fail_unless(decodeBoundedSdnv(&decoded, expected, expectedLength)
+			== expectedLength);
+	fail_unless(decoded == val);
+
+	/*	A truncated SDNV must be rejected.			*/
+
+	if (expectedLength > 1)
+	{
+		fail_unless(decodeBoundedSdnv(&decoded, padded,
+				expectedLength - 1) == 0);
+	}
+}
+
+static void	runBenchmark()
+{
+	uvast		*vals;
+	uvast		*decoded;
+	unsigned char	*text;
+	int		textLength = BENCH_VALUES * 10;
+	int		encodedLength = 0;
+	int		length;
+	int		pass;
+	int		i;
+	uvast		sum = 0;
+	struct timeval	start;
+	long		refEncodeUsec;
+	long		refDecodeUsec;
+	long		encodeUsec;
+	long		decodeUsec;
+
+	vals = (uvast *) malloc(BENCH_VALUES * sizeof(uvast));
+	decoded = (uvast *) malloc(BENCH_VALUES * sizeof(uvast));
+	text = (unsigned char *) malloc(textLength);
+	fail_unless(vals != NULL && decoded != NULL && text != NULL);
+
+	/*	Mostly small values, as in LTP and BP headers.		*/
+
+	for (i = 0; i < BENCH_VALUES; i++)
+	{
+		vals[i] = randomValue() & (((uvast) 1 << (rand() % 36)) - 1);
+	}
+
+	getCurrentTime(&start);
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+	{
+		encodedLength = 0;
+		for (i = 0; i < BENCH_VALUES; i++)
+		{
+			encodedLength += referenceEncode(text + encodedLength,
+					vals[i]);
+		}
+	}
+
+	refEncodeUsec = elapsedUsec(&start);
+	getCurrentTime(&start);
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+	{
+		length = 0;
+		for (i = 0; i < BENCH_VALUES; i++)
+		{
+			length += referenceDecode(decoded + i, text + length);
+		}
+
+		sum += decoded[pass];
+	}
+
+	refDecodeUsec = elapsedUsec(&start);
+	getCurrentTime(&start);
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+	{
+		length = encodeSdnvs(text, textLength, vals, BENCH_VALUES);
+	}
+
+	encodeUsec = elapsedUsec(&start);
+	fail_unless(length == encodedLength);
+	getCurrentTime(&start);
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+	{
+		length = decodeSdnvs(decoded, BENCH_VALUES, text, encodedLength);
+		sum += decoded[pass];
+	}
+
+	decodeUsec = elapsedUsec(&start);
+	fail_unless(length == encodedLength);
+	fail_unless(memcmp(decoded, vals, BENCH_VALUES * sizeof(uvast)) == 0);
+
+	printf("SDNVs per pass: %d (%d bytes), passes: %d, checksum: "
+			UVAST_FIELDSPEC "\n", BENCH_VALUES, encodedLength,
+			BENCH_PASSES, sum);
+	printf("Encode nsec per SDNV: reference %.2f, encodeSdnvs %.2f\n",
+			(refEncodeUsec * 1000.0) / (BENCH_VALUES * BENCH_PASSES),
+			(encodeUsec * 1000.0) / (BENCH_VALUES * BENCH_PASSES));
+	printf("Decode nsec per SDNV: reference %.2f, decodeSdnvs %.2f\n",
+			(refDecodeUsec * 1000.0) / (BENCH_VALUES * BENCH_PASSES),
+			(decodeUsec * 1000.0) / (BENCH_VALUES * BENCH_PASSES));
+	free(vals);
+	free(decoded);
+	free(text);
+}
+
+int	main(int argc, char **argv)
+{
+	uvast		vals[64];
+	uvast		decoded[64];
+	unsigned char	text[640];
+	int		textLength = 0;
+	int		length;
+	int		i;
+
+	srand(334);
+
+	/*	Every value at and around each SDNV length boundary.	*/
+
+	checkValue(0);
+	for (i = 1; i < 64; i++)
+	{
+		checkValue(((uvast) 1 << i) - 1);
+		checkValue((uvast) 1 << i);
+		checkValue(((uvast) 1 << i) + 1);
+	}
+
+	checkValue((uvast) -1);
+	for (i = 0; i < 100000; i++)
+	{
+		checkValue(randomValue());
+	}
+
+	/*	Batch functions, including an exactly-sized buffer.	*/
+
+	for (i = 0; i < 64; i++)
+	{
+		vals[i] = randomValue();
+		textLength += referenceEncode(text + textLength, vals[i]);
+	}
+
+	fail_unless(decodeSdnvs(decoded, 64, text, textLength) == textLength);
+	fail_unless(memcmp(decoded, vals, sizeof vals) == 0);
+	fail_unless(decodeSdnvs(decoded, 64, text, textLength - 1) == 0);
+	memset(text, 0, sizeof text);
+	fail_unless(encodeSdnvs(text, textLength - 1, vals, 64) == 0);
+	length = encodeSdnvs(text, textLength, vals, 64);
+	fail_unless(length == textLength);
+	fail_unless(decodeSdnvs(decoded, 64, text, textLength) == textLength);
+	fail_unless(memcmp(decoded, vals, sizeof vals) == 0);
+
+	runBenchmark();
+	CHECK_FINISH;
+}